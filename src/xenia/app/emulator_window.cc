@@ -36,6 +36,7 @@
 #include "xenia/gpu/command_processor.h"
 #include "xenia/gpu/graphics_system.h"
 #include "xenia/hid/input_system.h"
+#include "xenia/kernel/kernel_state.h"
 #include "xenia/kernel/xam/profile_manager.h"
 #include "xenia/kernel/xam/xam_module.h"
 #include "xenia/kernel/xam/xam_state.h"
@@ -584,6 +585,127 @@ void EmulatorWindow::DisplayConfigDialog::OnDraw(ImGuiIO& io) {
   }
 }
 
+void EmulatorWindow::ThreadStatisticsDialog::Sample() {
+  kernel::KernelState* kernel_state = emulator_window_.emulator_->kernel_state();
+  if (!kernel_state) {
+    rows_.clear();
+    return;
+  }
+  steady_clock::time_point now = steady_clock::now();
+  double interval_ns = double(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now -
+                                                           last_sample_time_)
+          .count());
+  std::vector<Row> previous_rows = std::move(rows_);
+  rows_.clear();
+  // Both sorted by thread ID.
+  auto previous_it = previous_rows.cbegin();
+  for (kernel::XThreadStatistics& statistics :
+       kernel_state->QueryThreadStatistics()) {
+    Row& row = rows_.emplace_back();
+    row.statistics = std::move(statistics);
+    while (previous_it != previous_rows.cend() &&
+           previous_it->statistics.thread_id < row.statistics.thread_id) {
+      ++previous_it;
+    }
+    if (previous_it == previous_rows.cend() ||
+        previous_it->statistics.thread_id != row.statistics.thread_id) {
+      continue;
+    }
+    // The CPU time is 0 if it couldn't be queried.
+    const kernel::XThreadStatistics& previous = previous_it->statistics;
+    if (row.statistics.cpu_time_ns >= previous.cpu_time_ns) {
+      row.cpu_usage = float(
+          double(row.statistics.cpu_time_ns - previous.cpu_time_ns) /
+          interval_ns);
+    }
+    row.wait_usage = float(
+        double(row.statistics.wait_time_ns - previous.wait_time_ns) /
+        interval_ns);
+  }
+  last_sample_time_ = now;
+}
+
+void EmulatorWindow::ThreadStatisticsDialog::OnDraw(ImGuiIO& io) {
+  if (steady_clock::now() - last_sample_time_ >=
+      std::chrono::milliseconds(500)) {
+    Sample();
+  }
+
+  ImGui::SetNextWindowPos(ImVec2(20, 20), ImGuiCond_FirstUseEver);
+  ImGui::SetNextWindowSize(ImVec2(20, 20), ImGuiCond_FirstUseEver);
+  ImGui::SetNextWindowBgAlpha(0.8f);
+
+  bool dialog_open = true;
+  if (!ImGui::Begin("Thread Statistics", &dialog_open,
+                    ImGuiWindowFlags_NoCollapse |
+                        ImGuiWindowFlags_AlwaysAutoResize |
+                        ImGuiWindowFlags_NoFocusOnAppearing)) {
+    ImGui::End();
+    return;
+  }
+
+  if (rows_.empty()) {
+    ImGui::TextUnformatted("No title is running.");
+  } else if (ImGui::BeginTable("###ThreadStatistics", 10,
+                               ImGuiTableFlags_Borders |
+                                   ImGuiTableFlags_RowBg |
+                                   ImGuiTableFlags_SizingFixedFit)) {
+    ImGui::TableSetupColumn("ID");
+    ImGui::TableSetupColumn("Name");
+    ImGui::TableSetupColumn("CPU");
+    ImGui::TableSetupColumn("Priority");
+    ImGui::TableSetupColumn("Host CPU");
+    ImGui::TableSetupColumn("CPU Time");
+    ImGui::TableSetupColumn("Waiting");
+    ImGui::TableSetupColumn("Waits");
+    ImGui::TableSetupColumn("Context Switches");
+    ImGui::TableSetupColumn("APCs");
+    ImGui::TableHeadersRow();
+    for (const Row& row : rows_) {
+      const kernel::XThreadStatistics& statistics = row.statistics;
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(
+          fmt::format("{:08X}", statistics.thread_id).c_str());
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(statistics.name.c_str());
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(
+          fmt::format("{}", uint32_t(statistics.active_cpu)).c_str());
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(fmt::format("{}", statistics.priority).c_str());
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(
+          fmt::format("{:.1f}%", row.cpu_usage * 100.0f).c_str());
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(
+          fmt::format("{:.2f} s", statistics.cpu_time_ns / 1e9).c_str());
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(
+          fmt::format("{:.1f}%", row.wait_usage * 100.0f).c_str());
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(fmt::format("{}", statistics.wait_count).c_str());
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(
+          fmt::format("{} / {}", statistics.voluntary_context_switches,
+                      statistics.involuntary_context_switches)
+              .c_str());
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(fmt::format("{}", statistics.apc_count).c_str());
+    }
+    ImGui::EndTable();
+  }
+
+  ImGui::End();
+
+  if (!dialog_open) {
+    emulator_window_.ToggleThreadStatisticsDialog();
+    // `this` might have been destroyed by ToggleThreadStatisticsDialog.
+    return;
+  }
+}
+
 void EmulatorWindow::ContentInstallDialog::OnDraw(ImGuiIO& io) {
   ImGui::SetNextWindowPos(ImVec2(20, 20), ImGuiCond_FirstUseEver);
   ImGui::SetNextWindowSize(ImVec2(20, 20), ImGuiCond_FirstUseEver);
@@ -751,6 +873,9 @@ bool EmulatorWindow::Initialize() {
     cpu_menu->AddChild(MenuItem::Create(MenuItem::Type::kString,
                                         "&Pause/Resume Profiler", "`",
                                         []() { Profiler::TogglePause(); }));
+    cpu_menu->AddChild(MenuItem::Create(
+        MenuItem::Type::kString, "Show &Thread Statistics", "",
+        std::bind(&EmulatorWindow::ToggleThreadStatisticsDialog, this)));
   }
   cpu_menu->AddChild(MenuItem::Create(MenuItem::Type::kSeparator));
   {
@@ -1657,6 +1782,15 @@ void EmulatorWindow::ToggleDisplayConfigDialog() {
   }
 }
 
+void EmulatorWindow::ToggleThreadStatisticsDialog() {
+  if (!thread_statistics_dialog_) {
+    thread_statistics_dialog_ = std::unique_ptr<ThreadStatisticsDialog>(
+        new ThreadStatisticsDialog(imgui_drawer_.get(), *this));
+  } else {
+    thread_statistics_dialog_.reset();
+  }
+}
+
 void EmulatorWindow::ToggleProfilesConfigDialog() {
   if (!profile_config_dialog_) {
     disable_hotkeys_ = true;
@@ -2127,16 +2261,11 @@ void EmulatorWindow::GamepadHotKeys() {
 
   if (input_sys) {
     while (true) {
-      auto input_lock = input_sys->lock();
-
       for (uint32_t user_index = 0; user_index < XUserMaxUserCount;
            ++user_index) {
         X_RESULT result = input_sys->GetState(
             user_index, X_INPUT_FLAG::X_INPUT_FLAG_GAMEPAD, &state);
 
-        // Release the lock before processing the hotkey
-        input_lock.mutex()->unlock();
-
         // Check if the controller is connected
         if (result == X_ERROR_SUCCESS) {
           if (ProcessControllerHotkey(state.gamepad.buttons).rumble) {
@@ -2401,6 +2530,10 @@ xe::X_STATUS EmulatorWindow::RunTitle(
     display_config_dialog_.reset();
   }
 
+  if (thread_statistics_dialog_) {
+    thread_statistics_dialog_.reset();
+  }
+
   if (friends_manager_dialog_) {
     friends_manager_dialog_.reset();
     kernel::xam::xam_dialogs_shown_--;
@@ -2548,6 +2681,10 @@ void EmulatorWindow::ClearDialogs() {
     display_config_dialog_.reset();
   }
 
+  if (thread_statistics_dialog_) {
+    thread_statistics_dialog_.reset();
+  }
+
   if (friends_manager_dialog_) {
     friends_manager_dialog_.reset();
   }
@@ -17,6 +17,7 @@
 #include "xenia/app/updater.h"
 #include "xenia/emulator.h"
 #include "xenia/gpu/command_processor.h"
+#include "xenia/kernel/xthread.h"
 #include "xenia/ui/imgui_dialog.h"
 #include "xenia/ui/imgui_drawer.h"
 #include "xenia/ui/immediate_drawer.h"
@@ -214,6 +215,30 @@ class EmulatorWindow {
     EmulatorWindow& emulator_window_;
   };
 
+  class ThreadStatisticsDialog final : public ui::ImGuiDialog {
+   public:
+    ThreadStatisticsDialog(ui::ImGuiDrawer* imgui_drawer,
+                           EmulatorWindow& emulator_window)
+        : ui::ImGuiDialog(imgui_drawer), emulator_window_(emulator_window) {}
+
+   protected:
+    void OnDraw(ImGuiIO& io) override;
+
+   private:
+    struct Row {
+      kernel::XThreadStatistics statistics;
+      // Of one host core over the last sampling interval.
+      float cpu_usage = 0.0f;
+      float wait_usage = 0.0f;
+    };
+
+    void Sample();
+
+    EmulatorWindow& emulator_window_;
+    std::vector<Row> rows_;
+    steady_clock::time_point last_sample_time_;
+  };
+
   explicit EmulatorWindow(Emulator* emulator,
                           ui::WindowedAppContext& app_context, uint32_t width,
                           uint32_t height);
@@ -256,6 +281,7 @@ class EmulatorWindow {
   void GpuTraceFrame();
   void GpuClearCaches();
   void ToggleDisplayConfigDialog();
+  void ToggleThreadStatisticsDialog();
   void ToggleControllerVibration();
   void ShowCompatibility();
   void ShowFAQ();
@@ -300,6 +326,8 @@ class EmulatorWindow {
 
   std::unique_ptr<DisplayConfigDialog> display_config_dialog_;
 
+  std::unique_ptr<ThreadStatisticsDialog> thread_statistics_dialog_;
+
   // Storing pointers and toggling dialog state is useful for broadcasting
   // messages back to guest.
   std::unique_ptr<ProfileConfigDialog> profile_config_dialog_;
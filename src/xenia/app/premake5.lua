@@ -35,6 +35,7 @@ project("xenia-app")
     "mspack",
     "snappy",
     "xxhash",
+    "zstd",
     "libcurl",
     "miniupnp",
   })
@@ -535,6 +535,8 @@ void EmulatorApp::OnDestroy() {
   // Delete sessions on shutdown.
   xe::kernel::XLiveAPI::DeleteAllSessionsByMac();
 
+  xe::kernel::XLiveAPI::Shutdown();
+
   curl_global_cleanup();
 #pragma endregion
 
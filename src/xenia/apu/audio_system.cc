@@ -92,6 +92,7 @@ X_STATUS AudioSystem::Setup(kernel::KernelState* kernel_state) {
   // As we run audio callbacks the debugger must be able to suspend us.
   worker_thread_->set_can_debugger_suspend(true);
   worker_thread_->set_name("Audio Worker");
+  worker_thread_->set_is_service_thread(true);
   worker_thread_->Create();
 
   return X_STATUS_SUCCESS;
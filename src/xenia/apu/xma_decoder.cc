@@ -169,6 +169,7 @@ X_STATUS XmaDecoder::Setup(kernel::KernelState* kernel_state) {
               ->GetIdleProcess()));  // this one doesnt need any process
                                      // actually. never calls any guest code
   worker_thread_->set_name("XMA Decoder");
+  worker_thread_->set_is_service_thread(true);
   worker_thread_->set_can_debugger_suspend(true);
   worker_thread_->Create();
 
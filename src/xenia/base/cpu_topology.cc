@@ -0,0 +1,59 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/base/cpu_topology.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace xe {
+
+uint32_t CpuTopology::core_count() const {
+  uint32_t count = 0;
+  for (const LogicalProcessor& processor : logical_processors) {
+    count = std::max(count, processor.core + 1);
+  }
+  return count;
+}
+
+uint32_t CpuTopology::cache_domain_count() const {
+  uint32_t count = 0;
+  for (const LogicalProcessor& processor : logical_processors) {
+    count = std::max(count, processor.cache_domain + 1);
+  }
+  return count;
+}
+
+CpuTopology CpuTopology::Flat(uint32_t logical_processor_count) {
+  CpuTopology topology;
+  logical_processor_count = std::min(logical_processor_count, uint32_t(64));
+  for (uint32_t i = 0; i < logical_processor_count; ++i) {
+    topology.logical_processors.push_back({i, i, i});
+  }
+  return topology;
+}
+
+void CpuTopology::Normalize() {
+  std::sort(logical_processors.begin(), logical_processors.end(),
+            [](const LogicalProcessor& a, const LogicalProcessor& b) {
+              return a.id < b.id;
+            });
+  std::unordered_map<uint32_t, uint32_t> core_remap, cache_domain_remap;
+  for (LogicalProcessor& processor : logical_processors) {
+    processor.core =
+        core_remap.emplace(processor.core, uint32_t(core_remap.size()))
+            .first->second;
+    processor.cache_domain =
+        cache_domain_remap
+            .emplace(processor.cache_domain, uint32_t(cache_domain_remap.size()))
+            .first->second;
+  }
+}
+
+}  // namespace xe
@@ -0,0 +1,48 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#ifndef XENIA_BASE_CPU_TOPOLOGY_H_
+#define XENIA_BASE_CPU_TOPOLOGY_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace xe {
+
+// Layout of the host logical processors usable in 64-bit affinity masks.
+struct CpuTopology {
+  struct LogicalProcessor {
+    // Index of the processor in affinity masks.
+    uint32_t id;
+    // Dense index of the physical core, shared by SMT siblings.
+    uint32_t core;
+    // Dense index of the last level cache shared by the core, such as a CCX
+    // on AMD processors.
+    uint32_t cache_domain;
+  };
+
+  // Sorted by id.
+  std::vector<LogicalProcessor> logical_processors;
+
+  uint32_t core_count() const;
+  uint32_t cache_domain_count() const;
+
+  // Queries the host, falling back to Flat if the layout is unknown.
+  static CpuTopology Query();
+  // Every logical processor is a separate core with its own cache.
+  static CpuTopology Flat(uint32_t logical_processor_count);
+
+  // Sorts the processors and renumbers cores and cache domains densely in
+  // the order of their first processor.
+  void Normalize();
+};
+
+}  // namespace xe
+
+#endif  // XENIA_BASE_CPU_TOPOLOGY_H_
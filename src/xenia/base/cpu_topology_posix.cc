@@ -0,0 +1,87 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/base/cpu_topology.h"
+
+#include <sched.h>
+#include <cstdio>
+#include <string>
+
+#include "xenia/base/platform.h"
+#include "xenia/base/threading.h"
+
+namespace xe {
+
+#if XE_PLATFORM_LINUX
+// Reads the first number of a sysfs file, which for CPU lists such as
+// thread_siblings_list ("0,8" or "0-1") is the lowest processor in the list.
+static bool ReadSysfsFirstNumber(const std::string& path, uint32_t& value_out) {
+  FILE* file = std::fopen(path.c_str(), "r");
+  if (!file) {
+    return false;
+  }
+  unsigned int value;
+  bool read = std::fscanf(file, "%u", &value) == 1;
+  std::fclose(file);
+  if (read) {
+    value_out = value;
+  }
+  return read;
+}
+#endif  // XE_PLATFORM_LINUX
+
+CpuTopology CpuTopology::Query() {
+#if XE_PLATFORM_LINUX
+  cpu_set_t process_set;
+  if (sched_getaffinity(0, sizeof(process_set), &process_set) == 0) {
+    CpuTopology topology;
+    for (uint32_t id = 0; id < 64; ++id) {
+      if (!CPU_ISSET(id, &process_set)) {
+        continue;
+      }
+      std::string cpu_path =
+          "/sys/devices/system/cpu/cpu" + std::to_string(id) + "/";
+      LogicalProcessor processor;
+      processor.id = id;
+      if (!ReadSysfsFirstNumber(cpu_path + "topology/thread_siblings_list",
+                                processor.core)) {
+        processor.core = id;
+      }
+      // The highest cache level shared by this processor.
+      processor.cache_domain = UINT32_MAX;
+      uint32_t cache_domain_level = 0;
+      for (uint32_t index = 0;; ++index) {
+        std::string cache_path =
+            cpu_path + "cache/index" + std::to_string(index) + "/";
+        uint32_t level, first_sharing_id;
+        if (!ReadSysfsFirstNumber(cache_path + "level", level)) {
+          break;
+        }
+        if (level > cache_domain_level &&
+            ReadSysfsFirstNumber(cache_path + "shared_cpu_list",
+                                 first_sharing_id)) {
+          cache_domain_level = level;
+          processor.cache_domain = first_sharing_id;
+        }
+      }
+      if (processor.cache_domain == UINT32_MAX) {
+        processor.cache_domain = processor.core;
+      }
+      topology.logical_processors.push_back(processor);
+    }
+    if (!topology.logical_processors.empty()) {
+      topology.Normalize();
+      return topology;
+    }
+  }
+#endif  // XE_PLATFORM_LINUX
+  return Flat(xe::threading::logical_processor_count());
+}
+
+}  // namespace xe
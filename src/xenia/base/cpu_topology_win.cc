@@ -0,0 +1,95 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/base/cpu_topology.h"
+
+#include <vector>
+
+#include "xenia/base/platform_win.h"
+#include "xenia/base/threading.h"
+
+namespace xe {
+
+CpuTopology CpuTopology::Query() {
+  DWORD buffer_size = 0;
+  GetLogicalProcessorInformationEx(RelationAll, nullptr, &buffer_size);
+  std::vector<uint8_t> buffer(buffer_size);
+  DWORD_PTR process_mask, system_mask;
+  if (!buffer_size ||
+      !GetLogicalProcessorInformationEx(
+          RelationAll,
+          reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(
+              buffer.data()),
+          &buffer_size) ||
+      !GetProcessAffinityMask(GetCurrentProcess(), &process_mask,
+                              &system_mask)) {
+    return Flat(xe::threading::logical_processor_count());
+  }
+
+  // Only the processors of the first group can be used in affinity masks.
+  constexpr uint32_t kUnknown = UINT32_MAX;
+  LogicalProcessor processors[64];
+  for (uint32_t id = 0; id < 64; ++id) {
+    processors[id] = {id, kUnknown, kUnknown};
+  }
+  uint32_t largest_cache_level[64] = {};
+  uint32_t core_index = 0, cache_index = 0;
+  for (DWORD offset = 0; offset < buffer_size;) {
+    auto& info = *reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(
+        buffer.data() + offset);
+    offset += info.Size;
+    if (info.Relationship == RelationProcessorCore) {
+      for (WORD i = 0; i < info.Processor.GroupCount; ++i) {
+        const GROUP_AFFINITY& group_mask = info.Processor.GroupMask[i];
+        if (group_mask.Group) {
+          continue;
+        }
+        for (uint32_t id = 0; id < 64; ++id) {
+          if (group_mask.Mask & (KAFFINITY(1) << id)) {
+            processors[id].core = core_index;
+          }
+        }
+      }
+      ++core_index;
+    } else if (info.Relationship == RelationCache) {
+      const CACHE_RELATIONSHIP& cache = info.Cache;
+      if (cache.Type == CacheInstruction || cache.GroupMask.Group) {
+        continue;
+      }
+      for (uint32_t id = 0; id < 64; ++id) {
+        if ((cache.GroupMask.Mask & (KAFFINITY(1) << id)) &&
+            cache.Level > largest_cache_level[id]) {
+          largest_cache_level[id] = cache.Level;
+          processors[id].cache_domain = cache_index;
+        }
+      }
+      ++cache_index;
+    }
+  }
+
+  CpuTopology topology;
+  for (uint32_t id = 0; id < 64; ++id) {
+    LogicalProcessor& processor = processors[id];
+    if (!(process_mask & (DWORD_PTR(1) << id)) || processor.core == kUnknown) {
+      continue;
+    }
+    if (processor.cache_domain == kUnknown) {
+      // Distinct from the indices of caches.
+      processor.cache_domain = cache_index + processor.core;
+    }
+    topology.logical_processors.push_back(processor);
+  }
+  if (topology.logical_processors.empty()) {
+    return Flat(xe::threading::logical_processor_count());
+  }
+  topology.Normalize();
+  return topology;
+}
+
+}  // namespace xe
@@ -0,0 +1,110 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/base/frame_pacer.h"
+
+#include <algorithm>
+
+#include "third_party/fmt/include/fmt/format.h"
+#include "xenia/base/threading.h"
+
+namespace xe {
+namespace threading {
+
+FramePacer::FramePacer(std::chrono::nanoseconds interval,
+                       std::chrono::nanoseconds max_slack)
+    : interval_(interval),
+      max_slack_(std::min(max_slack, interval)),
+      // Start from the middle and let the calibration find the actual value.
+      slack_(max_slack_ / 2),
+      next_deadline_(clock::now() + interval) {}
+
+void FramePacer::Wait() {
+  clock::time_point wait_start = clock::now();
+  clock::time_point deadline = next_deadline_;
+
+  clock::time_point sleep_end = deadline - slack_;
+  clock::time_point spin_start = wait_start;
+  if (sleep_end > wait_start) {
+    SleepUntil(sleep_end);
+    spin_start = clock::now();
+    // Rise quickly when oversleeping, so the deadlines aren't missed, and
+    // decay slowly towards the typical oversleep otherwise, so a single
+    // preemption doesn't make it spin for long.
+    auto oversleep = std::chrono::nanoseconds(spin_start - sleep_end);
+    if (oversleep > slack_) {
+      slack_ = std::min(slack_ + (oversleep - slack_) / 2, max_slack_);
+    } else {
+      slack_ -= (slack_ - oversleep) / 16;
+    }
+  }
+  clock::time_point now = spin_start;
+  while (now < deadline) {
+    MaybeYield();
+    now = clock::now();
+  }
+
+  auto lateness = std::chrono::nanoseconds(now - deadline);
+  size_t bucket = 0;
+  for (int64_t lateness_us = lateness.count() / 1000;
+       lateness_us && bucket + 1 < kLatenessBucketCount; lateness_us >>= 1) {
+    ++bucket;
+  }
+  ++statistics_.wait_count;
+  ++statistics_.lateness_histogram[bucket];
+  statistics_.max_lateness = std::max(statistics_.max_lateness, lateness);
+  statistics_.wait_time += now - wait_start;
+  statistics_.spin_time += now - spin_start;
+
+  next_deadline_ = deadline + interval_;
+  if (next_deadline_ < now) {
+    next_deadline_ = now + interval_;
+  }
+}
+
+void FramePacer::FollowDrift(std::chrono::nanoseconds drift) {
+  std::chrono::nanoseconds outstanding = drift - applied_drift_;
+  if (outstanding >= kDriftResyncThreshold ||
+      outstanding <= -kDriftResyncThreshold) {
+    applied_drift_ = drift;
+    return;
+  }
+  // Half of the outstanding drift, so a constant rate difference, such as with
+  // the guest clock scaled by 2, settles instead of alternating between
+  // immediate and full interval waits.
+  std::chrono::nanoseconds adjustment =
+      std::clamp<std::chrono::nanoseconds>(outstanding / 2, -interval_,
+                                           interval_);
+  next_deadline_ -= adjustment;
+  applied_drift_ += adjustment;
+}
+
+std::string FramePacer::DescribeStatistics() const {
+  std::string result = fmt::format(
+      "{} waits, max lateness {} us, spinning {:.2f}% of the wait time, slack "
+      "{} us, lateness histogram:",
+      statistics_.wait_count, statistics_.max_lateness.count() / 1000,
+      statistics_.wait_time.count()
+          ? 100.0 * double(statistics_.spin_time.count()) /
+                double(statistics_.wait_time.count())
+          : 0.0,
+      slack_.count() / 1000);
+  for (size_t i = 0; i < kLatenessBucketCount; ++i) {
+    if (i + 1 < kLatenessBucketCount) {
+      result += fmt::format(" <{}us:{}", uint64_t(1) << i,
+                            statistics_.lateness_histogram[i]);
+    } else {
+      result += fmt::format(" more:{}", statistics_.lateness_histogram[i]);
+    }
+  }
+  return result;
+}
+
+}  // namespace threading
+}  // namespace xe
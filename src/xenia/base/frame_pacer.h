@@ -0,0 +1,82 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#ifndef XENIA_BASE_FRAME_PACER_H_
+#define XENIA_BASE_FRAME_PACER_H_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace xe {
+namespace threading {
+
+// Wakes a thread up at a fixed interval, such as for vertical blanking.
+// Deadlines are absolute, so the time spent between the waits doesn't
+// accumulate as drift. The thread sleeps until slightly before each deadline
+// and spins for the rest. The slack is calibrated from how late the sleeps
+// actually return, so it's as little CPU time as the host allows.
+class FramePacer {
+ public:
+  using clock = std::chrono::steady_clock;
+
+  // Bucket i counts the wake-ups that were less than 2^i microseconds late,
+  // the last one counts the rest.
+  static constexpr size_t kLatenessBucketCount = 12;
+
+  static constexpr std::chrono::nanoseconds kDriftResyncThreshold =
+      std::chrono::seconds(1);
+
+  struct Statistics {
+    uint64_t wait_count = 0;
+    std::array<uint64_t, kLatenessBucketCount> lateness_histogram = {};
+    std::chrono::nanoseconds max_lateness{0};
+    // Time spent waiting, and the part of it spent spinning on the CPU.
+    std::chrono::nanoseconds wait_time{0};
+    std::chrono::nanoseconds spin_time{0};
+  };
+
+  FramePacer(std::chrono::nanoseconds interval,
+             std::chrono::nanoseconds max_slack);
+
+  std::chrono::nanoseconds interval() const { return interval_; }
+  std::chrono::nanoseconds slack() const { return slack_; }
+
+  // Waits until the next deadline, one interval after the previous one. If
+  // the deadline was missed by more than an interval, such as after the
+  // thread was suspended, the following deadlines are based on the current
+  // time instead of catching up.
+  void Wait();
+  // Moves the next deadline, to stay in step with another clock.
+  void Adjust(std::chrono::nanoseconds offset) { next_deadline_ += offset; }
+  // Keeps the deadlines in step with another clock, given how far it's ahead
+  // of the host clock in total. Each deadline is moved by at most an interval,
+  // the rest of the drift is applied over the following ones. Jumps of more
+  // than kDriftResyncThreshold, such as from the other clock being set, are
+  // skipped instead.
+  void FollowDrift(std::chrono::nanoseconds drift);
+
+  const Statistics& statistics() const { return statistics_; }
+  void ResetStatistics() { statistics_ = Statistics(); }
+  std::string DescribeStatistics() const;
+
+ private:
+  std::chrono::nanoseconds interval_;
+  std::chrono::nanoseconds max_slack_;
+  std::chrono::nanoseconds slack_;
+  clock::time_point next_deadline_;
+  std::chrono::nanoseconds applied_drift_{0};
+  Statistics statistics_;
+};
+
+}  // namespace threading
+}  // namespace xe
+
+#endif  // XENIA_BASE_FRAME_PACER_H_
@@ -31,6 +31,7 @@
 #include "xenia/base/memory.h"
 #include "xenia/base/platform.h"
 #include "xenia/base/ring_buffer.h"
+#include "xenia/base/scheduling_policy.h"
 #include "xenia/base/string.h"
 #include "xenia/base/system.h"
 #include "xenia/base/threading.h"
@@ -232,11 +233,15 @@ class Logger {
         xe::threading::Thread::Create({}, [this]() { WriteThread(); });
     assert_not_null(write_thread_);
     write_thread_->set_name("Logging Writer");
+    xe::threading::SchedulingPolicy::RegisterServiceThread(
+        write_thread_.get());
   }
 
   ~Logger() {
     AppendLine(0, '\0', nullptr, 0, true);  // append a terminator
     xe::threading::Wait(write_thread_.get(), true);
+    xe::threading::SchedulingPolicy::UnregisterServiceThread(
+        write_thread_.get());
   }
 
   void AddLogSink(std::unique_ptr<LogSink>&& sink) {
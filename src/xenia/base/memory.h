@@ -147,15 +147,41 @@ typedef int FileMappingHandle;
 constexpr FileMappingHandle kFileMappingHandleInvalid = -1;
 #endif
 
+// With large_pages, the host may back the views of the mapping with
+// large_page_size() pages where they're advised with AdviseLargePages.
 FileMappingHandle CreateFileMappingHandle(const std::filesystem::path& path,
                                           size_t length, PageAccess access,
-                                          bool commit);
+                                          bool commit,
+                                          bool large_pages = false);
 void CloseFileMappingHandle(FileMappingHandle handle,
                             const std::filesystem::path& path);
 void* MapFileView(FileMappingHandle handle, void* base_address, size_t length,
                   PageAccess access, size_t file_offset);
 bool UnmapFileView(FileMappingHandle handle, void* base_address, size_t length);
 
+// Returns the size of the large pages backing file mappings created with
+// large_pages, or 0 if the host backs them with normal pages only.
+size_t large_page_size();
+// Asks the host to back a view of a mapping created with large_pages with
+// large pages. Only the parts where both the address and the file offset are
+// aligned to large_page_size() can use them. Protect still works at the
+// granularity of page_size() - the host splits the large page translations
+// only where the protection differs.
+bool AdviseLargePages(void* base_address, size_t length);
+
+// Replaces the pages of a part of an existing view with a private
+// copy-on-write view of a regular file, so the pages that are never written
+// stay shared with the other processes mapping the same file. Returns false,
+// leaving the range unchanged, if the file is too small or replacing a part of
+// a view is not supported on the platform.
+bool MapFileViewCopyOnWrite(const std::filesystem::path& path,
+                            void* base_address, size_t length,
+                            PageAccess access, size_t file_offset);
+// Puts a part of a view of a file mapping back in place of the pages replaced
+// with MapFileViewCopyOnWrite.
+bool RestoreFileView(FileMappingHandle handle, void* base_address,
+                     size_t length, PageAccess access, size_t file_offset);
+
 inline size_t hash_combine(size_t seed) { return seed; }
 
 template <typename T, typename... Ts>
@@ -223,7 +223,7 @@ bool QueryProtect(void* base_address, size_t& length, PageAccess& access_out) {
 
 FileMappingHandle CreateFileMappingHandle(const std::filesystem::path& path,
                                           size_t length, PageAccess access,
-                                          bool commit) {
+                                          bool commit, bool large_pages) {
 #if XE_PLATFORM_ANDROID
   // TODO(Triang3l): Check if memfd can be used instead on API 30+.
   if (android_ASharedMemory_create_) {
@@ -247,6 +247,21 @@ FileMappingHandle CreateFileMappingHandle(const std::filesystem::path& path,
   }
   return ashmem_fd;
 #else
+#if XE_PLATFORM_GNU_LINUX
+  // Transparent huge pages for shared memory are controlled by
+  // /sys/kernel/mm/transparent_hugepage/shmem_enabled only on the internal
+  // mount used by memfd - /dev/shm has its own mount options.
+  if (large_pages && (access == PageAccess::kReadWrite ||
+                      access == PageAccess::kExecuteReadWrite)) {
+    int memfd = memfd_create(path.c_str(), MFD_CLOEXEC);
+    if (memfd >= 0) {
+      if (ftruncate64(memfd, length) == 0) {
+        return memfd;
+      }
+      close(memfd);
+    }
+  }
+#endif
   int oflag;
   switch (access) {
     case PageAccess::kNoAccess:
@@ -325,5 +340,66 @@ bool UnmapFileView(FileMappingHandle handle, void* base_address,
   return munmap(base_address, length) == 0;
 }
 
+size_t large_page_size() {
+#if XE_PLATFORM_GNU_LINUX
+  static const size_t size = []() -> size_t {
+    // The selected policy is in brackets, like "always [advise] never".
+    std::ifstream shmem_enabled(
+        "/sys/kernel/mm/transparent_hugepage/shmem_enabled");
+    std::string policies;
+    if (!std::getline(shmem_enabled, policies) ||
+        policies.find("[never]") != std::string::npos ||
+        policies.find("[deny]") != std::string::npos) {
+      return 0;
+    }
+    std::ifstream pmd_size(
+        "/sys/kernel/mm/transparent_hugepage/hpage_pmd_size");
+    size_t size = 0;
+    if (!(pmd_size >> size)) {
+      return 0;
+    }
+    return size;
+  }();
+  return size;
+#else
+  return 0;
+#endif
+}
+
+bool AdviseLargePages(void* base_address, size_t length) {
+#ifdef MADV_HUGEPAGE
+  return madvise(base_address, length, MADV_HUGEPAGE) == 0;
+#else
+  return false;
+#endif
+}
+
+bool MapFileViewCopyOnWrite(const std::filesystem::path& path,
+                            void* base_address, size_t length,
+                            PageAccess access, size_t file_offset) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  // Pages past the end of the file would raise SIGBUS on access.
+  off_t file_size = lseek(fd, 0, SEEK_END);
+  if (file_size < 0 || size_t(file_size) < file_offset + length) {
+    close(fd);
+    return false;
+  }
+  // MAP_FIXED atomically replaces the pages of the existing view, which stays
+  // registered in mapped_file_ranges as a whole.
+  void* result = mmap(base_address, length, ToPosixProtectFlags(access),
+                      MAP_PRIVATE | MAP_FIXED, fd, off_t(file_offset));
+  close(fd);
+  return result != MAP_FAILED;
+}
+
+bool RestoreFileView(FileMappingHandle handle, void* base_address,
+                     size_t length, PageAccess access, size_t file_offset) {
+  return mmap(base_address, length, ToPosixProtectFlags(access),
+              MAP_SHARED | MAP_FIXED, handle, off_t(file_offset)) != MAP_FAILED;
+}
+
 }  // namespace memory
 }  // namespace xe
@@ -212,7 +212,9 @@ bool QueryProtect(void* base_address, size_t& length, PageAccess& access_out) {
 
 FileMappingHandle CreateFileMappingHandle(const std::filesystem::path& path,
                                           size_t length, PageAccess access,
-                                          bool commit) {
+                                          bool commit, bool large_pages) {
+  // SEC_LARGE_PAGES needs SeLockMemoryPrivilege and commits the whole mapping
+  // upfront, so large pages are not used for file mappings.
   DWORD protect =
       ToWin32ProtectFlags(access) | (commit ? SEC_COMMIT : SEC_RESERVE);
   auto full_path = "Local" / path;
@@ -283,5 +285,22 @@ bool UnmapFileView(FileMappingHandle handle, void* base_address,
   return UnmapViewOfFile(base_address) ? true : false;
 }
 
+size_t large_page_size() { return 0; }
+
+bool AdviseLargePages(void* base_address, size_t length) { return false; }
+
+bool MapFileViewCopyOnWrite(const std::filesystem::path& path,
+                            void* base_address, size_t length,
+                            PageAccess access, size_t file_offset) {
+  // A part of a view can't be unmapped on Windows, so the whole view would
+  // have to be split into placeholders first.
+  return false;
+}
+
+bool RestoreFileView(FileMappingHandle handle, void* base_address,
+                     size_t length, PageAccess access, size_t file_offset) {
+  return false;
+}
+
 }  // namespace memory
 }  // namespace xe
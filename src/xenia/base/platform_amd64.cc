@@ -63,6 +63,7 @@ void InitFeatureFlags() {
     TEST_EMIT_FEATURE(kX64EmitAVX512DQ, Xbyak::util::Cpu::tAVX512DQ);
     TEST_EMIT_FEATURE(kX64EmitAVX512VBMI, Xbyak::util::Cpu::tAVX512VBMI);
     TEST_EMIT_FEATURE(kX64EmitPrefetchW, Xbyak::util::Cpu::tPREFETCHW);
+    TEST_EMIT_FEATURE(kX64EmitPCLMULQDQ, Xbyak::util::Cpu::tPCLMULQDQ);
 #undef TEST_EMIT_FEATURE
     /*
     fix for xbyak bug/omission, amd cpus are never checked for lzcnt. fixed in
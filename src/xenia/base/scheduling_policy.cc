@@ -0,0 +1,203 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/base/scheduling_policy.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "third_party/fmt/include/fmt/format.h"
+#include "xenia/base/cvar.h"
+#include "xenia/base/logging.h"
+
+DEFINE_string(
+    host_thread_placement, "legacy",
+    "Host processors for the threads running on each emulated hardware "
+    "thread, used when ignore_thread_affinities is false.\n"
+    " legacy: Hardware thread N on logical processor N.\n"
+    " compact: Each hardware thread on its own physical core, keeping them "
+    "within as few last level caches (CCXs) as possible.\n"
+    " none: Left to the host scheduler.",
+    "CPU");
+DEFINE_bool(host_thread_placement_share_cores, false,
+            "With compact host_thread_placement, put the two hardware threads "
+            "of each emulated core on SMT siblings of one host core, like on "
+            "the console, instead of separate cores.",
+            "CPU");
+DEFINE_bool(isolate_service_threads, false,
+            "Restrict the GPU command processor, audio, XMA decoder and "
+            "logging threads to the host processors not used by emulated "
+            "hardware threads.",
+            "CPU");
+
+namespace xe {
+namespace threading {
+
+SchedulingPolicy::SchedulingPolicy(const CpuTopology& topology,
+                                   const Options& options)
+    : options_(options) {
+  // Like on a host with fewer processors than the console, nothing is pinned
+  // if there are too few processors to give each hardware thread its own.
+  if (topology.logical_processors.size() < kHardwareThreadCount) {
+    return;
+  }
+  switch (options.placement) {
+    case Placement::kNone:
+      return;
+    case Placement::kLegacy:
+      for (uint32_t i = 0; i < kHardwareThreadCount; ++i) {
+        hardware_thread_affinity_[i] = uint64_t(1) << i;
+      }
+      break;
+    case Placement::kCompact:
+      PlaceCompact(topology, options.share_cores);
+      break;
+  }
+  if (options.isolate_service_threads) {
+    uint64_t hardware_threads_mask = 0;
+    for (uint64_t mask : hardware_thread_affinity_) {
+      hardware_threads_mask |= mask;
+    }
+    for (const CpuTopology::LogicalProcessor& processor :
+         topology.logical_processors) {
+      if (!(hardware_threads_mask & (uint64_t(1) << processor.id))) {
+        service_thread_affinity_ |= uint64_t(1) << processor.id;
+      }
+    }
+  }
+}
+
+void SchedulingPolicy::PlaceCompact(const CpuTopology& topology,
+                                    bool share_cores) {
+  // Logical processors of each core, and cores of each cache domain, in the
+  // order of their first processor.
+  std::vector<std::vector<uint32_t>> core_processors(topology.core_count());
+  std::vector<std::vector<uint32_t>> cache_domain_cores(
+      topology.cache_domain_count());
+  for (const CpuTopology::LogicalProcessor& processor :
+       topology.logical_processors) {
+    if (core_processors[processor.core].empty()) {
+      cache_domain_cores[processor.cache_domain].push_back(processor.core);
+    }
+    core_processors[processor.core].push_back(processor.id);
+  }
+  std::stable_sort(cache_domain_cores.begin(), cache_domain_cores.end(),
+                   [](const std::vector<uint32_t>& a,
+                      const std::vector<uint32_t>& b) {
+                     return a.size() > b.size();
+                   });
+  std::vector<uint32_t> cores;
+  for (const std::vector<uint32_t>& domain_cores : cache_domain_cores) {
+    cores.insert(cores.end(), domain_cores.begin(), domain_cores.end());
+  }
+
+  // Sharing is only possible if there are SMT siblings.
+  share_cores = share_cores &&
+                std::all_of(cores.begin(),
+                            cores.begin() + std::min(cores.size(), size_t(3)),
+                            [&](uint32_t core) {
+                              return core_processors[core].size() >= 2;
+                            });
+  for (uint32_t i = 0; i < kHardwareThreadCount; ++i) {
+    if (share_cores) {
+      const std::vector<uint32_t>& processors =
+          core_processors[cores[(i >> 1) % cores.size()]];
+      hardware_thread_affinity_[i] = uint64_t(1) << processors[i & 1];
+    } else {
+      // The whole core - with fewer cores than hardware threads, some are
+      // shared anyway.
+      for (uint32_t id : core_processors[cores[i % cores.size()]]) {
+        hardware_thread_affinity_[i] |= uint64_t(1) << id;
+      }
+    }
+  }
+}
+
+std::string SchedulingPolicy::Describe() const {
+  std::string description;
+  for (uint32_t i = 0; i < kHardwareThreadCount; ++i) {
+    description += fmt::format("HW{} {:X}, ", i, hardware_thread_affinity_[i]);
+  }
+  description +=
+      fmt::format("service threads {:X} (0 - any processor)",
+                  service_thread_affinity_);
+  return description;
+}
+
+static std::mutex policy_mutex_;
+static std::atomic<SchedulingPolicy*> policy_ = nullptr;
+// Protected with policy_mutex_.
+static std::vector<Thread*> pending_service_threads_;
+
+static void PlaceServiceThread(const SchedulingPolicy& policy,
+                               Thread* thread) {
+  uint64_t affinity = policy.service_thread_affinity();
+  if (affinity) {
+    thread->set_affinity_mask(affinity);
+  }
+}
+
+const SchedulingPolicy& SchedulingPolicy::Get() {
+  SchedulingPolicy* policy = policy_.load(std::memory_order_acquire);
+  if (policy) {
+    return *policy;
+  }
+  std::lock_guard<std::mutex> lock(policy_mutex_);
+  policy = policy_.load(std::memory_order_relaxed);
+  if (policy) {
+    return *policy;
+  }
+  Options options;
+  if (cvars::host_thread_placement == "none") {
+    options.placement = Placement::kNone;
+  } else if (cvars::host_thread_placement == "compact") {
+    options.placement = Placement::kCompact;
+  } else {
+    options.placement = Placement::kLegacy;
+  }
+  options.share_cores = cvars::host_thread_placement_share_cores;
+  options.isolate_service_threads = cvars::isolate_service_threads;
+  CpuTopology topology = CpuTopology::Query();
+  // Never destroyed, as threads may be placed until the process exits.
+  policy = new SchedulingPolicy(topology, options);
+  XELOGI(
+      "Host scheduling: {} logical processors, {} cores, {} cache domains, {}",
+      topology.logical_processors.size(), topology.core_count(),
+      topology.cache_domain_count(), policy->Describe());
+  for (Thread* thread : pending_service_threads_) {
+    PlaceServiceThread(*policy, thread);
+  }
+  pending_service_threads_.clear();
+  policy_.store(policy, std::memory_order_release);
+  return *policy;
+}
+
+void SchedulingPolicy::RegisterServiceThread(Thread* thread) {
+  std::lock_guard<std::mutex> lock(policy_mutex_);
+  SchedulingPolicy* policy = policy_.load(std::memory_order_relaxed);
+  if (policy) {
+    PlaceServiceThread(*policy, thread);
+  } else {
+    pending_service_threads_.push_back(thread);
+  }
+}
+
+void SchedulingPolicy::UnregisterServiceThread(Thread* thread) {
+  std::lock_guard<std::mutex> lock(policy_mutex_);
+  auto it = std::find(pending_service_threads_.begin(),
+                      pending_service_threads_.end(), thread);
+  if (it != pending_service_threads_.end()) {
+    pending_service_threads_.erase(it);
+  }
+}
+
+}  // namespace threading
+}  // namespace xe
@@ -0,0 +1,79 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#ifndef XENIA_BASE_SCHEDULING_POLICY_H_
+#define XENIA_BASE_SCHEDULING_POLICY_H_
+
+#include <cstdint>
+#include <string>
+
+#include "xenia/base/cpu_topology.h"
+#include "xenia/base/threading.h"
+
+namespace xe {
+namespace threading {
+
+// Decides which host logical processors the threads running on the emulated
+// hardware threads and the emulator's own service threads (GPU command
+// processor, audio, logging) may run on.
+class SchedulingPolicy {
+ public:
+  // Xenon has 3 cores with 2 hardware threads each.
+  static constexpr uint32_t kHardwareThreadCount = 6;
+
+  enum class Placement {
+    // Left to the host scheduler.
+    kNone,
+    // Hardware thread N on logical processor N, if there are enough.
+    kLegacy,
+    // Hardware threads on distinct physical cores, filling the cache domains
+    // with the most cores first so they share the last level cache.
+    kCompact,
+  };
+
+  struct Options {
+    Placement placement = Placement::kLegacy;
+    // With kCompact, put the two hardware threads of each Xenon core on SMT
+    // siblings of one host core like on the console, using half the cores.
+    bool share_cores = false;
+    // Restrict service threads to the processors not used by hardware
+    // threads.
+    bool isolate_service_threads = false;
+  };
+
+  SchedulingPolicy(const CpuTopology& topology, const Options& options);
+
+  // Affinity masks, 0 to leave the thread to the host scheduler.
+  uint64_t hardware_thread_affinity(uint32_t hardware_thread) const {
+    return hardware_thread_affinity_[hardware_thread % kHardwareThreadCount];
+  }
+  uint64_t service_thread_affinity() const { return service_thread_affinity_; }
+
+  std::string Describe() const;
+
+  // Created from the cvars and the host topology on the first call, which
+  // must be after the config has been loaded.
+  static const SchedulingPolicy& Get();
+  // Service threads may be created before the config is loaded, in which case
+  // they're placed when the policy is created.
+  static void RegisterServiceThread(Thread* thread);
+  static void UnregisterServiceThread(Thread* thread);
+
+ private:
+  void PlaceCompact(const CpuTopology& topology, bool share_cores);
+
+  Options options_;
+  uint64_t hardware_thread_affinity_[kHardwareThreadCount] = {};
+  uint64_t service_thread_affinity_ = 0;
+};
+
+}  // namespace threading
+}  // namespace xe
+
+#endif  // XENIA_BASE_SCHEDULING_POLICY_H_
@@ -0,0 +1,104 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/base/socket_reactor.h"
+
+#include "xenia/base/assert.h"
+
+namespace xe {
+
+bool SocketReactor::Register(uint64_t native_handle, ReadyCallback callback) {
+  auto registration = std::make_shared<Registration>();
+  registration->callback = std::move(callback);
+  {
+    std::lock_guard<std::mutex> lock(registrations_mutex_);
+    if (!registrations_.emplace(native_handle, registration).second) {
+      assert_always("Socket registered with the reactor twice");
+      return false;
+    }
+  }
+  if (!AddNative(native_handle)) {
+    std::lock_guard<std::mutex> lock(registrations_mutex_);
+    registrations_.erase(native_handle);
+    return false;
+  }
+  return true;
+}
+
+void SocketReactor::Unregister(uint64_t native_handle) {
+  std::shared_ptr<Registration> registration;
+  {
+    std::lock_guard<std::mutex> lock(registrations_mutex_);
+    auto it = registrations_.find(native_handle);
+    if (it == registrations_.end()) {
+      return;
+    }
+    registration = std::move(it->second);
+    registrations_.erase(it);
+  }
+  RemoveNative(native_handle);
+  // Wait for an in-flight callback to return, and make sure any readiness
+  // report already picked up by another reactor thread is dropped.
+  std::lock_guard<std::mutex> lock(registration->mutex);
+  registration->armed_events = 0;
+  registration->callback = nullptr;
+}
+
+bool SocketReactor::Arm(uint64_t native_handle, uint32_t events) {
+  std::shared_ptr<Registration> registration;
+  {
+    std::lock_guard<std::mutex> lock(registrations_mutex_);
+    auto it = registrations_.find(native_handle);
+    if (it == registrations_.end()) {
+      return false;
+    }
+    registration = it->second;
+  }
+  // Publish the armed events before the native arm so a report arriving right
+  // away is not mistaken for a stale one.
+  registration->armed_events = events;
+  return ArmNative(native_handle, events);
+}
+
+SocketReactor::Stats SocketReactor::GetStats() const {
+  Stats stats;
+  {
+    std::lock_guard<std::mutex> lock(registrations_mutex_);
+    stats.registered = uint32_t(registrations_.size());
+  }
+  stats.dispatches = dispatch_count_.load(std::memory_order_relaxed);
+  stats.dropped = drop_count_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void SocketReactor::Dispatch(uint64_t native_handle, uint32_t events) {
+  std::shared_ptr<Registration> registration;
+  {
+    std::lock_guard<std::mutex> lock(registrations_mutex_);
+    auto it = registrations_.find(native_handle);
+    if (it != registrations_.end()) {
+      registration = it->second;
+    }
+  }
+  if (!registration) {
+    drop_count_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  std::lock_guard<std::mutex> lock(registration->mutex);
+  uint32_t armed_events = registration->armed_events.exchange(0);
+  events &= armed_events | kEventError;
+  if (!registration->callback || !armed_events || !events) {
+    drop_count_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  dispatch_count_.fetch_add(1, std::memory_order_relaxed);
+  registration->callback(events);
+}
+
+}  // namespace xe
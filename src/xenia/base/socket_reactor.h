@@ -0,0 +1,99 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#ifndef XENIA_BASE_SOCKET_REACTOR_H_
+#define XENIA_BASE_SOCKET_REACTOR_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace xe {
+
+// Readiness notification service shared by many native sockets.
+// A small fixed pool of threads waits on every registered socket at once
+// (epoll on Linux, WSAPoll on Windows) and invokes the socket's callback as
+// soon as it becomes ready for the events it was armed with.
+//
+// Arming is one-shot: once the callback has been invoked the socket must be
+// re-armed to receive further notifications. This guarantees a callback never
+// runs on two reactor threads at the same time.
+class SocketReactor {
+ public:
+  enum Event : uint32_t {
+    kEventReadable = 1 << 0,
+    kEventWritable = 1 << 1,
+    // Error or hang-up. Reported whenever the socket is armed.
+    kEventError = 1 << 2,
+  };
+
+  // Called from a reactor thread with the set of ready events.
+  using ReadyCallback = std::function<void(uint32_t events)>;
+
+  struct Stats {
+    // Sockets currently registered.
+    uint32_t registered;
+    // Callbacks invoked.
+    uint64_t dispatches;
+    // Readiness reports dropped because the socket was unregistered or not
+    // armed by the time they were processed.
+    uint64_t dropped;
+  };
+
+  // Creates a reactor servicing sockets with the given number of threads, or
+  // a platform default if zero.
+  // Returns null if the host polling facility cannot be initialized.
+  static std::unique_ptr<SocketReactor> Create(uint32_t thread_count = 0);
+
+  virtual ~SocketReactor() = default;
+
+  // Associates a native socket with a callback. The socket is not armed.
+  bool Register(uint64_t native_handle, ReadyCallback callback);
+  // Removes the socket from the reactor. Once this returns the callback is
+  // not running and will never be invoked again, so it must not be called
+  // from the socket's own callback. Must be called before the native socket
+  // is closed.
+  void Unregister(uint64_t native_handle);
+  // Requests a single notification when any of the given events is ready.
+  // Replaces any previously armed events.
+  bool Arm(uint64_t native_handle, uint32_t events);
+
+  Stats GetStats() const;
+
+ protected:
+  SocketReactor() = default;
+
+  virtual bool AddNative(uint64_t native_handle) = 0;
+  virtual bool ArmNative(uint64_t native_handle, uint32_t events) = 0;
+  virtual void RemoveNative(uint64_t native_handle) = 0;
+
+  // Called by the platform implementation from a reactor thread.
+  void Dispatch(uint64_t native_handle, uint32_t events);
+
+ private:
+  struct Registration {
+    // Held while the callback runs so Unregister can wait for it.
+    std::mutex mutex;
+    ReadyCallback callback;
+    std::atomic<uint32_t> armed_events = 0;
+  };
+
+  mutable std::mutex registrations_mutex_;
+  std::unordered_map<uint64_t, std::shared_ptr<Registration>> registrations_;
+
+  std::atomic<uint64_t> dispatch_count_ = 0;
+  std::atomic<uint64_t> drop_count_ = 0;
+};
+
+}  // namespace xe
+
+#endif  // XENIA_BASE_SOCKET_REACTOR_H_
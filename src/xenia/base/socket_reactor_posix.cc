@@ -0,0 +1,169 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/base/socket_reactor.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <string>
+#include <vector>
+
+#include "xenia/base/logging.h"
+#include "xenia/base/threading.h"
+
+namespace xe {
+
+class PosixSocketReactor : public SocketReactor {
+ public:
+  PosixSocketReactor() = default;
+  ~PosixSocketReactor() override {
+    running_ = false;
+    if (wake_fd_ != -1) {
+      // The wake eventfd is level-triggered and never drained, so a single
+      // write releases every reactor thread.
+      uint64_t value = 1;
+      write(wake_fd_, &value, sizeof(value));
+    }
+    for (auto& thread : threads_) {
+      xe::threading::Wait(thread.get(), false);
+    }
+    threads_.clear();
+    if (wake_fd_ != -1) {
+      close(wake_fd_);
+    }
+    if (epoll_fd_ != -1) {
+      close(epoll_fd_);
+    }
+  }
+
+  bool Initialize(uint32_t thread_count) {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ == -1) {
+      XELOGE("SocketReactor: epoll_create1 failed with error {}", errno);
+      return false;
+    }
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ == -1) {
+      XELOGE("SocketReactor: eventfd failed with error {}", errno);
+      return false;
+    }
+    epoll_event wake_event = {};
+    wake_event.events = EPOLLIN;
+    wake_event.data.u64 = kWakeToken;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &wake_event)) {
+      XELOGE("SocketReactor: failed to register the wake eventfd");
+      return false;
+    }
+
+    running_ = true;
+    for (uint32_t i = 0; i < thread_count; ++i) {
+      auto thread = xe::threading::Thread::Create({}, [this, i]() {
+        xe::threading::set_name("Socket Reactor " + std::to_string(i));
+        ThreadMain();
+      });
+      if (!thread) {
+        return false;
+      }
+      threads_.push_back(std::move(thread));
+    }
+    return true;
+  }
+
+ protected:
+  bool AddNative(uint64_t native_handle) override {
+    // Added disarmed - EPOLLONESHOT with no events only leaves the
+    // always-reported error conditions, which Dispatch drops until armed.
+    epoll_event event = {};
+    event.events = EPOLLONESHOT;
+    event.data.u64 = native_handle;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, int(native_handle), &event)) {
+      XELOGE("SocketReactor: EPOLL_CTL_ADD failed with error {}", errno);
+      return false;
+    }
+    return true;
+  }
+
+  bool ArmNative(uint64_t native_handle, uint32_t events) override {
+    epoll_event event = {};
+    event.events = EPOLLONESHOT;
+    if (events & kEventReadable) {
+      event.events |= EPOLLIN | EPOLLRDHUP;
+    }
+    if (events & kEventWritable) {
+      event.events |= EPOLLOUT;
+    }
+    event.data.u64 = native_handle;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, int(native_handle), &event)) {
+      XELOGE("SocketReactor: EPOLL_CTL_MOD failed with error {}", errno);
+      return false;
+    }
+    return true;
+  }
+
+  void RemoveNative(uint64_t native_handle) override {
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, int(native_handle), nullptr);
+  }
+
+ private:
+  static constexpr uint64_t kWakeToken = UINT64_MAX;
+  static constexpr int kMaxEventsPerWait = 64;
+
+  void ThreadMain() {
+    epoll_event events[kMaxEventsPerWait];
+    while (running_) {
+      int count = epoll_wait(epoll_fd_, events, kMaxEventsPerWait, -1);
+      if (count < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        XELOGE("SocketReactor: epoll_wait failed with error {}", errno);
+        break;
+      }
+      for (int i = 0; i < count; ++i) {
+        const epoll_event& event = events[i];
+        if (event.data.u64 == kWakeToken) {
+          continue;
+        }
+        uint32_t ready = 0;
+        if (event.events & (EPOLLIN | EPOLLRDHUP)) {
+          ready |= kEventReadable;
+        }
+        if (event.events & EPOLLOUT) {
+          ready |= kEventWritable;
+        }
+        if (event.events & (EPOLLERR | EPOLLHUP)) {
+          ready |= kEventError;
+        }
+        Dispatch(event.data.u64, ready);
+      }
+    }
+  }
+
+  int epoll_fd_ = -1;
+  int wake_fd_ = -1;
+  std::atomic<bool> running_ = false;
+  std::vector<std::unique_ptr<xe::threading::Thread>> threads_;
+};
+
+std::unique_ptr<SocketReactor> SocketReactor::Create(uint32_t thread_count) {
+  if (!thread_count) {
+    thread_count =
+        std::clamp(xe::threading::logical_processor_count() / 8, 1u, 4u);
+  }
+  auto reactor = std::make_unique<PosixSocketReactor>();
+  if (!reactor->Initialize(thread_count)) {
+    return nullptr;
+  }
+  return std::unique_ptr<SocketReactor>(reactor.release());
+}
+
+}  // namespace xe
@@ -0,0 +1,219 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/base/socket_reactor.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "xenia/base/logging.h"
+#include "xenia/base/platform_win.h"
+#include "xenia/base/threading.h"
+
+// winsock includes must come after platform_win.h:
+#include <winsock2.h>  // NOLINT(build/include_order)
+#include <ws2tcpip.h>  // NOLINT(build/include_order)
+
+namespace xe {
+
+// There is no shareable kernel wait set for sockets on Windows comparable to
+// epoll, so each reactor thread owns a shard of the sockets and rebuilds its
+// WSAPoll set whenever the armed state of the shard changes. A connected
+// loopback UDP socket is used to interrupt WSAPoll.
+class Win32SocketReactor : public SocketReactor {
+ public:
+  Win32SocketReactor() = default;
+  ~Win32SocketReactor() override {
+    running_ = false;
+    for (auto& shard : shards_) {
+      Wake(*shard);
+    }
+    for (auto& shard : shards_) {
+      if (shard->thread) {
+        xe::threading::Wait(shard->thread.get(), false);
+      }
+      if (shard->wake_socket != INVALID_SOCKET) {
+        closesocket(shard->wake_socket);
+      }
+    }
+    shards_.clear();
+    WSACleanup();
+  }
+
+  bool Initialize(uint32_t thread_count) {
+    WSADATA wsa_data;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa_data)) {
+      return false;
+    }
+    running_ = true;
+    for (uint32_t i = 0; i < thread_count; ++i) {
+      auto shard = std::make_unique<Shard>();
+      if (!CreateWakeSocket(*shard)) {
+        XELOGE("SocketReactor: failed to create wake socket: {}",
+               WSAGetLastError());
+        shards_.push_back(std::move(shard));
+        return false;
+      }
+      Shard* shard_ptr = shard.get();
+      shard->thread = xe::threading::Thread::Create({}, [this, shard_ptr, i]() {
+        xe::threading::set_name("Socket Reactor " + std::to_string(i));
+        ThreadMain(*shard_ptr);
+      });
+      shards_.push_back(std::move(shard));
+      if (!shards_.back()->thread) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ protected:
+  bool AddNative(uint64_t native_handle) override { return true; }
+
+  bool ArmNative(uint64_t native_handle, uint32_t events) override {
+    Shard& shard = GetShard(native_handle);
+    {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      shard.armed[SOCKET(native_handle)] = events;
+    }
+    Wake(shard);
+    return true;
+  }
+
+  void RemoveNative(uint64_t native_handle) override {
+    Shard& shard = GetShard(native_handle);
+    bool was_armed;
+    {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      was_armed = shard.armed.erase(SOCKET(native_handle)) != 0;
+    }
+    if (was_armed) {
+      Wake(shard);
+    }
+  }
+
+ private:
+  struct Shard {
+    std::mutex mutex;
+    // Sockets waiting for readiness, removed once reported.
+    std::unordered_map<SOCKET, uint32_t> armed;
+    SOCKET wake_socket = INVALID_SOCKET;
+    std::unique_ptr<xe::threading::Thread> thread;
+  };
+
+  Shard& GetShard(uint64_t native_handle) {
+    // Socket handles are multiples of 4.
+    return *shards_[(native_handle >> 2) % shards_.size()];
+  }
+
+  static bool CreateWakeSocket(Shard& shard) {
+    SOCKET wake_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (wake_socket == INVALID_SOCKET) {
+      return false;
+    }
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int addr_len = sizeof(addr);
+    u_long non_blocking = 1;
+    if (bind(wake_socket, reinterpret_cast<sockaddr*>(&addr), addr_len) ||
+        getsockname(wake_socket, reinterpret_cast<sockaddr*>(&addr),
+                    &addr_len) ||
+        connect(wake_socket, reinterpret_cast<sockaddr*>(&addr), addr_len) ||
+        ioctlsocket(wake_socket, FIONBIO, &non_blocking)) {
+      closesocket(wake_socket);
+      return false;
+    }
+    shard.wake_socket = wake_socket;
+    return true;
+  }
+
+  static void Wake(Shard& shard) {
+    if (shard.wake_socket != INVALID_SOCKET) {
+      char value = 0;
+      send(shard.wake_socket, &value, 1, 0);
+    }
+  }
+
+  void ThreadMain(Shard& shard) {
+    std::vector<WSAPOLLFD> poll_fds;
+    while (running_) {
+      poll_fds.clear();
+      WSAPOLLFD wake_fd = {};
+      wake_fd.fd = shard.wake_socket;
+      wake_fd.events = POLLRDNORM;
+      poll_fds.push_back(wake_fd);
+      {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (const auto& [socket, events] : shard.armed) {
+          WSAPOLLFD poll_fd = {};
+          poll_fd.fd = socket;
+          poll_fd.events = SHORT((events & kEventReadable ? POLLRDNORM : 0) |
+                                 (events & kEventWritable ? POLLWRNORM : 0));
+          poll_fds.push_back(poll_fd);
+        }
+      }
+
+      int count = WSAPoll(poll_fds.data(), ULONG(poll_fds.size()), -1);
+      if (count == SOCKET_ERROR) {
+        XELOGE("SocketReactor: WSAPoll failed with error {}",
+               WSAGetLastError());
+        break;
+      }
+
+      if (poll_fds[0].revents) {
+        char drain[64];
+        while (recv(shard.wake_socket, drain, sizeof(drain), 0) > 0) {
+        }
+      }
+      for (size_t i = 1; i < poll_fds.size(); ++i) {
+        const WSAPOLLFD& poll_fd = poll_fds[i];
+        if (!poll_fd.revents) {
+          continue;
+        }
+        {
+          // One-shot - skip sockets removed in the meantime.
+          std::lock_guard<std::mutex> lock(shard.mutex);
+          if (!shard.armed.erase(poll_fd.fd)) {
+            continue;
+          }
+        }
+        uint32_t ready = 0;
+        if (poll_fd.revents & POLLRDNORM) {
+          ready |= kEventReadable;
+        }
+        if (poll_fd.revents & POLLWRNORM) {
+          ready |= kEventWritable;
+        }
+        if (poll_fd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+          ready |= kEventError;
+        }
+        Dispatch(uint64_t(poll_fd.fd), ready);
+      }
+    }
+  }
+
+  std::atomic<bool> running_ = false;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+std::unique_ptr<SocketReactor> SocketReactor::Create(uint32_t thread_count) {
+  if (!thread_count) {
+    thread_count =
+        std::clamp(xe::threading::logical_processor_count() / 8, 1u, 4u);
+  }
+  auto reactor = std::make_unique<Win32SocketReactor>();
+  if (!reactor->Initialize(thread_count)) {
+    return nullptr;
+  }
+  return std::unique_ptr<SocketReactor>(reactor.release());
+}
+
+}  // namespace xe
@@ -0,0 +1,136 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/base/frame_pacer.h"
+
+#include <chrono>
+#include <ctime>
+#include <numeric>
+
+#include "third_party/catch/include/catch.hpp"
+#include "third_party/fmt/include/fmt/format.h"
+#include "xenia/base/clock.h"
+#include "xenia/base/threading.h"
+
+namespace xe {
+namespace base {
+namespace test {
+
+using xe::threading::FramePacer;
+using namespace std::chrono_literals;
+
+TEST_CASE("Frame pacer keeps the interval without drifting", "[frame_pacer]") {
+  constexpr uint32_t kWaitCount = 100;
+  FramePacer pacer(2ms, 1ms);
+  auto start = FramePacer::clock::now();
+  for (uint32_t i = 0; i < kWaitCount; ++i) {
+    pacer.Wait();
+    // Work between the waits doesn't delay the following deadlines.
+    if (i & 1) {
+      xe::threading::Sleep(500us);
+    }
+  }
+  auto elapsed = FramePacer::clock::now() - start;
+  REQUIRE(elapsed >= kWaitCount * 2ms);
+  REQUIRE(elapsed < kWaitCount * 2ms + 20ms);
+
+  const FramePacer::Statistics& statistics = pacer.statistics();
+  REQUIRE(statistics.wait_count == kWaitCount);
+  REQUIRE(std::accumulate(statistics.lateness_histogram.cbegin(),
+                          statistics.lateness_histogram.cend(),
+                          uint64_t(0)) == kWaitCount);
+  REQUIRE(statistics.spin_time <= statistics.wait_time);
+  REQUIRE(pacer.slack() <= 1ms);
+}
+
+TEST_CASE("Frame pacer doesn't catch up missed deadlines", "[frame_pacer]") {
+  FramePacer pacer(1ms, 0ms);
+  pacer.Wait();
+  xe::threading::Sleep(10ms);
+  // Late, but only once.
+  pacer.Wait();
+  auto start = FramePacer::clock::now();
+  pacer.Wait();
+  REQUIRE(FramePacer::clock::now() - start >= 500us);
+  REQUIRE(pacer.statistics().max_lateness >= 8ms);
+
+  // Moving the deadline.
+  pacer.Adjust(5ms);
+  start = FramePacer::clock::now();
+  pacer.Wait();
+  REQUIRE(FramePacer::clock::now() - start >= 5ms);
+}
+
+TEST_CASE("Frame pacer follows the scaled guest clock", "[frame_pacer]") {
+  constexpr uint32_t kWaitCount = 100;
+  const double guest_time_scalar = Clock::guest_time_scalar();
+  // Drifting by at least an interval per wait initially.
+  for (double scalar : {2.0, 4.0}) {
+    Clock::set_guest_time_scalar(scalar);
+    FramePacer pacer(4ms, 1ms);
+    // Like the vblanks.
+    const double guest_tick_ns =
+        1000000000.0 / double(Clock::guest_tick_frequency());
+    auto host_start = FramePacer::clock::now();
+    uint64_t guest_start = Clock::QueryGuestTickCount();
+    auto guest_elapsed = [&]() {
+      return std::chrono::nanoseconds(int64_t(
+          double(Clock::QueryGuestTickCount() - guest_start) * guest_tick_ns));
+    };
+    for (uint32_t i = 0; i < kWaitCount; ++i) {
+      pacer.Wait();
+      pacer.FollowDrift(guest_elapsed() -
+                        (FramePacer::clock::now() - host_start));
+    }
+    auto elapsed = guest_elapsed();
+    Clock::set_guest_time_scalar(guest_time_scalar);
+    // An interval of the guest clock per wait.
+    REQUIRE(elapsed >= kWaitCount * 4ms - 8ms);
+    REQUIRE(elapsed < kWaitCount * 4ms + 24ms);
+  }
+}
+
+TEST_CASE("Frame pacer skips clock jumps", "[frame_pacer]") {
+  FramePacer pacer(4ms, 0ms);
+  auto start = FramePacer::clock::now();
+  // Applied over several deadlines.
+  pacer.FollowDrift(8ms);
+  pacer.Wait();
+  pacer.FollowDrift(8ms);
+  pacer.Wait();
+  REQUIRE(FramePacer::clock::now() - start < 4ms);
+  pacer.FollowDrift(8ms + FramePacer::kDriftResyncThreshold);
+  start = FramePacer::clock::now();
+  pacer.Wait();
+  REQUIRE(FramePacer::clock::now() - start >= 3ms);
+}
+
+// Run explicitly with the [.benchmark] tag.
+TEST_CASE("Frame pacer benchmark", "[frame_pacer][.benchmark]") {
+  constexpr uint32_t kWaitCount = 300;
+  for (auto max_slack : {0us, 200us, 2000us}) {
+    FramePacer pacer(16667us, max_slack);
+    std::clock_t cpu_start = std::clock();
+    auto start = FramePacer::clock::now();
+    for (uint32_t i = 0; i < kWaitCount; ++i) {
+      pacer.Wait();
+    }
+    double cpu_ms = 1000.0 * double(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+    double elapsed_ms = std::chrono::duration<double, std::milli>(
+                            FramePacer::clock::now() - start)
+                            .count();
+    fmt::print("Max slack {} us: CPU time {:.1f}% of {:.0f} ms, {}\n",
+               max_slack.count(), 100.0 * cpu_ms / elapsed_ms, elapsed_ms,
+               pacer.DescribeStatistics());
+  }
+}
+
+}  // namespace test
+}  // namespace base
+}  // namespace xe
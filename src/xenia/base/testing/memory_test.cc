@@ -13,8 +13,22 @@
 #include "third_party/fmt/include/fmt/format.h"
 
 #include "xenia/base/clock.h"
+#include "xenia/base/platform.h"
 
 #include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#if XE_PLATFORM_LINUX
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 namespace xe {
 namespace base {
@@ -558,6 +572,212 @@ TEST_CASE("read_write_view", "[virtual_memory_mapping]") {
   xe::memory::CloseFileMappingHandle(memory, path);
 }
 
+#if !XE_PLATFORM_WIN32
+TEST_CASE("copy_on_write_file_view", "[virtual_memory_mapping]") {
+  const size_t page_size = xe::memory::page_size();
+  const size_t length = page_size * 4;
+  auto path = fmt::format("xenia_test_{}", Clock::QueryHostTickCount());
+  auto memory = xe::memory::CreateFileMappingHandle(
+      path, length, xe::memory::PageAccess::kReadWrite, true);
+  REQUIRE(memory != xe::memory::kFileMappingHandleInvalid);
+  auto view = reinterpret_cast<uint8_t*>(
+      xe::memory::MapFileView(memory, nullptr, length,
+                              xe::memory::PageAccess::kReadWrite, 0));
+  REQUIRE(view);
+  std::memset(view, 0x11, length);
+
+  // The image file has a header page before the data.
+  auto image_path = std::filesystem::temp_directory_path() /
+                    fmt::format("xenia_test_{}.bin", Clock::QueryHostTickCount());
+  {
+    std::vector<uint8_t> image(page_size * 3, 0x22);
+    FILE* file = std::fopen(image_path.c_str(), "wb");
+    REQUIRE(file);
+    REQUIRE(std::fwrite(image.data(), image.size(), 1, file) == 1);
+    std::fclose(file);
+  }
+
+  // Too long for the file.
+  REQUIRE_FALSE(xe::memory::MapFileViewCopyOnWrite(
+      image_path, view + page_size, page_size * 3,
+      xe::memory::PageAccess::kReadWrite, page_size));
+  REQUIRE(view[page_size] == 0x11);
+
+  REQUIRE(xe::memory::MapFileViewCopyOnWrite(
+      image_path, view + page_size, page_size * 2,
+      xe::memory::PageAccess::kReadWrite, page_size));
+  REQUIRE(view[0] == 0x11);
+  REQUIRE(view[page_size] == 0x22);
+  REQUIRE(view[page_size * 3 - 1] == 0x22);
+  REQUIRE(view[page_size * 3] == 0x11);
+
+  // Writes stay private.
+  view[page_size] = 0x33;
+  {
+    FILE* file = std::fopen(image_path.c_str(), "rb");
+    REQUIRE(file);
+    std::fseek(file, long(page_size), SEEK_SET);
+    REQUIRE(std::fgetc(file) == 0x22);
+    std::fclose(file);
+  }
+
+  REQUIRE(xe::memory::RestoreFileView(memory, view + page_size, page_size * 2,
+                                      xe::memory::PageAccess::kReadWrite,
+                                      page_size));
+  REQUIRE(view[page_size] == 0x11);
+  REQUIRE(view[page_size * 3 - 1] == 0x11);
+
+  std::filesystem::remove(image_path);
+  xe::memory::UnmapFileView(memory, view, length);
+  xe::memory::CloseFileMappingHandle(memory, path);
+}
+#endif  // !XE_PLATFORM_WIN32
+
+TEST_CASE("large_page_file_view_protection", "[virtual_memory_mapping]") {
+  // Two large pages, aliased by two views like the guest physical memory.
+  const size_t page_size = xe::memory::page_size();
+  constexpr size_t length = 0x400000;
+  auto path = fmt::format("xenia_test_{}", Clock::QueryHostTickCount());
+  auto memory = xe::memory::CreateFileMappingHandle(
+      path, length, xe::memory::PageAccess::kReadWrite, false, true);
+  REQUIRE(memory != xe::memory::kFileMappingHandleInvalid);
+  auto view = reinterpret_cast<uint8_t*>(xe::memory::MapFileView(
+      memory, reinterpret_cast<void*>(0x100000000), length,
+      xe::memory::PageAccess::kReadWrite, 0));
+  auto alias = reinterpret_cast<uint8_t*>(xe::memory::MapFileView(
+      memory, reinterpret_cast<void*>(0x140000000), length,
+      xe::memory::PageAccess::kReadWrite, 0));
+  REQUIRE(view);
+  REQUIRE(alias);
+  // Not supported everywhere, but the views must behave the same either way.
+  xe::memory::AdviseLargePages(view, length);
+  xe::memory::AdviseLargePages(alias, length);
+  std::memset(view, 0x11, length);
+
+  // Protecting a single page inside a large page.
+  uint8_t* protected_page = view + length / 2 + page_size;
+  REQUIRE(xe::memory::Protect(protected_page, page_size,
+                              xe::memory::PageAccess::kReadOnly));
+  size_t query_length = page_size;
+  xe::memory::PageAccess access;
+  REQUIRE(xe::memory::QueryProtect(protected_page, query_length, access));
+  REQUIRE(access == xe::memory::PageAccess::kReadOnly);
+  REQUIRE(query_length == page_size);
+  query_length = page_size;
+  REQUIRE(xe::memory::QueryProtect(view + length / 2, query_length, access));
+  REQUIRE(access == xe::memory::PageAccess::kReadWrite);
+
+  view[length / 2] = 0x22;
+  protected_page[page_size] = 0x33;
+  REQUIRE(alias[length / 2] == 0x22);
+  REQUIRE(alias[length / 2 + page_size * 2] == 0x33);
+  REQUIRE(protected_page[0] == 0x11);
+  // The other view of the page stays writable.
+  alias[length / 2 + page_size] = 0x44;
+  REQUIRE(protected_page[0] == 0x44);
+
+  xe::memory::UnmapFileView(memory, alias, length);
+  xe::memory::UnmapFileView(memory, view, length);
+  xe::memory::CloseFileMappingHandle(memory, path);
+}
+
+#if XE_PLATFORM_LINUX
+// Counts the data TLB misses of loads in this thread, if the host exposes the
+// performance counters.
+class DtlbMissCounter {
+ public:
+  DtlbMissCounter() {
+    perf_event_attr attr = {};
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB |
+                  (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd_ = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+  ~DtlbMissCounter() {
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+  }
+  void Start() {
+    if (fd_ >= 0) {
+      ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+  std::string Stop() {
+    uint64_t count;
+    if (fd_ < 0 || ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0) ||
+        read(fd_, &count, sizeof(count)) != sizeof(count)) {
+      return "unavailable";
+    }
+    return std::to_string(count);
+  }
+
+ private:
+  int fd_;
+};
+#else
+class DtlbMissCounter {
+ public:
+  void Start() {}
+  std::string Stop() { return "unavailable"; }
+};
+#endif
+
+// Run explicitly with the [.benchmark] tag.
+TEST_CASE("large_page_file_view_benchmark",
+          "[virtual_memory_mapping][.benchmark]") {
+  // Random loads over a view as large as the guest physical memory.
+  constexpr size_t length = 0x20000000;
+  constexpr uint32_t kAccesses = 1 << 24;
+  fmt::print("Large page size: {} KB\n",
+             xe::memory::large_page_size() / 1024);
+  for (bool large_pages : {false, true}) {
+    auto path = fmt::format("xenia_test_{}", Clock::QueryHostTickCount());
+    auto memory = xe::memory::CreateFileMappingHandle(
+        path, length, xe::memory::PageAccess::kReadWrite, false, large_pages);
+    REQUIRE(memory != xe::memory::kFileMappingHandleInvalid);
+    auto view = reinterpret_cast<uint8_t*>(xe::memory::MapFileView(
+        memory, reinterpret_cast<void*>(0x100000000), length,
+        xe::memory::PageAccess::kReadWrite, 0));
+    REQUIRE(view);
+    if (large_pages) {
+      xe::memory::AdviseLargePages(view, length);
+    }
+    std::memset(view, 1, length);
+
+    DtlbMissCounter dtlb_misses;
+    uint64_t random = 88172645463325252ull;
+    uint64_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    dtlb_misses.Start();
+    for (uint32_t i = 0; i < kAccesses; ++i) {
+      random ^= random << 13;
+      random ^= random >> 7;
+      random ^= random << 17;
+      sum += *reinterpret_cast<volatile uint64_t*>(
+          view + (random & (length - 1) & ~uint64_t(7)));
+    }
+    std::string misses = dtlb_misses.Stop();
+    double ns = std::chrono::duration<double, std::nano>(
+                    std::chrono::steady_clock::now() - start)
+                    .count() /
+                kAccesses;
+    fmt::print(
+        "{} pages: {:.1f} ns per random load ({:.1f} M/s), {} dTLB misses "
+        "[{}]\n",
+        large_pages ? "Large" : "Normal", ns, 1000.0 / ns, misses, sum & 1);
+
+    xe::memory::UnmapFileView(memory, view, length);
+    xe::memory::CloseFileMappingHandle(memory, path);
+  }
+}
+
 TEST_CASE("make_fourcc", "[fourcc]") {
   SECTION("'1234'") {
     const uint32_t fourcc_host = 0x31323334;
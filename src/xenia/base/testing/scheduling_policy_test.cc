@@ -0,0 +1,215 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/base/scheduling_policy.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "third_party/catch/include/catch.hpp"
+#include "third_party/fmt/include/fmt/format.h"
+
+namespace xe {
+namespace base {
+namespace test {
+
+using xe::threading::SchedulingPolicy;
+
+// Two cache domains (CCXs) of 4 SMT cores each, with the siblings numbered
+// like on Linux - processors 0-7 are the first threads of cores 0-7, 8-15 the
+// second ones.
+static CpuTopology TwoCacheDomainTopology() {
+  CpuTopology topology;
+  for (uint32_t id = 0; id < 16; ++id) {
+    uint32_t core = id & 7;
+    topology.logical_processors.push_back({id, core, core >> 2});
+  }
+  topology.Normalize();
+  return topology;
+}
+
+static uint64_t HardwareThreadsMask(const SchedulingPolicy& policy) {
+  uint64_t mask = 0;
+  for (uint32_t i = 0; i < SchedulingPolicy::kHardwareThreadCount; ++i) {
+    mask |= policy.hardware_thread_affinity(i);
+  }
+  return mask;
+}
+
+TEST_CASE("CpuTopology normalization", "[scheduling_policy]") {
+  CpuTopology topology = TwoCacheDomainTopology();
+  REQUIRE(topology.logical_processors.size() == 16);
+  REQUIRE(topology.core_count() == 8);
+  REQUIRE(topology.cache_domain_count() == 2);
+  REQUIRE(topology.logical_processors[9].core == 1);
+  REQUIRE(topology.logical_processors[9].cache_domain == 0);
+  REQUIRE(topology.logical_processors[13].cache_domain == 1);
+
+  CpuTopology flat = CpuTopology::Flat(4);
+  REQUIRE(flat.core_count() == 4);
+  REQUIRE(flat.cache_domain_count() == 4);
+}
+
+TEST_CASE("Legacy placement", "[scheduling_policy]") {
+  SchedulingPolicy::Options options;
+  options.placement = SchedulingPolicy::Placement::kLegacy;
+  SchedulingPolicy policy(TwoCacheDomainTopology(), options);
+  for (uint32_t i = 0; i < SchedulingPolicy::kHardwareThreadCount; ++i) {
+    REQUIRE(policy.hardware_thread_affinity(i) == uint64_t(1) << i);
+  }
+  REQUIRE(policy.service_thread_affinity() == 0);
+
+  // Nothing is pinned with fewer processors than hardware threads.
+  SchedulingPolicy small_policy(CpuTopology::Flat(4), options);
+  for (uint32_t i = 0; i < SchedulingPolicy::kHardwareThreadCount; ++i) {
+    REQUIRE(small_policy.hardware_thread_affinity(i) == 0);
+  }
+}
+
+TEST_CASE("Compact placement", "[scheduling_policy]") {
+  SchedulingPolicy::Options options;
+  options.placement = SchedulingPolicy::Placement::kCompact;
+
+  SECTION("Separate cores") {
+    SchedulingPolicy policy(TwoCacheDomainTopology(), options);
+    // Cores 0-3 of the first domain, then 4-5 of the second, each with both
+    // siblings.
+    for (uint32_t i = 0; i < SchedulingPolicy::kHardwareThreadCount; ++i) {
+      REQUIRE(policy.hardware_thread_affinity(i) ==
+              ((uint64_t(1) << i) | (uint64_t(1) << (8 + i))));
+    }
+  }
+
+  SECTION("Shared cores") {
+    options.share_cores = true;
+    SchedulingPolicy policy(TwoCacheDomainTopology(), options);
+    // Each Xenon core on one host core within the first domain.
+    for (uint32_t i = 0; i < SchedulingPolicy::kHardwareThreadCount; ++i) {
+      uint32_t core = i >> 1;
+      REQUIRE(policy.hardware_thread_affinity(i) ==
+              uint64_t(1) << (core + (i & 1) * 8));
+    }
+    REQUIRE(HardwareThreadsMask(policy) == 0x0707);
+  }
+
+  SECTION("Shared cores without SMT") {
+    options.share_cores = true;
+    SchedulingPolicy policy(CpuTopology::Flat(8), options);
+    for (uint32_t i = 0; i < SchedulingPolicy::kHardwareThreadCount; ++i) {
+      REQUIRE(policy.hardware_thread_affinity(i) == uint64_t(1) << i);
+    }
+  }
+
+  SECTION("Larger cache domain first") {
+    // Domain 0 with 2 cores, domain 1 with 6.
+    CpuTopology topology;
+    for (uint32_t id = 0; id < 8; ++id) {
+      topology.logical_processors.push_back({id, id, id < 2 ? 0u : 1u});
+    }
+    topology.Normalize();
+    SchedulingPolicy policy(topology, options);
+    REQUIRE(HardwareThreadsMask(policy) == 0xFC);
+  }
+}
+
+TEST_CASE("Service thread isolation", "[scheduling_policy]") {
+  SchedulingPolicy::Options options;
+  options.placement = SchedulingPolicy::Placement::kCompact;
+  options.share_cores = true;
+  options.isolate_service_threads = true;
+  SchedulingPolicy policy(TwoCacheDomainTopology(), options);
+  REQUIRE(policy.service_thread_affinity() == (0xFFFF & ~uint64_t(0x0707)));
+
+  // No processors left over - the service threads aren't restricted.
+  options.share_cores = false;
+  SchedulingPolicy full_policy(CpuTopology::Flat(6), options);
+  REQUIRE(HardwareThreadsMask(full_policy) == 0x3F);
+  REQUIRE(full_policy.service_thread_affinity() == 0);
+
+  options.isolate_service_threads = false;
+  SchedulingPolicy shared_policy(TwoCacheDomainTopology(), options);
+  REQUIRE(shared_policy.service_thread_affinity() == 0);
+}
+
+// Round trips between the two threads of each Xenon core, like a guest
+// producer and consumer spinning on a shared lock, with all three cores busy.
+static double MeasurePingPong(const SchedulingPolicy* policy) {
+  constexpr uint32_t kRoundTrips = 200000;
+  constexpr uint32_t kCoreCount = SchedulingPolicy::kHardwareThreadCount / 2;
+  struct alignas(64) Pair {
+    std::atomic<uint32_t> value = 0;
+  };
+  Pair pairs[kCoreCount];
+  std::atomic<bool> go = false;
+  std::vector<std::unique_ptr<xe::threading::Thread>> threads;
+  for (uint32_t i = 0; i < SchedulingPolicy::kHardwareThreadCount; ++i) {
+    Pair& pair = pairs[i >> 1];
+    uint32_t parity = i & 1;
+    threads.push_back(xe::threading::Thread::Create({}, [&, parity]() {
+      while (!go.load(std::memory_order_acquire)) {
+      }
+      for (uint32_t n = parity; n < kRoundTrips * 2; n += 2) {
+        while (pair.value.load(std::memory_order_acquire) != n) {
+        }
+        pair.value.store(n + 1, std::memory_order_release);
+      }
+    }));
+    REQUIRE(threads.back());
+    if (policy && policy->hardware_thread_affinity(i)) {
+      threads.back()->set_affinity_mask(policy->hardware_thread_affinity(i));
+    }
+  }
+  auto start = std::chrono::steady_clock::now();
+  go.store(true, std::memory_order_release);
+  for (auto& thread : threads) {
+    xe::threading::Wait(thread.get(), false);
+  }
+  double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count();
+  return seconds * 1e9 / kRoundTrips;
+}
+
+// Run explicitly with the [.benchmark] tag.
+TEST_CASE("Scheduling policy benchmark", "[scheduling_policy][.benchmark]") {
+  CpuTopology topology = CpuTopology::Query();
+  fmt::print("{} logical processors, {} cores, {} cache domains\n",
+             topology.logical_processors.size(), topology.core_count(),
+             topology.cache_domain_count());
+  if (topology.logical_processors.size() <
+      SchedulingPolicy::kHardwareThreadCount) {
+    return;
+  }
+  fmt::print("Unpinned: {:.0f} ns per round trip\n", MeasurePingPong(nullptr));
+  struct Configuration {
+    const char* name;
+    SchedulingPolicy::Placement placement;
+    bool share_cores;
+  };
+  for (const Configuration& configuration : {
+           Configuration{"Legacy", SchedulingPolicy::Placement::kLegacy, false},
+           Configuration{"Compact", SchedulingPolicy::Placement::kCompact,
+                         false},
+           Configuration{"Compact, shared cores",
+                         SchedulingPolicy::Placement::kCompact, true},
+       }) {
+    SchedulingPolicy::Options options;
+    options.placement = configuration.placement;
+    options.share_cores = configuration.share_cores;
+    SchedulingPolicy policy(topology, options);
+    fmt::print("{} ({}): {:.0f} ns per round trip\n", configuration.name,
+               policy.Describe(), MeasurePingPong(&policy));
+  }
+}
+
+}  // namespace test
+}  // namespace base
+}  // namespace xe
@@ -133,6 +133,16 @@ TEST_CASE("Sleep Current Thread", "[sleep]") {
   REQUIRE(duration >= wait_time);
 }
 
+TEST_CASE("Sleep Current Thread Until a Deadline", "[sleep]") {
+  auto deadline = std::chrono::steady_clock::now() + 50ms;
+  SleepUntil(deadline);
+  REQUIRE(std::chrono::steady_clock::now() >= deadline);
+  // Already passed.
+  auto start = std::chrono::steady_clock::now();
+  SleepUntil(start - 1s);
+  REQUIRE(std::chrono::steady_clock::now() - start < 50ms);
+}
+
 TEST_CASE("Sleep Current Thread in Alertable State", "[sleep]") {
   auto wait_time = 50ms;
   auto start = std::chrono::steady_clock::now();
@@ -1139,6 +1149,37 @@ TEST_CASE("Test Thread QueueUserCallback", "[thread]") {
   // callbacks.
 }
 
+TEST_CASE("Query Thread CPU Statistics", "[thread]") {
+  Thread::CreationParameters params = {};
+  std::atomic<bool> stop = false;
+  auto thread = Thread::Create(params, [&stop] {
+    while (!stop) {
+    }
+  });
+
+  Thread::CpuStatistics first, second;
+  REQUIRE(thread->QueryCpuStatistics(first));
+  REQUIRE(spin_wait_for(1s, [&] {
+    return thread->QueryCpuStatistics(second) &&
+           second.cpu_time_ns > first.cpu_time_ns;
+  }));
+
+  // Sampled while the thread finishes and is joined.
+  std::atomic<bool> finished = false;
+  std::thread sampler([&] {
+    Thread::CpuStatistics statistics;
+    while (thread->QueryCpuStatistics(statistics)) {
+    }
+    finished = true;
+  });
+  stop = true;
+  auto result = Wait(thread.get(), false, 1s);
+  REQUIRE(result == WaitResult::kSuccess);
+  sampler.join();
+  REQUIRE(finished);
+  REQUIRE_FALSE(thread->QueryCpuStatistics(second));
+}
+
 }  // namespace test
 }  // namespace base
 }  // namespace xe
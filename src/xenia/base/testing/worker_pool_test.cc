@@ -0,0 +1,55 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/base/worker_pool.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "third_party/catch/include/catch.hpp"
+
+namespace xe {
+namespace base {
+namespace test {
+
+TEST_CASE("WorkerPool processes every item once", "[worker_pool]") {
+  for (uint32_t thread_count : {0u, 1u, 4u}) {
+    WorkerPool pool(thread_count, "Worker Pool Test");
+    REQUIRE(pool.thread_count() == thread_count);
+    for (uint32_t item_count : {0u, 1u, 2u, 7u, 1000u}) {
+      std::vector<std::atomic<uint32_t>> counts(item_count);
+      pool.ParallelFor(item_count, [&](uint32_t item) { ++counts[item]; });
+      for (uint32_t i = 0; i < item_count; ++i) {
+        REQUIRE(counts[i] == 1);
+      }
+    }
+  }
+}
+
+TEST_CASE("WorkerPool serializes concurrent loops", "[worker_pool]") {
+  WorkerPool pool(3, "Worker Pool Test");
+  constexpr uint32_t kLoops = 100;
+  constexpr uint32_t kItems = 64;
+  std::atomic<uint64_t> sums[2] = {0, 0};
+  auto submit = [&](uint32_t submitter) {
+    for (uint32_t i = 0; i < kLoops; ++i) {
+      pool.ParallelFor(kItems, [&](uint32_t item) { sums[submitter] += item; });
+    }
+  };
+  std::thread other_submitter(submit, 1);
+  submit(0);
+  other_submitter.join();
+  REQUIRE(sums[0] == uint64_t(kLoops) * (kItems * (kItems - 1) / 2));
+  REQUIRE(sums[1] == uint64_t(kLoops) * (kItems * (kItems - 1) / 2));
+}
+
+}  // namespace test
+}  // namespace base
+}  // namespace xe
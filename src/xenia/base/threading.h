@@ -19,6 +19,7 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <thread>
 #include <utility>
@@ -116,6 +117,10 @@ void SyncMemory();
 // Sleeps the current thread for at least as long as the given duration.
 void Sleep(std::chrono::microseconds duration);
 void NanoSleep(int64_t ns);
+// Sleeps the current thread until at least the given time. Unlike sleeping
+// for a duration computed from the current time, this doesn't drift if the
+// thread is preempted before starting to sleep.
+void SleepUntil(std::chrono::steady_clock::time_point deadline);
 template <typename Rep, typename Period>
 void Sleep(std::chrono::duration<Rep, Period> duration) {
   Sleep(std::chrono::duration_cast<std::chrono::microseconds>(duration));
@@ -427,7 +432,16 @@ class Thread : public WaitHandle {
   struct CreationParameters {
     size_t stack_size = 4_MiB;
     bool create_suspended = false;
-    int32_t initial_priority = 0;
+    // ThreadPriority to start the thread with, or the default of the host.
+    std::optional<int32_t> initial_priority;
+  };
+
+  struct CpuStatistics {
+    // Host CPU time consumed by the thread in user and kernel mode.
+    uint64_t cpu_time_ns = 0;
+    // Zero where the host doesn't report them for other threads.
+    uint64_t voluntary_context_switches = 0;
+    uint64_t involuntary_context_switches = 0;
   };
 
   // Creates a thread with the given parameters and calls the start routine from
@@ -469,6 +483,10 @@ class Thread : public WaitHandle {
   // process of a thread.
   virtual void set_affinity_mask(uint64_t new_affinity_mask) = 0;
 
+  // Samples the host resource usage of the thread, which may be called from
+  // any thread while it's running.
+  virtual bool QueryCpuStatistics(CpuStatistics& statistics_out) = 0;
+
   // Adds a user-mode asynchronous procedure call request to the thread queue.
   // When a user-mode APC is queued, the thread is not directed to call the APC
   // function unless it is in an alertable state. After the thread is in an
@@ -11,24 +11,40 @@
 
 #include "xenia/base/assert.h"
 #include "xenia/base/chrono_steady_cast.h"
+#include "xenia/base/cvar.h"
 #include "xenia/base/platform.h"
 #include "xenia/base/threading_timer_queue.h"
 
+#include <fcntl.h>
 #include <pthread.h>
 #include <sched.h>
 #include <signal.h>
 #include <sys/eventfd.h>
+#include <sys/resource.h>
 #include <sys/syscall.h>
 #include <sys/time.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include <memory>
 
 #include "logging.h"
 
+DEFINE_bool(posix_nice_thread_priorities, false,
+            "Apply thread priorities as nice values of normal threads instead "
+            "of SCHED_FIFO real-time priorities, which usually require "
+            "CAP_SYS_NICE. Raising priorities above normal still needs "
+            "RLIMIT_NICE to allow it.",
+            "CPU");
+
 #if XE_PLATFORM_ANDROID
 #include <dlfcn.h>
 
@@ -162,6 +178,14 @@ void Sleep(std::chrono::microseconds duration) {
 
 void NanoSleep(int64_t duration) { Sleep(std::chrono::nanoseconds(duration)); }
 
+void SleepUntil(std::chrono::steady_clock::time_point deadline) {
+  // steady_clock is CLOCK_MONOTONIC.
+  timespec rqtp = DurationToTimeSpec(deadline.time_since_epoch());
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &rqtp, nullptr) ==
+         EINTR) {
+  }
+}
+
 // TODO(bwrsandman) Implement by allowing alert interrupts from IO operations
 thread_local bool alertable_state_ = false;
 SleepResult AlertableSleep(std::chrono::microseconds duration) {
@@ -467,8 +491,33 @@ struct ThreadStartData {
   std::function<void()> start_routine;
   bool create_suspended;
   Thread* thread_obj;
+  // Applied by the thread itself with posix_nice_thread_priorities.
+  std::optional<int32_t> initial_nice_priority;
 };
 
+// Maps ThreadPriority (kLowest 1 - kHighest 32, kNormal 16) to nice values
+// (19 lowest - -20 highest), keeping the range moderate so high priority
+// threads can't starve the rest of the system.
+static int ThreadPriorityToNice(int32_t priority) {
+  return std::clamp(-(priority - ThreadPriority::kNormal) * 10 /
+                        ThreadPriority::kNormal,
+                    -20, 19);
+}
+
+// On Linux, nice values are per-thread when set for a thread ID.
+static bool SetThreadNicePriority(pid_t system_tid, int32_t priority) {
+  if (setpriority(PRIO_PROCESS, id_t(system_tid),
+                  ThreadPriorityToNice(priority)) != 0) {
+    if (errno == EACCES || errno == EPERM) {
+      XELOGW("Permission denied while setting thread nice value");
+    } else {
+      XELOGW("Unknown error while setting thread nice value");
+    }
+    return false;
+  }
+  return true;
+}
+
 template <>
 class PosixCondition<Thread> final : public PosixConditionBase {
   enum class State {
@@ -498,9 +547,11 @@ class PosixCondition<Thread> final : public PosixConditionBase {
       pthread_attr_destroy(&attr);
       return false;
     }
-    if (params.initial_priority != 0) {
+    if (params.initial_priority && cvars::posix_nice_thread_priorities) {
+      start_data->initial_nice_priority = params.initial_priority;
+    } else if (params.initial_priority) {
       sched_param sched{};
-      sched.sched_priority = params.initial_priority + 1;
+      sched.sched_priority = *params.initial_priority + 1;
       if (pthread_attr_setschedpolicy(&attr, SCHED_FIFO) != 0) {
         pthread_attr_destroy(&attr);
         return false;
@@ -526,12 +577,20 @@ class PosixCondition<Thread> final : public PosixConditionBase {
         exit_code_(0),
         state_(State::kRunning),
         suspend_count_(0) {
+    // Created on the thread itself by Thread::GetCurrentThread.
+    system_tid_.store(pid_t(syscall(SYS_gettid)),
+                      std::memory_order_release);
 #if XE_PLATFORM_ANDROID
     android_pre_api_26_name_[0] = '\0';
 #endif
   }
 
   ~PosixCondition() override {
+#if XE_PLATFORM_LINUX
+    if (status_fd_ >= 0) {
+      ::close(status_fd_);
+    }
+#endif  // XE_PLATFORM_LINUX
     // FIXME(RodoMa92): This causes random crashes.
     //  The proper way to handle them according to the webs is properly shutdown
     //  instead on relying on killing them using pthread_cancel.
@@ -624,7 +683,7 @@ class PosixCondition<Thread> final : public PosixConditionBase {
     auto cpu_count = std::min(CPU_SETSIZE, 64);
     for (auto i = 0u; i < cpu_count; i++) {
       auto set = CPU_ISSET(i, &cpu_set);
-      result |= set << i;
+      result |= uint64_t(set != 0) << i;
     }
     return result;
   }
@@ -634,7 +693,7 @@ class PosixCondition<Thread> final : public PosixConditionBase {
     cpu_set_t cpu_set;
     CPU_ZERO(&cpu_set);
     for (auto i = 0u; i < 64; i++) {
-      if (mask & (1 << i)) {
+      if (mask & (uint64_t(1) << i)) {
         CPU_SET(i, &cpu_set);
       }
     }
@@ -650,8 +709,36 @@ class PosixCondition<Thread> final : public PosixConditionBase {
 #endif
   }
 
+  bool QueryCpuStatistics(Thread::CpuStatistics& statistics_out) const {
+    WaitStarted();
+    // Held throughout so the thread can't finish and be joined while its
+    // clock is being queried.
+    std::unique_lock lock(state_mutex_);
+    if (state_ == State::kFinished) {
+      return false;
+    }
+    clockid_t clock_id;
+    timespec cpu_time;
+    if (pthread_getcpuclockid(thread_, &clock_id) != 0 ||
+        clock_gettime(clock_id, &cpu_time) != 0) {
+      return false;
+    }
+    statistics_out.cpu_time_ns =
+        uint64_t(cpu_time.tv_sec) * 1000000000 + uint64_t(cpu_time.tv_nsec);
+#if XE_PLATFORM_LINUX
+    UpdateContextSwitches();
+#endif  // XE_PLATFORM_LINUX
+    statistics_out.voluntary_context_switches = voluntary_context_switches_;
+    statistics_out.involuntary_context_switches =
+        involuntary_context_switches_;
+    return true;
+  }
+
   int priority() const {
     WaitStarted();
+    if (cvars::posix_nice_thread_priorities) {
+      return nice_priority_.load(std::memory_order_relaxed);
+    }
     int policy;
     sched_param param{};
     int ret = pthread_getschedparam(thread_, &policy, &param);
@@ -664,6 +751,13 @@ class PosixCondition<Thread> final : public PosixConditionBase {
 
   void set_priority(int new_priority) const {
     WaitStarted();
+    if (cvars::posix_nice_thread_priorities) {
+      if (SetThreadNicePriority(system_tid_.load(std::memory_order_acquire),
+                                new_priority)) {
+        nice_priority_.store(new_priority, std::memory_order_relaxed);
+      }
+      return;
+    }
     sched_param param{};
     param.sched_priority = new_priority;
     int res = pthread_setschedparam(thread_, SCHED_FIFO, &param);
@@ -790,6 +884,54 @@ class PosixCondition<Thread> final : public PosixConditionBase {
   }
 
  private:
+#if XE_PLATFORM_LINUX
+  // getrusage(RUSAGE_THREAD) only covers the calling thread, procfs exposes
+  // the counts for any thread of the process. Called with state_mutex_ held.
+  void UpdateContextSwitches() const {
+    // Sampling may be frequent with a short thread_statistics_csv_interval,
+    // and the counts are only shown in coarse intervals.
+    auto now = std::chrono::steady_clock::now();
+    if (context_switches_read_ &&
+        now - context_switches_read_time_ < std::chrono::milliseconds(100)) {
+      return;
+    }
+    if (status_fd_ < 0) {
+      pid_t system_tid = system_tid_.load(std::memory_order_acquire);
+      if (!system_tid) {
+        return;
+      }
+      char status_path[64];
+      std::snprintf(status_path, sizeof(status_path),
+                    "/proc/self/task/%d/status", int(system_tid));
+      // Kept open and reread rather than reopened for every sample.
+      status_fd_ = ::open(status_path, O_RDONLY | O_CLOEXEC);
+      if (status_fd_ < 0) {
+        return;
+      }
+    }
+    char status[4096];
+    ssize_t status_size = pread(status_fd_, status, sizeof(status) - 1, 0);
+    if (status_size <= 0) {
+      return;
+    }
+    status[status_size] = '\0';
+    const char* voluntary = std::strstr(status, "\nvoluntary_ctxt_switches:");
+    if (voluntary) {
+      voluntary_context_switches_ = std::strtoull(
+          voluntary + std::strlen("\nvoluntary_ctxt_switches:"), nullptr, 10);
+    }
+    const char* involuntary =
+        std::strstr(status, "\nnonvoluntary_ctxt_switches:");
+    if (involuntary) {
+      involuntary_context_switches_ = std::strtoull(
+          involuntary + std::strlen("\nnonvoluntary_ctxt_switches:"), nullptr,
+          10);
+    }
+    context_switches_read_ = true;
+    context_switches_read_time_ = now;
+  }
+#endif  // XE_PLATFORM_LINUX
+
   static void* ThreadStartRoutine(void* parameter);
   bool signaled() const override { return signaled_; }
   void post_execution() override {
@@ -798,6 +940,18 @@ class PosixCondition<Thread> final : public PosixConditionBase {
     }
   }
   pthread_t thread_;
+  // Kernel ID of the thread, for procfs lookups, 0 until it has started.
+  std::atomic<pid_t> system_tid_ = 0;
+  // ThreadPriority last applied with posix_nice_thread_priorities.
+  mutable std::atomic<int32_t> nice_priority_ = ThreadPriority::kNormal;
+  // Last read by QueryCpuStatistics, protected with state_mutex_.
+  mutable uint64_t voluntary_context_switches_ = 0;
+  mutable uint64_t involuntary_context_switches_ = 0;
+#if XE_PLATFORM_LINUX
+  mutable int status_fd_ = -1;
+  mutable bool context_switches_read_ = false;
+  mutable std::chrono::steady_clock::time_point context_switches_read_time_;
+#endif  // XE_PLATFORM_LINUX
   bool signaled_;
   int exit_code_;
   volatile State state_;
@@ -1065,6 +1219,10 @@ class PosixThread final : public PosixConditionHandle<Thread> {
     handle_.set_affinity_mask(mask);
   }
 
+  bool QueryCpuStatistics(CpuStatistics& statistics_out) override {
+    return handle_.QueryCpuStatistics(statistics_out);
+  }
+
   int priority() override { return handle_.priority(); }
   void set_priority(int new_priority) override {
     handle_.set_priority(new_priority);
@@ -1104,9 +1262,17 @@ void* PosixCondition<Thread>::ThreadStartRoutine(void* parameter) {
   auto thread = dynamic_cast<PosixThread*>(start_data->thread_obj);
   auto start_routine = std::move(start_data->start_routine);
   auto create_suspended = start_data->create_suspended;
+  auto initial_nice_priority = start_data->initial_nice_priority;
   delete start_data;
 
   current_thread_ = thread;
+  pid_t system_tid = pid_t(syscall(SYS_gettid));
+  thread->handle_.system_tid_.store(system_tid, std::memory_order_release);
+  if (initial_nice_priority &&
+      SetThreadNicePriority(system_tid, *initial_nice_priority)) {
+    thread->handle_.nice_priority_.store(*initial_nice_priority,
+                                         std::memory_order_relaxed);
+  }
   {
     std::unique_lock lock(thread->handle_.state_mutex_);
     thread->handle_.state_ =
@@ -161,6 +161,16 @@ void NanoSleep(int64_t ns) {
 }
 void SyncMemory() { MemoryBarrier(); }
 
+void SleepUntil(std::chrono::steady_clock::time_point deadline) {
+  // NtDelayExecution with an absolute time uses the system time, which may be
+  // adjusted, so sleep for the remaining relative time instead.
+  auto remaining = deadline - std::chrono::steady_clock::now();
+  if (remaining.count() > 0) {
+    NanoSleep(std::chrono::duration_cast<std::chrono::nanoseconds>(remaining)
+                  .count());
+  }
+}
+
 void Sleep(std::chrono::microseconds duration) {
   if (duration.count() < 100) {
     MaybeYield();
@@ -540,6 +550,24 @@ class Win32Thread : public Win32Handle<Thread> {
     SetThreadAffinityMask(handle_, new_affinity_mask);
   }
 
+  bool QueryCpuStatistics(CpuStatistics& statistics_out) override {
+    FILETIME creation_time, exit_time, kernel_time, user_time;
+    if (!GetThreadTimes(handle_, &creation_time, &exit_time, &kernel_time,
+                        &user_time)) {
+      return false;
+    }
+    // 100-nanosecond intervals. Context switch counts are only available
+    // through NtQuerySystemInformation for the whole process.
+    statistics_out.cpu_time_ns =
+        ((uint64_t(kernel_time.dwHighDateTime) << 32 |
+          kernel_time.dwLowDateTime) +
+         (uint64_t(user_time.dwHighDateTime) << 32 | user_time.dwLowDateTime)) *
+        100;
+    statistics_out.voluntary_context_switches = 0;
+    statistics_out.involuntary_context_switches = 0;
+    return true;
+  }
+
   struct ApcData {
     std::function<void()> callback;
   };
@@ -0,0 +1,103 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/base/worker_pool.h"
+
+#include "third_party/fmt/include/fmt/format.h"
+
+namespace xe {
+
+WorkerPool::WorkerPool(uint32_t thread_count, const std::string_view name) {
+  threads_.reserve(thread_count);
+  for (uint32_t i = 0; i < thread_count; ++i) {
+    std::string thread_name = fmt::format("{} {}", name, i);
+    auto thread = xe::threading::Thread::Create({}, [this, thread_name]() {
+      xe::threading::set_name(thread_name);
+      WorkerThreadMain();
+    });
+    if (!thread) {
+      break;
+    }
+    threads_.push_back(std::move(thread));
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  work_cond_.notify_all();
+  for (auto& thread : threads_) {
+    xe::threading::Wait(thread.get(), false);
+  }
+}
+
+void WorkerPool::ParallelFor(uint32_t item_count,
+                             const ItemFunction& function) {
+  if (threads_.empty() || item_count <= 1) {
+    for (uint32_t i = 0; i < item_count; ++i) {
+      function(i);
+    }
+    return;
+  }
+
+  std::lock_guard<std::mutex> submit_lock(submit_mutex_);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    function_ = &function;
+    item_count_ = item_count;
+    next_item_.store(0, std::memory_order_relaxed);
+    ++loop_index_;
+  }
+  work_cond_.notify_all();
+
+  ProcessItems();
+
+  // Every item has been taken - wait for the workers still processing theirs,
+  // and make sure no worker takes this loop after the function goes away.
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_cond_.wait(lock, [this] { return !busy_workers_; });
+  function_ = nullptr;
+}
+
+void WorkerPool::WorkerThreadMain() {
+  uint64_t last_loop_index = 0;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    work_cond_.wait(lock, [&] {
+      return shutdown_ || (function_ && loop_index_ != last_loop_index);
+    });
+    if (shutdown_) {
+      return;
+    }
+    last_loop_index = loop_index_;
+    ++busy_workers_;
+    lock.unlock();
+    ProcessItems();
+    lock.lock();
+    if (!--busy_workers_) {
+      idle_cond_.notify_all();
+    }
+  }
+}
+
+void WorkerPool::ProcessItems() {
+  // function_ and item_count_ are stable while there are busy workers or the
+  // submitting thread is processing.
+  const ItemFunction& function = *function_;
+  uint32_t item_count = item_count_;
+  uint32_t item;
+  while ((item = next_item_.fetch_add(1, std::memory_order_relaxed)) <
+         item_count) {
+    function(item);
+  }
+}
+
+}  // namespace xe
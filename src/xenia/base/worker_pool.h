@@ -0,0 +1,72 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#ifndef XENIA_BASE_WORKER_POOL_H_
+#define XENIA_BASE_WORKER_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "xenia/base/threading.h"
+
+namespace xe {
+
+// Fixed set of threads for splitting a CPU-heavy loop into independent
+// items. The submitting thread processes items too, so a pool without worker
+// threads simply runs the loop serially.
+class WorkerPool {
+ public:
+  using ItemFunction = std::function<void(uint32_t item)>;
+
+  // Creates thread_count worker threads named "<name> <n>".
+  WorkerPool(uint32_t thread_count, const std::string_view name);
+  ~WorkerPool();
+
+  uint32_t thread_count() const { return uint32_t(threads_.size()); }
+
+  // Invokes function for every item in [0, item_count) in an unspecified
+  // order and on unspecified threads, and returns once all have finished.
+  // Calls from multiple threads are serialized.
+  void ParallelFor(uint32_t item_count, const ItemFunction& function);
+
+ private:
+  void WorkerThreadMain();
+  void ProcessItems();
+
+  std::vector<std::unique_ptr<xe::threading::Thread>> threads_;
+
+  // Held for the whole ParallelFor call.
+  std::mutex submit_mutex_;
+
+  std::mutex mutex_;
+  // Notified when a loop is submitted or on shutdown.
+  std::condition_variable work_cond_;
+  // Notified when a worker leaves the current loop.
+  std::condition_variable idle_cond_;
+  // Protected with mutex_.
+  bool shutdown_ = false;
+  const ItemFunction* function_ = nullptr;
+  uint32_t item_count_ = 0;
+  uint64_t loop_index_ = 0;
+  // Workers that have taken the current loop and not left it yet.
+  uint32_t busy_workers_ = 0;
+
+  std::atomic<uint32_t> next_item_ = 0;
+};
+
+}  // namespace xe
+
+#endif  // XENIA_BASE_WORKER_POOL_H_
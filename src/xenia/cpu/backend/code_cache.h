@@ -20,6 +20,18 @@ namespace xe {
 namespace cpu {
 namespace backend {
 
+// Stack frame layout of a function in the code cache, returned by
+// LookupUnwindInfo on hosts where generated code isn't described to the OS
+// unwinder. The whole frame is allocated by a single stack pointer adjustment
+// in the prolog, with the return address right above it.
+struct CodeUnwindInfo {
+  uintptr_t code_address;
+  uint32_t code_size;
+  // Offset of the instruction after the stack allocation.
+  uint32_t prolog_stack_alloc_offset;
+  uint32_t stack_size;
+};
+
 class CodeCache {
  public:
   CodeCache() = default;
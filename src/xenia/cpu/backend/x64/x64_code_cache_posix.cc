@@ -9,6 +9,12 @@
 
 #include "xenia/cpu/backend/x64/x64_code_cache.h"
 
+#include <atomic>
+#include <cstdlib>
+#include <vector>
+
+#include "xenia/base/assert.h"
+
 namespace xe {
 namespace cpu {
 namespace backend {
@@ -21,19 +27,20 @@ class PosixX64CodeCache : public X64CodeCache {
 
   bool Initialize() override;
 
-  void* LookupUnwindInfo(uint64_t host_pc) override { return nullptr; }
+  void* LookupUnwindInfo(uint64_t host_pc) override;
 
  private:
-  /*
   UnwindReservation RequestUnwindReservation(uint8_t* entry_address) override;
-  void PlaceCode(uint32_t guest_address, void* machine_code, size_t code_size,
-                 size_t stack_size, void* code_execute_address,
+  void PlaceCode(uint32_t guest_address, void* machine_code,
+                 const EmitFunctionInfo& func_info, void* code_execute_address,
                  UnwindReservation unwind_reservation) override;
 
-  void InitializeUnwindEntry(uint8_t* unwind_entry_address,
-                             size_t unwind_table_slot, void* code_address,
-                             size_t code_size, size_t stack_size);
-  */
+  // Frame layouts for the stack walker, sorted by code address as code is
+  // placed in order. Reserved up front so it's never reallocated and can be
+  // searched without locking, including from signal handlers.
+  std::vector<CodeUnwindInfo> unwind_table_;
+  // Number of entries that are fully written and may be searched.
+  std::atomic<uint32_t> unwind_table_count_ = {0};
 };
 
 std::unique_ptr<X64CodeCache> X64CodeCache::Create() {
@@ -43,7 +50,59 @@ std::unique_ptr<X64CodeCache> X64CodeCache::Create() {
 PosixX64CodeCache::PosixX64CodeCache() = default;
 PosixX64CodeCache::~PosixX64CodeCache() = default;
 
-bool PosixX64CodeCache::Initialize() { return X64CodeCache::Initialize(); }
+bool PosixX64CodeCache::Initialize() {
+  if (!X64CodeCache::Initialize()) {
+    return false;
+  }
+  unwind_table_.reserve(kMaximumFunctionCount);
+  return true;
+}
+
+PosixX64CodeCache::UnwindReservation
+PosixX64CodeCache::RequestUnwindReservation(uint8_t* entry_address) {
+  assert_false(unwind_table_.size() >= kMaximumFunctionCount);
+  // The frame layout is kept in the table rather than next to the code.
+  UnwindReservation unwind_reservation;
+  unwind_reservation.table_slot = unwind_table_.size();
+  unwind_reservation.entry_address = entry_address;
+  return unwind_reservation;
+}
+
+void PosixX64CodeCache::PlaceCode(uint32_t guest_address, void* machine_code,
+                                  const EmitFunctionInfo& func_info,
+                                  void* code_execute_address,
+                                  UnwindReservation unwind_reservation) {
+  // Called with the global lock held, in the order the code is placed.
+  if (unwind_reservation.table_slot >= kMaximumFunctionCount) {
+    return;
+  }
+  CodeUnwindInfo unwind_info;
+  unwind_info.code_address = reinterpret_cast<uintptr_t>(code_execute_address);
+  unwind_info.code_size = uint32_t(func_info.code_size.total);
+  unwind_info.prolog_stack_alloc_offset =
+      uint32_t(func_info.prolog_stack_alloc_offset);
+  unwind_info.stack_size = uint32_t(func_info.stack_size);
+  unwind_table_.push_back(unwind_info);
+  unwind_table_count_.store(uint32_t(unwind_table_.size()),
+                            std::memory_order_release);
+}
+
+void* PosixX64CodeCache::LookupUnwindInfo(uint64_t host_pc) {
+  uint32_t count = unwind_table_count_.load(std::memory_order_acquire);
+  return std::bsearch(
+      &host_pc, unwind_table_.data(), count, sizeof(CodeUnwindInfo),
+      [](const void* key_ptr, const void* element_ptr) {
+        auto key = *reinterpret_cast<const uint64_t*>(key_ptr);
+        auto element = reinterpret_cast<const CodeUnwindInfo*>(element_ptr);
+        if (key < element->code_address) {
+          return -1;
+        } else if (key >= element->code_address + element->code_size) {
+          return 1;
+        } else {
+          return 0;
+        }
+      });
+}
 
 }  // namespace x64
 }  // namespace backend
@@ -128,6 +128,11 @@ class ExportResolver {
     const std::vector<Export*>& exports_by_name() const {
       return exports_by_name_;
     }
+    Export* GetExportByOrdinal(uint16_t ordinal) const {
+      return ordinal < exports_by_ordinal_->size()
+                 ? (*exports_by_ordinal_)[ordinal]
+                 : nullptr;
+    }
 
    private:
     std::string module_name_;
@@ -145,6 +150,8 @@ class ExportResolver {
     return all_exports_by_name_;
   }
 
+  // Finds the table once for resolving many imports from one module.
+  const Table* GetTable(const std::string_view module_name) const;
   Export* GetExportByOrdinal(const std::string_view module_name,
                              uint16_t ordinal);
 
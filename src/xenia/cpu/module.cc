@@ -101,6 +101,47 @@ Symbol::Status Module::DeclareSymbol(Symbol::Type type, uint32_t address,
   return status;
 }
 
+void Module::DeclareSymbols(Symbol::Type type, const uint32_t* addresses,
+                            size_t count, Symbol** out_symbols) {
+  // Symbols still being declared elsewhere need to be waited for one by one.
+  std::vector<size_t> declaring_indices;
+  {
+    auto global_lock = global_critical_region_.Acquire();
+    map_.reserve(map_.size() + count);
+    list_.reserve(list_.size() + count);
+    for (size_t i = 0; i < count; ++i) {
+      uint32_t address = addresses[i];
+      auto it = map_.find(address);
+      Symbol* symbol = it != map_.end() ? it->second : nullptr;
+      if (symbol) {
+        if (symbol->type() != type) {
+          symbol = nullptr;
+        } else if (symbol->status() == Symbol::Status::kDeclaring) {
+          declaring_indices.push_back(i);
+        }
+      } else {
+        switch (type) {
+          case Symbol::Type::kFunction:
+            symbol = CreateFunction(address).release();
+            break;
+          case Symbol::Type::kVariable:
+            symbol = new Symbol(Symbol::Type::kVariable, this, address);
+            break;
+        }
+        map_[address] = symbol;
+        list_.emplace_back(symbol);
+      }
+      out_symbols[i] = symbol;
+    }
+  }
+  for (size_t i : declaring_indices) {
+    if (DeclareSymbol(type, addresses[i], &out_symbols[i]) ==
+        Symbol::Status::kFailed) {
+      out_symbols[i] = nullptr;
+    }
+  }
+}
+
 Symbol::Status Module::DeclareFunction(uint32_t address,
                                        Function** out_function) {
   Symbol* symbol;
@@ -42,6 +42,11 @@ class Module {
   virtual Symbol::Status DeclareFunction(uint32_t address,
                                          Function** out_function);
   virtual Symbol::Status DeclareVariable(uint32_t address, Symbol** out_symbol);
+  // Declares symbols of one type at many addresses, such as import thunks,
+  // taking the lock once. Symbols that already exist with a different type are
+  // returned as null.
+  void DeclareSymbols(Symbol::Type type, const uint32_t* addresses,
+                      size_t count, Symbol** out_symbols);
 
   Symbol::Status DefineFunction(Function* symbol);
   Symbol::Status DefineVariable(Symbol* symbol);
@@ -20,6 +20,39 @@ project("xenia-cpu")
   local_platform_files("compiler/passes")
   local_platform_files("hir")
   local_platform_files("ppc")
+  removefiles({"xex_analyze_main.cc"})
+
+if enableMiscSubprojects then
+  project("xenia-cpu-analyze")
+    uuid("6b0e5a3c-8f4d-4e39-9d7a-2c51f0b8e7d4")
+    kind("ConsoleApp")
+    language("C++")
+    links({
+      "capstone", -- cpu-backend-x64
+      "fmt",
+      "imgui",
+      "mspack",
+      "xenia-base",
+      "xenia-core",
+      "xenia-cpu",
+      "xenia-gpu",
+      "xenia-hid-skylander",
+      "xenia-kernel",
+      "xenia-patcher",
+      "xenia-vfs",
+    })
+    files({
+      "xex_analyze_main.cc",
+      project_root.."/src/xenia/base/console_app_main_"..platform_suffix..".cc",
+    })
+    resincludedirs({
+      project_root,
+    })
+    filter("architecture:x86_64")
+      links({
+        "xenia-cpu-backend-x64",
+      })
+end
 
 if enableTests then
   include("testing")
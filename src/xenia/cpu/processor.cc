@@ -28,6 +28,7 @@
 #include "xenia/cpu/module.h"
 #include "xenia/cpu/ppc/ppc_decode_data.h"
 #include "xenia/cpu/ppc/ppc_frontend.h"
+#include "xenia/cpu/sampling_profiler.h"
 #include "xenia/cpu/stack_walker.h"
 #include "xenia/cpu/thread.h"
 #include "xenia/cpu/thread_state.h"
@@ -48,6 +49,15 @@ DEFINE_path(trace_function_data_path, "", "File to write trace data to.",
             "CPU");
 DEFINE_bool(break_on_start, false, "Break into the debugger on startup.",
             "CPU");
+DEFINE_path(sampling_profiler_path, "",
+            "File to write stacks of guest threads sampled while running to, "
+            "in the folded format of flamegraph.pl and speedscope. Not "
+            "supported on Windows.",
+            "CPU");
+DEFINE_uint32(sampling_profiler_interval_us, 1000,
+              "CPU time of a guest thread between samples taken by the "
+              "sampling profiler, in microseconds.",
+              "CPU");
 
 namespace xe {
 namespace kernel {
@@ -86,6 +96,9 @@ Processor::Processor(xe::Memory* memory, ExportResolver* export_resolver)
     : memory_(memory), export_resolver_(export_resolver) {}
 
 Processor::~Processor() {
+  // Resolving the last samples needs the functions and the code cache.
+  sampling_profiler_.reset();
+
   {
     auto global_lock = global_critical_region_.Acquire();
     modules_.clear();
@@ -147,6 +160,16 @@ bool Processor::Setup(std::unique_ptr<backend::Backend> backend) {
     }
   }
 
+  if (!cvars::sampling_profiler_path.empty()) {
+    if (stack_walker_) {
+      sampling_profiler_ = SamplingProfiler::Create(
+          stack_walker_.get(), cvars::sampling_profiler_path,
+          cvars::sampling_profiler_interval_us);
+    } else {
+      XELOGW("Sampling profiler unavailable due to lack of stack walker");
+    }
+  }
+
   // Open the trace data path, if requested.
   functions_trace_path_ = cvars::trace_function_data_path;
   if (!functions_trace_path_.empty()) {
@@ -490,7 +513,16 @@ void Processor::OnThreadCreated(uint32_t thread_handle,
   thread_debug_infos_.emplace(thread_info->thread_id, std::move(thread_info));
 }
 
+void Processor::OnThreadExecute(uint32_t thread_id, const std::string& name) {
+  if (sampling_profiler_) {
+    sampling_profiler_->RegisterCurrentThread(thread_id, name);
+  }
+}
+
 void Processor::OnThreadExit(uint32_t thread_id) {
+  if (sampling_profiler_) {
+    sampling_profiler_->UnregisterThread(thread_id);
+  }
   auto global_lock = global_critical_region_.Acquire();
   auto it = thread_debug_infos_.find(thread_id);
   assert_true(it != thread_debug_infos_.end());
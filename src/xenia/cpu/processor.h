@@ -37,6 +37,7 @@ namespace cpu {
 constexpr fourcc_t kProcessorSaveSignature = make_fourcc("PROC");
 
 class Breakpoint;
+class SamplingProfiler;
 class StackWalker;
 class XexModule;
 
@@ -201,6 +202,8 @@ class Processor {
   // TODO(benvanik): hide.
   void OnThreadCreated(uint32_t handle, ThreadState* thread_state,
                        Thread* thread);
+  // Called on the thread itself before it starts running guest code.
+  void OnThreadExecute(uint32_t thread_id, const std::string& name);
   void OnThreadExit(uint32_t thread_id);
   void OnThreadDestroyed(uint32_t thread_id);
   void OnThreadEnteringWait(uint32_t thread_id);
@@ -251,6 +254,7 @@ class Processor {
 
   Memory* memory_ = nullptr;
   std::unique_ptr<StackWalker> stack_walker_;
+  std::unique_ptr<SamplingProfiler> sampling_profiler_;
 
   std::function<DebugListener*(Processor*)> debug_listener_handler_;
   DebugListener* debug_listener_ = nullptr;
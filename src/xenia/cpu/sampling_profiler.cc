@@ -0,0 +1,206 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/cpu/sampling_profiler.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "third_party/fmt/include/fmt/format.h"
+#include "xenia/base/assert.h"
+#include "xenia/base/filesystem.h"
+#include "xenia/base/logging.h"
+#include "xenia/base/scheduling_policy.h"
+
+namespace xe {
+namespace cpu {
+
+// How often the folded stacks are rewritten, so they're available even if the
+// emulator doesn't shut down cleanly.
+constexpr uint32_t kWriteIntervalCollections = 100;
+
+SamplingProfiler::Sample* SamplingProfiler::ThreadSamples::BeginWrite() {
+  // Paired with the collector checking writing after retired, so either the
+  // collector sees the write in progress, or the writer sees the retirement.
+  writing.store(true, std::memory_order_seq_cst);
+  if (retired.load(std::memory_order_seq_cst)) {
+    writing.store(false, std::memory_order_release);
+    return nullptr;
+  }
+  uint32_t write = write_index.load(std::memory_order_relaxed);
+  if (write - read_index.load(std::memory_order_acquire) >= kCapacity) {
+    dropped_count.fetch_add(1, std::memory_order_relaxed);
+    writing.store(false, std::memory_order_release);
+    return nullptr;
+  }
+  return &samples[write % kCapacity];
+}
+
+void SamplingProfiler::ThreadSamples::EndWrite() {
+  write_index.fetch_add(1, std::memory_order_release);
+  writing.store(false, std::memory_order_release);
+}
+
+SamplingProfiler::SamplingProfiler(StackWalker* stack_walker,
+                                   const std::filesystem::path& output_path)
+    : stack_walker_(stack_walker), output_path_(output_path) {}
+
+SamplingProfiler::~SamplingProfiler() = default;
+
+SamplingProfiler::ThreadSamples* SamplingProfiler::AddThread(
+    uint32_t thread_id, const std::string& name) {
+  auto samples = std::make_unique<ThreadSamples>();
+  samples->samples = std::make_unique<Sample[]>(ThreadSamples::kCapacity);
+  // The thread is the root frame, with the name sanitized for the format.
+  samples->label = fmt::format("{} ({:08X})", name, thread_id);
+  std::replace(samples->label.begin(), samples->label.end(), ';', '_');
+  ThreadSamples* samples_ptr = samples.get();
+  std::lock_guard<std::mutex> lock(threads_mutex_);
+  threads_.push_back(std::move(samples));
+  return samples_ptr;
+}
+
+void SamplingProfiler::RetireThread(ThreadSamples* samples) {
+  samples->retired.store(true, std::memory_order_seq_cst);
+}
+
+void SamplingProfiler::StartCollector() {
+  collector_shutdown_event_ =
+      xe::threading::Event::CreateManualResetEvent(false);
+  collector_thread_ = xe::threading::Thread::Create(
+      {}, [this]() { CollectorThreadMain(); });
+  assert_not_null(collector_thread_);
+  collector_thread_->set_name("Sampling Profiler");
+  xe::threading::SchedulingPolicy::RegisterServiceThread(
+      collector_thread_.get());
+}
+
+void SamplingProfiler::StopCollector() {
+  if (!collector_thread_) {
+    return;
+  }
+  collector_shutdown_event_->Set();
+  xe::threading::Wait(collector_thread_.get(), false);
+  xe::threading::SchedulingPolicy::UnregisterServiceThread(
+      collector_thread_.get());
+  collector_thread_.reset();
+  Collect();
+  WriteFoldedStacks();
+}
+
+void SamplingProfiler::CollectorThreadMain() {
+  uint32_t collection_count = 0;
+  while (xe::threading::Wait(collector_shutdown_event_.get(), false,
+                             std::chrono::milliseconds(50)) ==
+         xe::threading::WaitResult::kTimeout) {
+    Collect();
+    if (++collection_count % kWriteIntervalCollections == 0) {
+      WriteFoldedStacks();
+    }
+  }
+}
+
+void SamplingProfiler::Collect() {
+  std::vector<ThreadSamples*> threads;
+  {
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    threads.reserve(threads_.size());
+    for (auto& thread : threads_) {
+      threads.push_back(thread.get());
+    }
+  }
+  StackFrame frames[kMaxFrameCount];
+  std::string stack;
+  for (ThreadSamples* thread : threads) {
+    if (!thread->samples) {
+      continue;
+    }
+    // Checked before draining, so samples written before the retirement are
+    // still collected when the ring is released.
+    bool released = thread->retired.load(std::memory_order_seq_cst) &&
+                    !thread->writing.load(std::memory_order_seq_cst);
+    uint32_t read = thread->read_index.load(std::memory_order_relaxed);
+    uint32_t write = thread->write_index.load(std::memory_order_acquire);
+    for (; read != write; ++read) {
+      Sample& sample = thread->samples[read % ThreadSamples::kCapacity];
+      size_t frame_count = std::min(sample.frame_count, kMaxFrameCount);
+      stack_walker_->ResolveStack(sample.frame_host_pcs, frames, frame_count);
+      // Outermost frame first.
+      stack = thread->label;
+      const std::string* previous_name = nullptr;
+      for (size_t i = frame_count; i-- > 0;) {
+        const std::string& name = GetFrameName(frames[i]);
+        // Consecutive unknown host frames are merged.
+        if (previous_name && *previous_name == name &&
+            frames[i].type == StackFrame::Type::kHost) {
+          continue;
+        }
+        stack += ';';
+        stack += name;
+        previous_name = &name;
+      }
+      ++folded_stacks_[stack];
+      ++sample_count_;
+    }
+    thread->read_index.store(read, std::memory_order_release);
+    if (released) {
+      thread->samples.reset();
+    }
+  }
+}
+
+const std::string& SamplingProfiler::GetFrameName(const StackFrame& frame) {
+  auto it = frame_names_.find(frame.host_pc);
+  if (it != frame_names_.end()) {
+    return it->second;
+  }
+  std::string name;
+  if (frame.type == StackFrame::Type::kGuest) {
+    Function* function = frame.guest_symbol.function;
+    if (!function) {
+      name = "[generated code]";
+    } else if (!function->name().empty()) {
+      name = function->name();
+    } else {
+      name = fmt::format("sub_{:08X}", function->address());
+    }
+  } else {
+    name = frame.host_symbol.name[0] ? std::string(frame.host_symbol.name)
+                                     : std::string("[host]");
+  }
+  std::replace(name.begin(), name.end(), ';', '_');
+  return frame_names_.emplace(frame.host_pc, std::move(name)).first->second;
+}
+
+void SamplingProfiler::WriteFoldedStacks() {
+  xe::filesystem::CreateParentFolder(output_path_);
+  FILE* file = xe::filesystem::OpenFile(output_path_, "wb");
+  if (!file) {
+    XELOGE("Sampling profiler: failed to open {} for writing",
+           xe::path_to_utf8(output_path_));
+    return;
+  }
+  for (const auto& folded_stack : folded_stacks_) {
+    fmt::print(file, "{} {}\n", folded_stack.first, folded_stack.second);
+  }
+  fclose(file);
+
+  uint64_t dropped_count = 0;
+  {
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    for (auto& thread : threads_) {
+      dropped_count += thread->dropped_count.load(std::memory_order_relaxed);
+    }
+  }
+  XELOGI("Sampling profiler: wrote {} samples ({} dropped) to {}",
+         sample_count_, dropped_count, xe::path_to_utf8(output_path_));
+}
+
+}  // namespace cpu
+}  // namespace xe
@@ -0,0 +1,121 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#ifndef XENIA_CPU_SAMPLING_PROFILER_H_
+#define XENIA_CPU_SAMPLING_PROFILER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "xenia/base/threading.h"
+#include "xenia/cpu/stack_walker.h"
+
+namespace xe {
+namespace cpu {
+
+// Periodically interrupts the threads running guest code and captures their
+// stacks, including the JIT frames, then writes how often each stack was seen
+// per guest thread in the folded format of flamegraph.pl and speedscope.
+// Only the CPU time of the threads is sampled, so waiting isn't counted.
+class SamplingProfiler {
+ public:
+  // Deeper stacks are truncated at the outermost frames.
+  static constexpr size_t kMaxFrameCount = 64;
+
+  // Returns nullptr if sampling is not supported on the host.
+  static std::unique_ptr<SamplingProfiler> Create(
+      StackWalker* stack_walker, const std::filesystem::path& output_path,
+      uint32_t interval_us);
+
+  virtual ~SamplingProfiler();
+
+  // Starts sampling the calling thread, must be called on it.
+  virtual void RegisterCurrentThread(uint32_t thread_id,
+                                     const std::string& name) = 0;
+  // Stops sampling the thread, may be called from any thread.
+  virtual void UnregisterThread(uint32_t thread_id) = 0;
+
+ protected:
+  struct Sample {
+    size_t frame_count;
+    uint64_t frame_host_pcs[kMaxFrameCount];
+  };
+
+  // Samples of one thread, produced by the signal handler (or whatever
+  // interrupts the thread) and consumed by the collector thread. The ring is
+  // released by the collector once the thread is retired and its samples are
+  // drained, but the rest is kept while the profiler exists, as the handler
+  // may still run on the thread after it's unregistered.
+  struct ThreadSamples {
+    static constexpr uint32_t kCapacity = 256;
+
+    std::string label;
+    std::unique_ptr<Sample[]> samples;
+    std::atomic<uint32_t> write_index = {0};
+    std::atomic<uint32_t> read_index = {0};
+    std::atomic<uint64_t> dropped_count = {0};
+    // Set when no more samples may be written.
+    std::atomic<bool> retired = {false};
+    // Set while a sample is being written, so the ring isn't released under
+    // the writer.
+    std::atomic<bool> writing = {false};
+
+    // Takes a slot to write a sample to, or returns nullptr if full or
+    // retired. EndWrite must be called if a slot is returned.
+    Sample* BeginWrite();
+    void EndWrite();
+  };
+
+  SamplingProfiler(StackWalker* stack_walker,
+                   const std::filesystem::path& output_path);
+
+  // Creates the samples of a newly registered thread.
+  ThreadSamples* AddThread(uint32_t thread_id, const std::string& name);
+  // Stops accepting samples of an unregistered thread, with the ones already
+  // taken still collected.
+  static void RetireThread(ThreadSamples* samples);
+
+  // Starts the thread aggregating and periodically writing the samples.
+  void StartCollector();
+  // Stops the collector thread and writes the final results.
+  void StopCollector();
+
+  StackWalker* stack_walker_;
+
+ private:
+  void CollectorThreadMain();
+  void Collect();
+  void WriteFoldedStacks();
+  const std::string& GetFrameName(const StackFrame& frame);
+
+  std::filesystem::path output_path_;
+
+  std::mutex threads_mutex_;
+  std::vector<std::unique_ptr<ThreadSamples>> threads_;
+
+  // Only accessed by the collector thread.
+  std::map<std::string, uint64_t> folded_stacks_;
+  std::unordered_map<uint64_t, std::string> frame_names_;
+  uint64_t sample_count_ = 0;
+
+  std::unique_ptr<xe::threading::Event> collector_shutdown_event_;
+  std::unique_ptr<xe::threading::Thread> collector_thread_;
+};
+
+}  // namespace cpu
+}  // namespace xe
+
+#endif  // XENIA_CPU_SAMPLING_PROFILER_H_
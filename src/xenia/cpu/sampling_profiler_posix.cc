@@ -0,0 +1,204 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/cpu/sampling_profiler.h"
+
+#include <signal.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+
+#include "xenia/base/host_thread_context.h"
+#include "xenia/base/logging.h"
+#include "xenia/base/platform.h"
+
+// Older glibc only has the union member.
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+namespace xe {
+namespace cpu {
+
+#if XE_ARCH_AMD64
+
+class PosixSamplingProfiler : public SamplingProfiler {
+ public:
+  PosixSamplingProfiler(StackWalker* stack_walker,
+                        const std::filesystem::path& output_path,
+                        uint32_t interval_us)
+      : SamplingProfiler(stack_walker, output_path),
+        interval_us_(interval_us) {}
+  ~PosixSamplingProfiler() override;
+
+  bool Initialize();
+
+  void RegisterCurrentThread(uint32_t thread_id,
+                             const std::string& name) override;
+  void UnregisterThread(uint32_t thread_id) override;
+
+ private:
+  static void SignalHandler(int signal, siginfo_t* info, void* context);
+
+  // The profiler the handler writes to, as there may only be one.
+  static std::atomic<PosixSamplingProfiler*> active_profiler_;
+  static thread_local ThreadSamples* current_thread_samples_;
+
+  struct RegisteredThread {
+    ThreadSamples* samples;
+    timer_t timer;
+  };
+
+  uint32_t interval_us_;
+  std::mutex registered_threads_mutex_;
+  std::unordered_map<uint32_t, RegisteredThread> registered_threads_;
+};
+
+std::atomic<PosixSamplingProfiler*> PosixSamplingProfiler::active_profiler_ = {
+    nullptr};
+thread_local SamplingProfiler::ThreadSamples*
+    PosixSamplingProfiler::current_thread_samples_ = nullptr;
+
+bool PosixSamplingProfiler::Initialize() {
+  PosixSamplingProfiler* expected = nullptr;
+  if (!active_profiler_.compare_exchange_strong(expected, this)) {
+    XELOGE("Sampling profiler: only one may be active at a time");
+    return false;
+  }
+  struct sigaction action = {};
+  action.sa_sigaction = SignalHandler;
+  action.sa_flags = SA_SIGINFO | SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  if (sigaction(SIGPROF, &action, nullptr)) {
+    XELOGE("Sampling profiler: failed to install the SIGPROF handler");
+    active_profiler_.store(nullptr, std::memory_order_release);
+    return false;
+  }
+  StartCollector();
+  return true;
+}
+
+PosixSamplingProfiler::~PosixSamplingProfiler() {
+  {
+    std::lock_guard<std::mutex> lock(registered_threads_mutex_);
+    for (auto& registered_thread : registered_threads_) {
+      timer_delete(registered_thread.second.timer);
+    }
+    registered_threads_.clear();
+  }
+  StopCollector();
+  // Signals that are already pending are ignored from now on. The handler is
+  // left installed so they don't terminate the process.
+  PosixSamplingProfiler* expected = this;
+  active_profiler_.compare_exchange_strong(expected, nullptr);
+}
+
+void PosixSamplingProfiler::RegisterCurrentThread(uint32_t thread_id,
+                                                  const std::string& name) {
+  stack_walker_->PrepareCurrentThread();
+  ThreadSamples* samples = AddThread(thread_id, name);
+  current_thread_samples_ = samples;
+
+  // Counting the CPU time of the thread, and delivered to it specifically.
+  sigevent event = {};
+  event.sigev_notify = SIGEV_THREAD_ID;
+  event.sigev_signo = SIGPROF;
+  event.sigev_notify_thread_id = pid_t(syscall(SYS_gettid));
+  timer_t timer;
+  if (timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &timer)) {
+    XELOGW("Sampling profiler: failed to create a timer for thread {:08X}",
+           thread_id);
+    current_thread_samples_ = nullptr;
+    RetireThread(samples);
+    return;
+  }
+  itimerspec interval = {};
+  interval.it_interval.tv_sec = interval_us_ / 1000000;
+  interval.it_interval.tv_nsec = (interval_us_ % 1000000) * 1000;
+  interval.it_value = interval.it_interval;
+  timer_settime(timer, 0, &interval, nullptr);
+
+  std::lock_guard<std::mutex> lock(registered_threads_mutex_);
+  auto it = registered_threads_.find(thread_id);
+  if (it != registered_threads_.end()) {
+    timer_delete(it->second.timer);
+    RetireThread(it->second.samples);
+    it->second = {samples, timer};
+  } else {
+    registered_threads_.emplace(thread_id, RegisteredThread{samples, timer});
+  }
+}
+
+void PosixSamplingProfiler::UnregisterThread(uint32_t thread_id) {
+  std::lock_guard<std::mutex> lock(registered_threads_mutex_);
+  auto it = registered_threads_.find(thread_id);
+  if (it == registered_threads_.end()) {
+    return;
+  }
+  timer_delete(it->second.timer);
+  // A signal that is already pending may still arrive, and is then ignored.
+  RetireThread(it->second.samples);
+  registered_threads_.erase(it);
+}
+
+void PosixSamplingProfiler::SignalHandler(int signal, siginfo_t* info,
+                                          void* context) {
+  // Must be async-signal-safe - no locking or allocation.
+  PosixSamplingProfiler* profiler =
+      active_profiler_.load(std::memory_order_acquire);
+  ThreadSamples* samples = current_thread_samples_;
+  if (!profiler || !samples) {
+    return;
+  }
+  Sample* sample = samples->BeginWrite();
+  if (!sample) {
+    return;
+  }
+  int saved_errno = errno;
+  const mcontext_t& mcontext =
+      reinterpret_cast<const ucontext_t*>(context)->uc_mcontext;
+  HostThreadContext thread_context;
+  thread_context.rip = uint64_t(mcontext.gregs[REG_RIP]);
+  thread_context.rsp = uint64_t(mcontext.gregs[REG_RSP]);
+  thread_context.rbp = uint64_t(mcontext.gregs[REG_RBP]);
+  sample->frame_count = profiler->stack_walker_->CaptureStackTrace(
+      nullptr, sample->frame_host_pcs, 0, kMaxFrameCount, &thread_context,
+      nullptr);
+  samples->EndWrite();
+  errno = saved_errno;
+}
+
+std::unique_ptr<SamplingProfiler> SamplingProfiler::Create(
+    StackWalker* stack_walker, const std::filesystem::path& output_path,
+    uint32_t interval_us) {
+  auto profiler = std::make_unique<PosixSamplingProfiler>(
+      stack_walker, output_path, std::max(interval_us, uint32_t(100)));
+  if (!profiler->Initialize()) {
+    return nullptr;
+  }
+  return profiler;
+}
+
+#else
+
+std::unique_ptr<SamplingProfiler> SamplingProfiler::Create(
+    StackWalker* stack_walker, const std::filesystem::path& output_path,
+    uint32_t interval_us) {
+  XELOGW("Sampling profiler unimplemented on this architecture");
+  return nullptr;
+}
+
+#endif  // XE_ARCH_AMD64
+
+}  // namespace cpu
+}  // namespace xe
@@ -0,0 +1,25 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/cpu/sampling_profiler.h"
+
+#include "xenia/base/logging.h"
+
+namespace xe {
+namespace cpu {
+
+std::unique_ptr<SamplingProfiler> SamplingProfiler::Create(
+    StackWalker* stack_walker, const std::filesystem::path& output_path,
+    uint32_t interval_us) {
+  XELOGW("Sampling profiler not supported on Windows");
+  return nullptr;
+}
+
+}  // namespace cpu
+}  // namespace xe
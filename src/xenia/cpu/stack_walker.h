@@ -64,6 +64,10 @@ class StackWalker {
   // Dumps all thread stacks to the log.
   void Dump();
 
+  // Prepares the calling thread for its stack to be captured from within a
+  // signal handler later, where not everything about it can be queried.
+  virtual void PrepareCurrentThread() {}
+
   // Captures up to the given number of stack frames from the current thread.
   // Use ResolveStackTrace to populate additional information.
   // Returns the number of frames captured, or 0 if an error occurred.
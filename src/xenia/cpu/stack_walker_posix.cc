@@ -9,16 +9,313 @@
 
 #include "xenia/cpu/stack_walker.h"
 
+#include <dlfcn.h>
+#include <pthread.h>
+#include <unwind.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
 #include "xenia/base/logging.h"
+#include "xenia/base/math.h"
+#include "xenia/base/platform.h"
+#include "xenia/base/xxhash.h"
+#include "xenia/cpu/backend/code_cache.h"
 
 namespace xe {
 namespace cpu {
 
+#if XE_ARCH_AMD64
+
+// Bounds of the stack of the current thread, queried outside signal handlers
+// since pthread_getattr_np isn't async-signal-safe.
+struct StackBounds {
+  uintptr_t low = 0;
+  uintptr_t high = 0;
+};
+static thread_local StackBounds current_stack_bounds_;
+
+static const StackBounds& QueryCurrentStackBounds() {
+  if (!current_stack_bounds_.high) {
+    pthread_attr_t attr;
+    if (!pthread_getattr_np(pthread_self(), &attr)) {
+      void* stack_addr;
+      size_t stack_size;
+      if (!pthread_attr_getstack(&attr, &stack_addr, &stack_size)) {
+        current_stack_bounds_.low = reinterpret_cast<uintptr_t>(stack_addr);
+        current_stack_bounds_.high = current_stack_bounds_.low + stack_size;
+      }
+      pthread_attr_destroy(&attr);
+    }
+  }
+  return current_stack_bounds_;
+}
+
+class PosixStackWalker : public StackWalker {
+ public:
+  explicit PosixStackWalker(backend::CodeCache* code_cache)
+      : code_cache_(code_cache) {
+    code_cache_min_ = code_cache_->execute_base_address();
+    code_cache_max_ = code_cache_min_ + code_cache_->total_size();
+  }
+
+  void PrepareCurrentThread() override { QueryCurrentStackBounds(); }
+
+  size_t CaptureStackTrace(uint64_t* frame_host_pcs, size_t frame_offset,
+                           size_t frame_count,
+                           uint64_t* out_stack_hash) override {
+    // Host frames are described by the .eh_frame of the emulator and the
+    // libraries, but generated code isn't known to the unwinder, so it stops
+    // at the first frame in the code cache, which is then walked using the
+    // frame layouts recorded by the code cache.
+    struct UnwindState {
+      PosixStackWalker* walker;
+      uint64_t* frame_host_pcs;
+      size_t frame_offset;
+      size_t frame_count;
+      size_t frame_index;
+      uint64_t generated_pc;
+      uint64_t generated_sp;
+    } state = {this, frame_host_pcs, frame_offset + 1, frame_count, 0, 0, 0};
+    _Unwind_Backtrace(
+        [](_Unwind_Context* context, void* state_ptr) -> _Unwind_Reason_Code {
+          auto& state = *reinterpret_cast<UnwindState*>(state_ptr);
+          uint64_t pc = _Unwind_GetIP(context);
+          if (!pc) {
+            return _URC_END_OF_STACK;
+          }
+          if (state.walker->IsInCodeCache(pc)) {
+            state.generated_pc = pc;
+            state.generated_sp = _Unwind_GetCFA(context);
+            return _URC_END_OF_STACK;
+          }
+          if (state.frame_index >= state.frame_offset + state.frame_count) {
+            return _URC_END_OF_STACK;
+          }
+          if (state.frame_index >= state.frame_offset) {
+            state.frame_host_pcs[state.frame_index - state.frame_offset] = pc;
+          }
+          ++state.frame_index;
+          return _URC_NO_REASON;
+        },
+        &state);
+
+    size_t captured_count = state.frame_index > state.frame_offset
+                                ? state.frame_index - state.frame_offset
+                                : 0;
+    if (state.generated_pc) {
+      size_t skip_count = state.frame_offset > state.frame_index
+                              ? state.frame_offset - state.frame_index
+                              : 0;
+      captured_count += WalkStack(
+          state.generated_pc, state.generated_sp, QueryCurrentStackBounds(),
+          frame_host_pcs + captured_count, skip_count,
+          frame_count - captured_count);
+    }
+    if (out_stack_hash) {
+      *out_stack_hash =
+          XXH3_64bits(frame_host_pcs, captured_count * sizeof(uint64_t));
+    }
+    return captured_count;
+  }
+
+  size_t CaptureStackTrace(void* thread_handle, uint64_t* frame_host_pcs,
+                           size_t frame_offset, size_t frame_count,
+                           const HostThreadContext* in_host_context,
+                           HostThreadContext* out_host_context,
+                           uint64_t* out_stack_hash) override {
+    if (out_stack_hash) {
+      *out_stack_hash = 0;
+    }
+    // Threads can't be suspended and inspected from outside on POSIX, so the
+    // context must be given, such as from a signal or exception handler.
+    if (!in_host_context) {
+      return 0;
+    }
+    if (out_host_context && out_host_context != in_host_context) {
+      std::memcpy(out_host_context, in_host_context,
+                  sizeof(HostThreadContext));
+    }
+    // Host frames are only skipped over by scanning the stack if it's known
+    // to belong to the current thread, to stay within its bounds.
+    StackBounds bounds;
+    if (in_host_context->rsp >= current_stack_bounds_.low &&
+        in_host_context->rsp < current_stack_bounds_.high) {
+      bounds = current_stack_bounds_;
+    }
+    size_t captured_count =
+        WalkStack(in_host_context->rip, in_host_context->rsp, bounds,
+                  frame_host_pcs, frame_offset, frame_count);
+    if (out_stack_hash) {
+      *out_stack_hash =
+          XXH3_64bits(frame_host_pcs, captured_count * sizeof(uint64_t));
+    }
+    return captured_count;
+  }
+
+  bool ResolveStack(uint64_t* frame_host_pcs, StackFrame* frames,
+                    size_t frame_count) override {
+    for (size_t i = 0; i < frame_count; ++i) {
+      auto& frame = frames[i];
+      std::memset(&frame, 0, sizeof(frame));
+      frame.host_pc = frame_host_pcs[i];
+
+      // If in the generated range, we know it's ours.
+      if (IsInCodeCache(frame.host_pc)) {
+        frame.type = StackFrame::Type::kGuest;
+        auto function = code_cache_->LookupFunction(frame.host_pc);
+        frame.guest_symbol.function = function;
+        if (function && function->is_guest()) {
+          frame.guest_pc =
+              static_cast<GuestFunction*>(function)
+                  ->MapMachineCodeToGuestAddress(frame.host_pc);
+        }
+      } else {
+        // Host symbol - only found if exported to the dynamic symbol table.
+        frame.type = StackFrame::Type::kHost;
+        Dl_info info;
+        if (dladdr(reinterpret_cast<void*>(frame.host_pc), &info) &&
+            info.dli_sname) {
+          frame.host_symbol.address =
+              reinterpret_cast<uint64_t>(info.dli_saddr);
+          std::strncpy(frame.host_symbol.name, info.dli_sname,
+                       xe::countof(frame.host_symbol.name) - 1);
+        }
+      }
+    }
+    return true;
+  }
+
+ private:
+  // How far above a host frame a return address into generated code is
+  // searched for.
+  static constexpr uintptr_t kMaxHostFrameScanSize = 64 * 1024;
+
+  bool IsInCodeCache(uint64_t pc) const {
+    return pc >= code_cache_min_ && pc < code_cache_max_;
+  }
+
+  // Whether the address is where a call in generated code returns to, as
+  // opposed to an arbitrary value in the code cache range.
+  bool IsGeneratedReturnAddress(uint64_t pc) const {
+    if (!IsInCodeCache(pc) || pc < code_cache_min_ + 6 ||
+        !code_cache_->LookupUnwindInfo(pc)) {
+      return false;
+    }
+    auto code = reinterpret_cast<const uint8_t*>(pc);
+    // call rel32, call r64, call [r64 + disp8], call [rip + disp32].
+    return code[-5] == 0xE8 || (code[-2] == 0xFF && (code[-1] & 0xF8) == 0xD0) ||
+           (code[-3] == 0xFF && (code[-2] & 0xF8) == 0x50) ||
+           (code[-6] == 0xFF && code[-5] == 0x15);
+  }
+
+  // Walks frames starting with the given PC and stack pointer without any
+  // locking or allocation, so it may be used from signal handlers. Only reads
+  // memory within the stack bounds if they're known.
+  size_t WalkStack(uint64_t pc, uint64_t sp, const StackBounds& bounds,
+                   uint64_t* frame_host_pcs, size_t frame_offset,
+                   size_t frame_count) const {
+    auto is_readable = [&bounds, sp](uint64_t address) {
+      if (bounds.high) {
+        return address >= bounds.low && address + 8 <= bounds.high;
+      }
+      // Only the frames of generated code, which are small, are walked
+      // without known bounds.
+      return address >= sp && address < sp + kMaxHostFrameScanSize;
+    };
+    size_t frame_index = 0;
+    while (pc && frame_index < frame_offset + frame_count) {
+      if (frame_index >= frame_offset) {
+        frame_host_pcs[frame_index - frame_offset] = pc;
+      }
+      ++frame_index;
+      if (IsInCodeCache(pc)) {
+        auto unwind_info = reinterpret_cast<const backend::CodeUnwindInfo*>(
+            code_cache_->LookupUnwindInfo(pc));
+        if (!unwind_info) {
+          // Data or a helper without a regular frame.
+          break;
+        }
+        uint64_t return_address_slot = sp;
+        if (!IsFrameDeallocated(pc, *unwind_info)) {
+          return_address_slot += unwind_info->stack_size;
+        }
+        if (!is_readable(return_address_slot)) {
+          break;
+        }
+        pc = *reinterpret_cast<const uint64_t*>(return_address_slot);
+        sp = return_address_slot + 8;
+      } else {
+        // No unwind information for the host code that can be used here -
+        // skip to the closest return address into generated code, such as
+        // the guest-to-host thunk.
+        if (!bounds.high) {
+          break;
+        }
+        uint64_t slot = sp;
+        uint64_t scan_end = std::min(uint64_t(bounds.high),
+                                     sp + kMaxHostFrameScanSize) - 8;
+        pc = 0;
+        for (; slot <= scan_end; slot += 8) {
+          uint64_t value = *reinterpret_cast<const uint64_t*>(slot);
+          if (IsGeneratedReturnAddress(value)) {
+            pc = value;
+            sp = slot + 8;
+            break;
+          }
+        }
+      }
+    }
+    return frame_index > frame_offset ? frame_index - frame_offset : 0;
+  }
+
+  // Whether the stack pointer is at the return address in the function - in
+  // the prolog before the allocation, or after the deallocation before a ret
+  // or a tail call.
+  static bool IsFrameDeallocated(uint64_t pc,
+                                 const backend::CodeUnwindInfo& unwind_info) {
+    uint64_t offset = pc - unwind_info.code_address;
+    if (offset < unwind_info.prolog_stack_alloc_offset) {
+      return true;
+    }
+    auto code = reinterpret_cast<const uint8_t*>(pc);
+    if (*code == 0xC3) {
+      return true;
+    }
+    // add rsp, imm8 or add rsp, imm32 right before.
+    if (offset >= 4 && code[-4] == 0x48 && code[-3] == 0x83 &&
+        code[-2] == 0xC4 && code[-1] == unwind_info.stack_size) {
+      return true;
+    }
+    if (offset >= 7 && code[-7] == 0x48 && code[-6] == 0x81 &&
+        code[-5] == 0xC4) {
+      uint32_t imm32;
+      std::memcpy(&imm32, code - 4, sizeof(imm32));
+      return imm32 == unwind_info.stack_size;
+    }
+    return false;
+  }
+
+  backend::CodeCache* code_cache_;
+  uintptr_t code_cache_min_;
+  uintptr_t code_cache_max_;
+};
+
+std::unique_ptr<StackWalker> StackWalker::Create(
+    backend::CodeCache* code_cache) {
+  return std::make_unique<PosixStackWalker>(code_cache);
+}
+
+#else
+
 std::unique_ptr<StackWalker> StackWalker::Create(
     backend::CodeCache* code_cache) {
   XELOGD("Stack walker unimplemented on posix");
   return nullptr;
 }
 
+#endif  // XE_ARCH_AMD64
+
 }  // namespace cpu
-}  // namespace xe
\ No newline at end of file
+}  // namespace xe
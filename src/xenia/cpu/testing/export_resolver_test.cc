@@ -0,0 +1,60 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/cpu/export_resolver.h"
+
+#include <vector>
+
+#include "third_party/catch/include/catch.hpp"
+
+namespace xe {
+namespace cpu {
+namespace test {
+
+TEST_CASE("Export table lookup by ordinal", "[export_resolver]") {
+  static Export kernel_exports_storage[] = {
+      Export(0x001, Export::Type::kFunction, "DbgBreakPoint"),
+      Export(0x00C, Export::Type::kVariable, "ExConsoleGameRegion"),
+  };
+  static Export xam_exports_storage[] = {
+      Export(0x005, Export::Type::kFunction, "NetDll_WSAStartup"),
+  };
+  static std::vector<Export*> kernel_exports(16);
+  static std::vector<Export*> xam_exports(8);
+  kernel_exports[0x001] = &kernel_exports_storage[0];
+  kernel_exports[0x00C] = &kernel_exports_storage[1];
+  xam_exports[0x005] = &xam_exports_storage[0];
+
+  ExportResolver resolver;
+  resolver.RegisterTable("xboxkrnl.exe", &kernel_exports);
+  resolver.RegisterTable("xam.xex", &xam_exports);
+
+  const ExportResolver::Table* kernel_table = resolver.GetTable("XBOXKRNL.EXE");
+  REQUIRE(kernel_table);
+  REQUIRE(kernel_table->module_name() == "xboxkrnl.exe");
+  REQUIRE(kernel_table->GetExportByOrdinal(0x001) ==
+          &kernel_exports_storage[0]);
+  REQUIRE(kernel_table->GetExportByOrdinal(0x00C)->get_type() ==
+          Export::Type::kVariable);
+  REQUIRE(kernel_table->GetExportByOrdinal(0x002) == nullptr);
+  // Past the end of the ordinal table.
+  REQUIRE(kernel_table->GetExportByOrdinal(0x100) == nullptr);
+
+  REQUIRE(resolver.GetTable("xam.xex") != kernel_table);
+  REQUIRE(resolver.GetExportByOrdinal("xam.xex", 0x005) ==
+          &xam_exports_storage[0]);
+  REQUIRE(resolver.GetTable("xbdm.xex") == nullptr);
+  REQUIRE(resolver.GetExportByOrdinal("xbdm.xex", 0x005) == nullptr);
+
+  REQUIRE(resolver.all_exports_by_name().size() == 3);
+}
+
+}  // namespace test
+}  // namespace cpu
+}  // namespace xe
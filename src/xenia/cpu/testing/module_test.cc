@@ -0,0 +1,157 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/cpu/module.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "xenia/cpu/function.h"
+#include "xenia/cpu/processor.h"
+
+#include "third_party/catch/include/catch.hpp"
+#include "third_party/fmt/include/fmt/format.h"
+
+namespace xe {
+namespace cpu {
+namespace test {
+
+class TestFunction : public GuestFunction {
+ public:
+  TestFunction(Module* module, uint32_t address)
+      : GuestFunction(module, address) {}
+
+  uint8_t* machine_code() const override { return nullptr; }
+  size_t machine_code_length() const override { return 0; }
+
+ protected:
+  bool CallImpl(ThreadState* thread_state, uint32_t return_address) override {
+    return false;
+  }
+};
+
+class TestModule : public Module {
+ public:
+  explicit TestModule(Processor* processor) : Module(processor) {}
+
+  const std::string& name() const override { return name_; }
+  bool is_executable() const override { return true; }
+
+ protected:
+  std::unique_ptr<Function> CreateFunction(uint32_t address) override {
+    return std::make_unique<TestFunction>(this, address);
+  }
+
+ private:
+  std::string name_ = "test";
+};
+
+// Import records are 16 bytes apart, a variable record and its thunk.
+std::vector<uint32_t> ImportAddresses(uint32_t count, uint32_t offset) {
+  std::vector<uint32_t> addresses(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    addresses[i] = 0x82000000 + i * 32 + offset;
+  }
+  return addresses;
+}
+
+TEST_CASE("Declare symbols in a batch", "[module]") {
+  Processor processor(nullptr, nullptr);
+  TestModule module(&processor);
+
+  Symbol* existing_variable;
+  REQUIRE(module.DeclareVariable(0x82000000, &existing_variable) ==
+          Symbol::Status::kNew);
+  Function* existing_function;
+  REQUIRE(module.DeclareFunction(0x82000010, &existing_function) ==
+          Symbol::Status::kNew);
+
+  std::vector<uint32_t> addresses = ImportAddresses(4, 0);
+  std::vector<Symbol*> variables(addresses.size());
+  module.DeclareSymbols(Symbol::Type::kVariable, addresses.data(),
+                        addresses.size(), variables.data());
+  REQUIRE(variables[0] == existing_variable);
+  for (size_t i = 0; i < addresses.size(); ++i) {
+    REQUIRE(variables[i]);
+    REQUIRE(variables[i]->type() == Symbol::Type::kVariable);
+    REQUIRE(variables[i]->address() == addresses[i]);
+    REQUIRE(module.LookupSymbol(addresses[i]) == variables[i]);
+  }
+
+  addresses = ImportAddresses(4, 0x10);
+  std::vector<Symbol*> thunks(addresses.size());
+  module.DeclareSymbols(Symbol::Type::kFunction, addresses.data(),
+                        addresses.size(), thunks.data());
+  REQUIRE(thunks[0] == existing_function);
+  for (size_t i = 1; i < addresses.size(); ++i) {
+    REQUIRE(thunks[i]);
+    REQUIRE(thunks[i]->type() == Symbol::Type::kFunction);
+    REQUIRE(thunks[i]->address() == addresses[i]);
+  }
+
+  // A symbol of another type at the address isn't returned.
+  Symbol* mismatch;
+  uint32_t variable_address = 0x82000000;
+  module.DeclareSymbols(Symbol::Type::kFunction, &variable_address, 1,
+                        &mismatch);
+  REQUIRE_FALSE(mismatch);
+  REQUIRE(module.QuerySymbolCount() == 8);
+}
+
+// Run explicitly with the [.benchmark] tag.
+TEST_CASE("Import declaration benchmark", "[module][.benchmark]") {
+  // A title with a thousand imports, about as many as the largest ones have,
+  // each a variable and a thunk.
+  constexpr uint32_t kImportCount = 1000;
+  constexpr int kIterations = 50;
+  std::vector<uint32_t> variable_addresses = ImportAddresses(kImportCount, 0);
+  std::vector<uint32_t> thunk_addresses = ImportAddresses(kImportCount, 0x10);
+  Processor processor(nullptr, nullptr);
+
+  auto measure = [&](auto declare) {
+    std::vector<double> times;
+    for (int i = 0; i < kIterations; ++i) {
+      TestModule module(&processor);
+      auto start = std::chrono::steady_clock::now();
+      declare(module);
+      times.push_back(std::chrono::duration<double, std::micro>(
+                          std::chrono::steady_clock::now() - start)
+                          .count());
+      REQUIRE(module.QuerySymbolCount() == kImportCount * 2);
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+  };
+
+  double individual_us = measure([&](TestModule& module) {
+    for (uint32_t i = 0; i < kImportCount; ++i) {
+      Symbol* variable;
+      module.DeclareVariable(variable_addresses[i], &variable);
+      Function* thunk;
+      module.DeclareFunction(thunk_addresses[i], &thunk);
+    }
+  });
+  double batched_us = measure([&](TestModule& module) {
+    std::vector<Symbol*> variables(kImportCount), thunks(kImportCount);
+    module.DeclareSymbols(Symbol::Type::kVariable, variable_addresses.data(),
+                          kImportCount, variables.data());
+    module.DeclareSymbols(Symbol::Type::kFunction, thunk_addresses.data(),
+                          kImportCount, thunks.data());
+  });
+  fmt::print("Declaring {} imports: {:.1f} us individually, {:.1f} us "
+             "batched\n",
+             kImportCount, individual_us, batched_us);
+}
+
+}  // namespace test
+}  // namespace cpu
+}  // namespace xe
@@ -0,0 +1,215 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/cpu/stack_walker.h"
+
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "xenia/base/platform.h"
+#include "xenia/cpu/backend/code_cache.h"
+
+#include "third_party/catch/include/catch.hpp"
+
+// Generated code is walked by the stack walker itself only on POSIX, Windows
+// uses the unwind information registered for the code cache.
+#if XE_ARCH_AMD64 && !XE_PLATFORM_WIN32
+
+namespace xe {
+namespace cpu {
+namespace test {
+
+// A code cache that is only read, never executed - the functions are nops
+// with the instructions the walker looks at placed where needed.
+class FakeCodeCache : public backend::CodeCache {
+ public:
+  static constexpr size_t kSize = 0x1000;
+
+  FakeCodeCache() : code_(kSize, 0x90) {}
+
+  uint64_t AddFunction(uint32_t offset, uint32_t size, uint32_t stack_size) {
+    backend::CodeUnwindInfo info;
+    info.code_address = execute_base_address() + offset;
+    info.code_size = size;
+    // sub rsp, imm8.
+    info.prolog_stack_alloc_offset = 4;
+    info.stack_size = stack_size;
+    functions_.push_back(info);
+    return info.code_address;
+  }
+
+  void SetCode(uint64_t address, uint8_t value) {
+    code_[address - execute_base_address()] = value;
+  }
+
+  const std::filesystem::path& file_name() const override {
+    return file_name_;
+  }
+  uintptr_t execute_base_address() const override {
+    return reinterpret_cast<uintptr_t>(code_.data());
+  }
+  size_t total_size() const override { return kSize; }
+
+  GuestFunction* LookupFunction(uint64_t host_pc) override { return nullptr; }
+
+  void* LookupUnwindInfo(uint64_t host_pc) override {
+    for (auto& info : functions_) {
+      if (host_pc >= info.code_address &&
+          host_pc < info.code_address + info.code_size) {
+        return &info;
+      }
+    }
+    return nullptr;
+  }
+
+ private:
+  std::filesystem::path file_name_;
+  std::vector<uint8_t> code_;
+  std::vector<backend::CodeUnwindInfo> functions_;
+};
+
+// Stands for the host function called by guest code, such as an export.
+void HostFunction() {}
+
+// Guest code calling guest code calling the host, which is interrupted:
+// guest_a -> guest_b -> host -> guest_a (interrupted).
+class GuestCallChain {
+ public:
+  GuestCallChain() {
+    guest_a_ = code_cache_.AddFunction(0x100, 0x100, 0x28);
+    guest_b_ = code_cache_.AddFunction(0x200, 0x100, 0x38);
+    walker_ = StackWalker::Create(&code_cache_);
+    REQUIRE(walker_);
+  }
+
+  FakeCodeCache& code_cache() { return code_cache_; }
+  StackWalker& walker() { return *walker_; }
+
+  uint64_t interrupted_pc() const { return guest_a_ + 0x20; }
+  uint64_t guest_b_return() const { return guest_b_ + 0x30; }
+  uint64_t host_pc() const {
+    return reinterpret_cast<uint64_t>(&HostFunction);
+  }
+  uint64_t guest_a_return() const { return guest_a_ + 0x80; }
+
+  // Lays out the frames on the stack, lowest address first.
+  HostThreadContext Build(uint64_t* stack) {
+    // guest_a, interrupted with its frame allocated.
+    stack[0x28 / 8] = guest_b_return();
+    // guest_b, which called the host.
+    stack[6 + 0x38 / 8] = host_pc();
+    // The host frame, with some locals before the return address into
+    // generated code, which must follow a call.
+    stack[14] = 0x1234;
+    stack[17] = guest_a_return();
+    code_cache_.SetCode(guest_a_return() - 5, 0xE8);
+    // guest_a, the outermost frame.
+    stack[18 + 0x28 / 8] = 0;
+
+    HostThreadContext context = {};
+    context.rip = interrupted_pc();
+    context.rsp = reinterpret_cast<uint64_t>(stack);
+    return context;
+  }
+
+ private:
+  FakeCodeCache code_cache_;
+  std::unique_ptr<StackWalker> walker_;
+  uint64_t guest_a_;
+  uint64_t guest_b_;
+};
+
+TEST_CASE("Stack walker walks guest and host frames", "[stack_walker]") {
+  GuestCallChain chain;
+  chain.walker().PrepareCurrentThread();
+  uint64_t stack[32] = {};
+  HostThreadContext context = chain.Build(stack);
+
+  uint64_t frame_host_pcs[8];
+  size_t frame_count = chain.walker().CaptureStackTrace(
+      nullptr, frame_host_pcs, 0, 8, &context, nullptr);
+  REQUIRE(frame_count == 4);
+  REQUIRE(frame_host_pcs[0] == chain.interrupted_pc());
+  REQUIRE(frame_host_pcs[1] == chain.guest_b_return());
+  REQUIRE(frame_host_pcs[2] == chain.host_pc());
+  REQUIRE(frame_host_pcs[3] == chain.guest_a_return());
+
+  StackFrame frames[4];
+  REQUIRE(chain.walker().ResolveStack(frame_host_pcs, frames, 4));
+  REQUIRE(frames[0].type == StackFrame::Type::kGuest);
+  REQUIRE(frames[1].type == StackFrame::Type::kGuest);
+  REQUIRE(frames[2].type == StackFrame::Type::kHost);
+  REQUIRE(frames[3].type == StackFrame::Type::kGuest);
+
+  SECTION("Frame range") {
+    frame_count = chain.walker().CaptureStackTrace(
+        nullptr, frame_host_pcs, 1, 2, &context, nullptr);
+    REQUIRE(frame_count == 2);
+    REQUIRE(frame_host_pcs[0] == chain.guest_b_return());
+    REQUIRE(frame_host_pcs[1] == chain.host_pc());
+  }
+
+  SECTION("Return address not after a call") {
+    chain.code_cache().SetCode(chain.guest_a_return() - 5, 0x90);
+    frame_count = chain.walker().CaptureStackTrace(
+        nullptr, frame_host_pcs, 0, 8, &context, nullptr);
+    REQUIRE(frame_count == 3);
+  }
+}
+
+TEST_CASE("Stack walker stops at host frames outside the thread stack",
+          "[stack_walker]") {
+  GuestCallChain chain;
+  chain.walker().PrepareCurrentThread();
+  // Not the stack of the current thread, so the host frame isn't scanned.
+  std::vector<uint64_t> stack(32);
+  HostThreadContext context = chain.Build(stack.data());
+
+  uint64_t frame_host_pcs[8];
+  size_t frame_count = chain.walker().CaptureStackTrace(
+      nullptr, frame_host_pcs, 0, 8, &context, nullptr);
+  REQUIRE(frame_count == 3);
+  REQUIRE(frame_host_pcs[2] == chain.host_pc());
+}
+
+TEST_CASE("Stack walker handles unallocated frames", "[stack_walker]") {
+  GuestCallChain chain;
+  chain.walker().PrepareCurrentThread();
+  uint64_t stack[32] = {};
+  HostThreadContext context = {};
+  context.rsp = reinterpret_cast<uint64_t>(stack);
+  // Return address right at the stack pointer.
+  stack[0] = chain.interrupted_pc();
+  stack[1 + 0x28 / 8] = 0;
+  uint64_t frame_host_pcs[8];
+
+  SECTION("Prolog") {
+    context.rip = chain.guest_b_return() - 0x30 + 2;
+  }
+
+  SECTION("Epilog") {
+    // ret
+    context.rip = chain.guest_b_return();
+    chain.code_cache().SetCode(context.rip, 0xC3);
+  }
+
+  size_t frame_count = chain.walker().CaptureStackTrace(
+      nullptr, frame_host_pcs, 0, 8, &context, nullptr);
+  REQUIRE(frame_count == 2);
+  REQUIRE(frame_host_pcs[0] == context.rip);
+  REQUIRE(frame_host_pcs[1] == chain.interrupted_pc());
+}
+
+}  // namespace test
+}  // namespace cpu
+}  // namespace xe
+
+#endif  // XE_ARCH_AMD64 && !XE_PLATFORM_WIN32
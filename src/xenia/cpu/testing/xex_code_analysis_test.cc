@@ -0,0 +1,146 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/cpu/xex_code_analysis.h"
+
+#include <vector>
+
+#include "xenia/base/byte_order.h"
+
+#include "third_party/catch/include/catch.hpp"
+
+namespace xe {
+namespace cpu {
+namespace test {
+
+constexpr uint32_t kLowAddress = 0x82000000;
+
+class TestImage {
+ public:
+  explicit TestImage(uint32_t word_count) : words_(word_count, 0) {}
+
+  void Set(uint32_t address, uint32_t instr) {
+    words_[(address - kLowAddress) / 4] = xe::byte_swap(instr);
+  }
+
+  // bl target
+  void SetCall(uint32_t address, uint32_t target) {
+    Set(address, 0x48000001 | ((target - address) & 0x03FFFFFC));
+  }
+
+  XexCodeRegion region() const {
+    XexCodeRegion region;
+    region.code = reinterpret_cast<const uint8_t*>(words_.data());
+    region.low_address = kLowAddress;
+    region.high_address = kLowAddress + uint32_t(words_.size()) * 4;
+    region.code_end_address = region.high_address;
+    return region;
+  }
+
+ private:
+  std::vector<uint32_t> words_;
+};
+
+TEST_CASE("Code analysis finds function starts", "[xex_code_analysis]") {
+  TestImage image(256);
+  // mflr r12 at an 8-byte-aligned address.
+  image.Set(kLowAddress + 0x10, 0x7D8802A6);
+  // blr, padding, then code at a 16-byte-aligned address.
+  image.Set(kLowAddress + 0x20, 0x38600000);
+  image.Set(kLowAddress + 0x24, 0x4E800020);
+  image.Set(kLowAddress + 0x30, 0x38600001);
+  // Call targets, only 8-byte-aligned ones count.
+  image.SetCall(kLowAddress + 0x100, kLowAddress + 0x200);
+  image.SetCall(kLowAddress + 0x104, kLowAddress + 0x204);
+  image.Set(kLowAddress + 0x200, 0x38600002);
+
+  XexCodeAnalysis analysis = AnalyzeXexCode(image.region());
+  REQUIRE(analysis.function_starts ==
+          std::vector<uint32_t>{kLowAddress + 0x10, kLowAddress + 0x30,
+                                kLowAddress + 0x200});
+  REQUIRE(analysis.hot_call_targets.empty());
+}
+
+TEST_CASE("Code analysis finds hot call targets", "[xex_code_analysis]") {
+  TestImage image(256);
+  for (uint32_t i = 0; i < kHotCallTargetMinCallSites; ++i) {
+    image.SetCall(kLowAddress + 0x100 + i * 4, kLowAddress + 0x300);
+  }
+  for (uint32_t i = 0; i + 1 < kHotCallTargetMinCallSites; ++i) {
+    image.SetCall(kLowAddress + 0x200 + i * 4, kLowAddress + 0x308);
+  }
+
+  XexCodeAnalysis analysis = AnalyzeXexCode(image.region());
+  REQUIRE(analysis.hot_call_targets == std::vector<uint32_t>{0x82000300});
+}
+
+TEST_CASE("Code analysis finds MMIO stores", "[xex_code_analysis]") {
+  TestImage image(256);
+  // lis r11, 0x7FC8
+  image.Set(kLowAddress + 0x40, 0x3D607FC8);
+  // stw r3, 0x714(r11)
+  image.Set(kLowAddress + 0x44, 0x906B0714);
+  // stw r3, 0(r10) - different base.
+  image.Set(kLowAddress + 0x48, 0x906A0000);
+  // stwbrx r4, r0, r11
+  image.Set(kLowAddress + 0x4C, 0x7C805D2C);
+  // li r11, 0 - the base is overwritten.
+  image.Set(kLowAddress + 0x50, 0x39600000);
+  // stw r3, 0(r11)
+  image.Set(kLowAddress + 0x54, 0x906B0000);
+  // lis r9, 0x8200 - not MMIO.
+  image.Set(kLowAddress + 0x80, 0x3D208200);
+  // stw r3, 0(r9)
+  image.Set(kLowAddress + 0x84, 0x90690000);
+
+  XexCodeAnalysis analysis = AnalyzeXexCode(image.region());
+  REQUIRE(analysis.mmio_store_sites ==
+          std::vector<uint32_t>{kLowAddress + 0x44, kLowAddress + 0x4C});
+}
+
+TEST_CASE("Code analysis on threads matches serial", "[xex_code_analysis]") {
+  TestImage image(64 * 1024);
+  uint32_t seed = 1;
+  for (uint32_t i = 0; i < 64 * 1024; i += 3) {
+    seed = seed * 1103515245 + 12345;
+    uint32_t address = kLowAddress + i * 4;
+    switch (seed >> 29) {
+      case 0:
+        image.SetCall(address, kLowAddress + ((seed >> 8) & 0x1F8));
+        break;
+      case 1:
+        image.Set(address & ~7u, 0x7D8802A6);
+        break;
+      case 2:
+        image.Set(address, 0x4E800020);
+        break;
+      case 3:
+        image.Set(address, 0x3D607FC8);
+        image.Set(address + 4, 0x906B0000);
+        break;
+      default:
+        image.Set(address, 0x38600000 | (seed & 0xFFFF));
+        break;
+    }
+  }
+
+  XexCodeAnalysis serial = AnalyzeXexCode(image.region());
+  WorkerPool pool(3, "Code Analysis Test");
+  XexCodeAnalysis parallel = AnalyzeXexCode(image.region(), &pool);
+  REQUIRE(!serial.function_starts.empty());
+  REQUIRE(!serial.hot_call_targets.empty());
+  REQUIRE(!serial.mmio_store_sites.empty());
+  REQUIRE(parallel.function_starts == serial.function_starts);
+  REQUIRE(parallel.hot_call_targets == serial.hot_call_targets);
+  REQUIRE(parallel.mmio_store_sites == serial.mmio_store_sites);
+}
+
+}  // namespace test
+}  // namespace cpu
+}  // namespace xe
@@ -0,0 +1,144 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "xenia/base/console_app_main.h"
+#include "xenia/base/cvar.h"
+#include "xenia/base/filesystem.h"
+#include "xenia/base/logging.h"
+#include "xenia/base/mapped_memory.h"
+#include "xenia/base/threading.h"
+#include "xenia/base/utf8.h"
+#include "xenia/base/worker_pool.h"
+#include "xenia/cpu/processor.h"
+#include "xenia/cpu/xex_module.h"
+#include "xenia/memory.h"
+#include "xenia/vfs/devices/disc_image_device.h"
+#include "xenia/vfs/devices/disc_zarchive_device.h"
+#include "xenia/vfs/file.h"
+#include "xenia/xbox.h"
+
+// Loads an executable without the kernel and writes a warm-start profile of
+// it to the infocache, so the first launch can precompile the functions found
+// by static analysis instead of discovering them while running.
+
+DEFINE_transient_path(source, "",
+                      "XEX to analyze, or a disc image (.iso or .zar) "
+                      "containing it.",
+                      "General");
+DEFINE_transient_path(analysis_cache_root, "",
+                      "Cache root of the emulator to write the infocache to.",
+                      "General");
+DEFINE_transient_string(disc_xex_path, "default.xex",
+                        "Path to the XEX within the disc image.", "General");
+
+namespace xe {
+namespace cpu {
+
+static bool ReadSourceXex(const std::filesystem::path& source_path,
+                          std::vector<uint8_t>& data_out) {
+  std::string extension =
+      xe::utf8::lower_ascii(xe::path_to_utf8(source_path.extension()));
+  std::unique_ptr<vfs::Device> device;
+  if (extension == ".iso") {
+    device = std::make_unique<vfs::DiscImageDevice>("", source_path);
+  } else if (extension == ".zar") {
+    device = std::make_unique<vfs::DiscZarchiveDevice>("", source_path);
+  }
+
+  if (!device) {
+    auto mapping = MappedMemory::Open(source_path, MappedMemory::Mode::kRead);
+    if (!mapping) {
+      XELOGE("Failed to open {}", xe::path_to_utf8(source_path));
+      return false;
+    }
+    data_out.assign(mapping->data(), mapping->data() + mapping->size());
+    return true;
+  }
+
+  if (!device->Initialize()) {
+    XELOGE("Failed to mount {}", xe::path_to_utf8(source_path));
+    return false;
+  }
+  vfs::Entry* entry = device->ResolvePath(cvars::disc_xex_path);
+  if (!entry) {
+    XELOGE("{} not found in {}", cvars::disc_xex_path,
+           xe::path_to_utf8(source_path));
+    return false;
+  }
+  vfs::File* file = nullptr;
+  if (entry->Open(xe::filesystem::FileAccess::kFileReadData, &file) !=
+      X_STATUS_SUCCESS) {
+    XELOGE("Failed to open {}", cvars::disc_xex_path);
+    return false;
+  }
+  data_out.resize(entry->size());
+  size_t bytes_read = 0;
+  X_STATUS status = file->ReadSync(data_out, 0, &bytes_read);
+  file->Destroy();
+  if (status != X_STATUS_SUCCESS || bytes_read != data_out.size()) {
+    XELOGE("Failed to read {}", cvars::disc_xex_path);
+    return false;
+  }
+  return true;
+}
+
+int xex_analyze_main(const std::vector<std::string>& args) {
+  if (cvars::source.empty() || cvars::analysis_cache_root.empty()) {
+    XELOGE("Usage: {} [source] [analysis_cache_root]", args[0]);
+    return 1;
+  }
+
+  std::vector<uint8_t> xex_data;
+  if (!ReadSourceXex(cvars::source, xex_data)) {
+    return 1;
+  }
+
+  // Only the guest address space is needed to load the image - no backend,
+  // and no kernel to resolve imports.
+  auto memory = std::make_unique<Memory>();
+  if (!memory->Initialize()) {
+    XELOGE("Failed to initialize guest memory");
+    return 1;
+  }
+  auto processor = std::make_unique<Processor>(memory.get(), nullptr);
+  std::string name = xe::path_to_utf8(cvars::source.filename());
+  auto module = std::make_unique<XexModule>(processor.get(), nullptr);
+  if (!module->Load(name, "", xex_data.data(), xex_data.size()) ||
+      !module->LoadContinue()) {
+    XELOGE("Failed to load the XEX");
+    return 1;
+  }
+
+  WorkerPool pool(
+      std::max(xe::threading::logical_processor_count(), uint32_t(1)) - 1,
+      "Analysis Worker");
+  XexCodeAnalysis analysis;
+  if (!module->WriteWarmStartProfile(cvars::analysis_cache_root, &pool,
+                                     &analysis)) {
+    XELOGE("Failed to write the infocache - is it disabled?");
+    return 1;
+  }
+  XELOGI(
+      "Recorded {} function starts, {} hot call targets and {} MMIO store "
+      "sites",
+      analysis.function_starts.size(), analysis.hot_call_targets.size(),
+      analysis.mmio_store_sites.size());
+  return 0;
+}
+
+}  // namespace cpu
+}  // namespace xe
+
+XE_DEFINE_CONSOLE_APP("xenia-cpu-analyze", xe::cpu::xex_analyze_main,
+                      "[source] [analysis_cache_root]", "source",
+                      "analysis_cache_root");
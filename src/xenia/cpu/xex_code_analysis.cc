@@ -0,0 +1,267 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/cpu/xex_code_analysis.h"
+
+#include <algorithm>
+
+#include "xenia/base/byte_order.h"
+#include "xenia/base/math.h"
+#include "xenia/base/memory.h"
+#include "xenia/cpu/ppc/ppc_decode_data.h"
+#include "xenia/cpu/ppc/ppc_instr.h"
+
+namespace xe {
+namespace cpu {
+
+namespace {
+
+constexpr uint32_t kMfsprR12Lr = 0x7D8802A6;
+constexpr uint32_t kBlr = 0x4E800020;
+// Instructions after a lis of an MMIO base to look for stores in.
+constexpr uint32_t kMMIOScanWindow = 16;
+
+struct ChunkResult {
+  std::vector<uint32_t> function_starts;
+  std::vector<uint32_t> call_targets;
+  std::vector<uint32_t> mmio_store_sites;
+};
+
+uint32_t GetBLCalledFunction(uint32_t current_base, ppc::PPCOpcodeBits wrd) {
+  int32_t displ = static_cast<int32_t>(ppc::XEEXTS26(wrd.I.LI << 2));
+
+  if (wrd.I.AA) {
+    return static_cast<uint32_t>(displ);
+  } else {
+    return static_cast<uint32_t>(static_cast<int32_t>(current_base) + displ);
+  }
+}
+
+bool IsOpcodeBL(uint32_t w) {
+  return (w >> (32 - 6)) == 18 && ppc::PPCOpcodeBits{w}.I.LK;
+}
+
+// lis rD, 0x7F00-0x7FFF - the upper half of an address in the range where
+// MMIO handlers are registered.
+bool IsMMIOBaseLoad(uint32_t w, uint32_t* reg_out) {
+  ppc::PPCOpcodeBits bits{w};
+  if ((w >> 26) != 15 || bits.D.RA != 0 || (bits.D.DS >> 8) != 0x7F) {
+    return false;
+  }
+  *reg_out = bits.D.RT;
+  return true;
+}
+
+class CodeScanner {
+ public:
+  explicit CodeScanner(const XexCodeRegion& region) : region_(region) {}
+
+  uint32_t Load(uint32_t address) const {
+    return xe::load_and_swap<uint32_t>(region_.code +
+                                       (address - region_.low_address));
+  }
+
+  // Scans the 8-byte-aligned range [start, end).
+  void ScanRange(uint32_t start, uint32_t end, uint32_t scan_end,
+                 ChunkResult& result) const {
+    for (uint32_t address = start; address < end; address += 8) {
+      // All functions seem to start on 8 byte boundaries, except for obvious
+      // ones like the save/rest functions.
+      uint32_t instr = Load(address);
+      if (instr == kMfsprR12Lr) {
+        // Saving the link register.
+        result.function_starts.push_back(address);
+      } else if (instr && address - 4 >= region_.low_address &&
+                 !Load(address - 4)) {
+        // Some functions are aligned to more than 8 bytes (something that
+        // appears to be longjmp is aligned to 16 bytes in most games), so
+        // skip all the padding before checking for a blr ending the previous
+        // function.
+        uint32_t check_address = address - 8;
+        while (check_address >= region_.low_address && !Load(check_address)) {
+          check_address -= 4;
+        }
+        if (check_address >= region_.low_address &&
+            Load(check_address) == kBlr) {
+          result.function_starts.push_back(address);
+        }
+      }
+      ScanInstruction(address, scan_end, result);
+      ScanInstruction(address + 4, scan_end, result);
+    }
+  }
+
+ private:
+  void ScanInstruction(uint32_t address, uint32_t scan_end,
+                       ChunkResult& result) const {
+    uint32_t instr = Load(address);
+    if (IsOpcodeBL(instr)) {
+      // It's safe to assume that the target of a bl is a function start.
+      uint32_t called_function =
+          GetBLCalledFunction(address, ppc::PPCOpcodeBits{instr});
+      if (!(called_function & (8 - 1)) &&
+          called_function >= region_.low_address &&
+          called_function < region_.high_address) {
+        result.call_targets.push_back(called_function);
+      }
+      return;
+    }
+    uint32_t base_reg;
+    if (IsMMIOBaseLoad(instr, &base_reg)) {
+      ScanMMIOStores(address + 4, base_reg, scan_end, result);
+    }
+  }
+
+  void ScanMMIOStores(uint32_t address, uint32_t base_reg, uint32_t scan_end,
+                      ChunkResult& result) const {
+    uint32_t window_end =
+        std::min(scan_end, address + kMMIOScanWindow * 4);
+    for (; address < window_end; address += 4) {
+      uint32_t instr = Load(address);
+      ppc::PPCOpcodeBits bits{instr};
+      uint32_t opcode = instr >> 26;
+      switch (opcode) {
+        case 16:  // bc
+        case 18:  // b
+        case 19:  // bclr, bcctr
+          return;
+        case 36:  // stw
+        case 38:  // stb
+        case 44:  // sth
+          if (bits.D.RA == base_reg) {
+            result.mmio_store_sites.push_back(address);
+          }
+          continue;
+        case 37:  // stwu
+        case 39:  // stbu
+        case 45:  // sthu
+          if (bits.D.RA == base_reg) {
+            result.mmio_store_sites.push_back(address);
+            // The base is modified.
+            return;
+          }
+          continue;
+        case 31: {
+          uint32_t xo = (instr >> 1) & 0x3FF;
+          if (xo == 151 || xo == 215 || xo == 407 || xo == 662 || xo == 918) {
+            // stwx, stbx, sthx, stwbrx, sthbrx.
+            if (bits.X.RA == base_reg || bits.X.RB == base_reg) {
+              result.mmio_store_sites.push_back(address);
+            }
+            continue;
+          }
+          break;
+        }
+        default:
+          break;
+      }
+      // Anything else that may overwrite the base ends the search -
+      // conservatively, the destination or, for logical and rotate
+      // instructions, the first source register.
+      if (bits.D.RT == base_reg ||
+          ((opcode == 31 || (opcode >= 20 && opcode <= 30)) &&
+           bits.D.RA == base_reg)) {
+        return;
+      }
+    }
+  }
+
+  const XexCodeRegion& region_;
+};
+
+}  // namespace
+
+XexCodeAnalysis AnalyzeXexCode(const XexCodeRegion& region, WorkerPool* pool) {
+  XexCodeAnalysis analysis;
+  uint32_t low_8_aligned = xe::align<uint32_t>(region.low_address, 8);
+  uint32_t high_8_aligned =
+      std::min(region.code_end_address, region.high_address) & ~(8U - 1);
+  if (!region.code || high_8_aligned <= low_8_aligned) {
+    return analysis;
+  }
+
+  // Chunks of whole 8-byte pairs, several per thread for balancing.
+  uint32_t pair_count = (high_8_aligned - low_8_aligned) / 8;
+  uint32_t chunk_count =
+      pool ? std::min(pair_count, (pool->thread_count() + 1) * 4) : 1;
+  uint32_t chunk_pairs = (pair_count + chunk_count - 1) / chunk_count;
+  chunk_count = (pair_count + chunk_pairs - 1) / chunk_pairs;
+  std::vector<ChunkResult> chunk_results(chunk_count);
+  CodeScanner scanner(region);
+  auto scan_chunk = [&](uint32_t chunk) {
+    uint32_t start = low_8_aligned + chunk * chunk_pairs * 8;
+    uint32_t end = std::min(high_8_aligned, start + chunk_pairs * 8);
+    scanner.ScanRange(start, end, high_8_aligned, chunk_results[chunk]);
+  };
+  if (pool) {
+    pool->ParallelFor(chunk_count, scan_chunk);
+  } else {
+    scan_chunk(0);
+  }
+
+  std::vector<uint32_t> call_targets;
+  for (ChunkResult& chunk_result : chunk_results) {
+    analysis.function_starts.insert(analysis.function_starts.end(),
+                                    chunk_result.function_starts.begin(),
+                                    chunk_result.function_starts.end());
+    call_targets.insert(call_targets.end(), chunk_result.call_targets.begin(),
+                        chunk_result.call_targets.end());
+    analysis.mmio_store_sites.insert(analysis.mmio_store_sites.end(),
+                                     chunk_result.mmio_store_sites.begin(),
+                                     chunk_result.mmio_store_sites.end());
+  }
+
+  if (region.pdata) {
+    uint32_t pdata_entry_count = region.pdata_size / 8;
+    for (uint32_t i = 0; i < pdata_entry_count; ++i) {
+      uint32_t function_address =
+          xe::load_and_swap<uint32_t>(region.pdata + i * 8);
+      if (function_address < region.low_address ||
+          function_address > region.code_end_address) {
+        // A zero function address terminates the table.
+        break;
+      }
+      analysis.function_starts.push_back(function_address);
+    }
+  }
+
+  std::sort(call_targets.begin(), call_targets.end());
+  for (size_t i = 0; i < call_targets.size();) {
+    size_t run_end = i + 1;
+    while (run_end < call_targets.size() &&
+           call_targets[run_end] == call_targets[i]) {
+      ++run_end;
+    }
+    if (run_end - i >= kHotCallTargetMinCallSites) {
+      analysis.hot_call_targets.push_back(call_targets[i]);
+    }
+    i = run_end;
+  }
+  call_targets.erase(std::unique(call_targets.begin(), call_targets.end()),
+                     call_targets.end());
+
+  analysis.function_starts.insert(analysis.function_starts.end(),
+                                  call_targets.begin(), call_targets.end());
+  std::sort(analysis.function_starts.begin(), analysis.function_starts.end());
+  analysis.function_starts.erase(
+      std::unique(analysis.function_starts.begin(),
+                  analysis.function_starts.end()),
+      analysis.function_starts.end());
+  // A store may follow multiple base loads.
+  std::sort(analysis.mmio_store_sites.begin(),
+            analysis.mmio_store_sites.end());
+  analysis.mmio_store_sites.erase(
+      std::unique(analysis.mmio_store_sites.begin(),
+                  analysis.mmio_store_sites.end()),
+      analysis.mmio_store_sites.end());
+  return analysis;
+}
+
+}  // namespace cpu
+}  // namespace xe
@@ -0,0 +1,60 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#ifndef XENIA_CPU_XEX_CODE_ANALYSIS_H_
+#define XENIA_CPU_XEX_CODE_ANALYSIS_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "xenia/base/worker_pool.h"
+
+namespace xe {
+namespace cpu {
+
+// Heuristic static analysis of the code of a loaded executable image, used
+// for early precompilation at load time and by the offline xenia-cpu-analyze
+// tool to build a warm-start profile in the infocache.
+
+struct XexCodeRegion {
+  // Host pointer to the image data at low_address, with the image mapped up
+  // to high_address.
+  const uint8_t* code = nullptr;
+  uint32_t low_address = 0;
+  uint32_t high_address = 0;
+  // End of the sections containing code - only [low_address, code_end) is
+  // scanned for instructions.
+  uint32_t code_end_address = 0;
+  // .pdata entries as stored in the image, or nullptr if there's no .pdata.
+  const uint8_t* pdata = nullptr;
+  uint32_t pdata_size = 0;
+};
+
+struct XexCodeAnalysis {
+  // Likely function starts: 8-byte-aligned mflr r12, code after a blr and
+  // padding, bl targets and .pdata entries. Sorted and unique.
+  std::vector<uint32_t> function_starts;
+  // Function starts called with bl from at least kHotCallTargetMinCallSites
+  // sites. Sorted.
+  std::vector<uint32_t> hot_call_targets;
+  // Stores using a base register loaded with lis with an MMIO range upper
+  // half shortly before. Sorted.
+  std::vector<uint32_t> mmio_store_sites;
+};
+
+constexpr uint32_t kHotCallTargetMinCallSites = 8;
+
+// Splits the scan between the threads of the pool if it's not null.
+XexCodeAnalysis AnalyzeXexCode(const XexCodeRegion& region,
+                               WorkerPool* pool = nullptr);
+
+}  // namespace cpu
+}  // namespace xe
+
+#endif  // XENIA_CPU_XEX_CODE_ANALYSIS_H_
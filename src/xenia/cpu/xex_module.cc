@@ -14,16 +14,20 @@
 #include "third_party/fmt/include/fmt/format.h"
 
 #include "xenia/base/byte_order.h"
+#include "xenia/base/clock.h"
 #include "xenia/base/cvar.h"
+#include "xenia/base/filesystem.h"
 #include "xenia/base/logging.h"
 #include "xenia/base/math.h"
 #include "xenia/base/memory.h"
 #include "xenia/base/pe_image.h"
+#include "xenia/base/xxhash.h"
 
 #include "xenia/cpu/cpu_flags.h"
 #include "xenia/cpu/export_resolver.h"
 #include "xenia/cpu/lzx.h"
 #include "xenia/cpu/processor.h"
+#include "xenia/cpu/xex_code_analysis.h"
 #include "xenia/emulator.h"
 #include "xenia/kernel/kernel_state.h"
 #include "xenia/kernel/xmodule.h"
@@ -48,6 +52,18 @@ DEFINE_bool(
     "finding/stress testing with the JIT",
     "CPU");
 
+DEFINE_bool(precompile_warm_start_profile, true,
+            "Pre-compile the guest functions recorded in the infocache by "
+            "xenia-cpu-analyze when loading a module.",
+            "CPU");
+
+DEFINE_bool(shared_xex_images, false,
+            "Store the decrypted and decompressed images of loaded XEX files "
+            "in the cache directory and map them into guest memory "
+            "copy-on-write, so multiple emulator instances running the same "
+            "title share the unmodified pages. Supported on Linux.",
+            "CPU");
+
 DECLARE_bool(allow_plugins);
 
 static constexpr uint8_t xe_xex1_retail_key[16] = {
@@ -59,6 +75,25 @@ static constexpr uint8_t xe_xex2_retail_key[16] = {
 static constexpr uint8_t xe_xex2_devkit_key[16] = {
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+// In the order they're tried when loading.
+static constexpr const uint8_t* xe_xex_image_keys[] = {
+    xe_xex2_retail_key, xe_xex2_devkit_key, xe_xex1_retail_key};
+
+// Header of a shared image file, followed by the image at
+// kSharedImageDataOffset so it can be mapped into guest memory.
+struct SharedImageHeader {
+  static constexpr uint32_t kMagic = xe::make_fourcc("XIMG");
+  static constexpr uint32_t kVersion = 1;
+  uint32_t magic;
+  uint32_t version;
+  // XXH3 of the whole XEX file.
+  uint64_t xex_hash;
+  uint32_t image_size;
+  // Index in xe_xex_image_keys.
+  uint32_t key_index;
+};
+// Aligned to the largest host page size and allocation granularity.
+static constexpr size_t kSharedImageDataOffset = 0x10000;
 
 void aes_decrypt_buffer(const uint8_t* session_key, const uint8_t* input_buffer,
                         const size_t input_size, uint8_t* output_buffer,
@@ -508,13 +543,20 @@ int XexModule::ApplyPatch(XexModule* module) {
   return result_code;
 }
 
+void XexModule::SetImageKey(const uint8_t* key) {
+  is_dev_kit_ = key[0] == 0x00;
+  aes_decrypt_buffer(
+      key, reinterpret_cast<const uint8_t*>(xex_security_info()->aes_key), 16,
+      session_key_, 16);
+}
+
 int XexModule::ReadImage(const void* xex_addr, size_t xex_length,
                          const uint8_t* key) {
   if (!opt_file_format_info()) {
     return 1;
   }
 
-  is_dev_kit_ = key[0] == 0x00;
+  SetImageKey(key);
 
   if (is_patch()) {
     // Make a copy of patch data for other XEX's to use with ApplyPatch()
@@ -528,10 +570,6 @@ int XexModule::ReadImage(const void* xex_addr, size_t xex_length,
 
   memory()->LookupHeap(base_address_)->Reset();
 
-  aes_decrypt_buffer(
-      key, reinterpret_cast<const uint8_t*>(xex_security_info()->aes_key), 16,
-      session_key_, 16);
-
   int result_code = 0;
   switch (opt_file_format_info()->compression_type) {
     case XEX_COMPRESSION_NONE:
@@ -814,6 +852,98 @@ int XexModule::ReadImageCompressed(const void* xex_addr, size_t xex_length) {
   return result_code;
 }
 
+std::filesystem::path XexModule::GetSharedImagePath(uint64_t xex_hash) const {
+  return kernel_state_->emulator()->cache_root() / "xex_images" /
+         fmt::format("{:016X}.bin", xex_hash);
+}
+
+bool XexModule::LoadSharedImage(const std::filesystem::path& path,
+                                uint64_t xex_hash) {
+  SharedImageHeader header;
+  {
+    FILE* file = xe::filesystem::OpenFile(path, "rb");
+    if (!file) {
+      return false;
+    }
+    bool header_read = std::fread(&header, sizeof(header), 1, file) == 1;
+    std::fclose(file);
+    if (!header_read || header.magic != SharedImageHeader::kMagic ||
+        header.version != SharedImageHeader::kVersion ||
+        header.xex_hash != xex_hash || !header.image_size ||
+        header.key_index >= xe::countof(xe_xex_image_keys)) {
+      return false;
+    }
+  }
+
+  auto heap = memory()->LookupHeap(base_address_);
+  heap->Reset();
+  if (!heap->AllocFixed(
+          base_address_, header.image_size, 4096,
+          xe::kMemoryAllocationReserve | xe::kMemoryAllocationCommit,
+          xe::kMemoryProtectRead | xe::kMemoryProtectWrite)) {
+    return false;
+  }
+  if (!memory()->MapSharedImage(base_address_, header.image_size, path,
+                                kSharedImageDataOffset)) {
+    heap->Release(base_address_);
+    return false;
+  }
+  if (!is_valid_executable()) {
+    memory()->UnmapSharedImage(base_address_, header.image_size);
+    heap->Release(base_address_);
+    return false;
+  }
+  SetImageKey(xe_xex_image_keys[header.key_index]);
+  shared_image_size_ = header.image_size;
+  return true;
+}
+
+void XexModule::WriteSharedImage(const std::filesystem::path& path,
+                                 uint64_t xex_hash, uint32_t key_index) {
+  SharedImageHeader header = {};
+  header.magic = SharedImageHeader::kMagic;
+  header.version = SharedImageHeader::kVersion;
+  header.xex_hash = xex_hash;
+  header.key_index = key_index;
+  if (!memory()->LookupHeap(base_address_)->QuerySize(base_address_,
+                                                      &header.image_size)) {
+    return;
+  }
+
+  // Written under a temporary name, so other instances never see a partial
+  // file.
+  std::error_code error;
+  std::filesystem::create_directories(path.parent_path(), error);
+  std::filesystem::path temp_path = path;
+  temp_path += fmt::format(".{:X}.tmp", Clock::QueryHostTickCount());
+  FILE* file = xe::filesystem::OpenFile(temp_path, "wb");
+  if (!file) {
+    return;
+  }
+  std::vector<uint8_t> header_data(kSharedImageDataOffset);
+  std::memcpy(header_data.data(), &header, sizeof(header));
+  bool written =
+      std::fwrite(header_data.data(), header_data.size(), 1, file) == 1 &&
+      std::fwrite(memory()->TranslateVirtual(base_address_), header.image_size,
+                  1, file) == 1;
+  written = std::fclose(file) == 0 && written;
+  if (written) {
+    std::filesystem::rename(temp_path, path, error);
+    written = !error;
+  }
+  if (!written) {
+    std::filesystem::remove(temp_path, error);
+    XELOGW("Failed to write the shared image of {}", name_);
+    return;
+  }
+
+  // The pages loaded by this instance can be shared too.
+  if (memory()->MapSharedImage(base_address_, header.image_size, path,
+                               kSharedImageDataOffset)) {
+    shared_image_size_ = header.image_size;
+  }
+}
+
 int XexModule::ReadPEHeaders() {
   const uint8_t* p = memory()->TranslateVirtual(base_address_);
 
@@ -947,18 +1077,33 @@ bool XexModule::Load(const std::string_view name, const std::string_view path,
   name_ = name;
   path_ = path;
 
+  std::filesystem::path shared_image_path;
+  uint64_t xex_hash = 0;
+  if (cvars::shared_xex_images && kernel_state_ && !is_patch()) {
+    xex_hash = XXH3_64bits(xex_addr, xex_length);
+    shared_image_path = GetSharedImagePath(xex_hash);
+    if (LoadSharedImage(shared_image_path, xex_hash)) {
+      XELOGI("Mapped the shared image of {} from {}", name_,
+             xe::path_to_utf8(shared_image_path));
+      return true;
+    }
+  }
+
   // Load in the XEX basefile
   // We'll try using both XEX2 keys to see if any give a valid PE
+  uint32_t key_index = 0;
   int result_code = ReadImage(xex_addr, xex_length, xe_xex2_retail_key);
   if (result_code) {
     XELOGW("XEX load failed with code {}, trying with devkit encryption key...",
            result_code);
 
+    key_index = 1;
     result_code = ReadImage(xex_addr, xex_length, xe_xex2_devkit_key);
     if (result_code) {
       XELOGE("XEX load failed with code {}, trying with xex1 encryption key...",
              result_code);
 
+      key_index = 2;
       result_code = ReadImage(xex_addr, xex_length, xe_xex1_retail_key);
       if (result_code) {
         XELOGE("XEX load failed with code {}", result_code);
@@ -967,6 +1112,10 @@ bool XexModule::Load(const std::string_view name, const std::string_view path,
     }
   }
 
+  if (!shared_image_path.empty()) {
+    WriteSharedImage(shared_image_path, xex_hash, key_index);
+  }
+
   // Note: caller will have to call LoadContinue once it's determined whether a
   // patch file exists or not!
   return true;
@@ -1022,14 +1171,18 @@ bool XexModule::LoadContinue() {
     page += desc.page_count;
   }
 
-  // Notify backend that we have an executable range.
-  processor_->backend()->CommitExecutableRange(low_address_, high_address_);
+  // Notify backend that we have an executable range. There's no backend when
+  // the module is only loaded for offline analysis.
+  if (processor_->backend()) {
+    processor_->backend()->CommitExecutableRange(low_address_, high_address_);
+  }
 
-  // Add all imports (variables/functions).
+  // Add all imports (variables/functions). They can't be resolved without the
+  // kernel, and the analysis doesn't need them.
   xex2_opt_import_libraries* opt_import_libraries = nullptr;
   GetOptHeader(XEX_HEADER_IMPORT_LIBRARIES, &opt_import_libraries);
 
-  if (opt_import_libraries) {
+  if (opt_import_libraries && kernel_state_) {
     // FIXME: Don't know if 32 is the actual limit, but haven't seen more than
     // 2.
     const char* string_table[32];
@@ -1051,6 +1204,8 @@ bool XexModule::LoadContinue() {
       }
     }
 
+    uint64_t import_setup_start = Clock::QueryHostTickCount();
+    size_t import_count = 0;
     auto library_data = reinterpret_cast<uint8_t*>(opt_import_libraries);
     uint32_t library_offset = opt_import_libraries->string_table.size + 12;
     while (library_offset < opt_import_libraries->size) {
@@ -1065,8 +1220,13 @@ bool XexModule::LoadContinue() {
       assert_not_null(string_table[library_name_index]);
       auto library_name = std::string(string_table[library_name_index]);
       SetupLibraryImports(library_name, library);
+      import_count += library->count;
       library_offset += library->size;
     }
+    XELOGD("{}: Set up {} import records from {} libraries in {} us", name_,
+           import_count, import_libs_.size(),
+           (Clock::QueryHostTickCount() - import_setup_start) * 1000000 /
+               Clock::QueryHostTickFrequency());
   }
 
   // Load a specified module map and diff.
@@ -1108,7 +1268,11 @@ bool XexModule::LoadContinue() {
   return true;
 }
 
-void XexModule::Precompile() {
+void XexModule::ComputeImageHash() {
+  if (!image_sha_str_.empty()) {
+    return;
+  }
+
   sha1::SHA1 final_image_sha_;
 
   final_image_sha_.reset();
@@ -1129,6 +1293,10 @@ void XexModule::Precompile() {
 #endif
     image_sha_str_ += &fmtbuf[0];
   }
+}
+
+void XexModule::Precompile() {
+  ComputeImageHash();
 
   // Find __savegprlr_* and __restgprlr_* and the others.
   // We can flag these for special handling (inlining/etc).
@@ -1136,9 +1304,44 @@ void XexModule::Precompile() {
     return;
   }
 
-  info_cache_.Init(this);
+  info_cache_.Init(this, kernel_state_->emulator()->cache_root());
   PrecompileDiscoveredFunctions();
 }
+
+bool XexModule::WriteWarmStartProfile(const std::filesystem::path& cache_root,
+                                      WorkerPool* pool,
+                                      XexCodeAnalysis* analysis_out) {
+  ComputeImageHash();
+  info_cache_.Init(this, cache_root);
+  auto header = info_cache_.GetHeader();
+  if (!header) {
+    return false;
+  }
+
+  XexCodeAnalysis analysis = AnalyzeXexCode(GetCodeRegion(), pool);
+  for (uint32_t address : analysis.function_starts) {
+    if (auto flags = GetInstructionAddressFlags(address)) {
+      flags->is_function_start = 1;
+    }
+  }
+  for (uint32_t address : analysis.hot_call_targets) {
+    if (auto flags = GetInstructionAddressFlags(address)) {
+      flags->is_hot_call_target = 1;
+    }
+  }
+  for (uint32_t address : analysis.mmio_store_sites) {
+    if (auto flags = GetInstructionAddressFlags(address)) {
+      flags->accessed_mmio = 1;
+    }
+  }
+  header->has_warm_start_profile = 1;
+
+  if (analysis_out) {
+    *analysis_out = std::move(analysis);
+  }
+  return true;
+}
+
 bool XexModule::Unload() {
   if (!loaded_) {
     return true;
@@ -1149,6 +1352,10 @@ bool XexModule::Unload() {
   if (!is_patch()) {
     assert_not_zero(base_address_);
 
+    if (shared_image_size_) {
+      memory()->UnmapSharedImage(base_address_, shared_image_size_);
+      shared_image_size_ = 0;
+    }
     memory()->LookupHeap(base_address_)->Release(base_address_);
   }
 
@@ -1159,13 +1366,15 @@ bool XexModule::Unload() {
 
 bool XexModule::SetupLibraryImports(const std::string_view name,
                                     const xex2_import_library* library) {
-  ExportResolver* kernel_resolver = nullptr;
+  // The export table or the module is looked up once for the whole library.
+  const ExportResolver::Table* kernel_table = nullptr;
+  kernel::object_ref<kernel::XModule> user_module;
   if (kernel_state_->IsKernelModule(name)) {
-    kernel_resolver = processor_->export_resolver();
+    kernel_table = processor_->export_resolver()->GetTable(name);
+  } else {
+    user_module = kernel_state_->GetModule(name);
   }
 
-  auto user_module = kernel_state_->GetModule(name);
-
   auto base_name = utf8::find_base_name_from_guest_path(name);
 
   ImportLibrary library_info;
@@ -1176,37 +1385,76 @@ bool XexModule::SetupLibraryImports(const std::string_view name,
 
   // Imports are stored as {import descriptor, thunk addr, import desc, ...}
   // Even thunks have an import descriptor (albeit unused/useless)
+  // All records are resolved first so the symbols can be declared in batches.
+  struct ResolvedImport {
+    uint32_t record_addr;
+    uint16_t record_type;
+    uint16_t ordinal;
+    Export* kernel_export;
+    uint32_t user_export_addr;
+  };
+  std::vector<ResolvedImport> imports;
+  imports.reserve(library->count);
+  std::vector<uint32_t> variable_addresses, thunk_addresses;
   for (uint32_t i = 0; i < library->count; i++) {
     uint32_t record_addr = library->import_table[i];
     assert_not_zero(record_addr);
 
-    auto record_slot =
-        memory()->TranslateVirtual<xe::be<uint32_t>*>(record_addr);
-    uint32_t record_value = *record_slot;
-
-    uint16_t record_type = (record_value & 0xFF000000) >> 24;
-    uint16_t ordinal = record_value & 0xFFFF;
+    uint32_t record_value =
+        *memory()->TranslateVirtual<xe::be<uint32_t>*>(record_addr);
 
-    Export* kernel_export = nullptr;
-    uint32_t user_export_addr = 0;
+    ResolvedImport& import = imports.emplace_back();
+    import.record_addr = record_addr;
+    import.record_type = (record_value & 0xFF000000) >> 24;
+    import.ordinal = record_value & 0xFFFF;
+    import.kernel_export = nullptr;
+    import.user_export_addr = 0;
 
-    if (kernel_resolver) {
-      kernel_export = kernel_resolver->GetExportByOrdinal(name, ordinal);
+    if (kernel_table) {
+      import.kernel_export = kernel_table->GetExportByOrdinal(import.ordinal);
     } else if (user_module) {
-      user_export_addr = user_module->GetProcAddressByOrdinal(ordinal);
+      import.user_export_addr =
+          user_module->GetProcAddressByOrdinal(import.ordinal);
     }
 
     // Import not resolved?
-    if (!kernel_export && !user_export_addr) {
+    if (!import.kernel_export && !import.user_export_addr) {
       XELOGW(
           "WARNING: an import variable was not resolved! (library: {}, import "
           "lib: {}, ordinal: {:03X})",
-          name_, name, ordinal);
+          name_, name, import.ordinal);
     }
 
-    StringBuffer import_name;
-    if (record_type == 0) {
+    if (import.record_type == 0) {
+      variable_addresses.push_back(record_addr);
+    } else if (import.record_type == 1) {
+      thunk_addresses.push_back(record_addr);
+    } else {
+      // Bad.
+      assert_always();
+    }
+  }
+
+  std::vector<Symbol*> variables(variable_addresses.size());
+  DeclareSymbols(Symbol::Type::kVariable, variable_addresses.data(),
+                 variable_addresses.size(), variables.data());
+  std::vector<Symbol*> thunks(thunk_addresses.size());
+  DeclareSymbols(Symbol::Type::kFunction, thunk_addresses.data(),
+                 thunk_addresses.size(), thunks.data());
+
+  library_info.imports.reserve(variable_addresses.size());
+  size_t variable_index = 0, thunk_index = 0;
+  StringBuffer import_name;
+  for (const ResolvedImport& import : imports) {
+    uint32_t record_addr = import.record_addr;
+    uint16_t ordinal = import.ordinal;
+    Export* kernel_export = import.kernel_export;
+    uint32_t user_export_addr = import.user_export_addr;
+
+    import_name.Reset();
+    if (import.record_type == 0) {
       // Variable.
+      Symbol* var_info = variables[variable_index++];
 
       ImportLibraryFn import_info;
       import_info.ordinal = ordinal;
@@ -1220,6 +1468,8 @@ bool XexModule::SetupLibraryImports(const std::string_view name,
         import_name.AppendFormat("{}_{:03X}", base_name, ordinal);
       }
 
+      auto record_slot =
+          memory()->TranslateVirtual<xe::be<uint32_t>*>(record_addr);
       if (kernel_export) {
         if (kernel_export->get_type() == Export::Type::kFunction) {
           // Not exactly sure what this should be...
@@ -1244,14 +1494,17 @@ bool XexModule::SetupLibraryImports(const std::string_view name,
       }
 
       // Setup a variable and define it.
-      Symbol* var_info;
-      DeclareVariable(record_addr, &var_info);
+      if (!var_info) {
+        assert_always();
+        continue;
+      }
       var_info->set_name(import_name.to_string_view());
       var_info->set_status(Symbol::Status::kDeclared);
       DefineVariable(var_info);
       var_info->set_status(Symbol::Status::kDefined);
-    } else if (record_type == 1) {
+    } else if (import.record_type == 1) {
       // Thunk.
+      auto function = static_cast<Function*>(thunks[thunk_index++]);
       if (library_info.imports.size() > 0) {
         auto& prev_import =
             library_info.imports[library_info.imports.size() - 1];
@@ -1265,8 +1518,10 @@ bool XexModule::SetupLibraryImports(const std::string_view name,
         import_name.AppendFormat("__{}_{:03X}", base_name, ordinal);
       }
 
-      Function* function;
-      DeclareFunction(record_addr, &function);
+      if (!function) {
+        assert_always();
+        continue;
+      }
       function->set_end_address(record_addr + 16 - 4);
       function->set_name(import_name.to_string_view());
 
@@ -1326,9 +1581,6 @@ bool XexModule::SetupLibraryImports(const std::string_view name,
                                                            kernel_export);
       }
       function->set_status(Symbol::Status::kDeclared);
-    } else {
-      // Bad.
-      assert_always();
     }
   }
 
@@ -1345,13 +1597,13 @@ std::unique_ptr<Function> XexModule::CreateFunction(uint32_t address) {
   return std::unique_ptr<Function>(
       processor_->backend()->CreateGuestFunction(this, address));
 }
-void XexInfoCache::Init(XexModule* xexmod) {
+void XexInfoCache::Init(XexModule* xexmod,
+                        const std::filesystem::path& cache_root) {
   if (cvars::disable_instruction_infocache) {
     return;
   }
 
-  auto emu = xexmod->kernel_state_->emulator();
-  std::filesystem::path infocache_path = emu->cache_root();
+  std::filesystem::path infocache_path = cache_root;
 
   infocache_path.append(L"modules");
 
@@ -1409,10 +1661,16 @@ InfoCacheFlags* XexModule::GetInstructionAddressFlags(uint32_t guest_addr) {
   return info_cache_.LookupFlags(guest_addr);
 }
 void XexModule::PrecompileDiscoveredFunctions() {
-  if (!cvars::enable_early_precompilation) {
-    return;
+  std::vector<uint32_t> others;
+  if (cvars::precompile_warm_start_profile) {
+    others = GetWarmStartProfileFunctions();
+  }
+  if (others.empty()) {
+    if (!cvars::enable_early_precompilation) {
+      return;
+    }
+    others = PreanalyzeCode();
   }
-  auto others = PreanalyzeCode();
 
   for (auto&& other : others) {
     if (other < low_address_ || other >= high_address_) {
@@ -1425,6 +1683,31 @@ void XexModule::PrecompileDiscoveredFunctions() {
     }
   }
 }
+
+std::vector<uint32_t> XexModule::GetWarmStartProfileFunctions() {
+  std::vector<uint32_t> functions;
+  auto header = info_cache_.GetHeader();
+  if (!header || !header->has_warm_start_profile) {
+    return functions;
+  }
+  uint32_t end = (high_address_ - low_address_) / 4;
+  auto flags = info_cache_.LookupFlags(0);
+  // Hot call targets first so they're available when compiling their
+  // callers, then everything else that's known to be a function.
+  for (uint32_t i = 0; i < end; i++) {
+    if (flags[i].is_hot_call_target) {
+      functions.push_back(low_address_ + (i * 4));
+    }
+  }
+  for (uint32_t i = 0; i < end; i++) {
+    if (!flags[i].is_hot_call_target &&
+        (flags[i].is_function_start || flags[i].was_resolved)) {
+      functions.push_back(low_address_ + (i * 4));
+    }
+  }
+  return functions;
+}
+
 void XexModule::PrecompileKnownFunctions() {
   if (!cvars::enable_early_precompilation) {
     return;
@@ -1448,165 +1731,29 @@ void XexModule::PrecompileKnownFunctions() {
   }
 }
 
-static uint32_t GetBLCalledFunction(XexModule* xexmod, uint32_t current_base,
-                                    ppc::PPCOpcodeBits wrd) {
-  int32_t displ = static_cast<int32_t>(ppc::XEEXTS26(wrd.I.LI << 2));
-
-  if (wrd.I.AA) {
-    return static_cast<uint32_t>(displ);
-  } else {
-    return static_cast<uint32_t>(static_cast<int32_t>(current_base) + displ);
-  }
-}
-static bool IsOpcodeBL(unsigned w) {
-  return (w >> (32 - 6)) == 18 && ppc::PPCOpcodeBits{w}.I.LK;
-}
-
-std::vector<uint32_t> XexModule::PreanalyzeCode() {
-  uint32_t low_8_aligned = xe::align<uint32_t>(low_address_, 8);
-
-  uint32_t highest_exec_addr = 0;
-
+XexCodeRegion XexModule::GetCodeRegion() {
+  XexCodeRegion region;
+  region.code = memory()->TranslateVirtual(low_address_);
+  region.low_address = low_address_;
+  region.high_address = high_address_;
   for (auto&& sec : pe_sections_) {
     if ((sec.flags & kXEPESectionContainsCode)) {
-      highest_exec_addr =
-          std::max<uint32_t>(highest_exec_addr, sec.address + sec.size);
+      region.code_end_address =
+          std::max<uint32_t>(region.code_end_address, sec.address + sec.size);
     }
   }
-  uint32_t high_8_aligned = highest_exec_addr & ~(8U - 1);
-  uint32_t n_possible_8byte_addresses = (high_8_aligned - low_8_aligned) / 8;
-  uint32_t* funcstart_candidate_stack =
-      new uint32_t[n_possible_8byte_addresses];
-  uint32_t* funcstart_candstack2 = new uint32_t[n_possible_8byte_addresses];
-
-  uint32_t stack_pos = 0;
-  {
-    // all functions seem to start on 8 byte boundaries, except for obvious ones
-    // like the save/rest funcs
-    uint32_t* range_start =
-        (uint32_t*)memory()->TranslateVirtual(low_8_aligned);
-    uint32_t* range_end = (uint32_t*)memory()->TranslateVirtual(
-        high_8_aligned);  // align down to multiple of 8
-
-    constexpr uint8_t mfspr_r12_lr[4] = {0x7D, 0x88, 0x02, 0xA6};
-
-    // a blr instruction, with 4 zero bytes afterwards to pad the next address
-    // to 8 byte alignment
-    // if we see this prior to our address, we can assume we are a function
-    // start
-    constexpr uint8_t blr[4] = {0x4E, 0x80, 0x0, 0x20};
-
-    uint32_t blr32 = *reinterpret_cast<const uint32_t*>(&blr[0]);
-
-    uint32_t mfspr_r12_lr32 =
-        *reinterpret_cast<const uint32_t*>(&mfspr_r12_lr[0]);
-
-    auto add_new_func = [funcstart_candidate_stack, &stack_pos](uint32_t addr) {
-      funcstart_candidate_stack[stack_pos++] = addr;
-    };
-    /*
-                First pass: detect save of the link register at an eight byte
-       aligned address
-        */
-    for (uint32_t* first_pass = range_start; first_pass < range_end;
-         first_pass += 2) {
-      if (*first_pass == mfspr_r12_lr32) {
-        // Push our newly discovered function start into our list
-        // All addresses in the list are sorted until the second pass
-        add_new_func(
-            static_cast<uint32_t>(reinterpret_cast<uintptr_t>(first_pass) -
-                                  reinterpret_cast<uintptr_t>(range_start)) +
-            low_8_aligned);
-      } else if (first_pass[-1] == 0 && *first_pass != 0) {
-        // originally i checked for blr followed by 0, but some functions are
-        // actually aligned to greater boundaries. something that appears to be
-        // longjmp (it occurs in most games, so standard library, and loads ctx,
-        // so longjmp) is aligned to 16 bytes in most games
-        uint32_t* check_iter = &first_pass[-2];
-
-        while (!*check_iter) {
-          --check_iter;
-        }
-
-        XE_LIKELY_IF(*check_iter == blr32) {
-          add_new_func(
-              static_cast<uint32_t>(reinterpret_cast<uintptr_t>(first_pass) -
-                                    reinterpret_cast<uintptr_t>(range_start)) +
-              low_8_aligned);
-        }
-      }
-    }
-    uint32_t current_guestaddr = low_8_aligned;
-    // Second pass: detect branch with link instructions and decode the target
-    // address. We can safely assume that if bl is to address, that address is
-    // the start of the function
-    for (uint32_t* second_pass = range_start; second_pass < range_end;
-         second_pass++, current_guestaddr += 4) {
-      uint32_t current_call = xe::byte_swap(*second_pass);
-
-      if (IsOpcodeBL(current_call)) {
-        uint32_t called_function = GetBLCalledFunction(
-            this, current_guestaddr, ppc::PPCOpcodeBits{current_call});
-        // must be 8 byte aligned and in range
-        if ((called_function & (8 - 1)) == 0 &&
-            called_function >= low_address_ &&
-            called_function < high_address_) {
-          add_new_func(called_function);
-        }
-      }
-    }
-
-    auto pdata = this->GetPESection(".pdata");
-
-    if (pdata) {
-      uint32_t* pdata_base =
-          (uint32_t*)this->memory()->TranslateVirtual(pdata->address);
-
-      uint32_t n_pdata_entries = pdata->raw_size / 8;
-
-      for (uint32_t i = 0; i < n_pdata_entries; ++i) {
-        uint32_t funcaddr = xe::load_and_swap<uint32_t>(&pdata_base[i * 2]);
-        if (funcaddr >= low_address_ && funcaddr <= highest_exec_addr) {
-          add_new_func(funcaddr);
-        } else {
-          // we hit 0 for func addr, that means we're done
-          break;
-        }
-      }
-    }
-  }
-
-  // Sort the list of function starts and then ensure that all addresses are
-  // unique
-  uint32_t n_known_funcaddrs = 0;
-  {
-    // make addresses unique
-
-    std::sort(funcstart_candidate_stack, funcstart_candidate_stack + stack_pos);
-
-    uint32_t read_pos = 0;
-    uint32_t write_pos = 0;
-    uint32_t previous_addr = ~0u;
-    while (read_pos < stack_pos) {
-      uint32_t current_addr = funcstart_candidate_stack[read_pos++];
-
-      if (current_addr != previous_addr) {
-        previous_addr = current_addr;
-        funcstart_candstack2[write_pos++] = current_addr;
-      }
-    }
-    n_known_funcaddrs = write_pos;
+  auto pdata = GetPESection(".pdata");
+  if (pdata) {
+    region.pdata = memory()->TranslateVirtual(pdata->address);
+    region.pdata_size = pdata->raw_size;
   }
+  return region;
+}
 
-  delete[] funcstart_candidate_stack;
-
-  std::vector<uint32_t> result;
-  result.resize(n_known_funcaddrs);
-  memcpy(&result[0], funcstart_candstack2,
-         sizeof(uint32_t) * n_known_funcaddrs);
-  delete[] funcstart_candstack2;
-  return result;
+std::vector<uint32_t> XexModule::PreanalyzeCode() {
+  return AnalyzeXexCode(GetCodeRegion()).function_starts;
 }
+
 bool XexModule::FindSaveRest() {
   // Special stack save/restore functions.
   // http://research.microsoft.com/en-us/um/redmond/projects/invisible/src/crt/md/ppc/xxx.s.htm
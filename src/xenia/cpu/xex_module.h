@@ -10,10 +10,13 @@
 #ifndef XENIA_CPU_XEX_MODULE_H_
 #define XENIA_CPU_XEX_MODULE_H_
 
+#include <filesystem>
 #include <string>
 #include <vector>
 #include "xenia/base/mapped_memory.h"
+#include "xenia/base/worker_pool.h"
 #include "xenia/cpu/module.h"
+#include "xenia/cpu/xex_code_analysis.h"
 #include "xenia/kernel/util/xex2_info.h"
 
 namespace xe {
@@ -37,7 +40,10 @@ struct InfoCacheFlags {
   uint32_t is_syscall_func : 1;
   uint32_t is_return_site : 1;  // address can be reached from another function
                                 // by returning
-  uint32_t reserved : 28;
+  uint32_t is_function_start : 1;   // found by xenia-cpu-analyze
+  uint32_t is_hot_call_target : 1;  // called from many sites, found by
+                                    // xenia-cpu-analyze
+  uint32_t reserved : 26;
 };
 static_assert(sizeof(InfoCacheFlags) == 4,
               "InfoCacheFlags size should be equal to sizeof ppc instruction.");
@@ -48,8 +54,11 @@ struct XexInfoCache {
 
   struct InfoCacheFlagsHeader {
     uint32_t version;
+    // Whether xenia-cpu-analyze has written is_function_start,
+    // is_hot_call_target and the statically found accessed_mmio flags.
+    uint32_t has_warm_start_profile;
 
-    unsigned char reserved[252];
+    unsigned char reserved[248];
 
     InfoCacheFlags* LookupFlags(unsigned offset) {
       return &reinterpret_cast<InfoCacheFlags*>(&this[1])[offset];
@@ -60,7 +69,7 @@ struct XexInfoCache {
   */
   std::unique_ptr<MappedMemory> executable_addr_flags_;
 
-  void Init(class XexModule*);
+  void Init(class XexModule*, const std::filesystem::path& cache_root);
   InfoCacheFlagsHeader* GetHeader() {
     if (!executable_addr_flags_) {
       return nullptr;
@@ -234,26 +243,45 @@ class XexModule : public xe::cpu::Module {
 
   virtual void Precompile() override;
 
+  // Statically analyzes the code, using the pool if not null, and records the
+  // results in the infocache in cache_root so the first launch can precompile
+  // them. Doesn't require the kernel, so the module can be loaded with a null
+  // kernel state and a processor without a backend for this.
+  bool WriteWarmStartProfile(const std::filesystem::path& cache_root,
+                             WorkerPool* pool,
+                             XexCodeAnalysis* analysis_out = nullptr);
+
  protected:
   std::unique_ptr<Function> CreateFunction(uint32_t address) override;
 
  private:
   void PrecompileKnownFunctions();
   void PrecompileDiscoveredFunctions();
+  std::vector<uint32_t> GetWarmStartProfileFunctions();
+  XexCodeRegion GetCodeRegion();
   std::vector<uint32_t> PreanalyzeCode();
   friend struct XexInfoCache;
   void ReadSecurityInfo();
 
+  void SetImageKey(const uint8_t* key);
   int ReadImage(const void* xex_addr, size_t xex_length, const uint8_t* key);
   int ReadImageUncompressed(const void* xex_addr, size_t xex_length);
   int ReadImageBasicCompressed(const void* xex_addr, size_t xex_length);
   int ReadImageCompressed(const void* xex_addr, size_t xex_length);
 
+  // Decrypted and decompressed images of XEX files shared between emulator
+  // processes via the cache directory.
+  std::filesystem::path GetSharedImagePath(uint64_t xex_hash) const;
+  bool LoadSharedImage(const std::filesystem::path& path, uint64_t xex_hash);
+  void WriteSharedImage(const std::filesystem::path& path, uint64_t xex_hash,
+                        uint32_t key_index);
+
   int ReadPEHeaders();
 
   bool SetupLibraryImports(const std::string_view name,
                            const xex2_import_library* library);
   bool FindSaveRest();
+  void ComputeImageHash();
 
   Processor* processor_ = nullptr;
   kernel::KernelState* kernel_state_ = nullptr;
@@ -271,6 +299,8 @@ class XexModule : public xe::cpu::Module {
 
   uint8_t session_key_[0x10];
   bool is_dev_kit_ = false;
+  // Size of the image if it's backed by a shared image file, 0 otherwise.
+  uint32_t shared_image_size_ = 0;
 
   bool loaded_ = false;         // Loaded into memory?
   bool finished_load_ = false;  // PE/imports/symbols/etc all loaded?
@@ -29,6 +29,7 @@
 #include "xenia/base/logging.h"
 #include "xenia/base/mapped_memory.h"
 #include "xenia/base/platform.h"
+#include "xenia/base/scheduling_policy.h"
 #include "xenia/base/string.h"
 #include "xenia/base/system.h"
 #include "xenia/cpu/backend/code_cache.h"
@@ -217,6 +218,9 @@ X_STATUS Emulator::Setup(
   // Before we can set thread affinity we must enable the process to use all
   // logical processors.
   xe::threading::EnableAffinityConfiguration();
+  // Create the host scheduling policy from the loaded config, also placing the
+  // service threads created before that.
+  xe::threading::SchedulingPolicy::Get();
 
   XELOGI("{}: Initializing Memory...", __func__);
   // Create memory system first, as it is required for other systems.
@@ -13,6 +13,7 @@
 
 #include "third_party/fmt/include/fmt/format.h"
 #include "xenia/base/byte_stream.h"
+#include "xenia/base/clock.h"
 #include "xenia/base/cvar.h"
 #include "xenia/base/logging.h"
 #include "xenia/base/profiling.h"
@@ -65,6 +66,13 @@ DEFINE_bool(
     "mid-frame synchronization, so it has a huge performance impact.",
     "GPU");
 
+DEFINE_uint32(
+    command_processor_max_spin_us, 250,
+    "Maximum time in microseconds the GPU command processor spins waiting for "
+    "new commands before sleeping. The actual spin time adapts to how often "
+    "the guest submits commands, 0 to always sleep right away.",
+    "GPU");
+
 namespace xe {
 namespace gpu {
 
@@ -144,6 +152,7 @@ bool CommandProcessor::Initialize() {
           },
           kernel_state_->GetIdleProcess()));
   worker_thread_->set_name("GPU Commands");
+  worker_thread_->set_is_service_thread(true);
   worker_thread_->Create();
 
   return true;
@@ -245,6 +254,9 @@ void CommandProcessor::CallInThread(std::function<void()> fn) {
     fn();
   } else {
     pending_fns_.push(std::move(fn));
+    // The queue isn't atomic, so the push may become visible after the check
+    // of worker_waiting_ in WakeWorker - always signal, this path is rare.
+    write_ptr_index_event_->Set();
   }
 }
 
@@ -278,24 +290,8 @@ void CommandProcessor::WorkerThreadMain() {
     if (write_ptr_index == 0xBAADF00D || read_ptr_index_ == write_ptr_index) {
       SCOPE_profile_cpu_i("gpu", "xe::gpu::CommandProcessor::Stall");
       // We've run out of commands to execute.
-      // We spin here waiting for new ones, as the overhead of waiting on our
-      // event is too high.
       PrepareForWait();
-      uint32_t loop_count = 0;
-      do {
-        // If we spin around too much, revert to a "low-power" state.
-        if (loop_count > 500) {
-          constexpr int wait_time_ms = 2;
-          xe::threading::Wait(write_ptr_index_event_.get(), true,
-                              std::chrono::milliseconds(wait_time_ms));
-        } else {
-          xe::threading::MaybeYield();
-        }
-        loop_count++;
-        write_ptr_index = write_ptr_index_.load();
-      } while (worker_running_ && pending_fns_.empty() &&
-               (write_ptr_index == 0xBAADF00D ||
-                read_ptr_index_ == write_ptr_index));
+      write_ptr_index = WaitForWork();
       ReturnFromWait();
       if (!worker_running_ || !pending_fns_.empty()) {
         continue;
@@ -346,6 +342,101 @@ void CommandProcessor::Resume() {
   worker_thread_->thread()->Resume();
 }
 
+uint32_t CommandProcessor::WaitForWork() {
+  auto has_work = [this](uint32_t write_ptr_index) {
+    return !worker_running_ || !pending_fns_.empty() ||
+           (write_ptr_index != 0xBAADF00D &&
+            read_ptr_index_ != write_ptr_index);
+  };
+
+  // If the guest has been submitting more often than the spin limit, the next
+  // submission will likely arrive soon, and spinning avoids the latency of
+  // sleeping and being woken up. Otherwise, sleep right away not to waste a
+  // host core while the guest is doing something else.
+  uint64_t tick_frequency = Clock::QueryHostTickFrequency();
+  uint64_t max_spin_ticks =
+      uint64_t(cvars::command_processor_max_spin_us) * tick_frequency /
+      1000000;
+  uint64_t spin_ticks =
+      submission_interval_average_ < max_spin_ticks
+          ? std::min(submission_interval_average_ * 2, max_spin_ticks)
+          : 0;
+
+  uint64_t wait_start_tick = Clock::QueryHostTickCount();
+  uint64_t spin_end_tick = wait_start_tick + spin_ticks;
+  uint64_t sleep_start_tick = 0;
+  uint32_t write_ptr_index;
+  while (true) {
+    write_ptr_index = write_ptr_index_.load();
+    if (has_work(write_ptr_index)) {
+      break;
+    }
+    if (!sleep_start_tick) {
+      if (Clock::QueryHostTickCount() < spin_end_tick) {
+        xe::threading::MaybeYield();
+        continue;
+      }
+      sleep_start_tick = Clock::QueryHostTickCount();
+    }
+    // Write pointer updates only signal the event while the worker is marked
+    // as waiting, so check again after marking to not miss a write done just
+    // before.
+    worker_waiting_.store(true);
+    write_ptr_index = write_ptr_index_.load();
+    if (!has_work(write_ptr_index)) {
+      xe::threading::Wait(write_ptr_index_event_.get(), true);
+    }
+    worker_waiting_.store(false, std::memory_order_relaxed);
+  }
+
+  uint64_t wait_end_tick = Clock::QueryHostTickCount();
+  if (sleep_start_tick) {
+    wait_spin_ticks_ += sleep_start_tick - wait_start_tick;
+    wait_sleep_ticks_ += wait_end_tick - sleep_start_tick;
+  } else {
+    wait_spin_ticks_ += wait_end_tick - wait_start_tick;
+  }
+
+  uint64_t submission_tick =
+      write_ptr_update_tick_.load(std::memory_order_relaxed);
+  if (submission_tick != last_submission_tick_) {
+    // Exponential moving average of the interval between submissions.
+    if (last_submission_tick_) {
+      int64_t interval = int64_t(submission_tick - last_submission_tick_);
+      submission_interval_average_ = uint64_t(
+          int64_t(submission_interval_average_) +
+          (interval - int64_t(submission_interval_average_)) / 8);
+    }
+    last_submission_tick_ = submission_tick;
+    if (wait_end_tick > submission_tick) {
+      ++wake_count_;
+      wake_latency_ticks_ += wait_end_tick - submission_tick;
+    }
+  }
+
+  uint64_t total_wait_ticks = wait_spin_ticks_ + wait_sleep_ticks_;
+  COUNT_profile_set("gpu/command_processor/wait_spin_percent",
+                    total_wait_ticks
+                        ? int64_t(wait_spin_ticks_ * 100 / total_wait_ticks)
+                        : 0);
+  COUNT_profile_set(
+      "gpu/command_processor/submission_interval_us",
+      int64_t(submission_interval_average_ * 1000000 / tick_frequency));
+  if (wake_count_) {
+    COUNT_profile_set("gpu/command_processor/wake_latency_avg_ns",
+                      int64_t(double(wake_latency_ticks_) * 1000000000.0 /
+                              double(tick_frequency) / double(wake_count_)));
+  }
+
+  return write_ptr_index;
+}
+
+void CommandProcessor::WakeWorker() {
+  if (worker_waiting_.load()) {
+    write_ptr_index_event_->SetBoostPriority();
+  }
+}
+
 bool CommandProcessor::Save(ByteStream* stream) {
   assert_true(paused_);
 
@@ -368,6 +459,7 @@ bool CommandProcessor::Restore(ByteStream* stream) {
   read_ptr_update_freq_ = stream->Read<uint32_t>();
   read_ptr_writeback_ptr_ = stream->Read<uint32_t>();
   write_ptr_index_.store(stream->Read<uint32_t>());
+  write_ptr_index_event_->Set();
 
   return true;
 }
@@ -422,8 +514,10 @@ void CommandProcessor::UpdateWritePointer(uint32_t value) {
   XE_UNLIKELY_IF(cvars::log_ringbuffer_kickoff_initiator_bts) {
     LogKickoffInitator(value);
   }
+  write_ptr_update_tick_.store(Clock::QueryHostTickCount(),
+                               std::memory_order_relaxed);
   write_ptr_index_ = value;
-  write_ptr_index_event_->SetBoostPriority();
+  WakeWorker();
 }
 
 void CommandProcessor::LogRegisterSet(uint32_t register_index, uint32_t value) {
@@ -161,6 +161,12 @@ class CommandProcessor {
   };
 
   void WorkerThreadMain();
+  // Spins or sleeps until new commands are written, a function is queued or
+  // the worker is stopped, returns the new write pointer.
+  uint32_t WaitForWork();
+  // Signals the worker if it's sleeping in WaitForWork, for write pointer
+  // updates - queued functions always signal the event.
+  void WakeWorker();
   virtual bool SetupContext() = 0;
   virtual void ShutdownContext() = 0;
   // rarely needed, most register writes have no special logic here
@@ -288,6 +294,20 @@ class CommandProcessor {
 
   std::unique_ptr<xe::threading::Event> write_ptr_index_event_;
   std::atomic<uint32_t> write_ptr_index_;
+  // Whether the worker is sleeping on write_ptr_index_event_, so the event is
+  // only signaled when needed.
+  std::atomic<bool> worker_waiting_ = false;
+  // Host tick count of the latest write pointer update by the guest.
+  std::atomic<uint64_t> write_ptr_update_tick_ = 0;
+
+  // Statistics of the waits for new commands, in host ticks, also used to
+  // choose how long to spin.
+  uint64_t last_submission_tick_ = 0;
+  uint64_t submission_interval_average_ = 0;
+  uint64_t wait_spin_ticks_ = 0;
+  uint64_t wait_sleep_ticks_ = 0;
+  uint64_t wake_count_ = 0;
+  uint64_t wake_latency_ticks_ = 0;
 
   uint64_t bin_select_ = 0xFFFFFFFFull;
   uint64_t bin_mask_ = 0xFFFFFFFFull;
@@ -13,6 +13,7 @@ project("xenia-gpu-d3d12")
     "xenia-ui",
     "xenia-ui-d3d12",
     "xxhash",
+    "zstd",
   })
   local_platform_files()
   files({
@@ -53,6 +54,7 @@ if enableMiscSubprojects then
       "mspack",
       "snappy",
       "xxhash",
+      "zstd",
     })
     files({
       "d3d12_trace_viewer_main.cc",
@@ -106,6 +108,7 @@ if enableMiscSubprojects then
       "mspack",
       "snappy",
       "xxhash",
+      "zstd",
     })
     files({
       "d3d12_trace_dump_main.cc",
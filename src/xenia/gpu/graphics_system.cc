@@ -19,6 +19,7 @@
 
 #include "xenia/base/byte_stream.h"
 #include "xenia/base/clock.h"
+#include "xenia/base/frame_pacer.h"
 #include "xenia/base/logging.h"
 #include "xenia/base/math.h"
 #include "xenia/base/profiling.h"
@@ -69,6 +70,14 @@ DEFINE_bool(
     "runtime spikes and freezes when playing the game not for the first time.",
     "GPU");
 
+DEFINE_uint32(
+    frame_limiter_max_spin_us, 2000,
+    "Maximum time in microseconds the vblank and frame limiter thread spins "
+    "before each vblank instead of sleeping. The actual time is calibrated "
+    "from the precision of sleeping on the host, lower values use less CPU "
+    "time but may make vblanks late.",
+    "GPU");
+
 namespace xe {
 namespace gpu {
 
@@ -166,60 +175,69 @@ X_STATUS GraphicsSystem::Setup(cpu::Processor* processor,
             if (normalized_framerate_limit == 0 && cvars::vsync)
               normalized_framerate_limit = 60;
 
-            const double vsync_duration_d =
-                cvars::vsync
-                    ? std::max<double>(5.0,
-                                       1000.0 / static_cast<double>(
-                                                    normalized_framerate_limit))
-                    : 1.0;
-            uint64_t last_frame_time = Clock::QueryGuestTickCount();
-            // Sleep for 90% of the vblank duration, spin for 10%
-            constexpr double duration_scalar = 0.90;
+            std::chrono::nanoseconds interval;
+            if (cvars::vsync) {
+              interval = std::max<std::chrono::nanoseconds>(
+                  std::chrono::milliseconds(5),
+                  std::chrono::nanoseconds(1000000000 /
+                                           normalized_framerate_limit));
+            } else if (normalized_framerate_limit > 0) {
+              // framerate_limit is over 0, vsync disabled
+              //  - No VSYNC + limited frames defined by user
+              interval = std::chrono::nanoseconds(1000000000 /
+                                                  normalized_framerate_limit);
+            } else {
+              // framerate_limit is 0, vsync disabled
+              //  - No VSYNC + unlimited frames
+              interval = std::chrono::milliseconds(1);
+            }
+            threading::FramePacer pacer(
+                interval,
+                std::chrono::microseconds(cvars::frame_limiter_max_spin_us));
+
+            // With VSYNC, the vblanks follow the guest clock, which may be
+            // scaled, so the drift between it and the host clock is applied
+            // to the deadlines.
+            const double guest_tick_ns =
+                1000000000.0 / double(Clock::guest_tick_frequency());
+            const auto host_start_time = std::chrono::steady_clock::now();
+            const uint64_t guest_start_time = Clock::QueryGuestTickCount();
 
             while (frame_limiter_worker_running_) {
+              pacer.Wait();
+
               register_file()->values[XE_GPU_REG_D1MODE_V_COUNTER] +=
                   GetInternalDisplayResolution().second;
 
               if (cvars::vsync) {
-                const uint64_t current_time = Clock::QueryGuestTickCount();
-                const uint64_t tick_freq = Clock::guest_tick_frequency();
-                const uint64_t time_delta = current_time - last_frame_time;
-                const double elapsed_d =
-                    static_cast<double>(time_delta) /
-                    (static_cast<double>(tick_freq) / 1000.0);
-                if (elapsed_d >= vsync_duration_d) {
-                  last_frame_time = current_time;
-
-                  // TODO(disjtqz): should recalculate the remaining time to a
-                  // vblank after MarkVblank, no idea how long the guest code
-                  // normally takes
-                  MarkVblank();
-                  if (cvars::vsync) {
-                    const uint64_t estimated_nanoseconds =
-                        static_cast<uint64_t>(
-                            (vsync_duration_d * 1000000.0) *
-                            duration_scalar);  // 1000 microseconds = 1 ms
-
-                    threading::NanoSleep(estimated_nanoseconds);
-                  }
-                }
+                auto host_elapsed =
+                    std::chrono::steady_clock::now() - host_start_time;
+                auto guest_elapsed = std::chrono::nanoseconds(int64_t(
+                    double(Clock::QueryGuestTickCount() - guest_start_time) *
+                    guest_tick_ns));
+                pacer.FollowDrift(guest_elapsed - host_elapsed);
               }
 
-              if (!cvars::vsync) {
-                MarkVblank();
-                if (normalized_framerate_limit > 0) {
-                  // framerate_limit is over 0, vsync disabled
-                  //  - No VSYNC + limited frames defined by user
-                  uint64_t framerate_limited_sleep_time =
-                      1000000000 / normalized_framerate_limit;
-                  xe::threading::NanoSleep(framerate_limited_sleep_time);
-                } else {
-                  // framerate_limit is 0, vsync disabled
-                  //  - No VSYNC + unlimited frames
-                  xe::threading::Sleep(std::chrono::milliseconds(1));
-                }
-              }
+              // TODO(disjtqz): should recalculate the remaining time to a
+              // vblank after MarkVblank, no idea how long the guest code
+              // normally takes
+              MarkVblank();
+
+              const threading::FramePacer::Statistics& statistics =
+                  pacer.statistics();
+              COUNT_profile_set("gpu/frame_limiter/slack_us",
+                                pacer.slack().count() / 1000);
+              COUNT_profile_set("gpu/frame_limiter/max_lateness_us",
+                                statistics.max_lateness.count() / 1000);
+              COUNT_profile_set(
+                  "gpu/frame_limiter/spin_permille",
+                  statistics.wait_time.count()
+                      ? statistics.spin_time.count() * 1000 /
+                            statistics.wait_time.count()
+                      : 0);
             }
+            XELOGI("GPU frame limiter statistics: {}",
+                   pacer.DescribeStatistics());
             return 0;
           },
           kernel_state->GetIdleProcess()));
@@ -14,6 +14,7 @@ project("xenia-gpu")
     "xenia-base",
     "xenia-ui",
     "xxhash",
+    "zstd",
   })
   includedirs({
     project_root.."/third_party/Vulkan-Headers/include",
@@ -34,6 +35,7 @@ project("xenia-gpu-shader-compiler")
     "xenia-gpu",
     "xenia-ui",
     "xenia-ui-vulkan",
+    "zstd",
   })
   includedirs({
     project_root.."/third_party/Vulkan-Headers/include",
@@ -53,3 +55,7 @@ project("xenia-gpu-shader-compiler")
         "1>scratch/stdout-shader-compiler.txt",
       })
     end
+
+if enableTests then
+  include("testing")
+end
@@ -20,6 +20,7 @@
 #include "xenia/base/logging.h"
 #include "xenia/base/math.h"
 #include "xenia/base/profiling.h"
+#include "xenia/base/threading.h"
 #include "xenia/gpu/register_file.h"
 #include "xenia/gpu/registers.h"
 #include "xenia/gpu/shader.h"
@@ -68,6 +69,26 @@ DEFINE_int32(
     "while a very low value may result in excessive locking and lookups.\n"
     "Negative values disable caching.",
     "GPU");
+DEFINE_bool(
+    primitive_processor_hash_cache, true,
+    "Reuse processed indices within a frame for draws with fewer indices than "
+    "primitive_processor_cache_min_indices, identifying them by a hash of the "
+    "guest indices rather than by their address. Requires no locking or "
+    "memory protection, so it's cheap enough for small repeated draws.",
+    "GPU");
+DEFINE_int32(
+    primitive_processor_parallel_min_indices, 32768,
+    "Smallest number of host indices produced by primitive type conversion or "
+    "reset index replacement for the processing to be split between multiple "
+    "threads.\n"
+    "Negative values disable multithreaded processing.",
+    "GPU");
+DEFINE_uint32(
+    primitive_processor_worker_threads, 0,
+    "Number of threads processing large index buffers together with the "
+    "command processor thread, or 0 to choose based on the number of logical "
+    "processors.",
+    "GPU");
 
 namespace xe {
 namespace gpu {
@@ -125,6 +146,18 @@ bool PrimitiveProcessor::InitializeCommon(
   expand_rectangle_lists_in_vs_ =
       !rectangle_lists_supported_without_vs_expansion;
 
+  if (cvars::primitive_processor_parallel_min_indices >= 0) {
+    uint32_t worker_thread_count = cvars::primitive_processor_worker_threads;
+    if (!worker_thread_count) {
+      worker_thread_count =
+          std::min(xe::threading::logical_processor_count() / 4, uint32_t(3));
+    }
+    if (worker_thread_count) {
+      conversion_worker_pool_ = std::make_unique<WorkerPool>(
+          worker_thread_count, "GPU Index Conversion");
+    }
+  }
+
   // Initialize the index buffer for conversion of auto-indexed primitive types.
   size_t builtin_index_buffer_size = 0;
   // 32-bit, before 16-bit due to alignment (for primitive expansion - when the
@@ -241,6 +274,8 @@ bool PrimitiveProcessor::InitializeCommon(
 }
 
 void PrimitiveProcessor::ShutdownCommon() {
+  conversion_worker_pool_.reset();
+  hash_cache_.NextFrame();
   if (memory_invalidation_callback_handle_) {
     // Clear the cache if it has ever been used and unregister the invalidation
     // callback.
@@ -261,6 +296,7 @@ void PrimitiveProcessor::ShutdownCommon() {
 }
 
 void PrimitiveProcessor::ClearPerFrameCache() {
+  hash_cache_.NextFrame();
   if (!memory_invalidation_callback_handle_) {
     // Only do clearing if cache has ever been used.
     return;
@@ -278,6 +314,107 @@ void PrimitiveProcessor::ClearPerFrameCache() {
               sizeof(cache_buckets_non_empty_l2_));
 }
 
+uint32_t PrimitiveProcessor::GetConversionChunkCount(
+    uint32_t host_index_count) const {
+  if (!conversion_worker_pool_ ||
+      cvars::primitive_processor_parallel_min_indices < 0 ||
+      host_index_count <
+          uint32_t(cvars::primitive_processor_parallel_min_indices)) {
+    return 1;
+  }
+  // A few chunks per thread for load balancing, but big enough for the
+  // synchronization to pay off.
+  return std::clamp(host_index_count / kMinConversionChunkIndices, uint32_t(1),
+                    (conversion_worker_pool_->thread_count() + 1) * 2);
+}
+
+template <typename Index, typename IndexTransform>
+void PrimitiveProcessor::ConvertSinglePrimitiveRangesChunked(
+    Index* dest, const Index* source,
+    xenos::PrimitiveType source_primitive_type,
+    const IndexTransform& index_transform, uint32_t host_index_count) {
+  auto ranges_beginning = single_primitive_ranges_.cbegin();
+  uint32_t chunk_count = GetConversionChunkCount(host_index_count);
+  if (chunk_count <= 1) {
+    ConvertSinglePrimitiveRanges(dest, source, source_primitive_type,
+                                 index_transform, ranges_beginning,
+                                 single_primitive_ranges_.cend());
+    return;
+  }
+  WorkerPool* pool = conversion_worker_pool_.get();
+
+  if (single_primitive_ranges_.size() == 1) {
+    // One large primitive - split it into runs of its triangles or indices.
+    const SinglePrimitiveRange& range = single_primitive_ranges_.front();
+    const Index* range_source = source + range.guest_offset;
+    switch (source_primitive_type) {
+      case xenos::PrimitiveType::kTriangleFan:
+        primitive_processor_chunks::ForEachChunk(
+            pool, range.host_index_count / 3, chunk_count,
+            [&](uint32_t first_triangle, uint32_t triangle_count) {
+              primitive_processor_chunks::TriangleFanToListPart(
+                  dest, range_source, first_triangle, triangle_count,
+                  index_transform);
+            });
+        break;
+      case xenos::PrimitiveType::kLineLoop:
+        primitive_processor_chunks::ForEachChunk(
+            pool, range.host_index_count, chunk_count,
+            [&](uint32_t first_index, uint32_t index_count) {
+              primitive_processor_chunks::LineLoopToStripPart(
+                  dest, range_source, range.guest_index_count, first_index,
+                  index_count, index_transform);
+            });
+        break;
+      case xenos::PrimitiveType::kQuadList:
+        primitive_processor_chunks::ForEachChunk(
+            pool, range.host_index_count / 6, chunk_count,
+            [&](uint32_t first_quad, uint32_t quad_count) {
+              primitive_processor_chunks::QuadListToTriangleListPart(
+                  dest, range_source, first_quad, quad_count,
+                  index_transform);
+            });
+        break;
+      default:
+        assert_unhandled_case(source_primitive_type);
+    }
+    return;
+  }
+
+  // Multiple primitives separated by reset indices - give every chunk a run of
+  // whole primitives with about the same total host index count.
+  struct RangeRun {
+    uint32_t range_begin;
+    uint32_t range_end;
+    uint32_t host_index_offset;
+  };
+  std::vector<RangeRun> runs;
+  runs.reserve(chunk_count + 1);
+  uint32_t run_host_index_count_target =
+      (host_index_count + chunk_count - 1) / chunk_count;
+  uint32_t range_count = uint32_t(single_primitive_ranges_.size());
+  RangeRun current_run = {};
+  uint32_t run_host_index_count = 0;
+  for (uint32_t i = 0; i < range_count; ++i) {
+    run_host_index_count += single_primitive_ranges_[i].host_index_count;
+    if (run_host_index_count >= run_host_index_count_target ||
+        i + 1 == range_count) {
+      current_run.range_end = i + 1;
+      runs.push_back(current_run);
+      current_run.range_begin = i + 1;
+      current_run.host_index_offset += run_host_index_count;
+      run_host_index_count = 0;
+    }
+  }
+  pool->ParallelFor(uint32_t(runs.size()), [&](uint32_t run_index) {
+    const RangeRun& run = runs[run_index];
+    ConvertSinglePrimitiveRanges(dest + run.host_index_offset, source,
+                                 source_primitive_type, index_transform,
+                                 ranges_beginning + run.range_begin,
+                                 ranges_beginning + run.range_end);
+  });
+}
+
 bool PrimitiveProcessor::Process(ProcessingResult& result_out) {
   SCOPE_profile_cpu_f("gpu");
 
@@ -683,9 +820,11 @@ bool PrimitiveProcessor::Process(ProcessingResult& result_out) {
       trace_writer_.WriteMemoryRead(guest_index_base,
                                     guest_index_buffer_needed_bytes);
       CacheTransaction cache_transaction(
-          *this, CacheKey(guest_index_base, guest_draw_vertex_count,
-                          guest_index_format, guest_index_endian,
-                          guest_primitive_reset_enabled, guest_primitive_type));
+          *this,
+          CacheKey(guest_index_base, guest_draw_vertex_count,
+                   guest_index_format, guest_index_endian,
+                   guest_primitive_reset_enabled, guest_primitive_type),
+          guest_primitive_reset_index_guest_endian);
       if (cache_transaction.GetFoundResult()) {
         cacheable = *cache_transaction.GetFoundResult();
       } else {
@@ -741,10 +880,9 @@ bool PrimitiveProcessor::Process(ProcessingResult& result_out) {
           if (!host_indices) {
             return false;
           }
-          ConvertSinglePrimitiveRanges(
+          ConvertSinglePrimitiveRangesChunked(
               host_indices, guest_indices, guest_primitive_type,
-              PassthroughIndexTransform(), single_primitive_ranges_.cbegin(),
-              single_primitive_ranges_.cend());
+              PassthroughIndexTransform(), cacheable.host_draw_vertex_count);
         } else {
           // 32-bit indices - may need to pre-swap and pre-mask also if the host
           // doesn't support full 32-bit vertex indices.
@@ -775,43 +913,35 @@ bool PrimitiveProcessor::Process(ProcessingResult& result_out) {
           if (!host_indices) {
             return false;
           }
-          auto single_primitive_ranges_beginning =
-              single_primitive_ranges_.cbegin();
-          auto single_primitive_ranges_end = single_primitive_ranges_.cend();
           if (full_32bit_vertex_indices_used_) {
-            ConvertSinglePrimitiveRanges(
+            ConvertSinglePrimitiveRangesChunked(
                 host_indices, guest_indices, guest_primitive_type,
-                PassthroughIndexTransform(), single_primitive_ranges_beginning,
-                single_primitive_ranges_end);
+                PassthroughIndexTransform(), cacheable.host_draw_vertex_count);
           } else {
             switch (guest_index_endian) {
               case xenos::Endian::kNone:
-                ConvertSinglePrimitiveRanges(host_indices, guest_indices,
-                                             guest_primitive_type,
-                                             To24NonSwappingIndexTransform(),
-                                             single_primitive_ranges_beginning,
-                                             single_primitive_ranges_end);
+                ConvertSinglePrimitiveRangesChunked(
+                    host_indices, guest_indices, guest_primitive_type,
+                    To24NonSwappingIndexTransform(),
+                    cacheable.host_draw_vertex_count);
                 break;
               case xenos::Endian::k8in16:
-                ConvertSinglePrimitiveRanges(host_indices, guest_indices,
-                                             guest_primitive_type,
-                                             To24Swapping8In16IndexTransform(),
-                                             single_primitive_ranges_beginning,
-                                             single_primitive_ranges_end);
+                ConvertSinglePrimitiveRangesChunked(
+                    host_indices, guest_indices, guest_primitive_type,
+                    To24Swapping8In16IndexTransform(),
+                    cacheable.host_draw_vertex_count);
                 break;
               case xenos::Endian::k8in32:
-                ConvertSinglePrimitiveRanges(host_indices, guest_indices,
-                                             guest_primitive_type,
-                                             To24Swapping8In32IndexTransform(),
-                                             single_primitive_ranges_beginning,
-                                             single_primitive_ranges_end);
+                ConvertSinglePrimitiveRangesChunked(
+                    host_indices, guest_indices, guest_primitive_type,
+                    To24Swapping8In32IndexTransform(),
+                    cacheable.host_draw_vertex_count);
                 break;
               case xenos::Endian::k16in32:
-                ConvertSinglePrimitiveRanges(host_indices, guest_indices,
-                                             guest_primitive_type,
-                                             To24Swapping16In32IndexTransform(),
-                                             single_primitive_ranges_beginning,
-                                             single_primitive_ranges_end);
+                ConvertSinglePrimitiveRangesChunked(
+                    host_indices, guest_indices, guest_primitive_type,
+                    To24Swapping16In32IndexTransform(),
+                    cacheable.host_draw_vertex_count);
                 break;
               default:
                 assert_unhandled_case(guest_index_endian);
@@ -848,9 +978,11 @@ bool PrimitiveProcessor::Process(ProcessingResult& result_out) {
             // Not specifying the primitive type in the cache key because not
             // replacing it, only the reset index in a type-independent way.
             CacheTransaction cache_transaction(
-                *this, CacheKey(guest_index_base, guest_draw_vertex_count,
-                                guest_index_format, guest_index_endian,
-                                guest_primitive_reset_enabled));
+                *this,
+                CacheKey(guest_index_base, guest_draw_vertex_count,
+                         guest_index_format, guest_index_endian,
+                         guest_primitive_reset_enabled),
+                guest_primitive_reset_index_guest_endian);
             if (cache_transaction.GetFoundResult()) {
               cacheable = *cache_transaction.GetFoundResult();
             } else {
@@ -875,17 +1007,24 @@ bool PrimitiveProcessor::Process(ProcessingResult& result_out) {
                 if (!host_indices_ptr) {
                   return false;
                 }
-                if (is_ffff_used_as_vertex_index) {
-                  ReplaceResetIndex16To24(
-                      reinterpret_cast<uint32_t*>(host_indices_ptr),
-                      guest_indices, guest_draw_vertex_count,
-                      guest_primitive_reset_index_guest_endian);
-                } else {
-                  ReplaceResetIndex16To16(
-                      reinterpret_cast<uint16_t*>(host_indices_ptr),
-                      guest_indices, guest_draw_vertex_count,
-                      guest_primitive_reset_index_guest_endian);
-                }
+                primitive_processor_chunks::ForEachChunk(
+                    conversion_worker_pool_.get(), guest_draw_vertex_count,
+                    GetConversionChunkCount(guest_draw_vertex_count),
+                    [&](uint32_t first_index, uint32_t index_count) {
+                      if (is_ffff_used_as_vertex_index) {
+                        ReplaceResetIndex16To24(
+                            reinterpret_cast<uint32_t*>(host_indices_ptr) +
+                                first_index,
+                            guest_indices + first_index, index_count,
+                            guest_primitive_reset_index_guest_endian);
+                      } else {
+                        ReplaceResetIndex16To16(
+                            reinterpret_cast<uint16_t*>(host_indices_ptr) +
+                                first_index,
+                            guest_indices + first_index, index_count,
+                            guest_primitive_reset_index_guest_endian);
+                      }
+                    });
               }
               cache_transaction.SetNewResult(cacheable);
             }
@@ -906,9 +1045,11 @@ bool PrimitiveProcessor::Process(ProcessingResult& result_out) {
           // Not specifying the primitive type in the cache key because not
           // replacing it, only the reset index in a type-independent way.
           CacheTransaction cache_transaction(
-              *this, CacheKey(guest_index_base, guest_draw_vertex_count,
-                              guest_index_format, guest_index_endian,
-                              guest_primitive_reset_enabled));
+              *this,
+              CacheKey(guest_index_base, guest_draw_vertex_count,
+                       guest_index_format, guest_index_endian,
+                       guest_primitive_reset_enabled),
+              guest_primitive_reset_index_guest_endian);
           if (cache_transaction.GetFoundResult()) {
             cacheable = *cache_transaction.GetFoundResult();
           } else {
@@ -926,31 +1067,37 @@ bool PrimitiveProcessor::Process(ProcessingResult& result_out) {
               if (!host_indices) {
                 return false;
               }
+              void (*replace_reset_index)(uint32_t* dest,
+                                          const uint32_t* source,
+                                          uint32_t count,
+                                          uint32_t reset_index_guest_endian,
+                                          uint32_t low_bits_mask_guest_endian);
               if (full_32bit_vertex_indices_used_ ||
                   guest_index_endian == xenos::Endian::kNone) {
-                ReplaceResetIndex32To24<xenos::Endian::kNone>(
-                    host_indices, guest_indices, guest_draw_vertex_count,
-                    guest_primitive_reset_index_guest_endian,
-                    guest_index_mask_guest_endian);
+                replace_reset_index =
+                    ReplaceResetIndex32To24<xenos::Endian::kNone>;
               } else if (guest_index_endian == xenos::Endian::k8in16) {
-                ReplaceResetIndex32To24<xenos::Endian::k8in16>(
-                    host_indices, guest_indices, guest_draw_vertex_count,
-                    guest_primitive_reset_index_guest_endian,
-                    guest_index_mask_guest_endian);
+                replace_reset_index =
+                    ReplaceResetIndex32To24<xenos::Endian::k8in16>;
               } else if (guest_index_endian == xenos::Endian::k8in32) {
-                ReplaceResetIndex32To24<xenos::Endian::k8in32>(
-                    host_indices, guest_indices, guest_draw_vertex_count,
-                    guest_primitive_reset_index_guest_endian,
-                    guest_index_mask_guest_endian);
+                replace_reset_index =
+                    ReplaceResetIndex32To24<xenos::Endian::k8in32>;
               } else if (guest_index_endian == xenos::Endian::k16in32) {
-                ReplaceResetIndex32To24<xenos::Endian::k16in32>(
-                    host_indices, guest_indices, guest_draw_vertex_count,
-                    guest_primitive_reset_index_guest_endian,
-                    guest_index_mask_guest_endian);
+                replace_reset_index =
+                    ReplaceResetIndex32To24<xenos::Endian::k16in32>;
               } else {
                 assert_unhandled_case(guest_index_endian);
                 return false;
               }
+              primitive_processor_chunks::ForEachChunk(
+                  conversion_worker_pool_.get(), guest_draw_vertex_count,
+                  GetConversionChunkCount(guest_draw_vertex_count),
+                  [&](uint32_t first_index, uint32_t index_count) {
+                    replace_reset_index(
+                        host_indices + first_index, guest_indices + first_index,
+                        index_count, guest_primitive_reset_index_guest_endian,
+                        guest_index_mask_guest_endian);
+                  });
               cacheable.host_shader_index_endian =
                   full_32bit_vertex_indices_used_ ? guest_index_endian
                                                   : xenos::Endian::kNone;
@@ -1412,21 +1559,34 @@ uint32_t PrimitiveProcessor::GetMultiPrimitiveHostIndexCountAndRanges(
 }
 
 PrimitiveProcessor::CacheTransaction::CacheTransaction(
-    PrimitiveProcessor& processor, CacheKey key)
+    PrimitiveProcessor& processor, CacheKey key,
+    uint32_t reset_index_guest_endian)
     : processor_(processor), key_(key) {
   assert_zero(processor_.cache_currently_processing_size_bytes_);
-  if (cvars::primitive_processor_cache_min_indices < 0 ||
-      key_.count < uint32_t(cvars::primitive_processor_cache_min_indices)) {
-    // Don't cache if the vertex count is too small.
+  if (cvars::primitive_processor_cache_min_indices < 0) {
     key_.key = 0;
+    return;
   }
-  if (!key_.count) {
+  if (key_.count < uint32_t(cvars::primitive_processor_cache_min_indices)) {
+    // Too small for locking and protecting pages to pay off - hash the
+    // indices instead if allowed.
+    if (cvars::primitive_processor_hash_cache && key_.count) {
+      hash_key_ = PrimitiveProcessorHashCache<CachedResult>::MakeKey(
+          processor_.memory_.TranslatePhysical(key_.base),
+          key_.GetSizeBytes(),
+          key_.GetHashCacheParameters(reset_index_guest_endian));
+      hash_key_valid_ = true;
+      const CachedResult* hash_cache_result =
+          processor_.hash_cache_.Find(hash_key_);
+      if (hash_cache_result) {
+        result_ = *hash_cache_result;
+        result_type_ = ResultType::kExisting;
+      }
+    }
+    key_.key = 0;
     return;
   }
-  uint32_t size_bytes =
-      (key_.format == xenos::IndexFormat::kInt16 ? sizeof(uint16_t)
-                                                 : sizeof(uint32_t)) *
-      key_.count;
+  uint32_t size_bytes = key_.GetSizeBytes();
   {
     auto global_lock = processor_.global_critical_region_.Acquire();
     auto cache_map_it = processor_.cache_map_.find(key_);
@@ -1456,6 +1616,10 @@ PrimitiveProcessor::CacheTransaction::CacheTransaction(
 }
 
 PrimitiveProcessor::CacheTransaction::~CacheTransaction() {
+  if (hash_key_valid_ && result_type_ == ResultType::kNewSet) {
+    processor_.hash_cache_.Insert(hash_key_, result_);
+    return;
+  }
   if (!key_.count || result_type_ == ResultType::kExisting) {
     return;
   }
@@ -17,15 +17,20 @@
 #include <cstring>
 #include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "xenia/base/assert.h"
 #include "xenia/base/cvar.h"
 #include "xenia/base/math.h"
 #include "xenia/base/mutex.h"
 #include "xenia/base/platform.h"
+#include "xenia/base/worker_pool.h"
+#include "xenia/gpu/primitive_processor_chunks.h"
+#include "xenia/gpu/primitive_processor_hash_cache.h"
 #include "xenia/gpu/register_file.h"
 #include "xenia/gpu/shader.h"
 #include "xenia/gpu/shared_memory.h"
@@ -556,15 +561,8 @@ class PrimitiveProcessor {
       // To match GetTriangleFanListIndexCount.
       return;
     }
-    Index index_first = index_transform(source[0]);
-    Index index_previous = index_transform(source[1]);
-    for (uint32_t i = 2; i < source_index_count; ++i) {
-      Index index_current = index_transform(source[i]);
-      *(dest++) = index_previous;
-      *(dest++) = index_current;
-      *(dest++) = index_first;
-      index_previous = index_current;
-    }
+    primitive_processor_chunks::TriangleFanToListPart(
+        dest, source, 0, source_index_count - 2, index_transform);
   }
 
   static constexpr uint32_t GetLineLoopStripIndexCount(
@@ -583,12 +581,9 @@ class PrimitiveProcessor {
       // To match GetLineLoopStripIndexCount.
       return;
     }
-    Index index_first = index_transform(source[0]);
-    dest[0] = index_first;
-    for (uint32_t i = 1; i < source_index_count; ++i) {
-      dest[i] = index_transform(source[i]);
-    }
-    dest[source_index_count] = index_first;
+    primitive_processor_chunks::LineLoopToStripPart(
+        dest, source, source_index_count, 0, source_index_count + 1,
+        index_transform);
   }
   static void LineLoopToStrip(uint16_t* dest, const uint16_t* source,
                               uint32_t source_index_count,
@@ -607,20 +602,9 @@ class PrimitiveProcessor {
   static void QuadListToTriangleList(Index* dest, const Index* source,
                                      uint32_t source_index_count,
                                      const IndexTransform& index_transform) {
-    uint32_t quad_count = source_index_count / 4;
-    for (uint32_t i = 0; i < quad_count; ++i) {
-      // TODO(Triang3l): Find the correct order.
-      // v0, v1, v2.
-      Index common_index_0 = index_transform(*(source++));
-      *(dest++) = common_index_0;
-      *(dest++) = index_transform(*(source++));
-      Index common_index_2 = index_transform(*(source++));
-      *(dest++) = common_index_2;
-      // v0, v2, v3.
-      *(dest++) = common_index_0;
-      *(dest++) = common_index_2;
-      *(dest++) = index_transform(*(source++));
-    }
+    // TODO(Triang3l): Find the correct order.
+    primitive_processor_chunks::QuadListToTriangleListPart(
+        dest, source, 0, source_index_count / 4, index_transform);
   }
 
   // Pre-gathering the ranges allows for usage of the same functions for
@@ -690,6 +674,20 @@ class PrimitiveProcessor {
     }
   }
 
+  // Host index count below which splitting processing into more chunks is not
+  // worth the synchronization.
+  static constexpr uint32_t kMinConversionChunkIndices = 8192;
+  // 1 if processing producing host_index_count indices should be done on the
+  // current thread only.
+  uint32_t GetConversionChunkCount(uint32_t host_index_count) const;
+  // ConvertSinglePrimitiveRanges for single_primitive_ranges_, split between
+  // the conversion worker threads if the draw is large.
+  template <typename Index, typename IndexTransform>
+  void ConvertSinglePrimitiveRangesChunked(
+      Index* dest, const Index* source,
+      xenos::PrimitiveType source_primitive_type,
+      const IndexTransform& index_transform, uint32_t host_index_count);
+
   const RegisterFile& register_file_;
   Memory& memory_;
   TraceWriter& trace_writer_;
@@ -709,6 +707,9 @@ class PrimitiveProcessor {
 
   std::deque<SinglePrimitiveRange> single_primitive_ranges_;
 
+  // Null if large index buffers are processed only on the calling thread.
+  std::unique_ptr<WorkerPool> conversion_worker_pool_;
+
   // Caching for reuse of converted indices within a frame.
 
   // 256 KB as the largest possible guest index buffer - 0xFFFF 32-bit indices -
@@ -763,6 +764,14 @@ class PrimitiveProcessor {
       return count * (format == xenos::IndexFormat::kInt16 ? sizeof(uint16_t)
                                                            : sizeof(uint32_t));
     }
+
+    // Parameters for the content hash cache, where the address doesn't matter,
+    // but the reset index does.
+    uint64_t GetHashCacheParameters(uint32_t reset_index_guest_endian) const {
+      CacheKey parameters_key = *this;
+      parameters_key.base = is_reset_enabled ? reset_index_guest_endian : 0;
+      return parameters_key.key;
+    }
   };
 
   // Subset of ConversionResult that can be reused for different primitive types
@@ -825,9 +834,12 @@ class PrimitiveProcessor {
   // If an entry was found in the cache (GetFoundResult results non-null), it
   // MUST be used instead of processing - this class doesn't provide the
   // possibility replace existing entries.
+  // Index counts below the address-keyed cache threshold use the content hash
+  // cache instead, which involves neither locking nor access callbacks.
   class CacheTransaction final {
    public:
-    CacheTransaction(PrimitiveProcessor& processor, CacheKey key);
+    CacheTransaction(PrimitiveProcessor& processor, CacheKey key,
+                     uint32_t reset_index_guest_endian);
     const CachedResult* GetFoundResult() const {
       return result_type_ == ResultType::kExisting ? &result_ : nullptr;
     }
@@ -846,6 +858,9 @@ class PrimitiveProcessor {
     // special logic, and count == 0 is also used as a special indicator for
     // vertex count below the cache usage threshold.
     CacheKey key_;
+    // Used instead of the address-keyed cache if hash_key_valid_.
+    PrimitiveProcessorHashCache<CachedResult>::Key hash_key_;
+    bool hash_key_valid_ = false;
     CachedResult result_;
     enum class ResultType {
       kNewUnset,
@@ -857,6 +872,9 @@ class PrimitiveProcessor {
 
   std::deque<CacheEntry> cache_entry_pool_;
 
+  // Only accessed by the processor, not by the invalidation callback.
+  PrimitiveProcessorHashCache<CachedResult> hash_cache_;
+
   void* memory_invalidation_callback_handle_ = nullptr;
 
   xe::global_critical_region global_critical_region_;
@@ -0,0 +1,131 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#ifndef XENIA_GPU_PRIMITIVE_PROCESSOR_CHUNKS_H_
+#define XENIA_GPU_PRIMITIVE_PROCESSOR_CHUNKS_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+
+#include "xenia/base/math.h"
+#include "xenia/base/worker_pool.h"
+
+namespace xe {
+namespace gpu {
+
+// Splitting of index buffer conversion of a single large primitive into
+// chunks that can be processed on multiple threads, with the output
+// bit-identical to converting the whole primitive at once.
+//
+// A chunk consists of whole output units - triangles for triangle fans and
+// quad lists, or individual indices for line loops and primitive reset index
+// replacement - and chunk boundaries are multiples of kUnitAlignment units.
+// A unit is at least one 16-bit index, so chunk boundaries are at multiples of
+// 64 bytes from the beginning of the destination, and chunks don't share cache
+// lines as long as the destination is aligned.
+namespace primitive_processor_chunks {
+
+constexpr uint32_t kUnitAlignment = 32;
+
+// Calls function(first_unit, unit_count) for chunks covering
+// [0, total_unit_count), on the pool if there's more than one chunk.
+inline void ForEachChunk(
+    WorkerPool* pool, uint32_t total_unit_count, uint32_t chunk_count,
+    const std::function<void(uint32_t first_unit, uint32_t unit_count)>&
+        function) {
+  if (!total_unit_count) {
+    return;
+  }
+  uint32_t chunk_unit_count = total_unit_count;
+  if (pool && chunk_count > 1) {
+    chunk_unit_count = xe::align(
+        (total_unit_count + chunk_count - 1) / chunk_count, kUnitAlignment);
+  }
+  chunk_count = (total_unit_count + chunk_unit_count - 1) / chunk_unit_count;
+  if (chunk_count <= 1) {
+    function(0, total_unit_count);
+    return;
+  }
+  pool->ParallelFor(chunk_count, [&](uint32_t chunk) {
+    uint32_t first_unit = chunk * chunk_unit_count;
+    function(first_unit,
+             std::min(chunk_unit_count, total_unit_count - first_unit));
+  });
+}
+
+// The parts below take the pointers to the beginning of the whole primitive
+// in the source and in the destination, and write only the destination
+// indices of the requested units.
+
+// Triangles [first_triangle, first_triangle + triangle_count), as
+// (v1, v2, v0), (v2, v3, v0) - like PrimitiveProcessor::TriangleFanToList.
+template <typename Index, typename IndexTransform>
+void TriangleFanToListPart(Index* dest, const Index* source,
+                           uint32_t first_triangle, uint32_t triangle_count,
+                           const IndexTransform& index_transform) {
+  if (!triangle_count) {
+    return;
+  }
+  dest += first_triangle * 3;
+  Index index_first = index_transform(source[0]);
+  Index index_previous = index_transform(source[first_triangle + 1]);
+  uint32_t source_end = first_triangle + triangle_count + 2;
+  for (uint32_t i = first_triangle + 2; i < source_end; ++i) {
+    Index index_current = index_transform(source[i]);
+    *(dest++) = index_previous;
+    *(dest++) = index_current;
+    *(dest++) = index_first;
+    index_previous = index_current;
+  }
+}
+
+// Strip indices [first_index, first_index + index_count) out of
+// source_index_count + 1, the last being the closing index.
+template <typename Index, typename IndexTransform>
+void LineLoopToStripPart(Index* dest, const Index* source,
+                         uint32_t source_index_count, uint32_t first_index,
+                         uint32_t index_count,
+                         const IndexTransform& index_transform) {
+  uint32_t end_index = first_index + index_count;
+  uint32_t copy_end_index = std::min(end_index, source_index_count);
+  for (uint32_t i = first_index; i < copy_end_index; ++i) {
+    dest[i] = index_transform(source[i]);
+  }
+  if (end_index > source_index_count) {
+    dest[source_index_count] = index_transform(source[0]);
+  }
+}
+
+// Quads [first_quad, first_quad + quad_count), as (v0, v1, v2), (v0, v2, v3)
+// - like PrimitiveProcessor::QuadListToTriangleList.
+template <typename Index, typename IndexTransform>
+void QuadListToTriangleListPart(Index* dest, const Index* source,
+                                uint32_t first_quad, uint32_t quad_count,
+                                const IndexTransform& index_transform) {
+  dest += first_quad * 6;
+  source += first_quad * 4;
+  for (uint32_t i = 0; i < quad_count; ++i) {
+    Index common_index_0 = index_transform(*(source++));
+    *(dest++) = common_index_0;
+    *(dest++) = index_transform(*(source++));
+    Index common_index_2 = index_transform(*(source++));
+    *(dest++) = common_index_2;
+    *(dest++) = common_index_0;
+    *(dest++) = common_index_2;
+    *(dest++) = index_transform(*(source++));
+  }
+}
+
+}  // namespace primitive_processor_chunks
+
+}  // namespace gpu
+}  // namespace xe
+
+#endif  // XENIA_GPU_PRIMITIVE_PROCESSOR_CHUNKS_H_
@@ -0,0 +1,115 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#ifndef XENIA_GPU_PRIMITIVE_PROCESSOR_HASH_CACHE_H_
+#define XENIA_GPU_PRIMITIVE_PROCESSOR_HASH_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "xenia/base/xxhash.h"
+
+namespace xe {
+namespace gpu {
+
+// Cache of primitive processing results within a frame, keyed by an XXH3 hash
+// of the guest indices and the processing parameters rather than by the guest
+// address.
+//
+// Unlike the address-keyed cache of the PrimitiveProcessor, modified indices
+// simply produce a different key, so no page protection (and therefore no
+// global critical region locking against the invalidation callback) is needed.
+// This makes it cheap enough for small, frequently repeated draws, and
+// identical index buffers at different addresses share the result too.
+//
+// Entries are tagged with the frame they were inserted in, so dropping the
+// previous frame's results (which reference host buffers that are only valid
+// for that frame) is O(1). Only to be used from a single thread.
+template <typename Result>
+class PrimitiveProcessorHashCache {
+ public:
+  struct Key {
+    uint64_t hash;
+    uint64_t parameters;
+  };
+
+  static Key MakeKey(const void* indices, size_t size_bytes,
+                     uint64_t parameters) {
+    return {XXH3_64bits_withSeed(indices, size_bytes, parameters),
+            parameters};
+  }
+
+  explicit PrimitiveProcessorHashCache(uint32_t slot_count_log2 = 12)
+      : slots_(size_t(1) << slot_count_log2),
+        slot_mask_((uint32_t(1) << slot_count_log2) - 1) {}
+
+  const Result* Find(const Key& key) const {
+    uint32_t slot_index = uint32_t(key.hash) & slot_mask_;
+    for (uint32_t i = 0; i < kMaxProbes; ++i) {
+      const Slot& slot = slots_[(slot_index + i) & slot_mask_];
+      if (slot.frame != frame_) {
+        // Slots are filled in probe order, so the key can't be further.
+        return nullptr;
+      }
+      if (slot.hash == key.hash && slot.parameters == key.parameters) {
+        return &slot.result;
+      }
+    }
+    return nullptr;
+  }
+
+  void Insert(const Key& key, const Result& result) {
+    uint32_t slot_index = uint32_t(key.hash) & slot_mask_;
+    Slot* target = &slots_[slot_index];
+    for (uint32_t i = 0; i < kMaxProbes; ++i) {
+      Slot& slot = slots_[(slot_index + i) & slot_mask_];
+      if (slot.frame != frame_) {
+        target = &slot;
+        break;
+      }
+    }
+    // If the probe sequence is full, replace the first entry in it.
+    target->hash = key.hash;
+    target->parameters = key.parameters;
+    target->frame = frame_;
+    target->result = result;
+  }
+
+  // Drops all the entries.
+  void NextFrame() {
+    if (++frame_ == 0) {
+      // Wrapped around - make sure no slot looks like it's from the new frame.
+      for (Slot& slot : slots_) {
+        slot.frame = 0;
+      }
+      frame_ = 1;
+    }
+  }
+
+ private:
+  static constexpr uint32_t kMaxProbes = 8;
+
+  struct Slot {
+    uint64_t hash = 0;
+    uint64_t parameters = 0;
+    // 0 is never a current frame.
+    uint32_t frame = 0;
+    Result result;
+  };
+
+  std::vector<Slot> slots_;
+  uint32_t slot_mask_;
+  uint32_t frame_ = 1;
+};
+
+}  // namespace gpu
+}  // namespace xe
+
+#endif  // XENIA_GPU_PRIMITIVE_PROCESSOR_HASH_CACHE_H_
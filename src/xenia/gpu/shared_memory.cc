@@ -15,6 +15,7 @@
 #include "xenia/base/bit_range.h"
 #include "xenia/base/logging.h"
 #include "xenia/base/profiling.h"
+#include "xenia/base/xxhash.h"
 
 namespace xe {
 namespace gpu {
@@ -434,6 +435,35 @@ bool SharedMemory::RequestRange(uint32_t start, uint32_t length,
   return UploadRanges(uploads, current_upload_range);
 }
 
+bool SharedMemory::HashCpuWrittenRange(uint32_t start, uint32_t length,
+                                       uint64_t& hash_out) {
+  if (start > kBufferSize || (kBufferSize - start) < length) {
+    return false;
+  }
+  if (length) {
+    uint32_t page_first = start >> page_size_log2_;
+    uint32_t page_last = (start + length - 1) >> page_size_log2_;
+    uint32_t block_first = page_first >> 6;
+    uint32_t block_last = page_last >> 6;
+    auto global_lock = global_critical_region_.Acquire();
+    for (uint32_t i = block_first; i <= block_last; ++i) {
+      uint64_t block_bits = UINT64_MAX;
+      if (i == block_first) {
+        block_bits &= ~((uint64_t(1) << (page_first & 63)) - 1);
+      }
+      if (i == block_last && (page_last & 63) != 63) {
+        block_bits &= (uint64_t(1) << ((page_last & 63) + 1)) - 1;
+      }
+      if (system_page_flags_valid_and_gpu_written_[i] & block_bits) {
+        return false;
+      }
+    }
+  }
+  SCOPE_profile_cpu_f("gpu");
+  hash_out = XXH3_64bits(memory().TranslatePhysical(start), length);
+  return true;
+}
+
 template <typename T>
 XE_FORCEINLINE XE_NOALIAS static T mod_shift_left(T value, uint32_t by) {
 #if XE_ARCH_AMD64 == 1
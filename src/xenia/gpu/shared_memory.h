@@ -74,6 +74,12 @@ class SharedMemory {
   bool RequestRange(uint32_t start, uint32_t length,
                     bool* any_data_resolved_out = nullptr);
 
+  // Computes the XXH3 of the guest data in a range previously requested, to
+  // detect rewrites with the same contents. Returns false if any page of it
+  // contains data written on the GPU, which may be missing in the main memory.
+  bool HashCpuWrittenRange(uint32_t start, uint32_t length,
+                           uint64_t& hash_out);
+
   void TryFindUploadRange(const uint32_t& block_first,
                           const uint32_t& block_last,
                           const uint32_t& page_first, const uint32_t& page_last,
@@ -0,0 +1,15 @@
+project_root = "../../../.."
+include(project_root.."/tools/build")
+
+test_suite("xenia-gpu-tests", project_root, ".", {
+  links = {
+    "fmt",
+    "snappy",
+    "xenia-base",
+    "xenia-core",
+    "xenia-cpu",
+    "xenia-gpu",
+    "xxhash",
+    "zstd",
+  },
+})
@@ -0,0 +1,211 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/gpu/primitive_processor_chunks.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "third_party/catch/include/catch.hpp"
+#include "third_party/fmt/include/fmt/format.h"
+
+#include "xenia/base/threading.h"
+
+namespace xe {
+namespace gpu {
+namespace test {
+
+namespace chunks = primitive_processor_chunks;
+
+struct Passthrough {
+  template <typename Index>
+  Index operator()(Index index) const {
+    return index;
+  }
+};
+
+struct Swap8In32Masked {
+  uint32_t operator()(uint32_t index) const {
+    index = (index >> 24) | ((index >> 8) & 0xFF00) |
+            ((index << 8) & 0xFF0000) | (index << 24);
+    return index & 0xFFFFFF;
+  }
+};
+
+enum class Conversion { kTriangleFan, kLineLoop, kQuadList };
+
+static uint32_t GetHostIndexCount(Conversion conversion, uint32_t count) {
+  switch (conversion) {
+    case Conversion::kTriangleFan:
+      return count > 2 ? (count - 2) * 3 : 0;
+    case Conversion::kLineLoop:
+      return count > 1 ? count + 1 : 0;
+    case Conversion::kQuadList:
+      return (count / 4) * 6;
+  }
+  return 0;
+}
+
+// Straightforward whole-primitive conversion.
+template <typename Index, typename IndexTransform>
+static std::vector<Index> ConvertReference(Conversion conversion,
+                                           const std::vector<Index>& source,
+                                           const IndexTransform& transform) {
+  std::vector<Index> dest;
+  uint32_t count = uint32_t(source.size());
+  switch (conversion) {
+    case Conversion::kTriangleFan:
+      for (uint32_t i = 2; i < count; ++i) {
+        dest.push_back(transform(source[i - 1]));
+        dest.push_back(transform(source[i]));
+        dest.push_back(transform(source[0]));
+      }
+      break;
+    case Conversion::kLineLoop:
+      if (count > 1) {
+        for (uint32_t i = 0; i < count; ++i) {
+          dest.push_back(transform(source[i]));
+        }
+        dest.push_back(transform(source[0]));
+      }
+      break;
+    case Conversion::kQuadList:
+      for (uint32_t i = 0; i + 4 <= count; i += 4) {
+        for (uint32_t j : {0, 1, 2, 0, 2, 3}) {
+          dest.push_back(transform(source[i + j]));
+        }
+      }
+      break;
+  }
+  return dest;
+}
+
+template <typename Index, typename IndexTransform>
+static void ConvertChunked(WorkerPool* pool, uint32_t chunk_count,
+                           Conversion conversion, Index* dest,
+                           const std::vector<Index>& source,
+                           const IndexTransform& transform) {
+  uint32_t count = uint32_t(source.size());
+  uint32_t host_count = GetHostIndexCount(conversion, count);
+  switch (conversion) {
+    case Conversion::kTriangleFan:
+      chunks::ForEachChunk(pool, host_count / 3, chunk_count,
+                           [&](uint32_t first, uint32_t unit_count) {
+                             chunks::TriangleFanToListPart(
+                                 dest, source.data(), first, unit_count,
+                                 transform);
+                           });
+      break;
+    case Conversion::kLineLoop:
+      chunks::ForEachChunk(pool, host_count, chunk_count,
+                           [&](uint32_t first, uint32_t unit_count) {
+                             chunks::LineLoopToStripPart(
+                                 dest, source.data(), count, first, unit_count,
+                                 transform);
+                           });
+      break;
+    case Conversion::kQuadList:
+      chunks::ForEachChunk(pool, host_count / 6, chunk_count,
+                           [&](uint32_t first, uint32_t unit_count) {
+                             chunks::QuadListToTriangleListPart(
+                                 dest, source.data(), first, unit_count,
+                                 transform);
+                           });
+      break;
+  }
+}
+
+template <typename Index, typename IndexTransform>
+static void TestConversions(WorkerPool& pool, const IndexTransform& transform) {
+  std::mt19937 random(0x58454E49);
+  for (Conversion conversion : {Conversion::kTriangleFan, Conversion::kLineLoop,
+                                Conversion::kQuadList}) {
+    for (uint32_t count : {0u, 1u, 2u, 3u, 4u, 5u, 97u, 1000u, 65535u}) {
+      std::vector<Index> source(count);
+      for (Index& index : source) {
+        index = Index(random());
+      }
+      std::vector<Index> reference =
+          ConvertReference(conversion, source, transform);
+      REQUIRE(reference.size() == GetHostIndexCount(conversion, count));
+      for (uint32_t chunk_count : {1u, 2u, 3u, 8u, 1000u}) {
+        // Canary after the end to check for overruns.
+        std::vector<Index> dest(reference.size() + 1, Index(0xCDCDCDCD));
+        ConvertChunked(&pool, chunk_count, conversion, dest.data(), source,
+                       transform);
+        REQUIRE(dest.back() == Index(0xCDCDCDCD));
+        dest.pop_back();
+        REQUIRE(dest == reference);
+      }
+    }
+  }
+}
+
+TEST_CASE("Chunked primitive conversion matches whole conversion",
+          "[primitive_processor]") {
+  WorkerPool pool(3, "Primitive Processor Test");
+  TestConversions<uint16_t>(pool, Passthrough());
+  TestConversions<uint32_t>(pool, Passthrough());
+  TestConversions<uint32_t>(pool, Swap8In32Masked());
+}
+
+TEST_CASE("Chunk boundaries are cache line aligned", "[primitive_processor]") {
+  WorkerPool pool(3, "Primitive Processor Test");
+  std::vector<uint32_t> firsts(16, UINT32_MAX);
+  std::atomic<uint32_t> chunk_index = 0;
+  chunks::ForEachChunk(&pool, 100000, 7, [&](uint32_t first, uint32_t count) {
+    firsts[chunk_index++] = first;
+  });
+  REQUIRE(chunk_index == 7);
+  for (uint32_t i = 0; i < chunk_index; ++i) {
+    // The smallest unit is a 16-bit index.
+    REQUIRE((firsts[i] * sizeof(uint16_t)) % 64 == 0);
+  }
+}
+
+// Compares converting the largest possible triangle fan (0xFFFF guest indices)
+// on one thread and split between threads.
+// Run explicitly with the [.benchmark] tag.
+TEST_CASE("Chunked primitive conversion benchmark",
+          "[primitive_processor][.benchmark]") {
+  constexpr uint32_t kIterations = 2000;
+  std::vector<uint32_t> source(UINT16_MAX);
+  std::mt19937 random(0x58454E49);
+  for (uint32_t& index : source) {
+    index = random();
+  }
+  std::vector<uint32_t> dest(
+      GetHostIndexCount(Conversion::kTriangleFan, UINT16_MAX));
+  uint32_t max_thread_count =
+      std::min(xe::threading::logical_processor_count(), uint32_t(8));
+  for (uint32_t thread_count = 0; thread_count < max_thread_count;
+       thread_count = thread_count ? thread_count * 2 : 1) {
+    WorkerPool pool(thread_count, "Primitive Processor Benchmark");
+    uint32_t chunk_count = (thread_count + 1) * 2;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < kIterations; ++i) {
+      ConvertChunked(&pool, chunk_count, Conversion::kTriangleFan, dest.data(),
+                     source, Swap8In32Masked());
+    }
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    fmt::print("{} worker threads: {:.1f} us per draw, {:.0f} MB/s output\n",
+               thread_count, seconds * 1e6 / kIterations,
+               double(dest.size() * sizeof(uint32_t)) * kIterations / seconds /
+                   1e6);
+  }
+}
+
+}  // namespace test
+}  // namespace gpu
+}  // namespace xe
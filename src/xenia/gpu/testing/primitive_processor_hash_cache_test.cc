@@ -0,0 +1,223 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/gpu/primitive_processor_hash_cache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "third_party/catch/include/catch.hpp"
+#include "third_party/fmt/include/fmt/format.h"
+
+#include "xenia/base/math.h"
+#include "xenia/base/memory.h"
+
+namespace xe {
+namespace gpu {
+namespace test {
+
+using Cache = PrimitiveProcessorHashCache<uint32_t>;
+
+TEST_CASE("Primitive processor hash cache lookup", "[primitive_processor]") {
+  Cache cache(4);
+  const uint16_t indices[] = {0, 1, 2, 3, 4, 5};
+  Cache::Key key = Cache::MakeKey(indices, sizeof(indices), 1);
+  REQUIRE(cache.Find(key) == nullptr);
+  cache.Insert(key, 123);
+  REQUIRE(cache.Find(key) != nullptr);
+  REQUIRE(*cache.Find(key) == 123);
+
+  // Same indices with different processing parameters.
+  REQUIRE(cache.Find(Cache::MakeKey(indices, sizeof(indices), 2)) == nullptr);
+
+  // Modified indices.
+  uint16_t modified_indices[6];
+  std::memcpy(modified_indices, indices, sizeof(indices));
+  modified_indices[5] = 6;
+  REQUIRE(cache.Find(Cache::MakeKey(modified_indices, sizeof(indices), 1)) ==
+          nullptr);
+
+  cache.NextFrame();
+  REQUIRE(cache.Find(key) == nullptr);
+}
+
+TEST_CASE("Primitive processor hash cache collisions",
+          "[primitive_processor]") {
+  Cache cache(4);
+  // All keys have the same home slot.
+  for (uint32_t i = 0; i < 16; ++i) {
+    cache.Insert({uint64_t(i) << 32, 0}, i);
+  }
+  // The most recent insertion must always be found, and older ones either
+  // found with their own value or evicted.
+  REQUIRE(cache.Find({uint64_t(15) << 32, 0}) != nullptr);
+  REQUIRE(*cache.Find({uint64_t(15) << 32, 0}) == 15);
+  for (uint32_t i = 0; i < 15; ++i) {
+    const uint32_t* result = cache.Find({uint64_t(i) << 32, 0});
+    REQUIRE((result == nullptr || *result == i));
+  }
+}
+
+// Index streams shaped like those of small fan, strip and reset-index draws
+// in captured frames: a set of buffers of a few to a few thousand indices,
+// each drawn several times per frame, some from multiple addresses.
+struct IndexStream {
+  struct Draw {
+    uint32_t buffer;
+    uint32_t address;
+  };
+  std::vector<std::vector<uint16_t>> buffers;
+  std::vector<Draw> draws;
+
+  IndexStream(uint32_t buffer_count, uint32_t draws_per_frame) {
+    std::mt19937 random(0x58454E49);
+    const uint32_t sizes[] = {4, 6, 8, 16, 32, 64, 128, 256, 1024, 4095};
+    for (uint32_t i = 0; i < buffer_count; ++i) {
+      std::vector<uint16_t> buffer(sizes[random() % std::size(sizes)]);
+      for (uint16_t& index : buffer) {
+        index = uint16_t(random() % 0x1000);
+      }
+      buffers.push_back(std::move(buffer));
+    }
+    std::geometric_distribution<uint32_t> popularity(4.0 / buffer_count);
+    for (uint32_t i = 0; i < draws_per_frame; ++i) {
+      uint32_t buffer = std::min(popularity(random), buffer_count - 1);
+      // Each buffer has copies at 4 addresses.
+      draws.push_back(
+          {buffer, buffer * 0x8000 + uint32_t(random() % 4) * 0x2000});
+    }
+  }
+};
+
+static uint32_t ConvertTriangleFan(uint16_t* dest, const uint16_t* source,
+                                   uint32_t count) {
+  for (uint32_t i = 2; i < count; ++i) {
+    *(dest++) = source[i - 1];
+    *(dest++) = source[i];
+    *(dest++) = source[0];
+  }
+  return count > 2 ? (count - 2) * 3 : 0;
+}
+
+// Compares processing small draws without caching, with a model of the
+// address-keyed cache (global lock, map lookup, and protecting the pages of
+// new entries, which the guest then has to fault on to rewrite), and with the
+// content hash cache.
+// Run explicitly with the [.benchmark] tag.
+TEST_CASE("Primitive processor cache benchmark",
+          "[primitive_processor][.benchmark]") {
+  constexpr uint32_t kFrames = 200;
+  IndexStream stream(256, 2000);
+
+  const size_t page_size = xe::memory::page_size();
+  const size_t guest_size = stream.buffers.size() * 0x8000;
+  auto guest_memory = static_cast<uint8_t*>(xe::memory::AllocFixed(
+      nullptr, guest_size, xe::memory::AllocationType::kReserveCommit,
+      xe::memory::PageAccess::kReadWrite));
+  REQUIRE(guest_memory);
+  for (const IndexStream::Draw& draw : stream.draws) {
+    const auto& buffer = stream.buffers[draw.buffer];
+    std::memcpy(guest_memory + draw.address, buffer.data(),
+                buffer.size() * sizeof(uint16_t));
+  }
+  std::vector<uint16_t> frame_buffer(stream.draws.size() * 3 * 4096);
+
+  auto run = [&](const char* name, auto&& process_draw, auto&& end_frame) {
+    uint64_t converted = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < kFrames; ++frame) {
+      size_t frame_buffer_used = 0;
+      for (const IndexStream::Draw& draw : stream.draws) {
+        converted += process_draw(draw, frame_buffer_used);
+      }
+      end_frame();
+    }
+    double ns_per_draw =
+        std::chrono::duration<double, std::nano>(
+            std::chrono::steady_clock::now() - start)
+            .count() /
+        (double(kFrames) * stream.draws.size());
+    fmt::print("{}: {:.1f} ns per draw, {} draws converted\n", name,
+               ns_per_draw, converted);
+  };
+
+  auto convert = [&](const IndexStream::Draw& draw, size_t& frame_buffer_used) {
+    auto count = uint32_t(stream.buffers[draw.buffer].size());
+    frame_buffer_used += ConvertTriangleFan(
+        frame_buffer.data() + frame_buffer_used,
+        reinterpret_cast<const uint16_t*>(guest_memory + draw.address), count);
+    return uint32_t(1);
+  };
+
+  run("No cache", convert, [] {});
+
+  std::mutex global_mutex;
+  std::unordered_map<uint64_t, size_t> address_cache;
+  std::vector<std::pair<uint32_t, uint32_t>> protected_ranges;
+  run(
+      "Address-keyed cache",
+      [&](const IndexStream::Draw& draw, size_t& frame_buffer_used) {
+        auto count = uint32_t(stream.buffers[draw.buffer].size());
+        uint64_t key = uint64_t(draw.address) | (uint64_t(count) << 32);
+        {
+          std::lock_guard<std::mutex> lock(global_mutex);
+          if (address_cache.find(key) != address_cache.end()) {
+            return uint32_t(0);
+          }
+        }
+        uint32_t page_first = draw.address & ~uint32_t(page_size - 1);
+        uint32_t page_end = xe::align(
+            uint32_t(draw.address + count * sizeof(uint16_t)),
+            uint32_t(page_size));
+        xe::memory::Protect(guest_memory + page_first, page_end - page_first,
+                            xe::memory::PageAccess::kReadOnly);
+        protected_ranges.emplace_back(page_first, page_end - page_first);
+        size_t offset = frame_buffer_used;
+        convert(draw, frame_buffer_used);
+        std::lock_guard<std::mutex> lock(global_mutex);
+        address_cache.emplace(key, offset);
+        return uint32_t(1);
+      },
+      [&] {
+        address_cache.clear();
+        // The guest rewriting its dynamic index buffers for the next frame.
+        for (const auto& range : protected_ranges) {
+          xe::memory::Protect(guest_memory + range.first, range.second,
+                              xe::memory::PageAccess::kReadWrite);
+        }
+        protected_ranges.clear();
+      });
+
+  PrimitiveProcessorHashCache<size_t> hash_cache;
+  run(
+      "Content hash cache",
+      [&](const IndexStream::Draw& draw, size_t& frame_buffer_used) {
+        auto count = uint32_t(stream.buffers[draw.buffer].size());
+        auto key = PrimitiveProcessorHashCache<size_t>::MakeKey(
+            guest_memory + draw.address, count * sizeof(uint16_t), count);
+        if (hash_cache.Find(key)) {
+          return uint32_t(0);
+        }
+        hash_cache.Insert(key, frame_buffer_used);
+        return convert(draw, frame_buffer_used);
+      },
+      [&] { hash_cache.NextFrame(); });
+
+  xe::memory::DeallocFixed(guest_memory, 0,
+                           xe::memory::DeallocationType::kRelease);
+}
+
+}  // namespace test
+}  // namespace gpu
+}  // namespace xe
@@ -0,0 +1,205 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/gpu/texture_cache.h"
+
+#include <cstring>
+#include <memory>
+#include <utility>
+
+#include "third_party/catch/include/catch.hpp"
+
+#include "xenia/base/cvar.h"
+#include "xenia/base/mutex.h"
+#include "xenia/memory.h"
+
+DECLARE_bool(texture_cache_content_hash);
+
+namespace xe {
+namespace gpu {
+namespace test {
+
+// Shared memory without a host GPU copy - uploading only marks the pages as
+// valid and watched.
+class TestSharedMemory : public SharedMemory {
+ public:
+  explicit TestSharedMemory(Memory& memory) : SharedMemory(memory) {
+    InitializeCommon();
+  }
+  ~TestSharedMemory() override { ShutdownCommon(); }
+
+ protected:
+  bool UploadRanges(const std::pair<uint32_t, uint32_t>* upload_page_ranges,
+                    uint32_t num_upload_ranges) override {
+    for (uint32_t i = 0; i < num_upload_ranges; ++i) {
+      MakeRangeValid(upload_page_ranges[i].first << page_size_log2(),
+                     upload_page_ranges[i].second << page_size_log2(), false,
+                     false);
+    }
+    return true;
+  }
+};
+
+// Counts the loads of the texture data instead of loading it, and fails them
+// on request.
+class TestTextureCache : public TextureCache {
+ public:
+  using TextureCache::Texture;
+  using TextureCache::TextureKey;
+
+  TestTextureCache(const RegisterFile& register_file,
+                   SharedMemory& shared_memory)
+      : TextureCache(register_file, shared_memory, 1, 1) {}
+  ~TestTextureCache() override { DestroyAllTextures(true); }
+
+  Texture* FindOrCreateTexture(TextureKey key) {
+    return TextureCache::FindOrCreateTexture(key);
+  }
+  bool LoadTextureData(Texture& texture) {
+    return TextureCache::LoadTextureData(texture);
+  }
+
+  uint32_t load_count() const { return load_count_; }
+  void set_fail_loads(bool fail_loads) { fail_loads_ = fail_loads; }
+
+ protected:
+  uint32_t GetHostFormatSwizzle(TextureKey key) const override {
+    return xenos::XE_GPU_TEXTURE_SWIZZLE_RGBA;
+  }
+  uint32_t GetMaxHostTextureWidthHeight(
+      xenos::DataDimension dimension) const override {
+    return 8192;
+  }
+  uint32_t GetMaxHostTextureDepthOrArraySize(
+      xenos::DataDimension dimension) const override {
+    return 2048;
+  }
+
+  std::unique_ptr<Texture> CreateTexture(TextureKey key) override {
+    return std::unique_ptr<Texture>(new TestTexture(*this, key));
+  }
+
+  bool LoadTextureDataFromResidentMemoryImpl(Texture& texture, bool load_base,
+                                             bool load_mips) override {
+    ++load_count_;
+    return !fail_loads_;
+  }
+
+ private:
+  class TestTexture : public Texture {
+   public:
+    TestTexture(TextureCache& texture_cache, const TextureKey& key)
+        : Texture(texture_cache, key) {}
+  };
+
+  uint32_t load_count_ = 0;
+  bool fail_loads_ = false;
+};
+
+// A linear 64x64 texture without mips in guest physical memory.
+class TextureCacheTest {
+ public:
+  static constexpr uint32_t kSize = 64 * 64 * 4;
+
+  TextureCacheTest() {
+    REQUIRE(memory_.Initialize());
+    virtual_address_ =
+        memory_.SystemHeapAlloc(kSize, 4096, kSystemHeapPhysical);
+    REQUIRE(virtual_address_);
+    shared_memory_ = std::make_unique<TestSharedMemory>(memory_);
+    texture_cache_ =
+        std::make_unique<TestTextureCache>(register_file_, *shared_memory_);
+
+    TestTextureCache::TextureKey key;
+    key.base_page = memory_.GetPhysicalAddress(virtual_address_) >> 12;
+    key.dimension = xenos::DataDimension::k2DOrStacked;
+    key.width_minus_1 = 63;
+    key.height_minus_1 = 63;
+    key.pitch = 64 >> 5;
+    key.format = xenos::TextureFormat::k_8_8_8_8;
+    key.is_valid = 1;
+    texture_ = texture_cache_->FindOrCreateTexture(key);
+    REQUIRE(texture_);
+    REQUIRE(texture_->GetGuestBaseSize() == kSize);
+  }
+
+  TestTextureCache& texture_cache() { return *texture_cache_; }
+  TestTextureCache::Texture& texture() { return *texture_; }
+
+  // Writes the data like the guest CPU, invalidating the watched pages.
+  void Write(uint8_t value) {
+    memory_.TriggerPhysicalMemoryCallbacks(
+        global_critical_region::AcquireDirect(), virtual_address_, kSize, true,
+        false);
+    std::memset(memory_.TranslateVirtual(virtual_address_), value, kSize);
+  }
+
+  // Loads the texture, returning whether the data was actually loaded.
+  bool Load() {
+    uint32_t load_count = texture_cache_->load_count();
+    REQUIRE(texture_cache_->LoadTextureData(*texture_));
+    return texture_cache_->load_count() != load_count;
+  }
+
+ private:
+  Memory memory_;
+  RegisterFile register_file_;
+  std::unique_ptr<TestSharedMemory> shared_memory_;
+  std::unique_ptr<TestTextureCache> texture_cache_;
+  TestTextureCache::Texture* texture_ = nullptr;
+  uint32_t virtual_address_ = 0;
+};
+
+TEST_CASE("Texture cache skips rewrites with the same data",
+          "[texture_cache]") {
+  TextureCacheTest test;
+  test.Write(1);
+  REQUIRE(test.Load());
+  // Loaded and watched already.
+  REQUIRE_FALSE(test.Load());
+
+  test.Write(1);
+  REQUIRE_FALSE(test.Load());
+  test.Write(2);
+  REQUIRE(test.Load());
+  test.Write(1);
+  REQUIRE(test.Load());
+
+  cvars::texture_cache_content_hash = false;
+  test.Write(1);
+  REQUIRE(test.Load());
+  cvars::texture_cache_content_hash = true;
+}
+
+TEST_CASE("Texture cache reloads textures after a failed load",
+          "[texture_cache]") {
+  TextureCacheTest test;
+  test.Write(1);
+  REQUIRE(test.Load());
+
+  // The host data may be partially overwritten by the failed load.
+  test.Write(2);
+  test.texture_cache().set_fail_loads(true);
+  REQUIRE_FALSE(test.texture_cache().LoadTextureData(test.texture()));
+  test.texture_cache().set_fail_loads(false);
+  REQUIRE(test.Load());
+  REQUIRE_FALSE(test.Load());
+
+  // Even if rewritten with the data loaded before the failure.
+  test.Write(1);
+  test.texture_cache().set_fail_loads(true);
+  REQUIRE_FALSE(test.texture_cache().LoadTextureData(test.texture()));
+  test.texture_cache().set_fail_loads(false);
+  test.Write(2);
+  REQUIRE(test.Load());
+}
+
+}  // namespace test
+}  // namespace gpu
+}  // namespace xe
@@ -0,0 +1,364 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "third_party/catch/include/catch.hpp"
+#include "third_party/fmt/include/fmt/format.h"
+
+#include "xenia/base/filesystem.h"
+#include "xenia/gpu/trace_reader.h"
+#include "xenia/gpu/trace_writer.h"
+
+// The writer is only compiled into builds with the trace instrumentation.
+#if XE_ENABLE_TRACE_WRITER_INSTRUMENTATION == 1
+
+namespace xe {
+namespace gpu {
+namespace test {
+
+constexpr size_t kGuestMemorySize = 16 * 1024 * 1024;
+// Enough reads stored inline for a frame to span multiple command blocks.
+constexpr uint32_t kFrameReadCount = 1536;
+constexpr uint32_t kFrameReadSize = 1024;
+
+class TestTraceReader : public TraceReader {
+ public:
+  struct MemoryRead {
+    uint32_t base_ptr;
+    MemoryEncodingFormat encoding_format;
+    MemoryBlockReference reference;
+    std::vector<uint8_t> data;
+  };
+
+  // Decodes every memory read in the frame, which only has memory reads,
+  // packets and events in these tests.
+  std::vector<MemoryRead> ReadMemoryCommands(int frame_index) {
+    std::vector<MemoryRead> reads;
+    const Frame* frame = this->frame(frame_index);
+    REQUIRE(frame);
+    const uint8_t* ptr = frame->start_ptr;
+    const uint8_t* end = frame->end_ptr;
+    while (ptr < end) {
+      TraceCommandType type;
+      std::memcpy(&type, ptr, sizeof(type));
+      if (type == TraceCommandType::kEvent) {
+        ptr += sizeof(EventCommand);
+        continue;
+      }
+      if (type == TraceCommandType::kPacketStart) {
+        PacketStartCommand cmd;
+        std::memcpy(&cmd, ptr, sizeof(cmd));
+        ptr += sizeof(cmd) + sizeof(uint32_t) * cmd.count;
+        continue;
+      }
+      if (type == TraceCommandType::kPacketEnd) {
+        ptr += sizeof(PacketEndCommand);
+        continue;
+      }
+      REQUIRE(type == TraceCommandType::kMemoryRead);
+      MemoryCommand cmd;
+      std::memcpy(&cmd, ptr, sizeof(cmd));
+      ptr += sizeof(cmd);
+      MemoryRead& read = reads.emplace_back();
+      read.base_ptr = cmd.base_ptr;
+      read.encoding_format = cmd.encoding_format;
+      read.reference = {};
+      if (cmd.encoding_format == MemoryEncodingFormat::kMemoryBlock) {
+        std::memcpy(&read.reference, ptr, sizeof(read.reference));
+      }
+      read.data.resize(cmd.decoded_length);
+      REQUIRE(DecompressMemory(cmd.encoding_format, ptr, cmd.encoded_length,
+                               read.data.data(), read.data.size()));
+      ptr += cmd.encoded_length;
+    }
+    return reads;
+  }
+
+  std::vector<MemoryRead> ReadMemoryCommands() {
+    std::vector<MemoryRead> reads;
+    for (int i = 0; i < frame_count(); ++i) {
+      auto frame_reads = ReadMemoryCommands(i);
+      reads.insert(reads.end(), std::make_move_iterator(frame_reads.begin()),
+                   std::make_move_iterator(frame_reads.end()));
+    }
+    return reads;
+  }
+
+  size_t memory_block_count() const { return memory_block_infos_.size(); }
+  size_t loaded_frame_count() const { return loaded_frames_.size(); }
+};
+
+class TraceFile {
+ public:
+  TraceFile() : memory_(kGuestMemorySize) {
+    path_ = std::filesystem::temp_directory_path() /
+            fmt::format("xenia_trace_test_{}.xtr",
+                        std::chrono::steady_clock::now()
+                            .time_since_epoch()
+                            .count());
+    std::mt19937 random(1);
+    for (uint8_t& value : memory_) {
+      value = uint8_t(random());
+    }
+  }
+  ~TraceFile() {
+    writer_.reset();
+    std::error_code error;
+    std::filesystem::remove(path_, error);
+  }
+
+  const std::filesystem::path& path() const { return path_; }
+  const uint8_t* memory() const { return memory_.data(); }
+
+  // Writes reads of 16 bytes (stored inline), a 4 KB read repeated at
+  // another address with the same data, and enough 256 KB reads to fill
+  // several memory blocks.
+  void Write() {
+    // The same data at two addresses.
+    std::memcpy(memory_.data() + 0x10000, memory_.data() + 0x8000, 0x1000);
+    TraceWriter writer(memory_.data());
+    REQUIRE(writer.Open(path_, 0x41560817));
+    writer.WriteMemoryRead(0x100, 16);
+    writer.WriteMemoryRead(0x8000, 0x1000);
+    writer.WriteMemoryRead(0x10000, 0x1000);
+    writer.WriteEvent(EventCommand::Type::kSwap);
+    for (uint32_t address = 0x100000; address < kGuestMemorySize;
+         address += 0x40000) {
+      writer.WriteMemoryRead(address, 0x40000);
+    }
+    // Already stored, so only referenced again.
+    writer.WriteMemoryRead(0x100000, 0x40000);
+    writer.Close();
+  }
+
+  // Writes frames ended by swaps, leaving the writer open.
+  void WriteFrames(uint32_t frame_count) {
+    // A big-endian PM4 type 3 DRAW_INDX header for the packets to be parsed
+    // as draws.
+    const uint8_t packet[] = {0xC0, 0x00, 0x22, 0x00};
+    std::memcpy(memory_.data(), packet, sizeof(packet));
+    writer_ = std::make_unique<TraceWriter>(memory_.data());
+    REQUIRE(writer_->Open(path_, 0x41560817));
+    for (uint32_t frame = 0; frame < frame_count; ++frame) {
+      writer_->WritePacketStart(0, 1);
+      for (uint32_t i = 0; i < kFrameReadCount; ++i) {
+        writer_->WriteMemoryRead(FrameReadAddress(frame, i), kFrameReadSize);
+      }
+      writer_->WritePacketEnd();
+      writer_->WriteEvent(EventCommand::Type::kSwap);
+      // Ends the frame.
+      writer_->WritePacketStart(0, 1);
+      writer_->WritePacketEnd();
+    }
+  }
+
+  static uint32_t FrameReadAddress(uint32_t frame, uint32_t read) {
+    return (frame * kFrameReadCount + read) * kFrameReadSize;
+  }
+
+  TraceWriter& writer() { return *writer_; }
+
+  void Truncate(size_t removed_bytes) {
+    std::filesystem::resize_file(
+        path_, std::filesystem::file_size(path_) - removed_bytes);
+  }
+
+  void Patch(size_t offset_from_end, const void* data, size_t size) {
+    std::fstream file(path_, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(std::streamoff(std::filesystem::file_size(path_) -
+                              offset_from_end));
+    file.write(reinterpret_cast<const char*>(data), std::streamsize(size));
+  }
+
+ private:
+  std::filesystem::path path_;
+  std::vector<uint8_t> memory_;
+  std::unique_ptr<TraceWriter> writer_;
+};
+
+void RequireReadsMatch(TestTraceReader& reader, const TraceFile& trace) {
+  auto reads = reader.ReadMemoryCommands();
+  REQUIRE(reads.size() == 3 + (kGuestMemorySize - 0x100000) / 0x40000 + 1);
+  for (const auto& read : reads) {
+    INFO(read.base_ptr);
+    REQUIRE(std::memcmp(read.data.data(), trace.memory() + read.base_ptr,
+                        read.data.size()) == 0);
+  }
+}
+
+TEST_CASE("Trace round trip", "[trace]") {
+  TraceFile trace;
+  trace.Write();
+
+  TestTraceReader reader;
+  REQUIRE(reader.Open(xe::path_to_utf8(trace.path())));
+  REQUIRE(reader.header()->version == kTraceFormatVersion);
+  REQUIRE(reader.header()->title_id == 0x41560817);
+  REQUIRE(reader.frame_count() == 1);
+  // 15 MB of distinct data in 4 MB blocks.
+  REQUIRE(reader.memory_block_count() == 4);
+  REQUIRE(reader.frame(0)->memory_blocks.size() == 4);
+
+  auto reads = reader.ReadMemoryCommands();
+  REQUIRE(reads[0].encoding_format == MemoryEncodingFormat::kNone);
+  // Identical data is deduplicated.
+  REQUIRE(reads[1].encoding_format == MemoryEncodingFormat::kMemoryBlock);
+  REQUIRE(reads[2].reference.block_index == reads[1].reference.block_index);
+  REQUIRE(reads[2].reference.block_offset == reads[1].reference.block_offset);
+  REQUIRE(reads.back().reference.block_index ==
+          reads[3].reference.block_index);
+  REQUIRE(reads.back().reference.block_offset ==
+          reads[3].reference.block_offset);
+  RequireReadsMatch(reader, trace);
+}
+
+void RequireFrameReadsMatch(TestTraceReader& reader, const TraceFile& trace,
+                           int frame) {
+  auto reads = reader.ReadMemoryCommands(frame);
+  REQUIRE(reads.size() == kFrameReadCount);
+  for (uint32_t i = 0; i < kFrameReadCount; ++i) {
+    INFO(i);
+    REQUIRE(reads[i].base_ptr == TraceFile::FrameReadAddress(frame, i));
+    REQUIRE(std::memcmp(reads[i].data.data(),
+                        trace.memory() + reads[i].base_ptr,
+                        kFrameReadSize) == 0);
+  }
+}
+
+TEST_CASE("Trace frames are loaded on demand", "[trace]") {
+  TraceFile trace;
+  trace.WriteFrames(8);
+  trace.writer().Close();
+
+  TestTraceReader reader;
+  REQUIRE(reader.Open(xe::path_to_utf8(trace.path())));
+  REQUIRE(reader.frame_count() == 8);
+  REQUIRE(reader.loaded_frame_count() == 0);
+
+  RequireFrameReadsMatch(reader, trace, 5);
+  REQUIRE(reader.loaded_frame_count() == 1);
+  // The packet after the swap is the last in the frame.
+  REQUIRE(reader.frame(5)->commands.size() == 2);
+
+  for (int i = 0; i < reader.frame_count(); ++i) {
+    RequireFrameReadsMatch(reader, trace, i);
+  }
+  REQUIRE(reader.loaded_frame_count() <= 4);
+  // Unloaded frames are decompressed again.
+  RequireFrameReadsMatch(reader, trace, 0);
+}
+
+TEST_CASE("Trace is readable before it's closed", "[trace]") {
+  TraceFile trace;
+  trace.WriteFrames(3);
+  trace.writer().Flush();
+
+  // The last frame is still in the command block being accumulated, and the
+  // index of the others is written by the compression thread.
+  TestTraceReader reader;
+  bool indexed = false;
+  for (int i = 0; i < 100 && !indexed; ++i) {
+    indexed = reader.Open(xe::path_to_utf8(trace.path())) &&
+              reader.frame_count() == 2;
+    if (!indexed) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+  }
+  REQUIRE(indexed);
+  RequireFrameReadsMatch(reader, trace, 0);
+  RequireFrameReadsMatch(reader, trace, 1);
+  reader.Close();
+
+  trace.writer().Close();
+  REQUIRE(reader.Open(xe::path_to_utf8(trace.path())));
+  REQUIRE(reader.frame_count() == 3);
+  RequireFrameReadsMatch(reader, trace, 2);
+}
+
+TEST_CASE("Trace memory block cache is bounded", "[trace]") {
+  TraceFile trace;
+  trace.Write();
+
+  TestTraceReader reader;
+  REQUIRE(reader.Open(xe::path_to_utf8(trace.path())));
+  reader.PrefetchMemoryBlocks(reader.frame(0));
+  REQUIRE(reader.memory_block_cache_size() > 12 * 1024 * 1024);
+
+  // Dropped blocks are decompressed again when needed.
+  reader.set_memory_block_cache_limit(5 * 1024 * 1024);
+  RequireReadsMatch(reader, trace);
+  REQUIRE(reader.memory_block_cache_size() <= 5 * 1024 * 1024);
+  RequireReadsMatch(reader, trace);
+  REQUIRE(reader.memory_block_cache_size() <= 5 * 1024 * 1024);
+}
+
+TEST_CASE("Trace with a broken block index is rejected", "[trace]") {
+  TestTraceReader reader;
+
+  SECTION("Truncated footer") {
+    TraceFile trace;
+    trace.Write();
+    trace.Truncate(1);
+    REQUIRE_FALSE(reader.Open(xe::path_to_utf8(trace.path())));
+  }
+
+  SECTION("Truncated blocks") {
+    TraceFile trace;
+    trace.Write();
+    // Without the index and footer, as if the recording was interrupted.
+    trace.Truncate(sizeof(TraceFooter) + sizeof(TraceFrameInfo) +
+                   sizeof(TraceBlockInfo) * 4);
+    REQUIRE_FALSE(reader.Open(xe::path_to_utf8(trace.path())));
+  }
+
+  SECTION("Corrupt footer magic") {
+    TraceFile trace;
+    trace.Write();
+    const uint32_t magic = 0;
+    trace.Patch(sizeof(uint32_t), &magic, sizeof(magic));
+    REQUIRE_FALSE(reader.Open(xe::path_to_utf8(trace.path())));
+  }
+
+  SECTION("Block outside the file") {
+    TraceFile trace;
+    trace.Write();
+    // The file offset of the last block info.
+    const uint64_t file_offset = uint64_t(1) << 40;
+    trace.Patch(sizeof(TraceFooter) + sizeof(TraceFrameInfo) +
+                    sizeof(TraceBlockInfo),
+                &file_offset, sizeof(file_offset));
+    REQUIRE_FALSE(reader.Open(xe::path_to_utf8(trace.path())));
+  }
+
+  SECTION("Frame outside the command stream") {
+    TraceFile trace;
+    trace.Write();
+    // The command size of the only frame.
+    const uint64_t command_size = uint64_t(1) << 40;
+    trace.Patch(sizeof(TraceFooter) + sizeof(TraceFrameInfo) -
+                    offsetof(TraceFrameInfo, command_size),
+                &command_size, sizeof(command_size));
+    REQUIRE_FALSE(reader.Open(xe::path_to_utf8(trace.path())));
+  }
+}
+
+}  // namespace test
+}  // namespace gpu
+}  // namespace xe
+
+#endif  // XE_ENABLE_TRACE_WRITER_INSTRUMENTATION == 1
@@ -59,6 +59,13 @@ DEFINE_uint32(
     "textures - so with 2x2 resolution scaling, the soft limit will be 360 + "
     "96 MB, and with 3x3, it will be 360 + 216 MB.",
     "GPU");
+DEFINE_bool(
+    texture_cache_content_hash, true,
+    "Hash the guest data of textures when loading them, and when the memory "
+    "of a texture is written by the CPU, skip reloading it if the data is the "
+    "same as before (such as when streaming systems copy unchanged mips "
+    "again).",
+    "GPU");
 
 namespace xe {
 namespace gpu {
@@ -563,6 +570,18 @@ void TextureCache::Texture::WatchCallback(
   }
 }
 
+bool TextureCache::Texture::IsContentHashEqual(bool is_mip,
+                                               uint64_t hash) const {
+  const std::optional<uint64_t>& content_hash =
+      is_mip ? mips_content_hash_ : base_content_hash_;
+  return content_hash == hash;
+}
+
+void TextureCache::Texture::SetContentHash(bool is_mip,
+                                           std::optional<uint64_t> hash) {
+  (is_mip ? mips_content_hash_ : base_content_hash_) = hash;
+}
+
 void TextureCache::WatchCallback(const global_unique_lock_type& global_lock,
                                  void* context, void* data, uint64_t argument,
                                  bool invalidated_by_gpu) {
@@ -733,9 +752,9 @@ void TextureCache::LoadTexturesData(Texture** textures, uint32_t n_textures) {
     }
 
     // Actually load the texture data.
-    if (!LoadTextureDataFromResidentMemoryImpl(
-            texture, (index_base_outdated & (1ULL << i)) != 0,
-            (index_mips_outdated & (1ULL << i)) != 0)) {
+    if (!LoadChangedTextureData(
+            texture, (index_base_outdated & (1ULL << i)) != 0, base_resolved,
+            (index_mips_outdated & (1ULL << i)) != 0, mips_resolved)) {
       continue;
     }
 
@@ -829,8 +848,8 @@ bool TextureCache::LoadTextureData(Texture& texture) {
   }
 
   // Actually load the texture data.
-  if (!LoadTextureDataFromResidentMemoryImpl(texture, base_outdated,
-                                             mips_outdated)) {
+  if (!LoadChangedTextureData(texture, base_outdated, base_resolved,
+                              mips_outdated, mips_resolved)) {
     return false;
   }
 
@@ -853,6 +872,75 @@ bool TextureCache::LoadTextureData(Texture& texture) {
   return true;
 }
 
+std::optional<uint64_t> TextureCache::HashTextureData(const Texture& texture,
+                                                      bool is_mip,
+                                                      bool resolved) {
+  const TextureKey& texture_key = texture.key();
+  // Resolved data is only up to date in the GPU memory.
+  if (!cvars::texture_cache_content_hash || texture_key.scaled_resolve ||
+      resolved) {
+    return std::nullopt;
+  }
+  uint64_t hash;
+  if (!shared_memory().HashCpuWrittenRange(
+          (is_mip ? texture_key.mip_page : texture_key.base_page) << 12,
+          is_mip ? texture.GetGuestMipsSize() : texture.GetGuestBaseSize(),
+          hash)) {
+    return std::nullopt;
+  }
+  return hash;
+}
+
+bool TextureCache::LoadChangedTextureData(Texture& texture, bool base_outdated,
+                                          bool base_resolved,
+                                          bool mips_outdated,
+                                          bool mips_resolved) {
+  auto is_unchanged = [&](bool is_mip, bool resolved,
+                          std::optional<uint64_t>& hash) {
+    hash = HashTextureData(texture, is_mip, resolved);
+    if (!hash || !texture.IsContentHashEqual(is_mip, *hash)) {
+      return false;
+    }
+    ++unchanged_texture_data_skipped_loads_;
+    unchanged_texture_data_skipped_bytes_ +=
+        is_mip ? texture.GetGuestMipsSize() : texture.GetGuestBaseSize();
+    COUNT_profile_set("gpu/texture_cache/unchanged_skipped_loads",
+                      unchanged_texture_data_skipped_loads_);
+    COUNT_profile_set("gpu/texture_cache/unchanged_skipped_mb",
+                      unchanged_texture_data_skipped_bytes_ >> 20);
+    texture.LogAction(is_mip ? "Kept the unchanged mips of"
+                             : "Kept the unchanged base of");
+    return true;
+  };
+  std::optional<uint64_t> base_hash, mips_hash;
+  bool load_base =
+      base_outdated && !is_unchanged(false, base_resolved, base_hash);
+  bool load_mips =
+      mips_outdated && !is_unchanged(true, mips_resolved, mips_hash);
+  if (!load_base && !load_mips) {
+    return true;
+  }
+
+  // A failed load may leave the host data partially overwritten, so until the
+  // load succeeds, it doesn't match any guest data.
+  if (load_base) {
+    texture.SetContentHash(false, std::nullopt);
+  }
+  if (load_mips) {
+    texture.SetContentHash(true, std::nullopt);
+  }
+  if (!LoadTextureDataFromResidentMemoryImpl(texture, load_base, load_mips)) {
+    return false;
+  }
+  if (load_base) {
+    texture.SetContentHash(false, base_hash);
+  }
+  if (load_mips) {
+    texture.SetContentHash(true, mips_hash);
+  }
+  return true;
+}
+
 void TextureCache::BindingInfoFromFetchConstant(
     const xenos::xe_gpu_texture_fetch_t& fetch, TextureKey& key_out,
     uint8_t* swizzled_signs_out) {
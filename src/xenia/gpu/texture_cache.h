@@ -15,6 +15,7 @@
 #include <cstdint>
 #include <cstring>
 #include <memory>
+#include <optional>
 #include <unordered_map>
 
 #include "xenia/base/assert.h"
@@ -267,6 +268,13 @@ class TextureCache {
 
     void WatchCallback(const global_unique_lock_type& global_lock, bool is_mip);
 
+    // Whether the base or the mips were last loaded from guest data with the
+    // hash.
+    bool IsContentHashEqual(bool is_mip, uint64_t hash) const;
+    // Sets the hash of the guest data the base or the mips have been loaded
+    // from, or forgets it if nullopt, such as while they're being loaded.
+    void SetContentHash(bool is_mip, std::optional<uint64_t> hash);
+
     // For LRU caching - updates the last usage frame and moves the texture to
     // the end of the usage queue. Must be called any time the texture is
     // referenced by any GPU work in the implementation to make sure it's not
@@ -314,6 +322,12 @@ class TextureCache {
     // Watch handles for the memory ranges.
     SharedMemory::WatchHandle base_watch_handle_ = nullptr;
     SharedMemory::WatchHandle mips_watch_handle_ = nullptr;
+
+    // XXH3 of the guest data the base / mips were last successfully loaded
+    // from, if it was only written by the CPU, for skipping reloading when the
+    // guest rewrites the memory with the same data.
+    std::optional<uint64_t> base_content_hash_;
+    std::optional<uint64_t> mips_content_hash_;
   };
 
   // Rules of data access in load shaders:
@@ -602,6 +616,18 @@ class TextureCache {
  private:
   void UpdateTexturesTotalHostMemoryUsage(uint64_t add, uint64_t subtract);
 
+  // Hashes the outdated base or mips of the texture, already requested in the
+  // shared memory, or returns nullopt if they can't be compared to the data
+  // they were last loaded from.
+  std::optional<uint64_t> HashTextureData(const Texture& texture, bool is_mip,
+                                          bool resolved);
+  // Loads the outdated base and mips, already requested in the shared memory,
+  // unless they have been rewritten with the same data they were last loaded
+  // from. The hashes are only kept if the load succeeds.
+  bool LoadChangedTextureData(Texture& texture, bool base_outdated,
+                              bool base_resolved, bool mips_outdated,
+                              bool mips_resolved);
+
   // Shared memory callback for texture data invalidation.
   static void WatchCallback(const global_unique_lock_type& global_lock,
                             void* context, void* data, uint64_t argument,
@@ -648,6 +674,10 @@ class TextureCache {
 
   uint64_t textures_total_host_memory_usage_ = 0;
 
+  // Loads skipped because the data was the same as previously loaded.
+  uint64_t unchanged_texture_data_skipped_loads_ = 0;
+  uint64_t unchanged_texture_data_skipped_bytes_ = 0;
+
   Texture* texture_used_first_ = nullptr;
   Texture* texture_used_last_ = nullptr;
 
@@ -36,7 +36,7 @@ TracePlayer::TracePlayer(GraphicsSystem* graphics_system)
   assert_not_null(playback_event_);
 }
 
-const TraceReader::Frame* TracePlayer::current_frame() const {
+const TraceReader::Frame* TracePlayer::current_frame() {
   if (current_frame_index_ >= frame_count()) {
     return nullptr;
   }
@@ -52,6 +52,7 @@ void TracePlayer::SeekFrame(int target_frame) {
   current_command_index_ = int(frame->commands.size()) - 1;
 
   assert_true(frame->start_ptr <= frame->end_ptr);
+  PrefetchMemoryBlocks(frame);
   PlayTrace(frame->start_ptr, frame->end_ptr - frame->start_ptr,
             TracePlaybackMode::kBreakOnSwap, false);
 }
@@ -76,6 +77,7 @@ void TracePlayer::SeekCommand(int target_command) {
               TracePlaybackMode::kBreakOnSwap, false);
   } else {
     // Full playback from frame start.
+    PrefetchMemoryBlocks(frame);
     PlayTrace(frame->start_ptr, command.end_ptr - frame->start_ptr,
               TracePlaybackMode::kBreakOnSwap, true);
   }
@@ -23,7 +23,11 @@ static constexpr char kTraceExtension[] = "xtr";
 // Other changes besides the file format may require bumps, such as
 // anything that changes what is recorded into the files (new GPU
 // command processor commands, etc).
-constexpr uint32_t kTraceFormatVersion = 1;
+constexpr uint32_t kTraceFormatVersion = 3;
+// Version 1 traces - a single uncompressed stream of commands with
+// individually snappy-compressed data, without an index - can still be read,
+// but are not written anymore.
+constexpr uint32_t kTraceFormatVersionUnindexed = 1;
 
 // Trace file header identifying information about the trace.
 // This must be positioned at the start of the file and must only occur once.
@@ -40,6 +44,59 @@ struct TraceHeader {
   uint32_t title_id;
 };
 
+// Since version 3, the file after the header consists of:
+// - zstd-compressed blocks, in the order they were written.
+// - An array of TraceBlockInfo for all blocks.
+// - An array of TraceFrameInfo for all frames.
+// - TraceFooter, at the very end of the file.
+// Concatenated in the order of the index, the decompressed kCommands blocks
+// form the command stream, which is stored directly after the header in
+// version 1. Large memory data is stored in kMemory blocks instead, and
+// referenced from the command stream.
+// While recording, the index is periodically written after the last complete
+// block and overwritten by the next blocks, so a trace that wasn't closed
+// properly can still be read up to the last indexed frame.
+enum class TraceBlockType : uint32_t {
+  kCommands,
+  kMemory,
+};
+
+struct TraceBlockInfo {
+  uint64_t file_offset;
+  uint32_t compressed_size;
+  uint32_t decompressed_size;
+  TraceBlockType type;
+  // Index among the blocks of the same type.
+  uint32_t type_index;
+};
+
+// "XTRI" in little endian.
+constexpr uint32_t kTraceFooterMagic = 0x49525458;
+
+// A frame ends with the first packet after a swap event. Frames can be
+// decompressed and parsed independently of each other.
+struct TraceFrameInfo {
+  // Range of the frame in the command stream.
+  uint64_t command_offset;
+  uint64_t command_size;
+  // The kCommands blocks containing the range.
+  uint32_t first_command_block;
+  uint32_t command_block_count;
+  // 1 + the highest index of the kMemory blocks referenced by the frame.
+  uint32_t memory_block_count;
+  uint32_t reserved;
+};
+
+struct TraceFooter {
+  uint64_t block_info_offset;
+  uint32_t block_count;
+  // The frame infos follow the block infos.
+  uint32_t frame_count;
+  uint32_t reserved;
+  // Set to kTraceFooterMagic.
+  uint32_t magic;
+};
+
 // Tags each command in the trace file stream as one of the *Command types.
 // Each command has this value as its first dword.
 enum class TraceCommandType : uint32_t {
@@ -95,6 +152,16 @@ enum class MemoryEncodingFormat {
   kNone,
   // Data is compressed with third_party/snappy.
   kSnappy,
+  // Data is stored in a kMemory block - the encoded data is a
+  // MemoryBlockReference. Memory commands with identical data may reference
+  // the same location.
+  kMemoryBlock,
+};
+
+struct MemoryBlockReference {
+  // Index among the kMemory blocks.
+  uint32_t block_index;
+  uint32_t block_offset;
 };
 
 // Represents the GPU reading or writing data from or to memory.
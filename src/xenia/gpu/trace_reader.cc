@@ -9,14 +9,18 @@
 
 #include "xenia/gpu/trace_reader.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cinttypes>
 
 #include "third_party/snappy/snappy.h"
+#include "third_party/zstd/lib/zstd.h"
 #include "xenia/base/filesystem.h"
 #include "xenia/base/logging.h"
 #include "xenia/base/mapped_memory.h"
 #include "xenia/base/math.h"
 #include "xenia/base/platform.h"
+#include "xenia/base/threading.h"
 #include "xenia/gpu/packet_disassembler.h"
 #include "xenia/gpu/trace_protocol.h"
 #include "xenia/memory.h"
@@ -45,8 +49,13 @@ bool TraceReader::Open(const std::string_view path) {
   trace_size_ = mmap_->size();
 
   // Verify version.
+  if (trace_size_ < sizeof(TraceHeader)) {
+    XELOGE("Trace file is too small");
+    return false;
+  }
   auto header = reinterpret_cast<const TraceHeader*>(trace_data_);
-  if (header->version != kTraceFormatVersion) {
+  if (header->version != kTraceFormatVersion &&
+      header->version != kTraceFormatVersionUnindexed) {
     XELOGE("Trace format version mismatch, code has {}, file has {}",
            kTraceFormatVersion, header->version);
     if (header->version < kTraceFormatVersion) {
@@ -62,21 +71,279 @@ bool TraceReader::Open(const std::string_view path) {
   XELOGI("    Commit: {}", commit_str);
   XELOGI("  Title ID: {}", header->title_id);
 
-  ParseTrace();
+  if (header->version == kTraceFormatVersionUnindexed) {
+    command_data_ = trace_data_ + sizeof(TraceHeader);
+    command_size_ = trace_size_ - sizeof(TraceHeader);
+    ParseFrames(command_data_, command_size_, true, frames_);
+  } else if (!ReadBlockIndex()) {
+    Close();
+    return false;
+  }
 
   return true;
 }
 
 void TraceReader::Close() {
+  frames_.clear();
+  command_block_infos_.clear();
+  command_block_offsets_.clear();
+  frame_infos_.clear();
+  frame_command_data_.clear();
+  loaded_frames_.clear();
+  worker_pool_.reset();
+  memory_block_infos_.clear();
+  memory_block_cache_.clear();
+  memory_block_lru_.clear();
+  memory_block_cache_size_ = 0;
+  command_data_ = nullptr;
+  command_size_ = 0;
   mmap_.reset();
   trace_data_ = nullptr;
   trace_size_ = 0;
 }
 
-void TraceReader::ParseTrace() {
-  // Skip file header.
-  auto trace_ptr = trace_data_;
-  trace_ptr += sizeof(TraceHeader);
+bool TraceReader::ReadBlockIndex() {
+  if (trace_size_ < sizeof(TraceHeader) + sizeof(TraceFooter)) {
+    XELOGE("Trace file is truncated - it was possibly not closed properly");
+    return false;
+  }
+  size_t footer_offset = trace_size_ - sizeof(TraceFooter);
+  TraceFooter footer;
+  std::memcpy(&footer, trace_data_ + footer_offset, sizeof(footer));
+  if (footer.magic != kTraceFooterMagic ||
+      footer.block_info_offset < sizeof(TraceHeader) ||
+      footer.block_info_offset > footer_offset ||
+      footer_offset - footer.block_info_offset !=
+          sizeof(TraceBlockInfo) * uint64_t(footer.block_count) +
+              sizeof(TraceFrameInfo) * uint64_t(footer.frame_count)) {
+    XELOGE("Trace file has no valid block index - it was possibly not closed "
+           "properly");
+    return false;
+  }
+
+  // Lay out the command blocks and validate everything before decompressing.
+  uint64_t command_size = 0;
+  for (uint32_t i = 0; i < footer.block_count; ++i) {
+    TraceBlockInfo block_info;
+    std::memcpy(&block_info,
+                trace_data_ + footer.block_info_offset +
+                    sizeof(TraceBlockInfo) * i,
+                sizeof(block_info));
+    if (block_info.file_offset < sizeof(TraceHeader) ||
+        block_info.file_offset > footer.block_info_offset ||
+        footer.block_info_offset - block_info.file_offset <
+            block_info.compressed_size) {
+      XELOGE("Trace block {} is out of bounds", i);
+      return false;
+    }
+    switch (block_info.type) {
+      case TraceBlockType::kCommands:
+        if (block_info.type_index != command_block_infos_.size()) {
+          XELOGE("Trace command block {} is out of order", i);
+          return false;
+        }
+        command_block_infos_.push_back(block_info);
+        command_block_offsets_.push_back(command_size);
+        command_size += block_info.decompressed_size;
+        break;
+      case TraceBlockType::kMemory:
+        if (block_info.type_index != memory_block_infos_.size()) {
+          XELOGE("Trace memory block {} is out of order", i);
+          return false;
+        }
+        memory_block_infos_.push_back(block_info);
+        break;
+      default:
+        XELOGE("Trace block {} has unknown type {}", i,
+               uint32_t(block_info.type));
+        return false;
+    }
+  }
+  memory_block_cache_.resize(memory_block_infos_.size());
+
+  const uint8_t* frame_info_data = trace_data_ + footer.block_info_offset +
+                                   sizeof(TraceBlockInfo) * footer.block_count;
+  frame_infos_.resize(footer.frame_count);
+  for (uint32_t i = 0; i < footer.frame_count; ++i) {
+    TraceFrameInfo& frame_info = frame_infos_[i];
+    std::memcpy(&frame_info, frame_info_data + sizeof(TraceFrameInfo) * i,
+                sizeof(frame_info));
+    uint64_t block_end = uint64_t(frame_info.first_command_block) +
+                         frame_info.command_block_count;
+    if (!frame_info.command_block_count ||
+        block_end > command_block_infos_.size() ||
+        frame_info.memory_block_count > memory_block_infos_.size() ||
+        frame_info.command_offset <
+            command_block_offsets_[frame_info.first_command_block] ||
+        frame_info.command_size >
+            command_block_offsets_[block_end - 1] +
+                command_block_infos_[block_end - 1].decompressed_size -
+                frame_info.command_offset) {
+      XELOGE("Trace frame {} is out of bounds", i);
+      return false;
+    }
+  }
+  frames_.resize(frame_infos_.size());
+  frame_command_data_.resize(frame_infos_.size());
+
+  // Frames spanning multiple blocks, as well as memory blocks for
+  // prefetching, are decompressed in parallel.
+  worker_pool_ = std::make_unique<WorkerPool>(
+      std::min(xe::threading::logical_processor_count(), uint32_t(8)) - 1,
+      "GPU Trace Decompression");
+  XELOGI("    Blocks: {} command ({}b decompressed), {} memory",
+         command_block_infos_.size(), command_size,
+         memory_block_infos_.size());
+  XELOGI("    Frames: {}", frames_.size());
+  return true;
+}
+
+const TraceReader::Frame* TraceReader::frame(int n) {
+  if (n < 0 || n >= frame_count()) {
+    return nullptr;
+  }
+  if (!frame_infos_.empty() && !LoadFrame(n)) {
+    XELOGE("Failed to load trace frame {}", n);
+  }
+  return &frames_[n];
+}
+
+bool TraceReader::LoadFrame(int n) {
+  if (frame_command_data_[n]) {
+    loaded_frames_.remove(n);
+    loaded_frames_.push_front(n);
+    return true;
+  }
+
+  const TraceFrameInfo& frame_info = frame_infos_[n];
+  std::vector<size_t> block_offsets(frame_info.command_block_count);
+  size_t data_size = 0;
+  for (uint32_t i = 0; i < frame_info.command_block_count; ++i) {
+    block_offsets[i] = data_size;
+    data_size +=
+        command_block_infos_[frame_info.first_command_block + i]
+            .decompressed_size;
+  }
+  auto data = std::make_unique<uint8_t[]>(data_size);
+  std::atomic<bool> data_valid = true;
+  auto decompress_block = [&](uint32_t i) {
+    const TraceBlockInfo& block_info =
+        command_block_infos_[frame_info.first_command_block + i];
+    size_t result = ZSTD_decompress(
+        data.get() + block_offsets[i], block_info.decompressed_size,
+        trace_data_ + block_info.file_offset, block_info.compressed_size);
+    if (ZSTD_isError(result) || result != block_info.decompressed_size) {
+      data_valid.store(false, std::memory_order_relaxed);
+    }
+  };
+  if (frame_info.command_block_count > 1) {
+    worker_pool_->ParallelFor(frame_info.command_block_count,
+                              decompress_block);
+  } else {
+    decompress_block(0);
+  }
+  if (!data_valid) {
+    return false;
+  }
+
+  // The index defines the frame boundaries.
+  uint64_t frame_data_offset =
+      frame_info.command_offset -
+      command_block_offsets_[frame_info.first_command_block];
+  std::vector<Frame> parsed_frames;
+  ParseFrames(data.get() + frame_data_offset, size_t(frame_info.command_size),
+              false, parsed_frames);
+  if (parsed_frames.empty()) {
+    return false;
+  }
+  frames_[n] = std::move(parsed_frames.front());
+  frame_command_data_[n] = std::move(data);
+  loaded_frames_.push_front(n);
+  while (loaded_frames_.size() > kMaxLoadedFrames) {
+    int unloaded_frame = loaded_frames_.back();
+    loaded_frames_.pop_back();
+    frames_[unloaded_frame] = Frame();
+    frame_command_data_[unloaded_frame].reset();
+  }
+  return true;
+}
+
+std::shared_ptr<const uint8_t[]> TraceReader::GetMemoryBlock(
+    uint32_t block_index) {
+  if (block_index >= memory_block_infos_.size()) {
+    return nullptr;
+  }
+  {
+    std::lock_guard<std::mutex> lock(memory_block_mutex_);
+    CachedMemoryBlock& cached_block = memory_block_cache_[block_index];
+    if (cached_block.data) {
+      memory_block_lru_.splice(memory_block_lru_.begin(), memory_block_lru_,
+                               cached_block.lru_position);
+      return cached_block.data;
+    }
+  }
+  // Decompress without holding the lock so prefetching is parallel.
+  const TraceBlockInfo& block_info = memory_block_infos_[block_index];
+  std::shared_ptr<uint8_t[]> data(new uint8_t[block_info.decompressed_size]);
+  size_t result = ZSTD_decompress(
+      data.get(), block_info.decompressed_size,
+      trace_data_ + block_info.file_offset, block_info.compressed_size);
+  if (ZSTD_isError(result) || result != block_info.decompressed_size) {
+    XELOGE("Failed to decompress trace memory block {}", block_index);
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(memory_block_mutex_);
+  CachedMemoryBlock& cached_block = memory_block_cache_[block_index];
+  if (cached_block.data) {
+    // Decompressed on another thread in the meantime.
+    return cached_block.data;
+  }
+  cached_block.data = std::move(data);
+  memory_block_lru_.push_front(block_index);
+  cached_block.lru_position = memory_block_lru_.begin();
+  memory_block_cache_size_ += block_info.decompressed_size;
+  TrimMemoryBlockCache();
+  return cached_block.data;
+}
+
+void TraceReader::TrimMemoryBlockCache() {
+  // Keeps at least the most recent block. Blocks still referenced by the
+  // callers of GetMemoryBlock are freed when they release them.
+  while (memory_block_cache_size_ > memory_block_cache_limit_ &&
+         memory_block_lru_.size() > 1) {
+    uint32_t evicted_index = memory_block_lru_.back();
+    memory_block_lru_.pop_back();
+    memory_block_cache_[evicted_index].data.reset();
+    memory_block_cache_size_ -=
+        memory_block_infos_[evicted_index].decompressed_size;
+  }
+}
+
+void TraceReader::PrefetchMemoryBlocks(const Frame* frame) {
+  if (!frame || !worker_pool_ || frame->memory_blocks.empty()) {
+    return;
+  }
+  worker_pool_->ParallelFor(
+      uint32_t(frame->memory_blocks.size()),
+      [&](uint32_t i) { GetMemoryBlock(frame->memory_blocks[i]); });
+}
+
+void TraceReader::set_memory_block_cache_limit(size_t limit) {
+  std::lock_guard<std::mutex> lock(memory_block_mutex_);
+  memory_block_cache_limit_ = limit;
+  TrimMemoryBlockCache();
+}
+
+size_t TraceReader::memory_block_cache_size() const {
+  std::lock_guard<std::mutex> lock(memory_block_mutex_);
+  return memory_block_cache_size_;
+}
+
+void TraceReader::ParseFrames(const uint8_t* data, size_t size,
+                              bool split_at_swaps,
+                              std::vector<Frame>& frames) {
+  auto trace_ptr = data;
+  auto trace_end = data + size;
 
   Frame current_frame;
   current_frame.start_ptr = trace_ptr;
@@ -84,11 +351,26 @@ void TraceReader::ParseTrace() {
   const uint8_t* packet_start_ptr = nullptr;
   const uint8_t* last_ptr = trace_ptr;
   bool pending_break = false;
+  auto add_memory_block = [&](MemoryEncodingFormat encoding_format,
+                              const uint8_t* encoded_data) {
+    if (encoding_format != MemoryEncodingFormat::kMemoryBlock) {
+      return;
+    }
+    MemoryBlockReference reference;
+    std::memcpy(&reference, encoded_data, sizeof(reference));
+    current_frame.memory_blocks.push_back(reference.block_index);
+  };
+  auto finish_frame_memory_blocks = [&]() {
+    auto& memory_blocks = current_frame.memory_blocks;
+    std::sort(memory_blocks.begin(), memory_blocks.end());
+    memory_blocks.erase(std::unique(memory_blocks.begin(), memory_blocks.end()),
+                        memory_blocks.end());
+  };
   auto current_command_buffer = new CommandBuffer();
   current_frame.command_tree =
       std::unique_ptr<CommandBuffer>(current_command_buffer);
 
-  while (trace_ptr < trace_data_ + trace_size_) {
+  while (trace_ptr < trace_end) {
     ++current_frame.command_count;
     auto type = static_cast<TraceCommandType>(xe::load<uint32_t>(trace_ptr));
     switch (type) {
@@ -176,21 +458,24 @@ void TraceReader::ParseTrace() {
             break;
           }
         }
-        if (pending_break) {
+        if (pending_break && split_at_swaps) {
           current_frame.end_ptr = trace_ptr;
-          frames_.push_back(std::move(current_frame));
+          finish_frame_memory_blocks();
+          frames.push_back(std::move(current_frame));
           current_command_buffer = new CommandBuffer();
           current_frame.command_tree =
               std::unique_ptr<CommandBuffer>(current_command_buffer);
           current_frame.start_ptr = trace_ptr;
           current_frame.end_ptr = nullptr;
           current_frame.command_count = 0;
+          current_frame.memory_blocks.clear();
           pending_break = false;
         }
         break;
       }
       case TraceCommandType::kMemoryRead: {
         auto cmd = reinterpret_cast<const MemoryCommand*>(trace_ptr);
+        add_memory_block(cmd->encoding_format, trace_ptr + sizeof(*cmd));
         trace_ptr += sizeof(*cmd) + cmd->encoded_length;
         break;
       }
@@ -201,6 +486,7 @@ void TraceReader::ParseTrace() {
       }
       case TraceCommandType::kEdramSnapshot: {
         auto cmd = reinterpret_cast<const EdramSnapshotCommand*>(trace_ptr);
+        add_memory_block(cmd->encoding_format, trace_ptr + sizeof(*cmd));
         trace_ptr += sizeof(*cmd) + cmd->encoded_length;
         break;
       }
@@ -233,7 +519,8 @@ void TraceReader::ParseTrace() {
   }
   if (pending_break || current_frame.command_count) {
     current_frame.end_ptr = trace_ptr;
-    frames_.push_back(std::move(current_frame));
+    finish_frame_memory_blocks();
+    frames.push_back(std::move(current_frame));
   }
 }
 
@@ -248,6 +535,26 @@ bool TraceReader::DecompressMemory(MemoryEncodingFormat encoding_format,
     case MemoryEncodingFormat::kSnappy:
       return snappy::RawUncompress(reinterpret_cast<const char*>(src), src_size,
                                    reinterpret_cast<char*>(dest));
+    case MemoryEncodingFormat::kMemoryBlock: {
+      if (src_size != sizeof(MemoryBlockReference)) {
+        return false;
+      }
+      MemoryBlockReference reference;
+      std::memcpy(&reference, src, sizeof(reference));
+      std::shared_ptr<const uint8_t[]> block_data =
+          GetMemoryBlock(reference.block_index);
+      if (!block_data) {
+        return false;
+      }
+      uint32_t block_size =
+          memory_block_infos_[reference.block_index].decompressed_size;
+      if (reference.block_offset > block_size ||
+          block_size - reference.block_offset < dest_size) {
+        return false;
+      }
+      std::memcpy(dest, block_data.get() + reference.block_offset, dest_size);
+      return true;
+    }
     default:
       assert_unhandled_case(encoding_format);
       return false;
@@ -10,10 +10,14 @@
 #ifndef XENIA_GPU_TRACE_READER_H_
 #define XENIA_GPU_TRACE_READER_H_
 
+#include <list>
+#include <memory>
+#include <mutex>
 #include <string_view>
 #include <vector>
 
 #include "xenia/base/mapped_memory.h"
+#include "xenia/base/worker_pool.h"
 #include "xenia/gpu/trace_protocol.h"
 #include "xenia/memory.h"
 
@@ -87,6 +91,9 @@ class TraceReader {
 
     // Tree of all command buffers
     std::unique_ptr<CommandBuffer> command_tree;
+
+    // Memory blocks referenced by the commands in this frame, sorted.
+    std::vector<uint32_t> memory_blocks;
   };
 
   TraceReader() = default;
@@ -96,22 +103,75 @@ class TraceReader {
     return reinterpret_cast<const TraceHeader*>(trace_data_);
   }
 
-  const Frame* frame(int n) const { return &frames_[n]; }
+  // In indexed traces, the commands of the frame are decompressed on first
+  // access, and the frames least recently accessed beyond kMaxLoadedFrames are
+  // unloaded - their pointers must not be used after accessing other frames.
+  const Frame* frame(int n);
   int frame_count() const { return int(frames_.size()); }
 
   bool Open(const std::string_view path);
 
   void Close();
 
+  // Decompresses the memory blocks used by the frame in parallel ahead of
+  // playback rather than one by one when they're first accessed.
+  void PrefetchMemoryBlocks(const Frame* frame);
+
+  // Decompressed memory blocks are kept for reuse by later frames up to this
+  // many bytes, dropping the least recently used ones beyond it.
+  void set_memory_block_cache_limit(size_t limit);
+  size_t memory_block_cache_size() const;
+
  protected:
-  void ParseTrace();
+  static constexpr size_t kMaxLoadedFrames = 4;
+
+  bool ReadBlockIndex();
+  // Appends the frames in the commands to frames, or only one frame with all
+  // of them if not splitting them at swaps.
+  void ParseFrames(const uint8_t* data, size_t size, bool split_at_swaps,
+                   std::vector<Frame>& frames);
+  bool LoadFrame(int n);
   bool DecompressMemory(MemoryEncodingFormat encoding_format, const void* src,
                         size_t src_size, void* dest, size_t dest_size);
+  // Returns the decompressed data of the kMemory block, or nullptr if it's
+  // broken.
+  std::shared_ptr<const uint8_t[]> GetMemoryBlock(uint32_t block_index);
+  // Drops the least recently used memory blocks beyond the limit, with
+  // memory_block_mutex_ held.
+  void TrimMemoryBlockCache();
 
   std::unique_ptr<MappedMemory> mmap_;
   const uint8_t* trace_data_ = nullptr;
   size_t trace_size_ = 0;
+  // The command stream, directly in the file in unindexed traces.
+  const uint8_t* command_data_ = nullptr;
+  size_t command_size_ = 0;
   std::vector<Frame> frames_;
+
+  // Indexed traces only.
+  std::vector<TraceBlockInfo> command_block_infos_;
+  // Offsets of the kCommands blocks in the command stream.
+  std::vector<uint64_t> command_block_offsets_;
+  std::vector<TraceFrameInfo> frame_infos_;
+  // Decompressed command blocks of the loaded frames.
+  std::vector<std::unique_ptr<uint8_t[]>> frame_command_data_;
+  // Indices of the loaded frames, the most recently accessed first.
+  std::list<int> loaded_frames_;
+
+  std::unique_ptr<WorkerPool> worker_pool_;
+  // Indexed by the block index among the kMemory blocks.
+  std::vector<TraceBlockInfo> memory_block_infos_;
+  struct CachedMemoryBlock {
+    std::shared_ptr<const uint8_t[]> data;
+    std::list<uint32_t>::iterator lru_position;
+  };
+  mutable std::mutex memory_block_mutex_;
+  // Protected with memory_block_mutex_, decompressed on first access.
+  std::vector<CachedMemoryBlock> memory_block_cache_;
+  // Indices of the cached blocks, the most recently used first.
+  std::list<uint32_t> memory_block_lru_;
+  size_t memory_block_cache_size_ = 0;
+  size_t memory_block_cache_limit_ = 512 * 1024 * 1024;
 };
 
 }  // namespace gpu
@@ -9,27 +9,41 @@
 
 #include "xenia/gpu/trace_writer.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <memory>
 
-#include "third_party/snappy/snappy-sinksource.h"
-#include "third_party/snappy/snappy.h"
+#include "third_party/zstd/lib/zstd.h"
 
 #include "build/version.h"
 #include "xenia/base/assert.h"
 #include "xenia/base/filesystem.h"
 #include "xenia/base/logging.h"
 #include "xenia/base/string.h"
+#include "xenia/base/xxhash.h"
 #include "xenia/gpu/registers.h"
 #include "xenia/gpu/xenos.h"
 
 namespace xe {
 namespace gpu {
 #if XE_ENABLE_TRACE_WRITER_INSTRUMENTATION == 1
+// Commands are split into blocks more often than memory data so the stream
+// can be decompressed in parallel.
+constexpr size_t kCommandBlockSize = 1 * 1024 * 1024;
+constexpr size_t kMemoryBlockSize = 4 * 1024 * 1024;
+// Uncompressed bytes that may be queued before the command processor waits
+// for the compression thread.
+constexpr size_t kMaxQueuedBytes = 64 * 1024 * 1024;
+constexpr int kCompressionLevel = 3;
+// How often the index is rewritten after new blocks, so an interrupted
+// recording loses at most this much of the trace.
+constexpr auto kIndexWriteInterval = std::chrono::seconds(1);
+
 TraceWriter::TraceWriter(uint8_t* membase)
     : membase_(membase), file_(nullptr) {}
 
-TraceWriter::~TraceWriter() = default;
+TraceWriter::~TraceWriter() { Close(); }
 
 bool TraceWriter::Open(const std::filesystem::path& path, uint32_t title_id) {
   Close();
@@ -54,23 +68,298 @@ bool TraceWriter::Open(const std::filesystem::path& path, uint32_t title_id) {
   fwrite(&header, sizeof(header), 1, file_);
 
   cached_memory_reads_.clear();
+  command_buffer_.clear();
+  command_buffer_.reserve(kCommandBlockSize);
+  command_block_count_ = 0;
+  command_stream_size_ = 0;
+  memory_buffer_.clear();
+  memory_block_count_ = 0;
+  memory_block_data_.clear();
+  frame_command_offset_ = 0;
+  frame_first_command_block_ = 0;
+  frame_memory_block_count_ = 0;
+  swap_pending_ = false;
+  block_queue_.clear();
+  queued_bytes_ = 0;
+  flush_requested_ = false;
+  shutdown_ = false;
+  frame_infos_.clear();
+  block_infos_.clear();
+  file_offset_ = sizeof(header);
+
+  compression_thread_ = xe::threading::Thread::Create({}, [this]() {
+    xe::threading::set_name("GPU Trace Compression");
+    CompressionThreadMain();
+  });
+  if (!compression_thread_) {
+    XELOGE("Failed to create the GPU trace compression thread");
+    fclose(file_);
+    file_ = nullptr;
+    return false;
+  }
   return true;
 }
 
 void TraceWriter::Flush() {
-  if (file_) {
-    fflush(file_);
+  if (!file_) {
+    return;
+  }
+  // Only make what has already been compressed visible - submitting partial
+  // blocks here would hurt the compression ratio as this is called on every
+  // command processor wait. The compression thread keeps the index of the
+  // complete frames up to date on its own.
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    flush_requested_ = true;
   }
+  queue_cond_.notify_one();
 }
 
 void TraceWriter::Close() {
-  if (file_) {
-    cached_memory_reads_.clear();
+  if (!file_) {
+    return;
+  }
 
-    fflush(file_);
-    fclose(file_);
-    file_ = nullptr;
+  SubmitCommandBlock();
+  SubmitMemoryBlock();
+  if (swap_pending_ || command_stream_size_ > frame_command_offset_) {
+    EndFrame();
+  }
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    shutdown_ = true;
+  }
+  queue_cond_.notify_one();
+  xe::threading::Wait(compression_thread_.get(), false);
+  compression_thread_.reset();
+
+  // All blocks are written, so every frame is complete.
+  WriteIndex(frame_infos_);
+
+  cached_memory_reads_.clear();
+  memory_block_data_.clear();
+  frame_infos_.clear();
+  block_infos_.clear();
+
+  fflush(file_);
+  fclose(file_);
+  file_ = nullptr;
+}
+
+void TraceWriter::AppendCommandData(const void* data, size_t length) {
+  const uint8_t* data_bytes = reinterpret_cast<const uint8_t*>(data);
+  command_buffer_.insert(command_buffer_.end(), data_bytes,
+                         data_bytes + length);
+  command_stream_size_ += length;
+  if (command_buffer_.size() >= kCommandBlockSize) {
+    SubmitCommandBlock();
+  }
+}
+
+MemoryBlockReference TraceWriter::StoreMemoryBlockData(const void* data,
+                                                       size_t length) {
+  XXH128_hash_t hash = XXH3_128bits(data, length);
+  auto it = memory_block_data_.find(hash.low64);
+  if (it != memory_block_data_.end() && it->second.hash_high == hash.high64 &&
+      it->second.length == length) {
+    frame_memory_block_count_ = std::max(
+        frame_memory_block_count_, it->second.reference.block_index + 1);
+    return it->second.reference;
+  }
+
+  // Keep the data contiguous within one block.
+  if (!memory_buffer_.empty() &&
+      memory_buffer_.size() + length > kMemoryBlockSize) {
+    SubmitMemoryBlock();
+  }
+  MemoryBlockReference reference;
+  reference.block_index = memory_block_count_;
+  reference.block_offset = uint32_t(memory_buffer_.size());
+  const uint8_t* data_bytes = reinterpret_cast<const uint8_t*>(data);
+  memory_buffer_.insert(memory_buffer_.end(), data_bytes, data_bytes + length);
+  // Replaces the entry on a collision of the lower half.
+  MemoryBlockDataEntry& entry = memory_block_data_[hash.low64];
+  entry.hash_high = hash.high64;
+  entry.length = uint32_t(length);
+  entry.reference = reference;
+  frame_memory_block_count_ =
+      std::max(frame_memory_block_count_, reference.block_index + 1);
+  if (memory_buffer_.size() >= kMemoryBlockSize) {
+    SubmitMemoryBlock();
+  }
+  return reference;
+}
+
+void TraceWriter::EndFrame() {
+  TraceFrameInfo frame_info = {};
+  frame_info.command_offset = frame_command_offset_;
+  frame_info.command_size = command_stream_size_ - frame_command_offset_;
+  frame_info.first_command_block = frame_first_command_block_;
+  // The end is either in the block being accumulated or in the last
+  // submitted one.
+  frame_info.command_block_count = command_block_count_ +
+                                   uint32_t(!command_buffer_.empty()) -
+                                   frame_first_command_block_;
+  frame_info.memory_block_count = frame_memory_block_count_;
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    frame_infos_.push_back(frame_info);
+  }
+  frame_command_offset_ = command_stream_size_;
+  frame_first_command_block_ = command_block_count_;
+  frame_memory_block_count_ = 0;
+  swap_pending_ = false;
+}
+
+void TraceWriter::SubmitCommandBlock() {
+  if (command_buffer_.empty()) {
+    return;
+  }
+  std::vector<uint8_t> data;
+  data.reserve(kCommandBlockSize);
+  data.swap(command_buffer_);
+  SubmitBlock(TraceBlockType::kCommands, command_block_count_++,
+              std::move(data));
+}
+
+void TraceWriter::SubmitMemoryBlock() {
+  if (memory_buffer_.empty()) {
+    return;
+  }
+  std::vector<uint8_t> data;
+  data.swap(memory_buffer_);
+  SubmitBlock(TraceBlockType::kMemory, memory_block_count_++, std::move(data));
+}
+
+void TraceWriter::SubmitBlock(TraceBlockType type, uint32_t type_index,
+                              std::vector<uint8_t>&& data) {
+  size_t size = data.size();
+  {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    // Throttle the command processor if compression can't keep up, but
+    // always accept at least one block regardless of its size.
+    queue_space_cond_.wait(lock, [&] {
+      return !queued_bytes_ || queued_bytes_ + size <= kMaxQueuedBytes;
+    });
+    PendingBlock& block = block_queue_.emplace_back();
+    block.type = type;
+    block.type_index = type_index;
+    block.data = std::move(data);
+    queued_bytes_ += size;
+  }
+  queue_cond_.notify_one();
+}
+
+void TraceWriter::CompressionThreadMain() {
+  ZSTD_CCtx* cctx = ZSTD_createCCtx();
+  std::vector<uint8_t> compressed;
+  uint32_t written_command_blocks = 0;
+  uint32_t written_memory_blocks = 0;
+  bool index_outdated = false;
+  auto index_write_time =
+      std::chrono::steady_clock::now() - kIndexWriteInterval;
+  std::vector<TraceFrameInfo> indexed_frame_infos;
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  while (true) {
+    auto has_work = [this] {
+      return !block_queue_.empty() || flush_requested_ || shutdown_;
+    };
+    if (index_outdated) {
+      queue_cond_.wait_until(lock, index_write_time + kIndexWriteInterval,
+                             has_work);
+    } else {
+      queue_cond_.wait(lock, has_work);
+    }
+    if (index_outdated && !shutdown_ &&
+        std::chrono::steady_clock::now() >=
+            index_write_time + kIndexWriteInterval) {
+      // Only index the frames whose blocks are all in the file already.
+      indexed_frame_infos.clear();
+      for (const TraceFrameInfo& frame_info : frame_infos_) {
+        if (frame_info.first_command_block + frame_info.command_block_count >
+                written_command_blocks ||
+            frame_info.memory_block_count > written_memory_blocks) {
+          break;
+        }
+        indexed_frame_infos.push_back(frame_info);
+      }
+      lock.unlock();
+      WriteIndex(indexed_frame_infos);
+      fflush(file_);
+      lock.lock();
+      index_outdated = false;
+      index_write_time = std::chrono::steady_clock::now();
+      flush_requested_ = false;
+      continue;
+    }
+    if (!block_queue_.empty()) {
+      PendingBlock block = std::move(block_queue_.front());
+      block_queue_.pop_front();
+      lock.unlock();
+
+      compressed.resize(ZSTD_compressBound(block.data.size()));
+      size_t compressed_size =
+          ZSTD_compressCCtx(cctx, compressed.data(), compressed.size(),
+                            block.data.data(), block.data.size(),
+                            kCompressionLevel);
+      if (ZSTD_isError(compressed_size)) {
+        // Not expected with a buffer of ZSTD_compressBound size, but still
+        // write something the reader can detect.
+        XELOGE("Failed to compress a GPU trace block: {}",
+               ZSTD_getErrorName(compressed_size));
+        compressed_size = 0;
+      }
+      fwrite(compressed.data(), 1, compressed_size, file_);
+      TraceBlockInfo& block_info = block_infos_.emplace_back();
+      block_info.file_offset = file_offset_;
+      block_info.compressed_size = uint32_t(compressed_size);
+      block_info.decompressed_size = uint32_t(block.data.size());
+      block_info.type = block.type;
+      block_info.type_index = block.type_index;
+      file_offset_ += compressed_size;
+      if (block.type == TraceBlockType::kCommands) {
+        ++written_command_blocks;
+      } else {
+        ++written_memory_blocks;
+      }
+      index_outdated = true;
+
+      lock.lock();
+      queued_bytes_ -= block.data.size();
+      queue_space_cond_.notify_all();
+      continue;
+    }
+    if (flush_requested_) {
+      flush_requested_ = false;
+      lock.unlock();
+      fflush(file_);
+      lock.lock();
+      continue;
+    }
+    // Shutting down with all blocks written.
+    break;
+  }
+  lock.unlock();
+  ZSTD_freeCCtx(cctx);
+}
+
+void TraceWriter::WriteIndex(const std::vector<TraceFrameInfo>& frame_infos) {
+  // Overwritten by the blocks written later.
+  TraceFooter footer = {};
+  footer.block_info_offset = file_offset_;
+  footer.block_count = uint32_t(block_infos_.size());
+  footer.frame_count = uint32_t(frame_infos.size());
+  footer.magic = kTraceFooterMagic;
+  if (!block_infos_.empty()) {
+    fwrite(block_infos_.data(), sizeof(TraceBlockInfo), block_infos_.size(),
+           file_);
+  }
+  if (!frame_infos.empty()) {
+    fwrite(frame_infos.data(), sizeof(TraceFrameInfo), frame_infos.size(),
+           file_);
   }
+  fwrite(&footer, sizeof(footer), 1, file_);
+  xe::filesystem::Seek(file_, int64_t(file_offset_), SEEK_SET);
 }
 
 void TraceWriter::WritePrimaryBufferStart(uint32_t base_ptr, uint32_t count) {
@@ -82,7 +371,7 @@ void TraceWriter::WritePrimaryBufferStart(uint32_t base_ptr, uint32_t count) {
       base_ptr,
       0,
   };
-  fwrite(&cmd, 1, sizeof(cmd), file_);
+  AppendCommandData(&cmd, sizeof(cmd));
 }
 
 void TraceWriter::WritePrimaryBufferEnd() {
@@ -92,7 +381,7 @@ void TraceWriter::WritePrimaryBufferEnd() {
   PrimaryBufferEndCommand cmd = {
       TraceCommandType::kPrimaryBufferEnd,
   };
-  fwrite(&cmd, 1, sizeof(cmd), file_);
+  AppendCommandData(&cmd, sizeof(cmd));
 }
 
 void TraceWriter::WriteIndirectBufferStart(uint32_t base_ptr, uint32_t count) {
@@ -104,7 +393,7 @@ void TraceWriter::WriteIndirectBufferStart(uint32_t base_ptr, uint32_t count) {
       base_ptr,
       0,
   };
-  fwrite(&cmd, 1, sizeof(cmd), file_);
+  AppendCommandData(&cmd, sizeof(cmd));
 }
 
 void TraceWriter::WriteIndirectBufferEnd() {
@@ -114,7 +403,7 @@ void TraceWriter::WriteIndirectBufferEnd() {
   IndirectBufferEndCommand cmd = {
       TraceCommandType::kIndirectBufferEnd,
   };
-  fwrite(&cmd, 1, sizeof(cmd), file_);
+  AppendCommandData(&cmd, sizeof(cmd));
 }
 
 void TraceWriter::WritePacketStart(uint32_t base_ptr, uint32_t count) {
@@ -126,8 +415,8 @@ void TraceWriter::WritePacketStart(uint32_t base_ptr, uint32_t count) {
       base_ptr,
       count,
   };
-  fwrite(&cmd, 1, sizeof(cmd), file_);
-  fwrite(membase_ + base_ptr, 4, count, file_);
+  AppendCommandData(&cmd, sizeof(cmd));
+  AppendCommandData(membase_ + base_ptr, 4 * size_t(count));
 }
 
 void TraceWriter::WritePacketEnd() {
@@ -137,7 +426,11 @@ void TraceWriter::WritePacketEnd() {
   PacketEndCommand cmd = {
       TraceCommandType::kPacketEnd,
   };
-  fwrite(&cmd, 1, sizeof(cmd), file_);
+  AppendCommandData(&cmd, sizeof(cmd));
+  // Split frames where unindexed traces are split by the reader.
+  if (swap_pending_) {
+    EndFrame();
+  }
 }
 
 void TraceWriter::WriteMemoryRead(uint32_t base_ptr, size_t length,
@@ -182,86 +475,46 @@ void TraceWriter::WriteMemoryWrite(uint32_t base_ptr, size_t length,
                      host_ptr);
 }
 
-class SnappySink : public snappy::Sink {
- public:
-  SnappySink(FILE* file) : file_(file) {}
-
-  void Append(const char* bytes, size_t n) override {
-    fwrite(bytes, 1, n, file_);
-  }
-
- private:
-  FILE* file_ = nullptr;
-};
-
 void TraceWriter::WriteMemoryCommand(TraceCommandType type, uint32_t base_ptr,
                                      size_t length, const void* host_ptr) {
   MemoryCommand cmd = {};
   cmd.type = type;
   cmd.base_ptr = base_ptr;
-  cmd.encoding_format = MemoryEncodingFormat::kNone;
-  cmd.encoded_length = cmd.decoded_length = static_cast<uint32_t>(length);
+  cmd.decoded_length = static_cast<uint32_t>(length);
 
   if (!host_ptr) {
     host_ptr = membase_ + cmd.base_ptr;
   }
 
-  bool compress = compress_output_ && length > compression_threshold_;
-  if (compress) {
-    // Write the header now so we reserve space in the buffer.
-    long header_position = std::ftell(file_);
-    cmd.encoding_format = MemoryEncodingFormat::kSnappy;
-    fwrite(&cmd, 1, sizeof(cmd), file_);
-
-    // Stream the content right to the buffer.
-    snappy::ByteArraySource snappy_source(
-        reinterpret_cast<const char*>(host_ptr), cmd.decoded_length);
-    SnappySink snappy_sink(file_);
-    cmd.encoded_length =
-        static_cast<uint32_t>(snappy::Compress(&snappy_source, &snappy_sink));
-
-    // Seek back and overwrite the header with our final size.
-    std::fseek(file_, header_position, SEEK_SET);
-    fwrite(&cmd, 1, sizeof(cmd), file_);
-    std::fseek(file_, header_position + sizeof(cmd) + cmd.encoded_length,
-               SEEK_SET);
+  if (length > memory_block_threshold_) {
+    // Large data is compressed separately from the commands, and repeated
+    // uploads of the same data are only stored once.
+    MemoryBlockReference reference = StoreMemoryBlockData(host_ptr, length);
+    cmd.encoding_format = MemoryEncodingFormat::kMemoryBlock;
+    cmd.encoded_length = sizeof(reference);
+    AppendCommandData(&cmd, sizeof(cmd));
+    AppendCommandData(&reference, sizeof(reference));
   } else {
-    // Uncompressed - write buffer directly to the file.
+    // Small data is stored inline, compressed along with the commands.
     cmd.encoding_format = MemoryEncodingFormat::kNone;
-    fwrite(&cmd, 1, sizeof(cmd), file_);
-    fwrite(host_ptr, 1, cmd.decoded_length, file_);
+    cmd.encoded_length = cmd.decoded_length;
+    AppendCommandData(&cmd, sizeof(cmd));
+    AppendCommandData(host_ptr, cmd.decoded_length);
   }
 }
 
 void TraceWriter::WriteEdramSnapshot(const void* snapshot) {
+  if (!file_) {
+    return;
+  }
   EdramSnapshotCommand cmd = {};
   cmd.type = TraceCommandType::kEdramSnapshot;
-
-  if (compress_output_) {
-    // Write the header now so we reserve space in the buffer.
-    long header_position = std::ftell(file_);
-    cmd.encoding_format = MemoryEncodingFormat::kSnappy;
-    fwrite(&cmd, 1, sizeof(cmd), file_);
-
-    // Stream the content right to the buffer.
-    snappy::ByteArraySource snappy_source(
-        reinterpret_cast<const char*>(snapshot), xenos::kEdramSizeBytes);
-    SnappySink snappy_sink(file_);
-    cmd.encoded_length =
-        static_cast<uint32_t>(snappy::Compress(&snappy_source, &snappy_sink));
-
-    // Seek back and overwrite the header with our final size.
-    std::fseek(file_, header_position, SEEK_SET);
-    fwrite(&cmd, 1, sizeof(cmd), file_);
-    std::fseek(file_, header_position + sizeof(cmd) + cmd.encoded_length,
-               SEEK_SET);
-  } else {
-    // Uncompressed - write buffer directly to the file.
-    cmd.encoding_format = MemoryEncodingFormat::kNone;
-    cmd.encoded_length = xenos::kEdramSizeBytes;
-    fwrite(&cmd, 1, sizeof(cmd), file_);
-    fwrite(snapshot, 1, xenos::kEdramSizeBytes, file_);
-  }
+  MemoryBlockReference reference =
+      StoreMemoryBlockData(snapshot, xenos::kEdramSizeBytes);
+  cmd.encoding_format = MemoryEncodingFormat::kMemoryBlock;
+  cmd.encoded_length = sizeof(reference);
+  AppendCommandData(&cmd, sizeof(cmd));
+  AppendCommandData(&reference, sizeof(reference));
 }
 
 void TraceWriter::WriteEvent(EventCommand::Type event_type) {
@@ -272,51 +525,38 @@ void TraceWriter::WriteEvent(EventCommand::Type event_type) {
       TraceCommandType::kEvent,
       event_type,
   };
-  fwrite(&cmd, 1, sizeof(cmd), file_);
+  AppendCommandData(&cmd, sizeof(cmd));
+  if (event_type == EventCommand::Type::kSwap) {
+    swap_pending_ = true;
+  }
 }
 
 void TraceWriter::WriteRegisters(uint32_t first_register,
                                  const uint32_t* register_values,
                                  uint32_t register_count,
                                  bool execute_callbacks_on_play) {
+  if (!file_) {
+    return;
+  }
   RegistersCommand cmd = {};
   cmd.type = TraceCommandType::kRegisters;
   cmd.first_register = first_register;
   cmd.register_count = register_count;
   cmd.execute_callbacks = execute_callbacks_on_play;
-
-  uint32_t uncompressed_length = uint32_t(sizeof(uint32_t) * register_count);
-  if (compress_output_) {
-    // Write the header now so we reserve space in the buffer.
-    long header_position = std::ftell(file_);
-    cmd.encoding_format = MemoryEncodingFormat::kSnappy;
-    fwrite(&cmd, 1, sizeof(cmd), file_);
-
-    // Stream the content right to the buffer.
-    snappy::ByteArraySource snappy_source(
-        reinterpret_cast<const char*>(register_values), uncompressed_length);
-    SnappySink snappy_sink(file_);
-    cmd.encoded_length =
-        static_cast<uint32_t>(snappy::Compress(&snappy_source, &snappy_sink));
-
-    // Seek back and overwrite the header with our final size.
-    std::fseek(file_, header_position, SEEK_SET);
-    fwrite(&cmd, 1, sizeof(cmd), file_);
-    std::fseek(file_, header_position + sizeof(cmd) + cmd.encoded_length,
-               SEEK_SET);
-  } else {
-    // Uncompressed - write the values directly to the file.
-    cmd.encoding_format = MemoryEncodingFormat::kNone;
-    cmd.encoded_length = uncompressed_length;
-    fwrite(&cmd, 1, sizeof(cmd), file_);
-    fwrite(register_values, 1, uncompressed_length, file_);
-  }
+  // Compressed along with the commands.
+  cmd.encoding_format = MemoryEncodingFormat::kNone;
+  cmd.encoded_length = uint32_t(sizeof(uint32_t) * register_count);
+  AppendCommandData(&cmd, sizeof(cmd));
+  AppendCommandData(register_values, cmd.encoded_length);
 }
 
 void TraceWriter::WriteGammaRamp(
     const reg::DC_LUT_30_COLOR* gamma_ramp_256_entry_table,
     const reg::DC_LUT_PWL_DATA* gamma_ramp_pwl_rgb,
     uint32_t gamma_ramp_rw_component) {
+  if (!file_) {
+    return;
+  }
   GammaRampCommand cmd = {};
   cmd.type = TraceCommandType::kGammaRamp;
   cmd.rw_component = uint8_t(gamma_ramp_rw_component);
@@ -325,42 +565,14 @@ void TraceWriter::WriteGammaRamp(
       sizeof(reg::DC_LUT_30_COLOR) * 256;
   constexpr uint32_t kPWLUncompressedLength =
       sizeof(reg::DC_LUT_PWL_DATA) * 3 * 128;
-  constexpr uint32_t kUncompressedLength =
+  // Compressed along with the commands.
+  cmd.encoding_format = MemoryEncodingFormat::kNone;
+  cmd.encoded_length =
       k256EntryTableUncompressedLength + kPWLUncompressedLength;
-  if (compress_output_) {
-    // Write the header now so we reserve space in the buffer.
-    long header_position = std::ftell(file_);
-    cmd.encoding_format = MemoryEncodingFormat::kSnappy;
-    fwrite(&cmd, 1, sizeof(cmd), file_);
-
-    // Stream the content right to the buffer.
-    {
-      std::unique_ptr<char[]> gamma_ramps(new char[kUncompressedLength]);
-      std::memcpy(gamma_ramps.get(), gamma_ramp_256_entry_table,
-                  k256EntryTableUncompressedLength);
-      std::memcpy(gamma_ramps.get() + k256EntryTableUncompressedLength,
-                  gamma_ramp_pwl_rgb, kPWLUncompressedLength);
-      snappy::ByteArraySource snappy_source(gamma_ramps.get(),
-                                            kUncompressedLength);
-      SnappySink snappy_sink(file_);
-      cmd.encoded_length =
-          static_cast<uint32_t>(snappy::Compress(&snappy_source, &snappy_sink));
-    }
-
-    // Seek back and overwrite the header with our final size.
-    std::fseek(file_, header_position, SEEK_SET);
-    fwrite(&cmd, 1, sizeof(cmd), file_);
-    std::fseek(file_, header_position + sizeof(cmd) + cmd.encoded_length,
-               SEEK_SET);
-  } else {
-    // Uncompressed - write the values directly to the file.
-    cmd.encoding_format = MemoryEncodingFormat::kNone;
-    cmd.encoded_length = kUncompressedLength;
-    fwrite(&cmd, 1, sizeof(cmd), file_);
-    fwrite(gamma_ramp_256_entry_table, 1, k256EntryTableUncompressedLength,
-           file_);
-    fwrite(gamma_ramp_pwl_rgb, 1, kPWLUncompressedLength, file_);
-  }
+  AppendCommandData(&cmd, sizeof(cmd));
+  AppendCommandData(gamma_ramp_256_entry_table,
+                    k256EntryTableUncompressedLength);
+  AppendCommandData(gamma_ramp_pwl_rgb, kPWLUncompressedLength);
 }
 #endif
 }  //  namespace gpu
@@ -10,9 +10,17 @@
 #ifndef XENIA_GPU_TRACE_WRITER_H_
 #define XENIA_GPU_TRACE_WRITER_H_
 
+#include <condition_variable>
+#include <deque>
 #include <filesystem>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "xenia/base/threading.h"
 
 #include "xenia/gpu/registers.h"
 #include "xenia/gpu/trace_protocol.h"
@@ -63,15 +71,72 @@ class TraceWriter {
                       uint32_t gamma_ramp_rw_component);
 
  private:
+  // Data accumulated by the command processor thread, compressed and written
+  // to the file on the compression thread.
+  struct PendingBlock {
+    TraceBlockType type;
+    uint32_t type_index;
+    std::vector<uint8_t> data;
+  };
+
+  struct MemoryBlockDataEntry {
+    uint64_t hash_high;
+    uint32_t length;
+    MemoryBlockReference reference;
+  };
+
   void WriteMemoryCommand(TraceCommandType type, uint32_t base_ptr,
                           size_t length, const void* host_ptr = nullptr);
+  void AppendCommandData(const void* data, size_t length);
+  // Records the frame ending at the current position in the command stream.
+  void EndFrame();
+  // Places the data in a memory block, or finds identical data written
+  // earlier.
+  MemoryBlockReference StoreMemoryBlockData(const void* data, size_t length);
+  void SubmitCommandBlock();
+  void SubmitMemoryBlock();
+  void SubmitBlock(TraceBlockType type, uint32_t type_index,
+                   std::vector<uint8_t>&& data);
+  void CompressionThreadMain();
+  // Writes the block and frame infos and the footer after the last block,
+  // leaving the file position at the end of the blocks.
+  void WriteIndex(const std::vector<TraceFrameInfo>& frame_infos);
 
   std::set<uint64_t> cached_memory_reads_;
   uint8_t* membase_;
   FILE* file_;
 
-  bool compress_output_ = true;
-  size_t compression_threshold_ = 1024;  // Min. number of bytes to compress.
+  size_t memory_block_threshold_ = 1024;  // Min. bytes to place in a block.
+
+  std::vector<uint8_t> command_buffer_;
+  uint32_t command_block_count_ = 0;
+  uint64_t command_stream_size_ = 0;
+  std::vector<uint8_t> memory_buffer_;
+  uint32_t memory_block_count_ = 0;
+  // Keyed by the lower half of XXH3-128 of the data.
+  std::unordered_map<uint64_t, MemoryBlockDataEntry> memory_block_data_;
+
+  // The frame being recorded.
+  uint64_t frame_command_offset_ = 0;
+  uint32_t frame_first_command_block_ = 0;
+  uint32_t frame_memory_block_count_ = 0;
+  bool swap_pending_ = false;
+
+  std::unique_ptr<xe::threading::Thread> compression_thread_;
+  std::mutex queue_mutex_;
+  // Notified when a block is queued, on flush requests and on shutdown.
+  std::condition_variable queue_cond_;
+  // Notified when the compression thread is done with a block.
+  std::condition_variable queue_space_cond_;
+  // Protected with queue_mutex_.
+  std::deque<PendingBlock> block_queue_;
+  size_t queued_bytes_ = 0;
+  bool flush_requested_ = false;
+  bool shutdown_ = false;
+  std::vector<TraceFrameInfo> frame_infos_;
+  // Owned by the compression thread until it's joined.
+  std::vector<TraceBlockInfo> block_infos_;
+  uint64_t file_offset_ = 0;
 
 #else
   // this could be annoying to maintain if new methods are added or the
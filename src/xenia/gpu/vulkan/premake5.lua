@@ -14,6 +14,7 @@ project("xenia-gpu-vulkan")
     "xenia-ui",
     "xenia-ui-vulkan",
     "xxhash",
+    "zstd",
   })
   includedirs({
     project_root.."/third_party/Vulkan-Headers/include",
@@ -57,6 +58,7 @@ if enableMiscSubprojects then
       "mspack",
       "snappy",
       "xxhash",
+      "zstd",
     })
     includedirs({
       project_root.."/third_party/Vulkan-Headers/include",
@@ -122,6 +124,7 @@ if enableMiscSubprojects then
       "mspack",
       "snappy",
       "xxhash",
+      "zstd",
     })
     includedirs({
       project_root.."/third_party/Vulkan-Headers/include",
@@ -8,10 +8,12 @@
  */
 
 #include <array>
+#include <chrono>
 #include <cstring>
 #include <forward_list>
 #include <memory>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <unordered_map>
 #include <vector>
@@ -101,6 +103,9 @@ class HidDemoApp final : public ui::WindowedApp {
       ui::Window* window);
 
   void Draw(ImGuiIO& io);
+  // Measures the GetState throughput of the created drivers, from one and from
+  // several threads at once, like guest threads polling.
+  std::string BenchmarkGetState() const;
   void DrawUserInputGetState(uint32_t user_index) const;
   void DrawInputGetState() const;
   void DrawUserInputGetKeystroke(uint32_t user_index, bool poll,
@@ -118,6 +123,7 @@ class HidDemoApp final : public ui::WindowedApp {
   std::unique_ptr<HidDemoDialog> demo_dialog_;
 
   bool is_active_ = true;
+  std::string benchmark_result_;
 };
 
 std::vector<std::unique_ptr<hid::InputDriver>> HidDemoApp::CreateInputDrivers(
@@ -234,6 +240,15 @@ void HidDemoApp::Draw(ImGuiIO& io) {
 
     ImGui::Text("Input System (hid) = \"%s\"", cvars::hid.c_str());
     ImGui::Checkbox("is_active", &is_active_);
+    ImGui::SameLine();
+    if (ImGui::Button("Benchmark GetState()")) {
+      benchmark_result_ = BenchmarkGetState();
+      XELOGI("GetState() benchmark: {}", benchmark_result_);
+    }
+    if (!benchmark_result_.empty()) {
+      ImGui::SameLine();
+      ImGui::TextUnformatted(benchmark_result_.c_str());
+    }
   }
   ImGui::End();
 
@@ -273,6 +288,35 @@ void HidDemoApp::Draw(ImGuiIO& io) {
   ImGui::End();
 }
 
+std::string HidDemoApp::BenchmarkGetState() const {
+  constexpr uint32_t kIterations = 100000;
+  std::string result;
+  for (uint32_t thread_count : {1, 4}) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < thread_count; ++i) {
+      threads.emplace_back([this]() {
+        X_INPUT_STATE state;
+        for (uint32_t j = 0; j < kIterations; ++j) {
+          input_system_->GetState(0, X_INPUT_FLAG_GAMEPAD, &state);
+        }
+      });
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    double ns = std::chrono::duration<double, std::nano>(
+                    std::chrono::steady_clock::now() - start)
+                    .count() /
+                kIterations;
+    if (!result.empty()) {
+      result += ", ";
+    }
+    result += fmt::format("{} threads: {:.1f} ns", thread_count, ns);
+  }
+  return result;
+}
+
 void HidDemoApp::DrawUserInputGetState(uint32_t user_index) const {
   ImGui::Text("User %u:", user_index);
 
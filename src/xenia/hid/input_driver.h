@@ -38,6 +38,7 @@ class InputDriver {
 
   virtual X_RESULT GetCapabilities(uint32_t user_index, uint32_t flags,
                                    X_INPUT_CAPABILITIES* out_caps) = 0;
+  // May be called by multiple threads at once, without the input system lock.
   virtual X_RESULT GetState(uint32_t user_index, X_INPUT_STATE* out_state) = 0;
   virtual X_RESULT SetState(uint32_t user_index,
                             X_INPUT_VIBRATION* vibration) = 0;
@@ -0,0 +1,76 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#ifndef XENIA_HID_INPUT_STATE_SNAPSHOT_H_
+#define XENIA_HID_INPUT_STATE_SNAPSHOT_H_
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace xe {
+namespace hid {
+
+// Latest value of some input state, published by a single thread (such as the
+// one receiving the device events) and read by any number of threads without
+// locking or allocating (a sequence lock). Reads only retry if they overlap a
+// publication, which is rare as states are small and change at most a few
+// thousand times per second.
+template <typename T>
+class InputStateSnapshot {
+  // Copied as bytes - plain data such as the guest structures, which aren't
+  // trivially copyable only because of the byte order wrappers.
+  static_assert(std::is_standard_layout_v<T> &&
+                std::is_trivially_destructible_v<T>);
+
+ public:
+  InputStateSnapshot() { Publish(T()); }
+
+  // Must only be called by one thread at a time.
+  void Publish(const T& value) {
+    uint64_t words[kWordCount] = {};
+    std::memcpy(words, &value, sizeof(T));
+    const uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+    // Odd while the words are being written.
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kWordCount; ++i) {
+      words_[i].store(words[i], std::memory_order_relaxed);
+    }
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  T Read() const {
+    uint64_t words[kWordCount];
+    uint32_t sequence;
+    do {
+      sequence = sequence_.load(std::memory_order_acquire);
+      for (size_t i = 0; i < kWordCount; ++i) {
+        words[i] = words_[i].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((sequence & 1) ||
+             sequence != sequence_.load(std::memory_order_relaxed));
+    T value;
+    std::memcpy(static_cast<void*>(&value), words, sizeof(T));
+    return value;
+  }
+
+ private:
+  static constexpr size_t kWordCount = (sizeof(T) + 7) / 8;
+
+  std::atomic<uint32_t> sequence_ = {0};
+  std::atomic<uint64_t> words_[kWordCount] = {};
+};
+
+}  // namespace hid
+}  // namespace xe
+
+#endif  // XENIA_HID_INPUT_STATE_SNAPSHOT_H_
@@ -46,6 +46,14 @@ InputSystem::~InputSystem() = default;
 X_STATUS InputSystem::Setup() { return X_STATUS_SUCCESS; }
 
 void InputSystem::AddDriver(std::unique_ptr<InputDriver> driver) {
+  const uint32_t input_type = driver->GetInputType();
+  if (input_type != InputType::None) {
+    for (uint32_t flags = 0; flags <= kInputTypeMask; ++flags) {
+      if (flags & input_type) {
+        filtered_drivers_[flags].push_back(driver.get());
+      }
+    }
+  }
   drivers_.push_back(std::move(driver));
 }
 
@@ -61,13 +69,22 @@ void InputSystem::UpdateUsedSlot(InputDriver* driver, uint8_t slot,
     return;
   }
 
-  if (connected_slots.test(slot) == connected) {
+  const uint32_t slot_bit = uint32_t(1) << slot;
+  if (bool(connected_slots_.load(std::memory_order_relaxed) & slot_bit) ==
+      connected) {
     // No state change, so nothing to do.
     return;
   }
 
+  std::lock_guard<std::mutex> slot_change_lock(slot_change_mutex_);
+  if (bool(connected_slots_.load(std::memory_order_relaxed) & slot_bit) ==
+      connected) {
+    // Another thread has already handled the change.
+    return;
+  }
+
   XELOGI(controller_slot_state_change_message[connected].c_str(), slot);
-  connected_slots.flip(slot);
+  connected_slots_.fetch_xor(slot_bit, std::memory_order_relaxed);
   if (kernel::kernel_state()) {
     kernel::kernel_state()->BroadcastNotification(
         kXNotificationSystemInputDevicesChanged, 0);
@@ -80,33 +97,20 @@ void InputSystem::UpdateUsedSlot(InputDriver* driver, uint8_t slot,
       return;
     }
 
-    controllers_max_joystick_value[slot] = {
-        {capabilities.gamepad.thumb_lx, capabilities.gamepad.thumb_ly},
-        {capabilities.gamepad.thumb_rx, capabilities.gamepad.thumb_ry}};
+    controllers_max_joystick_values_[slot].store(
+        uint64_t(uint16_t(capabilities.gamepad.thumb_lx)) |
+            (uint64_t(uint16_t(capabilities.gamepad.thumb_ly)) << 16) |
+            (uint64_t(uint16_t(capabilities.gamepad.thumb_rx)) << 32) |
+            (uint64_t(uint16_t(capabilities.gamepad.thumb_ry)) << 48),
+        std::memory_order_relaxed);
   }
 }
 
-std::vector<InputDriver*> InputSystem::FilterDrivers(uint32_t flags) {
-  std::vector<InputDriver*> filtered_drivers;
-  for (auto& driver : drivers_) {
-    if (driver->GetInputType() == InputType::None) {
-      continue;
-    }
-
-    if ((flags & driver->GetInputType()) != 0) {
-      filtered_drivers.push_back(driver.get());
-    }
-  }
-  return filtered_drivers;
-}
-
 X_RESULT InputSystem::GetCapabilities(uint32_t user_index, uint32_t flags,
                                       X_INPUT_CAPABILITIES* out_caps) {
   SCOPE_profile_cpu_f("hid");
 
-  std::vector<InputDriver*> filtered_drivers = FilterDrivers(flags);
-
-  for (auto& driver : filtered_drivers) {
+  for (InputDriver* driver : FilterDrivers(flags)) {
     X_RESULT result = driver->GetCapabilities(user_index, flags, out_caps);
     if (result == X_ERROR_SUCCESS) {
       return result;
@@ -119,19 +123,19 @@ X_RESULT InputSystem::GetState(uint32_t user_index, uint32_t flags,
                                X_INPUT_STATE* out_state) {
   SCOPE_profile_cpu_f("hid");
 
-  std::vector<InputDriver*> filtered_drivers = FilterDrivers(flags);
+  const std::vector<InputDriver*>& filtered_drivers = FilterDrivers(flags);
   if (filtered_drivers.empty()) {
     return X_ERROR_DEVICE_NOT_CONNECTED;
   }
 
-  for (auto& driver : filtered_drivers) {
+  for (InputDriver* driver : filtered_drivers) {
     X_RESULT result = driver->GetState(user_index, out_state);
     if (result == X_ERROR_SUCCESS) {
       UpdateUsedSlot(driver, user_index, true);
       AdjustDeadzoneLevels(user_index, &out_state->gamepad);
 
       if (out_state->gamepad.buttons != 0) {
-        last_used_slot = user_index;
+        last_used_slot_.store(user_index, std::memory_order_relaxed);
       }
       return result;
     }
@@ -157,10 +161,8 @@ X_RESULT InputSystem::GetKeystroke(uint32_t user_index, uint32_t flags,
                                    X_INPUT_KEYSTROKE* out_keystroke) {
   SCOPE_profile_cpu_f("hid");
 
-  std::vector<InputDriver*> filtered_drivers = FilterDrivers(flags);
-
   bool any_connected = false;
-  for (auto& driver : filtered_drivers) {
+  for (InputDriver* driver : FilterDrivers(flags)) {
     // connected_slots
     X_RESULT result = driver->GetKeystroke(user_index, flags, out_keystroke);
     if (result == X_ERROR_INVALID_PARAMETER ||
@@ -171,7 +173,7 @@ X_RESULT InputSystem::GetKeystroke(uint32_t user_index, uint32_t flags,
     any_connected = true;
 
     if (result == X_ERROR_SUCCESS) {
-      last_used_slot = user_index;
+      last_used_slot_.store(user_index, std::memory_order_relaxed);
       return result;
     }
 
@@ -196,19 +198,24 @@ void InputSystem::ToggleVibration() {
 
 void InputSystem::AdjustDeadzoneLevels(const uint8_t slot,
                                        X_INPUT_GAMEPAD* gamepad) {
-  if (slot > XUserMaxUserCount) {
+  if (slot >= XUserMaxUserCount) {
     return;
   }
 
+  const uint64_t max_joystick_values =
+      controllers_max_joystick_values_[slot].load(std::memory_order_relaxed);
+  // Unsigned, the SDL driver reports 0xFFFF as the maximum.
+  auto max_joystick_value = [max_joystick_values](uint32_t axis) {
+    return uint16_t(max_joystick_values >> (axis * 16));
+  };
+
   // Left stick
   if (cvars::left_stick_deadzone_percentage > 0.0 &&
       cvars::left_stick_deadzone_percentage < 1.0) {
     const double deadzone_lx_percentage =
-        controllers_max_joystick_value[slot].first.first *
-        cvars::left_stick_deadzone_percentage;
+        max_joystick_value(0) * cvars::left_stick_deadzone_percentage;
     const double deadzone_ly_percentage =
-        controllers_max_joystick_value[slot].first.second *
-        cvars::left_stick_deadzone_percentage;
+        max_joystick_value(1) * cvars::left_stick_deadzone_percentage;
 
     const double theta = std::atan2(static_cast<double>(gamepad->thumb_ly),
                                     static_cast<double>(gamepad->thumb_lx));
@@ -231,11 +238,9 @@ void InputSystem::AdjustDeadzoneLevels(const uint8_t slot,
   if (cvars::right_stick_deadzone_percentage > 0.0 &&
       cvars::right_stick_deadzone_percentage < 1.0) {
     const double deadzone_rx_percentage =
-        controllers_max_joystick_value[slot].second.first *
-        cvars::right_stick_deadzone_percentage;
+        max_joystick_value(2) * cvars::right_stick_deadzone_percentage;
     const double deadzone_ry_percentage =
-        controllers_max_joystick_value[slot].second.second *
-        cvars::right_stick_deadzone_percentage;
+        max_joystick_value(3) * cvars::right_stick_deadzone_percentage;
 
     const double theta = std::atan2(static_cast<double>(gamepad->thumb_ry),
                                     static_cast<double>(gamepad->thumb_rx));
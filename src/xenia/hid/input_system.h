@@ -10,8 +10,11 @@
 #ifndef XENIA_HID_INPUT_SYSTEM_H_
 #define XENIA_HID_INPUT_SYSTEM_H_
 
+#include <array>
+#include <atomic>
 #include <bitset>
 #include <memory>
+#include <mutex>
 #include <vector>
 #include "xenia/base/mutex.h"
 #include "xenia/hid/input.h"
@@ -37,10 +40,12 @@ class InputSystem {
 
   X_STATUS Setup();
 
+  // Drivers must be added before the input is used.
   void AddDriver(std::unique_ptr<InputDriver> driver);
 
   X_RESULT GetCapabilities(uint32_t user_index, uint32_t flags,
                            X_INPUT_CAPABILITIES* out_caps);
+  // Doesn't require the lock, may be called by multiple threads at once.
   X_RESULT GetState(uint32_t user_index, uint32_t flags,
                     X_INPUT_STATE* out_state);
   X_RESULT SetState(uint32_t user_index, X_INPUT_VIBRATION* vibration);
@@ -51,18 +56,18 @@ class InputSystem {
   void ToggleVibration();
 
   const std::bitset<XUserMaxUserCount> GetConnectedSlots() const {
-    return connected_slots;
+    return connected_slots_.load(std::memory_order_relaxed);
   }
 
-  uint32_t GetLastUsedSlot() const { return last_used_slot; }
+  uint32_t GetLastUsedSlot() const {
+    return last_used_slot_.load(std::memory_order_relaxed);
+  }
 
   SkylanderPortal* GetSkylanderPortal() { return skylander_portal_.get(); }
 
   std::unique_lock<xe_unlikely_mutex> lock();
 
  private:
-  typedef std::pair<uint16_t, uint16_t> joystick_value;
-
   const std::string controller_slot_state_change_message[2] = {
       "Controller disconnected from slot {}.",
       "New controller connected to slot {}."};
@@ -71,18 +76,30 @@ class InputSystem {
   void AdjustDeadzoneLevels(const uint8_t slot, X_INPUT_GAMEPAD* gamepad);
   X_INPUT_VIBRATION ModifyVibrationLevel(X_INPUT_VIBRATION* vibration);
 
-  std::vector<InputDriver*> FilterDrivers(uint32_t flags);
+  const std::vector<InputDriver*>& FilterDrivers(uint32_t flags) const {
+    return filtered_drivers_[flags & kInputTypeMask];
+  }
+
+  static constexpr uint32_t kInputTypeMask =
+      InputType::Controller | InputType::Keyboard | InputType::Other;
 
   xe::ui::Window* window_ = nullptr;
 
   std::vector<std::unique_ptr<InputDriver>> drivers_;
+  // The drivers of the input types for every combination of the type flags,
+  // so the drivers to query don't need to be gathered on every call.
+  std::array<std::vector<InputDriver*>, kInputTypeMask + 1> filtered_drivers_;
 
   std::unique_ptr<SkylanderPortal> skylander_portal_;
 
-  std::bitset<XUserMaxUserCount> connected_slots = {};
-  std::array<std::pair<joystick_value, joystick_value>, XUserMaxUserCount>
-      controllers_max_joystick_value = {};
-  uint32_t last_used_slot = 0;
+  // Taken when a controller is connected or disconnected.
+  std::mutex slot_change_mutex_;
+  std::atomic<uint32_t> connected_slots_ = {0};
+  // Maximum thumb stick values reported by the controller in each slot, as
+  // left x, left y, right x and right y in 16 bits each.
+  std::array<std::atomic<uint64_t>, XUserMaxUserCount>
+      controllers_max_joystick_values_ = {};
+  std::atomic<uint32_t> last_used_slot_ = {0};
 
   xe_unlikely_mutex lock_;
 };
@@ -14,3 +14,7 @@ project("xenia-hid")
   })
   local_platform_files()
   removefiles({"*_demo.cc"})
+
+if enableTests then
+  include("testing")
+end
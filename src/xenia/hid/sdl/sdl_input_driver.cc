@@ -33,6 +33,14 @@ namespace xe {
 namespace hid {
 namespace sdl {
 
+// The packet number, the change count it's for, and whether input was active
+// when it was last requested.
+static uint64_t PackPacketState(uint32_t packet_number, uint32_t change_count,
+                                bool is_active) {
+  return (uint64_t(packet_number & 0x7FFFFFFF) << 33) |
+         (uint64_t(is_active) << 32) | change_count;
+}
+
 SDLInputDriver::SDLInputDriver(xe::ui::Window* window, size_t window_z_order)
     : InputDriver(window, window_z_order),
       sdl_events_initialized_(false),
@@ -227,22 +235,43 @@ X_RESULT SDLInputDriver::GetState(uint32_t user_index,
     QueueControllerUpdate();
   }
 
-  auto controller = GetControllerState(user_index);
-  if (!controller) {
+  const ControllerSnapshot controller =
+      controller_snapshots_[user_index].Read();
+  if (!controller.connected) {
     return X_ERROR_DEVICE_NOT_CONNECTED;
   }
 
   // Make sure packet_number is only incremented by 1, even if there have been
   // multiple updates between GetState calls. Also track `is_active` to
-  // increment the packet number if it changed.
-  if ((is_active != controller->is_active) ||
-      (is_active && controller->state_changed)) {
-    controller->state.packet_number++;
-    controller->is_active = is_active;
-    controller->state_changed = false;
-  }
-  std::memcpy(out_state, &controller->state, sizeof(*out_state));
-  if (!is_active) {
+  // increment the packet number if it changed. May be called by multiple
+  // threads, so the new packet number is only taken if no other call got one
+  // in the meantime.
+  std::atomic<uint64_t>& packet_state = packet_states_[user_index];
+  uint64_t old_packet_state = packet_state.load(std::memory_order_relaxed);
+  uint32_t packet_number;
+  while (true) {
+    packet_number = uint32_t(old_packet_state >> 33);
+    const uint32_t last_change_count = uint32_t(old_packet_state);
+    const bool was_active = (old_packet_state >> 32) & 1;
+    if (is_active == was_active &&
+        (!is_active || controller.change_count == last_change_count)) {
+      break;
+    }
+    ++packet_number;
+    // While inactive, changes are seen once input is active again.
+    const uint64_t new_packet_state = PackPacketState(
+        packet_number,
+        is_active ? controller.change_count : last_change_count, is_active);
+    if (packet_state.compare_exchange_weak(old_packet_state, new_packet_state,
+                                           std::memory_order_relaxed)) {
+      break;
+    }
+  }
+
+  out_state->packet_number = packet_number;
+  if (is_active) {
+    out_state->gamepad = controller.gamepad;
+  } else {
     // Simulate an "untouched" controller. When we become active again the
     // pressed buttons aren't lost and will be visible again.
     std::memset(&out_state->gamepad, 0, sizeof(out_state->gamepad));
@@ -342,8 +371,9 @@ X_RESULT SDLInputDriver::GetKeystroke(uint32_t users, uint32_t flags,
 
   for (uint32_t user_index = (user_any ? 0 : users);
        user_index < (user_any ? HID_SDL_USER_COUNT : users + 1); user_index++) {
-    auto controller = GetControllerState(user_index);
-    if (!controller) {
+    const ControllerSnapshot controller =
+        controller_snapshots_[user_index].Read();
+    if (!controller.connected) {
       if (user_any) {
         continue;
       } else {
@@ -355,8 +385,8 @@ X_RESULT SDLInputDriver::GetKeystroke(uint32_t users, uint32_t flags,
     // "unpressed". The algorithm will automatically send UP events when
     // `is_active()` goes low and DOWN events when it goes high again.
     const uint64_t curr_butts =
-        is_active ? (controller->state.gamepad.buttons |
-                     AnalogToKeyfield(controller->state.gamepad))
+        is_active ? (controller.gamepad.buttons |
+                     AnalogToKeyfield(controller.gamepad))
                   : uint64_t(0);
     KeystrokeState& last = keystroke_states_.at(user_index);
 
@@ -526,8 +556,10 @@ void SDLInputDriver::OnControllerDeviceAdded(const SDL_Event& event) {
     auto& state = controllers_.at(user_id);
     state = {controller, {}};
     // XInput seems to start with packet_number = 1 .
-    state.state_changed = true;
+    state.change_count = 1;
     UpdateXCapabilities(state);
+    packet_states_[user_id].store(0, std::memory_order_relaxed);
+    PublishControllerState(user_id);
 
     XELOGI("SDL OnControllerDeviceAdded: Added at index {}.", user_id);
     XELOGI("SDL Controller {}: {}", user_id,
@@ -545,6 +577,7 @@ void SDLInputDriver::OnControllerDeviceRemoved(const SDL_Event& event) {
   if (idx) {
     SDL_GameControllerClose(controllers_.at(*idx).sdl);
     controllers_.at(*idx) = {};
+    PublishControllerState(*idx);
     keystroke_states_.at(*idx) = {};
     XELOGI("SDL OnControllerDeviceRemoved: Removed at player index {}.", *idx);
   } else {
@@ -580,7 +613,8 @@ void SDLInputDriver::OnControllerDeviceAxisMotion(const SDL_Event& event) {
       assert_always();
       break;
   }
-  controllers_.at(*idx).state_changed = true;
+  controllers_.at(*idx).change_count++;
+  PublishControllerState(*idx);
 }
 
 void SDLInputDriver::OnControllerDeviceButtonChanged(const SDL_Event& event) {
@@ -642,7 +676,8 @@ void SDLInputDriver::OnControllerDeviceButtonChanged(const SDL_Event& event) {
     xbuttons &= ~xbutton;
   }
   controller.state.gamepad.buttons = xbuttons;
-  controller.state_changed = true;
+  controller.change_count++;
+  PublishControllerState(*idx);
 }
 
 std::optional<size_t> SDLInputDriver::GetControllerIndexFromInstanceID(
@@ -802,6 +837,15 @@ inline uint64_t SDLInputDriver::AnalogToKeyfield(
   return f;
 }
 
+void SDLInputDriver::PublishControllerState(size_t user_index) {
+  const ControllerState& controller = controllers_.at(user_index);
+  ControllerSnapshot snapshot = {};
+  snapshot.gamepad = controller.state.gamepad;
+  snapshot.change_count = controller.change_count;
+  snapshot.connected = controller.sdl != nullptr;
+  controller_snapshots_[user_index].Publish(snapshot);
+}
+
 }  // namespace sdl
 }  // namespace hid
 }  // namespace xe
@@ -18,6 +18,7 @@
 #include "SDL.h"
 #include "third_party/rapidcsv/src/rapidcsv.h"
 #include "xenia/hid/input_driver.h"
+#include "xenia/hid/input_state_snapshot.h"
 
 #define HID_SDL_USER_COUNT 4
 #define HID_SDL_THUMB_THRES 0x4E00
@@ -51,8 +52,16 @@ class SDLInputDriver final : public InputDriver {
     SDL_GameController* sdl;
     X_INPUT_CAPABILITIES caps;
     X_INPUT_STATE state;
-    bool state_changed;
-    bool is_active;
+    // Incremented for every change of the state.
+    uint32_t change_count;
+  };
+
+  // What GetState and GetKeystroke see of a controller, published by the
+  // thread handling the SDL events.
+  struct ControllerSnapshot {
+    X_INPUT_GAMEPAD gamepad;
+    uint32_t change_count;
+    bool connected;
   };
 
   enum class RepeatState {
@@ -82,12 +91,22 @@ class SDLInputDriver final : public InputDriver {
   bool TestSDLVersion() const;
   void UpdateXCapabilities(ControllerState& state);
   void QueueControllerUpdate();
+  void PublishControllerState(size_t user_index);
 
   bool sdl_events_initialized_;
   bool sdl_gamecontroller_initialized_;
   int sdl_events_unflushed_;
   std::atomic<bool> sdl_pumpevents_queued_;
+  // Only accessed by the thread handling the SDL events, and by
+  // GetCapabilities.
   std::array<ControllerState, HID_SDL_USER_COUNT> controllers_;
+  std::array<InputStateSnapshot<ControllerSnapshot>, HID_SDL_USER_COUNT>
+      controller_snapshots_;
+  // The packet number of each controller, which is only incremented once
+  // between GetState calls no matter how many changes there were, packed with
+  // the change count it's for and whether input was active (see
+  // PackPacketState).
+  std::array<std::atomic<uint64_t>, HID_SDL_USER_COUNT> packet_states_ = {};
   std::array<KeystrokeState, HID_SDL_USER_COUNT> keystroke_states_;
 };
 
@@ -0,0 +1,12 @@
+project_root = "../../../.."
+include(project_root.."/tools/build")
+
+test_suite("xenia-hid-tests", project_root, ".", {
+  links = {
+    "fmt",
+    "xenia-base",
+    "xenia-hid",
+    "xenia-hid-nop",
+    "xenia-kernel",
+  },
+})
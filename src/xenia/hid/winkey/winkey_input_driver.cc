@@ -159,7 +159,8 @@ X_RESULT WinKeyInputDriver::GetState(uint32_t user_index,
     return X_ERROR_DEVICE_NOT_CONNECTED;
   }
 
-  packet_number_++;
+  const uint32_t packet_number =
+      packet_number_.fetch_add(1, std::memory_order_relaxed) + 1;
 
   uint16_t buttons = 0;
   uint8_t left_trigger = 0;
@@ -256,7 +257,7 @@ X_RESULT WinKeyInputDriver::GetState(uint32_t user_index,
     }
   }
 
-  out_state->packet_number = packet_number_;
+  out_state->packet_number = packet_number;
   out_state->gamepad.buttons = buttons;
   out_state->gamepad.left_trigger = left_trigger;
   out_state->gamepad.right_trigger = right_trigger;
@@ -10,6 +10,7 @@
 #ifndef XENIA_HID_WINKEY_WINKEY_INPUT_DRIVER_H_
 #define XENIA_HID_WINKEY_WINKEY_INPUT_DRIVER_H_
 
+#include <atomic>
 #include <queue>
 
 #include "xenia/base/mutex.h"
@@ -76,7 +77,7 @@ class WinKeyInputDriver final : public InputDriver {
   std::queue<KeyEvent> key_events_;
   std::vector<KeyBinding> key_bindings_;
   uint8_t key_map_[256];
-  uint32_t packet_number_ = 1;
+  std::atomic<uint32_t> packet_number_ = {1};
 };
 
 }  // namespace winkey
@@ -7,6 +7,7 @@
  ******************************************************************************
  */
 
+#include <future>
 #include <random>
 
 #include "third_party/rapidcsv/src/rapidcsv.h"
@@ -56,6 +57,14 @@ DEFINE_bool(
     "Store user data on backend (not recommended), otherwise fallback locally.",
     "Live");
 
+DEFINE_uint32(api_max_connections, 4,
+              "Maximum simultaneous connections to the API server.", "Live");
+
+DEFINE_uint32(api_cache_ttl, 2000,
+              "Milliseconds session and service queries may be answered from "
+              "cache. 0 disables caching.",
+              "Live");
+
 DEFINE_int32(discord_presence_user_index, 0,
              "User profile index used for Discord rich presence [0, 3].",
              "Live");
@@ -406,199 +415,156 @@ void XLiveAPI::clearXnaddrCache() {
   macAddressCache.clear();
 }
 
-// Request data from the server
-std::unique_ptr<HTTPResponseObjectJSON> XLiveAPI::Get(std::string endpoint,
-                                                      const uint32_t timeout) {
-  response_data chunk = {};
-  CURL* curl_handle = curl_easy_init();
-  CURLcode result;
-
-  if (GetInitState() == InitState::Failed) {
-    XELOGE("XLiveAPI::Get: Initialization failed");
-    return PraseResponse(chunk);
-  }
-
-  if (!curl_handle) {
-    XELOGE("XLiveAPI::Get: Cannot initialize CURL");
-    return PraseResponse(chunk);
+HttpClient* XLiveAPI::GetHttpClient() {
+  std::call_once(http_client_once_, []() {
+    http_client_ = HttpClient::Create(cvars::api_max_connections,
+                                      kMaxQueuedRequests);
+  });
+  if (http_client_) {
+    http_client_->set_verbose(cvars::logging);
   }
+  return http_client_.get();
+}
 
-  std::string endpoint_API = fmt::format("{}{}", GetApiAddress(), endpoint);
-
-  if (cvars::logging) {
-    XELOGI("cURL: {}", endpoint_API);
-
-    curl_easy_setopt(curl_handle, CURLOPT_VERBOSE, 1);
-    curl_easy_setopt(curl_handle, CURLOPT_STDERR, stderr);
-  }
-
-  curl_slist* headers = NULL;
-  headers = curl_slist_append(headers, "Content-Type: application/json");
-  headers = curl_slist_append(headers, "Accept: application/json");
-  headers = curl_slist_append(headers, "charset: utf-8");
-
-  if (headers == NULL) {
-    return PraseResponse(chunk);
-  }
+void XLiveAPI::Shutdown() { http_client_.reset(); }
 
-  if (timeout > 0) {
-    curl_easy_setopt(curl_handle, CURLOPT_TIMEOUT, timeout);
+void XLiveAPI::Submit(HttpClient::Request request,
+                      HttpClient::CompletionCallback callback) {
+  HttpClient* client =
+      GetInitState() != InitState::Failed ? GetHttpClient() : nullptr;
+  if (!client) {
+    HttpClient::Response response;
+    response.result = CURLE_FAILED_INIT;
+    callback(response);
+    return;
   }
 
-  curl_easy_setopt(curl_handle, CURLOPT_URL, endpoint_API.c_str());
-  curl_easy_setopt(curl_handle, CURLOPT_CUSTOMREQUEST, "GET");
-  curl_easy_setopt(curl_handle, CURLOPT_HTTPHEADER, headers);
-  curl_easy_setopt(curl_handle, CURLOPT_USERAGENT, "xenia");
-  curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, callback);
-  curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, (void*)&chunk);
-
-  result = curl_easy_perform(curl_handle);
+  InvalidateTitleCache(client, request);
+  client->Submit(std::move(request), std::move(callback));
+}
 
-  if (result != CURLE_OK) {
-    XELOGE("XLiveAPI::Get: CURL Error Code: {}", static_cast<uint32_t>(result));
-    return PraseResponse(chunk);
+bool XLiveAPI::TrySubmit(HttpClient::Request request,
+                         HttpClient::CompletionCallback callback) {
+  HttpClient* client =
+      GetInitState() != InitState::Failed ? GetHttpClient() : nullptr;
+  if (!client) {
+    HttpClient::Response response;
+    response.result = CURLE_FAILED_INIT;
+    callback(response);
+    return true;
   }
 
-  result =
-      curl_easy_getinfo(curl_handle, CURLINFO_RESPONSE_CODE, &chunk.http_code);
-
-  curl_easy_cleanup(curl_handle);
-  curl_slist_free_all(headers);
+  InvalidateTitleCache(client, request);
+  return client->TrySubmit(std::move(request), std::move(callback));
+}
 
-  if (result == CURLE_OK &&
-      (chunk.http_code == HTTP_STATUS_CODE::HTTP_OK ||
-       chunk.http_code == HTTP_STATUS_CODE::HTTP_NO_CONTENT)) {
-    return PraseResponse(chunk);
+void XLiveAPI::InvalidateTitleCache(HttpClient* client,
+                                    const HttpClient::Request& request) {
+  // Writes to a title's sessions invalidate its cached queries.
+  if (request.method != HttpClient::Method::kGet) {
+    const std::string title_prefix = GetApiAddress() + "title/";
+    const std::string_view url = request.url;
+    if (url.starts_with(title_prefix)) {
+      const size_t title_end = url.find('/', title_prefix.size());
+      client->InvalidateCache(url.substr(0, title_end + 1));
+    }
   }
-
-  XELOGE("XLiveAPI::Get: Failed! HTTP Error Code: {}", chunk.http_code);
-  return PraseResponse(chunk);
 }
 
-// Send data to the server
-std::unique_ptr<HTTPResponseObjectJSON> XLiveAPI::Post(std::string endpoint,
-                                                       const uint8_t* data,
-                                                       size_t data_size) {
+std::unique_ptr<HTTPResponseObjectJSON> XLiveAPI::Perform(
+    HttpClient::Request request) {
   response_data chunk = {};
-  CURL* curl_handle = curl_easy_init();
-  CURLcode result;
 
   if (GetInitState() == InitState::Failed) {
-    XELOGE("XLiveAPI::Post: Initialization failed");
+    XELOGE("XLiveAPI: Initialization failed");
     return PraseResponse(chunk);
   }
 
-  if (!curl_handle) {
-    XELOGE("XLiveAPI::Post: Cannot initialize CURL");
-    return PraseResponse(chunk);
-  }
-
-  std::string endpoint_API = fmt::format("{}{}", GetApiAddress(), endpoint);
-
-  if (cvars::logging) {
-    XELOGI("cURL: {}", endpoint_API);
-
-    curl_easy_setopt(curl_handle, CURLOPT_VERBOSE, 1);
-    curl_easy_setopt(curl_handle, CURLOPT_STDERR, stderr);
-  }
-
-  curl_slist* headers = NULL;
-
-  curl_easy_setopt(curl_handle, CURLOPT_URL, endpoint_API.c_str());
-  curl_easy_setopt(curl_handle, CURLOPT_CUSTOMREQUEST, "POST");
-  curl_easy_setopt(curl_handle, CURLOPT_USERAGENT, "xenia");
-  curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDS, data);
-
-  if (data_size > 0) {
-    curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDSIZE_LARGE,
-                     (curl_off_t)data_size);
-  } else {
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-    headers = curl_slist_append(headers, "Accept: application/json");
-    headers = curl_slist_append(headers, "charset: utf-8");
-
-    if (headers == NULL) {
-      return PraseResponse(chunk);
-    }
-
-    curl_easy_setopt(curl_handle, CURLOPT_HTTPHEADER, headers);
-  }
+  std::promise<HttpClient::Response> promise;
+  Submit(std::move(request), [&promise](HttpClient::Response& response) {
+    promise.set_value(std::move(response));
+  });
+  return PraseResponse(promise.get_future().get());
+}
 
-  // FindPlayers, QoS, SessionSearch
-  curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, (void*)&chunk);
-  curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, callback);
+// Request data from the server
+std::unique_ptr<HTTPResponseObjectJSON> XLiveAPI::Get(std::string endpoint,
+                                                      const uint32_t timeout,
+                                                      bool cacheable) {
+  HttpClient::Request request;
+  request.method = HttpClient::Method::kGet;
+  request.url = fmt::format("{}{}", GetApiAddress(), endpoint);
+  request.timeout = timeout;
+  request.cache_ttl_ms = cacheable ? cvars::api_cache_ttl : 0;
 
-  result = curl_easy_perform(curl_handle);
+  std::unique_ptr<HTTPResponseObjectJSON> response =
+      Perform(std::move(request));
 
-  if (result != CURLE_OK) {
-    XELOGE("XLiveAPI::Post: CURL Error Code: {}",
-           static_cast<uint32_t>(result));
-    return PraseResponse(chunk);
+  if (response->StatusCode() != HTTP_STATUS_CODE::HTTP_OK &&
+      response->StatusCode() != HTTP_STATUS_CODE::HTTP_NO_CONTENT) {
+    XELOGE("XLiveAPI::Get: Failed! HTTP Error Code: {}",
+           response->StatusCode());
   }
+  return response;
+}
 
-  result =
-      curl_easy_getinfo(curl_handle, CURLINFO_RESPONSE_CODE, &chunk.http_code);
-
-  curl_easy_cleanup(curl_handle);
-  curl_slist_free_all(headers);
+// Send data to the server
+std::unique_ptr<HTTPResponseObjectJSON> XLiveAPI::Post(std::string endpoint,
+                                                       const uint8_t* data,
+                                                       size_t data_size) {
+  std::unique_ptr<HTTPResponseObjectJSON> response =
+      Perform(MakePostRequest(endpoint, data, data_size));
 
-  if (CURLE_OK == result && chunk.http_code == HTTP_STATUS_CODE::HTTP_CREATED) {
-    return PraseResponse(chunk);
+  if (response->StatusCode() != HTTP_STATUS_CODE::HTTP_CREATED) {
+    XELOGE("XLiveAPI::Post: Failed! HTTP Error Code: {}",
+           response->StatusCode());
   }
+  return response;
+}
 
-  XELOGE("XLiveAPI::Post: Failed! HTTP Error Code: {}", chunk.http_code);
-  return PraseResponse(chunk);
+void XLiveAPI::PostAsync(
+    std::string endpoint, const uint8_t* data, size_t data_size,
+    std::function<void(std::unique_ptr<HTTPResponseObjectJSON>)> callback) {
+  Submit(MakePostRequest(endpoint, data, data_size),
+         [callback](HttpClient::Response& response) {
+           callback(PraseResponse(response));
+         });
 }
 
 // Delete data from the server
 std::unique_ptr<HTTPResponseObjectJSON> XLiveAPI::Delete(std::string endpoint) {
-  response_data chunk = {};
-  CURL* curl_handle = curl_easy_init();
-  CURLcode result;
+  HttpClient::Request request;
+  request.method = HttpClient::Method::kDelete;
+  request.url = fmt::format("{}{}", GetApiAddress(), endpoint);
 
-  if (GetInitState() == InitState::Failed) {
-    XELOGE("XLiveAPI::Delete: Initialization failed");
-    return PraseResponse(chunk);
-  }
+  std::unique_ptr<HTTPResponseObjectJSON> response =
+      Perform(std::move(request));
 
-  if (!curl_handle) {
-    XELOGE("XLiveAPI::Delete: Cannot initialize CURL");
-    return PraseResponse(chunk);
+  if (response->StatusCode() != HTTP_STATUS_CODE::HTTP_OK) {
+    XELOGE("XLiveAPI::Delete: Failed! HTTP Error Code: {}",
+           response->StatusCode());
   }
+  return response;
+}
 
-  std::string endpoint_API = fmt::format("{}{}", GetApiAddress(), endpoint);
-
-  struct curl_slist* headers = NULL;
-  headers = curl_slist_append(headers, "Content-Type: application/json");
-  headers = curl_slist_append(headers, "Accept: application/json");
-  headers = curl_slist_append(headers, "charset: utf-8");
-
-  curl_easy_setopt(curl_handle, CURLOPT_URL, endpoint_API.c_str());
-
-  curl_easy_setopt(curl_handle, CURLOPT_CUSTOMREQUEST, "DELETE");
-  curl_easy_setopt(curl_handle, CURLOPT_HTTPHEADER, headers);
-  curl_easy_setopt(curl_handle, CURLOPT_USERAGENT, "xenia");
-
-  result = curl_easy_perform(curl_handle);
+HttpClient::Request XLiveAPI::MakePostRequest(std::string_view endpoint,
+                                              const uint8_t* data,
+                                              size_t data_size) {
+  HttpClient::Request request;
+  request.method = HttpClient::Method::kPost;
+  request.url = fmt::format("{}{}", GetApiAddress(), endpoint);
 
-  if (result != CURLE_OK) {
-    XELOGE("XLiveAPI::Delete: CURL Error Code: {}",
-           static_cast<uint32_t>(result));
-    return PraseResponse(chunk);
+  // Without a size the data is a JSON string, otherwise it's binary (QoS,
+  // XStorage).
+  if (data_size > 0) {
+    request.json = false;
+  } else if (data) {
+    data_size = strlen(reinterpret_cast<const char*>(data));
   }
-
-  result =
-      curl_easy_getinfo(curl_handle, CURLINFO_RESPONSE_CODE, &chunk.http_code);
-
-  curl_easy_cleanup(curl_handle);
-  curl_slist_free_all(headers);
-
-  if (result == CURLE_OK && chunk.http_code == HTTP_STATUS_CODE::HTTP_OK) {
-    return PraseResponse(chunk);
+  if (data) {
+    request.body.assign(data, data + data_size);
   }
-
-  XELOGE("XLiveAPI::Delete: Failed! HTTP Error Code: {}", chunk.http_code);
-  return PraseResponse(chunk);
+  return request;
 }
 
 // Check connection to xenia web server.
@@ -829,6 +795,41 @@ response_data XLiveAPI::QoSGet(uint64_t sessionId) {
   return response->RawResponse();
 }
 
+std::vector<response_data> XLiveAPI::QoSGet(
+    std::span<const uint64_t> session_ids) {
+  // Issue every lookup up front so they run concurrently over the pooled
+  // connections instead of back to back.
+  std::vector<std::promise<HttpClient::Response>> promises(session_ids.size());
+  for (size_t i = 0; i < session_ids.size(); i++) {
+    HttpClient::Request request;
+    request.url = fmt::format("{}title/{:08X}/sessions/{:016x}/qos",
+                              GetApiAddress(), kernel_state()->title_id(),
+                              session_ids[i]);
+    Submit(std::move(request),
+           [&promise = promises[i]](HttpClient::Response& response) {
+             promise.set_value(std::move(response));
+           });
+  }
+
+  std::vector<response_data> chunks;
+  chunks.reserve(session_ids.size());
+  for (auto& promise : promises) {
+    std::unique_ptr<HTTPResponseObjectJSON> response =
+        PraseResponse(promise.get_future().get());
+
+    if (response->StatusCode() != HTTP_STATUS_CODE::HTTP_OK &&
+        response->StatusCode() != HTTP_STATUS_CODE::HTTP_NO_CONTENT) {
+      XELOGE("QoSGet error message: {}", response->Message());
+    }
+
+    chunks.push_back(response->RawResponse());
+  }
+
+  XELOGI("Requested QoS data for {} sessions.", session_ids.size());
+
+  return chunks;
+}
+
 void XLiveAPI::SessionModify(uint64_t sessionId, XGI_SESSION_MODIFY* data) {
   std::string endpoint = fmt::format("title/{:08X}/sessions/{:016x}/modify",
                                      kernel_state()->title_id(), sessionId);
@@ -865,7 +866,7 @@ std::vector<std::unique_ptr<SessionObjectJSON>> XLiveAPI::GetTitleSessions(
 
   std::string endpoint = fmt::format("title/{:08X}/sessions/search", title_id);
 
-  std::unique_ptr<HTTPResponseObjectJSON> response = Get(endpoint);
+  std::unique_ptr<HTTPResponseObjectJSON> response = Get(endpoint, 0, true);
 
   std::vector<std::unique_ptr<SessionObjectJSON>> sessions;
 
@@ -903,6 +904,114 @@ const std::vector<std::unique_ptr<SessionObjectJSON>> XLiveAPI::SessionSearch(
   std::string endpoint =
       fmt::format("title/{:08X}/sessions/search", kernel_state()->title_id());
 
+  const std::string query = MakeSessionSearchQuery(data, num_users);
+
+  std::unique_ptr<HTTPResponseObjectJSON> response =
+      Post(endpoint, (uint8_t*)query.c_str());
+
+  return ParseSessionSearch(response.get());
+}
+
+bool XLiveAPI::SessionSearchAsync(
+    XGI_SESSION_SEARCH* data, uint32_t num_users,
+    std::function<void(std::vector<SessionSearchResult>)> callback) {
+  const uint32_t title_id = kernel_state()->title_id();
+  const uint32_t num_results = data->num_results;
+
+  std::string endpoint = fmt::format("title/{:08X}/sessions/search", title_id);
+
+  const std::string query = MakeSessionSearchQuery(data, num_users);
+
+  struct PendingSearch {
+    std::mutex mutex;
+    std::vector<SessionSearchResult> results;
+    // Outstanding detail and property requests.
+    uint32_t remaining;
+    std::function<void(std::vector<SessionSearchResult>)> callback;
+  };
+
+  return TrySubmit(
+      MakePostRequest(endpoint, (uint8_t*)query.c_str(), 0),
+      [title_id, num_results,
+       callback](HttpClient::Response& http_response) {
+        auto sessions =
+            ParseSessionSearch(PraseResponse(http_response).get());
+
+        const uint32_t session_count = std::min<uint32_t>(
+            num_results, static_cast<uint32_t>(sessions.size()));
+
+        if (!session_count) {
+          callback({});
+          return;
+        }
+
+        auto search = std::make_shared<PendingSearch>();
+        search->results.resize(session_count);
+        search->remaining = session_count * 2;
+        search->callback = callback;
+
+        // The last request to finish hands the results over.
+        auto finish = [search]() {
+          std::unique_lock<std::mutex> lock(search->mutex);
+          if (--search->remaining) {
+            return;
+          }
+          lock.unlock();
+          search->callback(std::move(search->results));
+        };
+
+        // Details and properties of all sessions are fetched concurrently.
+        // This runs on the HTTP client thread, so it mustn't wait for a
+        // queue slot; sessions that don't fit are left out.
+        for (uint32_t i = 0; i < session_count; i++) {
+          const uint64_t session_id = sessions[i]->SessionID_UInt();
+
+          HttpClient::Request details;
+          details.url = fmt::format("{}title/{:08X}/sessions/{:016x}",
+                                    GetApiAddress(), title_id, session_id);
+
+          if (!TrySubmit(std::move(details),
+                         [search, finish, i](HttpClient::Response& response) {
+                           auto session = PraseResponse(response);
+                           if (session->StatusCode() ==
+                               HTTP_STATUS_CODE::HTTP_OK) {
+                             std::lock_guard<std::mutex> lock(search->mutex);
+                             search->results[i].session =
+                                 session->Deserialize<SessionObjectJSON>();
+                           }
+                           finish();
+                         })) {
+            XELOGW("SessionSearch: Queue full, dropping session {:016x}",
+                   session_id);
+            finish();
+          }
+
+          HttpClient::Request properties;
+          properties.url =
+              fmt::format("{}title/{:08X}/sessions/{:016x}/properties",
+                          GetApiAddress(), title_id, session_id);
+
+          if (!TrySubmit(std::move(properties),
+                         [search, finish, i](HttpClient::Response& response) {
+                           auto properties = PraseResponse(response);
+                           if (properties->StatusCode() ==
+                               HTTP_STATUS_CODE::HTTP_OK) {
+                             std::lock_guard<std::mutex> lock(search->mutex);
+                             search->results[i].properties =
+                                 properties
+                                     ->Deserialize<PropertiesObjectJSON>()
+                                     ->Properties();
+                           }
+                           finish();
+                         })) {
+            finish();
+          }
+        }
+      });
+}
+
+std::string XLiveAPI::MakeSessionSearchQuery(XGI_SESSION_SEARCH* data,
+                                             uint32_t num_users) {
   Document doc;
   doc.SetObject();
 
@@ -914,9 +1023,11 @@ const std::vector<std::unique_ptr<SessionObjectJSON>> XLiveAPI::SessionSearch(
   PrettyWriter<rapidjson::StringBuffer> writer(buffer);
   doc.Accept(writer);
 
-  std::unique_ptr<HTTPResponseObjectJSON> response =
-      Post(endpoint, (uint8_t*)buffer.GetString());
+  return buffer.GetString();
+}
 
+std::vector<std::unique_ptr<SessionObjectJSON>> XLiveAPI::ParseSessionSearch(
+    HTTPResponseObjectJSON* response) {
   std::vector<std::unique_ptr<SessionObjectJSON>> sessions;
 
   if (response->StatusCode() != HTTP_STATUS_CODE::HTTP_CREATED) {
@@ -926,7 +1037,8 @@ const std::vector<std::unique_ptr<SessionObjectJSON>> XLiveAPI::SessionSearch(
     return sessions;
   }
 
-  doc.Swap(doc.Parse(response->RawResponse().response));
+  Document doc;
+  doc.Parse(response->RawResponse().response);
 
   const Value& sessionsJsonArray = doc.GetArray();
 
@@ -950,7 +1062,7 @@ const std::unique_ptr<SessionObjectJSON> XLiveAPI::SessionDetails(
   std::string endpoint = fmt::format("title/{:08X}/sessions/{:016x}/details",
                                      kernel_state()->title_id(), sessionId);
 
-  std::unique_ptr<HTTPResponseObjectJSON> response = Get(endpoint);
+  std::unique_ptr<HTTPResponseObjectJSON> response = Get(endpoint, 0, true);
 
   std::unique_ptr<SessionObjectJSON> session =
       std::make_unique<SessionObjectJSON>();
@@ -1095,6 +1207,21 @@ std::unique_ptr<HTTPResponseObjectJSON> XLiveAPI::LeaderboardsFind(
   return response;
 }
 
+bool XLiveAPI::LeaderboardsFindAsync(
+    const uint8_t* data,
+    std::function<void(std::unique_ptr<HTTPResponseObjectJSON>)> callback) {
+  return TrySubmit(MakePostRequest("leaderboards/find", data, 0),
+                   [callback](HttpClient::Response& http_response) {
+                     auto response = PraseResponse(http_response);
+                     if (response->StatusCode() !=
+                         HTTP_STATUS_CODE::HTTP_CREATED) {
+                       XELOGE("LeaderboardsFind error message: {}",
+                              response->Message());
+                     }
+                     callback(std::move(response));
+                   });
+}
+
 void XLiveAPI::DeleteSession(uint64_t sessionId) {
   std::string endpoint = fmt::format("title/{:08X}/sessions/{:016x}",
                                      kernel_state()->title_id(), sessionId);
@@ -1334,7 +1461,7 @@ std::unique_ptr<ServicesObjectJSON> XLiveAPI::GetServices() {
   std::string endpoint =
       fmt::format("title/{:08X}/services", kernel_state()->title_id());
 
-  std::unique_ptr<HTTPResponseObjectJSON> response = Get(endpoint);
+  std::unique_ptr<HTTPResponseObjectJSON> response = Get(endpoint, 0, true);
 
   std::unique_ptr<ServicesObjectJSON> services =
       std::make_unique<ServicesObjectJSON>();
@@ -1707,13 +1834,30 @@ void XLiveAPI::SetPresence() {
   const uint8_t* player_presence_data =
       reinterpret_cast<const uint8_t*>(player_presence.c_str());
 
-  std::unique_ptr<HTTPResponseObjectJSON> response =
-      Post(endpoint, player_presence_data);
+  // Nothing waits on presence updates, so don't block the caller.
+  PostAsync(endpoint, player_presence_data, 0,
+            [](std::unique_ptr<HTTPResponseObjectJSON> response) {
+              if (response->StatusCode() != HTTP_STATUS_CODE::HTTP_CREATED) {
+                XELOGE("SetPresence error message: {}", response->Message());
+              }
+            });
+}
 
-  if (response->StatusCode() != HTTP_STATUS_CODE::HTTP_CREATED) {
-    XELOGE("SetPresence error message: {}", response->Message());
-    assert_always();
+std::unique_ptr<HTTPResponseObjectJSON> XLiveAPI::PraseResponse(
+    const HttpClient::Response& http_response) {
+  // Callers take ownership of the raw response, so hand out a malloc'd copy
+  // rather than the shared buffer.
+  response_data chunk = {};
+  if (http_response.result == CURLE_OK) {
+    chunk.http_code = http_response.http_code;
+    if (!http_response.body.empty()) {
+      chunk.size = http_response.body.size();
+      chunk.response = static_cast<char*>(malloc(chunk.size + 1));
+      memcpy(chunk.response, http_response.body.data(), chunk.size);
+      chunk.response[chunk.size] = 0;
+    }
   }
+  return PraseResponse(chunk);
 }
 
 std::unique_ptr<HTTPResponseObjectJSON> XLiveAPI::PraseResponse(
@@ -10,6 +10,8 @@
 #ifndef XENIA_KERNEL_XLIVEAPI_H_
 #define XENIA_KERNEL_XLIVEAPI_H_
 
+#include <functional>
+#include <mutex>
 #include <span>
 #include <unordered_set>
 
@@ -17,6 +19,7 @@
 
 #include "xenia/base/byte_order.h"
 #include "xenia/kernel/upnp.h"
+#include "xenia/kernel/util/http_client.h"
 #include "xenia/kernel/util/net_utils.h"
 #include "xenia/kernel/xsession.h"
 
@@ -82,6 +85,9 @@ class XLiveAPI {
 
   static void Init();
 
+  // Aborts outstanding requests and closes the pooled connections.
+  static void Shutdown();
+
   static void clearXnaddrCache();
 
   static sockaddr_in Getwhoami();
@@ -105,6 +111,9 @@ class XLiveAPI {
 
   static response_data QoSGet(uint64_t sessionId);
 
+  static std::vector<response_data> QoSGet(
+      std::span<const uint64_t> session_ids);
+
   static void SessionModify(uint64_t sessionId, XGI_SESSION_MODIFY* data);
 
   static std::vector<std::unique_ptr<SessionObjectJSON>> GetTitleSessions(
@@ -113,6 +122,19 @@ class XLiveAPI {
   static const std::vector<std::unique_ptr<SessionObjectJSON>> SessionSearch(
       XGI_SESSION_SEARCH* data, uint32_t num_users);
 
+  // Asynchronous variants for overlapped XAM messages, see
+  // App::DispatchMessageOverlapped. They return false, without calling back,
+  // if the request queue is full. The callback runs on the HTTP client thread.
+
+  // Also fetches the details and properties of each session found.
+  static bool SessionSearchAsync(
+      XGI_SESSION_SEARCH* data, uint32_t num_users,
+      std::function<void(std::vector<SessionSearchResult>)> callback);
+
+  static bool LeaderboardsFindAsync(
+      const uint8_t* data,
+      std::function<void(std::unique_ptr<HTTPResponseObjectJSON>)> callback);
+
   static void SessionContextSet(uint64_t session_id,
                                 std::map<uint32_t, uint32_t> contexts);
 
@@ -182,6 +204,9 @@ class XLiveAPI {
 
   static void SetPresence();
 
+  static std::unique_ptr<HTTPResponseObjectJSON> PraseResponse(
+      const HttpClient::Response& http_response);
+
   static std::unique_ptr<HTTPResponseObjectJSON> PraseResponse(
       response_data response);
 
@@ -248,30 +273,54 @@ class XLiveAPI {
 
   inline static InitState initialized_ = InitState::Pending;
 
+  // Outstanding requests beyond which submitting blocks.
+  static constexpr uint32_t kMaxQueuedRequests = 64;
+
+  inline static std::once_flag http_client_once_;
+  inline static std::unique_ptr<HttpClient> http_client_;
+
+  static HttpClient* GetHttpClient();
+
+  static void Submit(HttpClient::Request request,
+                     HttpClient::CompletionCallback callback);
+
+  static bool TrySubmit(HttpClient::Request request,
+                        HttpClient::CompletionCallback callback);
+
+  static void InvalidateTitleCache(HttpClient* client,
+                                   const HttpClient::Request& request);
+
+  // Blocks until the response arrives. For callers that are synchronous by
+  // contract, or overlapped messages that fell back to the dispatch thread.
+  static std::unique_ptr<HTTPResponseObjectJSON> Perform(
+      HttpClient::Request request);
+
+  static std::string MakeSessionSearchQuery(XGI_SESSION_SEARCH* data,
+                                            uint32_t num_users);
+
+  static std::vector<std::unique_ptr<SessionObjectJSON>> ParseSessionSearch(
+      HTTPResponseObjectJSON* response);
+
+  static HttpClient::Request MakePostRequest(std::string_view endpoint,
+                                             const uint8_t* data,
+                                             size_t data_size);
+
+  // Cacheable requests may be answered with a response up to api_cache_ttl
+  // old.
   static std::unique_ptr<HTTPResponseObjectJSON> Get(
-      std::string endpoint, const uint32_t timeout = 0);
+      std::string endpoint, const uint32_t timeout = 0,
+      bool cacheable = false);
 
   static std::unique_ptr<HTTPResponseObjectJSON> Post(std::string endpoint,
                                                       const uint8_t* data,
                                                       size_t data_size = 0);
 
-  static std::unique_ptr<HTTPResponseObjectJSON> Delete(std::string endpoint);
-
-  // https://curl.se/libcurl/c/CURLOPT_WRITEFUNCTION.html
-  static size_t callback(void* data, size_t size, size_t nmemb, void* clientp) {
-    size_t realsize = size * nmemb;
-    struct response_data* mem = (struct response_data*)clientp;
-
-    char* ptr = (char*)realloc(mem->response, mem->size + realsize + 1);
-    if (ptr == NULL) return 0; /* out of memory! */
+  // Callback is invoked on the HTTP client thread.
+  static void PostAsync(
+      std::string endpoint, const uint8_t* data, size_t data_size,
+      std::function<void(std::unique_ptr<HTTPResponseObjectJSON>)> callback);
 
-    mem->response = ptr;
-    memcpy(&(mem->response[mem->size]), data, realsize);
-    mem->size += realsize;
-    mem->response[mem->size] = 0;
-
-    return realsize;
-  };
+  static std::unique_ptr<HTTPResponseObjectJSON> Delete(std::string endpoint);
 
   inline static sockaddr_in online_ip_{};
 
@@ -9,7 +9,11 @@
 
 #include "xenia/kernel/kernel_state.h"
 
+#include <algorithm>
+
 #include "xenia/base/byte_stream.h"
+#include "xenia/base/clock.h"
+#include "xenia/base/filesystem.h"
 #include "xenia/base/logging.h"
 #include "xenia/emulator.h"
 #include "xenia/hid/input_system.h"
@@ -36,6 +40,20 @@ DEFINE_bool(allow_incompatible_title_update, true,
 DEFINE_uint32(kernel_build_version, 1888, "Define current kernel version",
               "Kernel");
 
+DEFINE_uint32(socket_reactor_threads, 0,
+              "Number of host threads completing overlapped and event-selected "
+              "guest socket operations. 0 picks a default based on the host "
+              "core count.",
+              "Live");
+
+DEFINE_path(thread_statistics_csv, "",
+            "Periodically appends the CPU time, wait and APC statistics of "
+            "all kernel threads to this CSV file while a title is running.",
+            "Kernel");
+DEFINE_uint32(thread_statistics_csv_interval, 1000,
+              "Interval of thread_statistics_csv rows in milliseconds.",
+              "Kernel");
+
 DECLARE_string(cl);
 
 DECLARE_int32(network_mode);
@@ -83,6 +101,12 @@ KernelState::KernelState(Emulator* emulator)
 KernelState::~KernelState() {
   SetExecutableModule(nullptr);
 
+  if (thread_statistics_thread_) {
+    thread_statistics_shutdown_event_->Set();
+    xe::threading::Wait(thread_statistics_thread_.get(), false);
+    thread_statistics_thread_.reset();
+  }
+
   if (dispatch_thread_running_) {
     dispatch_thread_running_ = false;
     dispatch_cond_.notify_all();
@@ -96,6 +120,8 @@ KernelState::~KernelState() {
   // Delete all objects.
   object_table_.Reset();
 
+  socket_reactor_.reset();
+
   xam_state_.reset();
 
   assert_true(shared_kernel_state_ == this);
@@ -104,6 +130,16 @@ KernelState::~KernelState() {
 
 KernelState* KernelState::shared() { return shared_kernel_state_; }
 
+SocketReactor* KernelState::socket_reactor() {
+  std::call_once(socket_reactor_once_, [this]() {
+    socket_reactor_ = SocketReactor::Create(cvars::socket_reactor_threads);
+    if (!socket_reactor_) {
+      XELOGE("Failed to create the guest socket reactor");
+    }
+  });
+  return socket_reactor_.get();
+}
+
 uint32_t KernelState::title_id() const {
   if (!executable_module_) {
     return 0;
@@ -462,6 +498,51 @@ void KernelState::SetExecutableModule(object_ref<UserModule> module) {
     dispatch_thread_->set_name("Kernel Dispatch");
     dispatch_thread_->Create();
   }
+
+  if (!cvars::thread_statistics_csv.empty() && !thread_statistics_thread_) {
+    thread_statistics_shutdown_event_ =
+        xe::threading::Event::CreateManualResetEvent(false);
+    thread_statistics_thread_ = xe::threading::Thread::Create(
+        {}, [this]() { ThreadStatisticsThreadMain(); });
+    thread_statistics_thread_->set_name("Kernel Thread Statistics");
+  }
+}
+
+void KernelState::ThreadStatisticsThreadMain() {
+  FILE* file = xe::filesystem::OpenFile(cvars::thread_statistics_csv, "w");
+  if (!file) {
+    XELOGE("Failed to open {} for writing thread statistics",
+           xe::path_to_utf8(cvars::thread_statistics_csv));
+    return;
+  }
+  fmt::print(file,
+             "uptime_ms,thread_id,name,guest,priority,cpu,suspend_count,"
+             "cpu_time_ms,wait_time_ms,waits,voluntary_context_switches,"
+             "involuntary_context_switches,apcs\n");
+  auto interval = std::chrono::milliseconds(
+      std::max(cvars::thread_statistics_csv_interval, uint32_t(1)));
+  while (xe::threading::Wait(thread_statistics_shutdown_event_.get(), false,
+                             interval) == xe::threading::WaitResult::kTimeout) {
+    uint64_t uptime_ms = Clock::QueryHostUptimeMillis();
+    for (const XThreadStatistics& thread : QueryThreadStatistics()) {
+      // Names may contain commas and quotes.
+      std::string name = thread.name;
+      for (size_t quote = name.find('"'); quote != std::string::npos;
+           quote = name.find('"', quote + 2)) {
+        name.insert(quote, 1, '"');
+      }
+      fmt::print(file,
+                 "{},{:08X},\"{}\",{},{},{},{},{:.3f},{:.3f},{},{},{},{}\n",
+                 uptime_ms, thread.thread_id, name,
+                 thread.is_guest_thread ? 1 : 0, thread.priority,
+                 uint32_t(thread.active_cpu), thread.suspend_count,
+                 thread.cpu_time_ns / 1e6, thread.wait_time_ns / 1e6,
+                 thread.wait_count, thread.voluntary_context_switches,
+                 thread.involuntary_context_switches, thread.apc_count);
+    }
+    std::fflush(file);
+  }
+  std::fclose(file);
 }
 
 void KernelState::LoadKernelModule(object_ref<KernelModule> kernel_module) {
@@ -895,6 +976,27 @@ object_ref<XThread> KernelState::GetThreadByID(uint32_t thread_id) {
   return retain_object(thread);
 }
 
+std::vector<XThreadStatistics> KernelState::QueryThreadStatistics() {
+  // Sampling the host may be slow, don't hold the global lock while doing it.
+  std::vector<object_ref<XThread>> threads;
+  {
+    auto global_lock = global_critical_region_.Acquire();
+    threads.reserve(threads_by_id_.size());
+    for (const auto& it : threads_by_id_) {
+      threads.push_back(retain_object(it.second));
+    }
+  }
+  std::vector<XThreadStatistics> statistics(threads.size());
+  for (size_t i = 0; i < threads.size(); ++i) {
+    threads[i]->QueryStatistics(statistics[i]);
+  }
+  std::sort(statistics.begin(), statistics.end(),
+            [](const XThreadStatistics& a, const XThreadStatistics& b) {
+              return a.thread_id < b.thread_id;
+            });
+  return statistics;
+}
+
 void KernelState::RegisterNotifyListener(XNotifyListener* listener) {
   auto global_lock = global_critical_region_.Acquire();
   notify_listeners_.push_back(retain_object(listener));
@@ -1038,6 +1140,12 @@ void KernelState::CompleteOverlappedDeferredEx(
     std::function<X_RESULT(uint32_t&, uint32_t&)> completion_callback,
     uint32_t overlapped_ptr, std::function<void()> pre_callback,
     std::function<void()> post_callback) {
+  BeginOverlappedDeferred(overlapped_ptr);
+  QueueOverlappedCompletion(std::move(completion_callback), overlapped_ptr,
+                            std::move(pre_callback), std::move(post_callback));
+}
+
+void KernelState::BeginOverlappedDeferred(uint32_t overlapped_ptr) {
   auto ptr = memory()->TranslateVirtual(overlapped_ptr);
   XOverlappedSetResult(ptr, X_ERROR_IO_PENDING);
   XOverlappedSetContext(ptr, XThread::GetCurrentThreadHandle());
@@ -1050,6 +1158,12 @@ void KernelState::CompleteOverlappedDeferredEx(
       ev.get<XEvent>()->Reset();
     }
   }
+}
+
+void KernelState::QueueOverlappedCompletion(
+    std::function<X_RESULT(uint32_t&, uint32_t&)> completion_callback,
+    uint32_t overlapped_ptr, std::function<void()> pre_callback,
+    std::function<void()> post_callback) {
   auto global_lock = global_critical_region_.Acquire();
   dispatch_queue_.push_back([this, completion_callback, overlapped_ptr,
                              pre_callback, post_callback]() {
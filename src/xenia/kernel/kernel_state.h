@@ -14,9 +14,11 @@
 #include <condition_variable>
 #include <functional>
 #include <list>
+#include <mutex>
 #include <vector>
 
 #include "xenia/base/bit_map.h"
+#include "xenia/base/socket_reactor.h"
 #include "xenia/cpu/backend/backend.h"
 #include "xenia/cpu/export_resolver.h"
 #include "xenia/kernel/smc.h"
@@ -190,6 +192,10 @@ class KernelState {
 
   SystemManagementController* smc() const { return smc_.get(); }
 
+  // Readiness reactor shared by all guest sockets, created on first use.
+  // May return null if the host polling facility is unavailable.
+  SocketReactor* socket_reactor();
+
   xam::AchievementManager* achievement_manager() const {
     return xam_state()->achievement_manager();
   }
@@ -267,6 +273,8 @@ class KernelState {
   void OnThreadExecute(XThread* thread);
   void OnThreadExit(XThread* thread);
   object_ref<XThread> GetThreadByID(uint32_t thread_id);
+  // Snapshot of the statistics of all threads, sorted by thread ID.
+  std::vector<XThreadStatistics> QueryThreadStatistics();
 
   void RegisterNotifyListener(XNotifyListener* listener);
   void UnregisterNotifyListener(XNotifyListener* listener);
@@ -301,6 +309,17 @@ class KernelState {
       uint32_t overlapped_ptr, std::function<void()> pre_callback = nullptr,
       std::function<void()> post_callback = nullptr);
 
+  // CompleteOverlappedDeferredEx in two steps, for completions that wait on a
+  // host event (such as an HTTP response) rather than run straight away.
+  // BeginOverlappedDeferred marks the overlapped pending and must be called on
+  // the issuing guest thread. QueueOverlappedCompletion may then be called
+  // from any host thread to complete it on the dispatch thread.
+  void BeginOverlappedDeferred(uint32_t overlapped_ptr);
+  void QueueOverlappedCompletion(
+      std::function<X_RESULT(uint32_t&, uint32_t&)> completion_callback,
+      uint32_t overlapped_ptr, std::function<void()> pre_callback = nullptr,
+      std::function<void()> post_callback = nullptr);
+
   bool Save(ByteStream* stream);
   bool Restore(ByteStream* stream);
 
@@ -330,6 +349,7 @@ class KernelState {
   void SetProcessTLSVars(X_KPROCESS* process, int num_slots, int tls_data_size,
                          int tls_static_data_address);
   void InitializeKernelGuestGlobals();
+  void ThreadStatisticsThreadMain();
 
   std::vector<xam::XCONTENT_AGGREGATE_DATA> FindTitleUpdate(
       const uint32_t title_id) const;
@@ -353,6 +373,10 @@ class KernelState {
 
   xe::global_critical_region global_critical_region_;
 
+  // Must outlive the sockets in the object table.
+  std::once_flag socket_reactor_once_;
+  std::unique_ptr<SocketReactor> socket_reactor_;
+
   // Must be guarded by the global critical region.
   util::ObjectTable object_table_;
   std::unordered_map<uint32_t, XThread*> threads_by_id_;
@@ -375,6 +399,9 @@ class KernelState {
   BitMap tls_bitmap_;
   uint32_t ke_timestamp_bundle_ptr_ = 0;
   std::unique_ptr<xe::threading::HighResolutionTimer> timestamp_timer_;
+  // Periodic thread_statistics_csv writer.
+  std::unique_ptr<xe::threading::Event> thread_statistics_shutdown_event_;
+  std::unique_ptr<xe::threading::Thread> thread_statistics_thread_;
   cpu::backend::GuestTrampolineGroup kernel_trampoline_group_;
   // fixed address referenced by dashboards. Data is currently unknown
   uint32_t strange_hardcoded_page_ = 0x8E038634 & (~0xFFFF);
@@ -27,3 +27,7 @@ project("xenia-kernel")
   files({
     "debug_visualizers.natvis",
   })
+
+if enableTests then
+  include("testing")
+end
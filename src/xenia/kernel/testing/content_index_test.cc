@@ -0,0 +1,224 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/kernel/xam/content_index.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "third_party/fmt/include/fmt/format.h"
+
+#include "third_party/catch/include/catch.hpp"
+
+namespace xe {
+namespace kernel {
+namespace xam {
+namespace test {
+
+// Package and header directories of a content type, removed when destroyed.
+class ContentTree {
+ public:
+  ContentTree() {
+    path_ = std::filesystem::temp_directory_path() /
+            fmt::format("xenia_content_index_test_{}",
+                        std::chrono::steady_clock::now()
+                            .time_since_epoch()
+                            .count());
+    std::filesystem::create_directories(package_root());
+    std::filesystem::create_directories(header_root());
+  }
+  ~ContentTree() {
+    std::error_code error;
+    std::filesystem::remove_all(path_, error);
+  }
+
+  std::filesystem::path package_root() const { return path_ / "Packages"; }
+  std::filesystem::path header_root() const { return path_ / "Headers"; }
+  std::filesystem::path index_path() const { return path_ / "index.bin"; }
+
+  void AddPackage(const std::string& name, bool with_header,
+                  const std::u16string& display_name = u"") {
+    std::filesystem::create_directory(package_root() / name);
+    if (with_header) {
+      WriteHeader(name, display_name);
+    }
+  }
+
+  void WriteHeader(const std::string& name,
+                   const std::u16string& display_name) {
+    XCONTENT_AGGREGATE_DATA data = {};
+    data.device_id = 1;
+    data.content_type = XContentType::kSavedGame;
+    data.set_display_name(display_name);
+    data.set_file_name(name);
+    data.title_id = 0x41560817;
+    std::ofstream file(header_root() / (name + ".header"), std::ios::binary);
+    file.write(reinterpret_cast<const char*>(&data), sizeof(data));
+  }
+
+  // Sets the modification times of the directories to the same time, out of
+  // the window in which they aren't cached.
+  void Age() {
+    std::filesystem::last_write_time(package_root(), aged_time_);
+    std::filesystem::last_write_time(header_root(), aged_time_);
+  }
+
+ private:
+  std::filesystem::path path_;
+  std::filesystem::file_time_type aged_time_ =
+      std::filesystem::file_time_type::clock::now() - std::chrono::hours(1);
+};
+
+std::vector<ContentIndex::Package> Sorted(
+    std::vector<ContentIndex::Package> packages) {
+  std::sort(packages.begin(), packages.end(),
+            [](const auto& a, const auto& b) { return a.name < b.name; });
+  return packages;
+}
+
+TEST_CASE("Content index lists packages and headers", "[content_index]") {
+  ContentTree tree;
+  tree.AddPackage("0000000000000001", true, u"Save 1");
+  tree.AddPackage("0000000000000002", false);
+  // Files next to the packages aren't packages.
+  std::ofstream(tree.package_root() / "file.bin");
+  tree.Age();
+
+  ContentIndex index(tree.index_path());
+  auto packages = Sorted(index.List(tree.package_root(), tree.header_root()));
+  REQUIRE(packages.size() == 2);
+  REQUIRE(packages[0].name == "0000000000000001");
+  REQUIRE(packages[0].has_header);
+  REQUIRE(packages[0].data.display_name() == u"Save 1");
+  REQUIRE(packages[0].data.title_id == 0x41560817);
+  REQUIRE(packages[1].name == "0000000000000002");
+  REQUIRE_FALSE(packages[1].has_header);
+  REQUIRE(index.size() == 1);
+
+  // Missing directories have no packages.
+  REQUIRE(index.List(tree.package_root() / "missing", tree.header_root())
+              .empty());
+}
+
+TEST_CASE("Content index rescans changed directories", "[content_index]") {
+  ContentTree tree;
+  tree.AddPackage("A", true, u"First");
+  tree.Age();
+
+  ContentIndex index(tree.index_path());
+  REQUIRE(index.List(tree.package_root(), tree.header_root()).size() == 1);
+
+  // A header rewritten in place is only seen once its directory is touched.
+  tree.WriteHeader("A", u"Second");
+  tree.Age();
+  REQUIRE(index.List(tree.package_root(), tree.header_root())[0]
+              .data.display_name() == u"First");
+  std::filesystem::last_write_time(
+      tree.header_root(), std::filesystem::file_time_type::clock::now());
+  REQUIRE(index.List(tree.package_root(), tree.header_root())[0]
+              .data.display_name() == u"Second");
+
+  // Recently modified directories are rescanned every time.
+  REQUIRE(index.size() == 0);
+  tree.AddPackage("B", false);
+  REQUIRE(index.List(tree.package_root(), tree.header_root()).size() == 2);
+  std::filesystem::remove(tree.package_root() / "A");
+  REQUIRE(index.List(tree.package_root(), tree.header_root()).size() == 1);
+
+  tree.Age();
+  auto packages = index.List(tree.package_root(), tree.header_root());
+  REQUIRE(packages.size() == 1);
+  REQUIRE(packages[0].name == "B");
+  REQUIRE(index.size() == 1);
+}
+
+TEST_CASE("Content index is persisted", "[content_index]") {
+  ContentTree tree;
+  tree.AddPackage("A", true, u"Saved");
+  tree.AddPackage("B", false);
+  tree.Age();
+
+  {
+    ContentIndex index(tree.index_path());
+    REQUIRE_FALSE(index.Load());
+    index.List(tree.package_root(), tree.header_root());
+    REQUIRE(index.Save());
+  }
+
+  // Changed without touching the directories, so only the persisted index
+  // has the previous header.
+  tree.WriteHeader("A", u"Changed");
+  tree.Age();
+
+  ContentIndex index(tree.index_path());
+  REQUIRE(index.Load());
+  REQUIRE(index.size() == 1);
+  auto packages = Sorted(index.List(tree.package_root(), tree.header_root()));
+  REQUIRE(packages.size() == 2);
+  REQUIRE(packages[0].data.display_name() == u"Saved");
+  REQUIRE_FALSE(packages[1].has_header);
+
+  // A truncated index is ignored.
+  std::filesystem::resize_file(tree.index_path(),
+                               std::filesystem::file_size(tree.index_path()) -
+                                   1);
+  ContentIndex truncated_index(tree.index_path());
+  REQUIRE_FALSE(truncated_index.Load());
+  REQUIRE(truncated_index.size() == 0);
+}
+
+// Run explicitly with the [.benchmark] tag.
+TEST_CASE("Content index benchmark", "[content_index][.benchmark]") {
+  for (uint32_t package_count : {100u, 1000u, 5000u}) {
+    ContentTree tree;
+    for (uint32_t i = 0; i < package_count; ++i) {
+      tree.AddPackage(fmt::format("{:016X}", i), i % 8 != 0, u"Saved game");
+    }
+    tree.Age();
+
+    ContentIndex index(tree.index_path());
+    auto time = [&](const char* name, uint32_t iterations, auto&& function) {
+      size_t sink = 0;
+      auto start = std::chrono::steady_clock::now();
+      for (uint32_t i = 0; i < iterations; ++i) {
+        sink += function();
+      }
+      double us = std::chrono::duration<double, std::micro>(
+                      std::chrono::steady_clock::now() - start)
+                      .count() /
+                  iterations;
+      fmt::print("{} packages, {}: {:.1f} us [{}]\n", package_count, name, us,
+                 sink / iterations);
+    };
+    time("scan", 10, [&]() {
+      ContentIndex cold_index(tree.index_path());
+      return cold_index.List(tree.package_root(), tree.header_root()).size();
+    });
+    index.List(tree.package_root(), tree.header_root());
+    time("indexed", 100, [&]() {
+      return index.List(tree.package_root(), tree.header_root()).size();
+    });
+    index.Save();
+    time("loaded", 10, [&]() {
+      ContentIndex loaded_index(tree.index_path());
+      loaded_index.Load();
+      return loaded_index.List(tree.package_root(), tree.header_root()).size();
+    });
+  }
+}
+
+}  // namespace test
+}  // namespace xam
+}  // namespace kernel
+}  // namespace xe
@@ -0,0 +1,162 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2025 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/kernel/xam/xdbf/gpd_info.h"
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "third_party/catch/include/catch.hpp"
+#include "third_party/fmt/include/fmt/format.h"
+#include "xenia/base/string.h"
+
+namespace xe {
+namespace kernel {
+namespace test {
+
+using xam::Entry;
+using xam::GpdInfo;
+using xam::GpdSection;
+
+constexpr uint32_t kTitleId = 0x4D5307E6;
+
+class TestGpdInfo : public GpdInfo {
+ public:
+  using GpdInfo::GpdInfo;
+
+  // Replaces the image with data of a different size, so it's moved.
+  void ReplaceImage(uint32_t id, uint8_t value, uint32_t size) {
+    Entry entry(id, static_cast<uint16_t>(GpdSection::kImage), size);
+    std::memset(entry.data.data(), value, size);
+    UpsertEntry(&entry);
+  }
+
+  void PatchImage(uint32_t id, uint8_t value) {
+    Entry* entry = GetEntry(static_cast<uint16_t>(GpdSection::kImage), id);
+    REQUIRE(entry);
+    entry->data[0] = value;
+  }
+};
+
+// The strings are returned with the terminator.
+static std::u16string GetString(const GpdInfo& gpd, uint32_t id) {
+  return gpd.GetString(id).c_str();
+}
+
+static void AddEntries(GpdInfo& gpd, uint32_t count) {
+  for (uint32_t i = 0; i < count; ++i) {
+    gpd.AddString(i, xe::to_utf16(fmt::format("String {}", i)));
+    std::vector<uint8_t> image(16 + i % 64, uint8_t(i));
+    gpd.AddImage(i, image);
+  }
+}
+
+TEST_CASE("GPD entries lookup", "[gpd_info]") {
+  TestGpdInfo gpd(kTitleId);
+  AddEntries(gpd, 2000);
+
+  TestGpdInfo loaded(kTitleId, gpd.Serialize());
+  REQUIRE(loaded.IsValid());
+  for (uint32_t i = 0; i < 2000; ++i) {
+    REQUIRE(GetString(loaded, i) == xe::to_utf16(fmt::format("String {}", i)));
+    REQUIRE(loaded.GetImage(i).size() == 16 + i % 64);
+  }
+  REQUIRE(GetString(loaded, 2000).empty());
+  REQUIRE(loaded.GetImage(2000).empty());
+
+  // Removal moves another entry in place of the removed one.
+  loaded.ReplaceImage(0, 0xAA, 200);
+  REQUIRE(loaded.GetImage(0).size() == 200);
+  REQUIRE(loaded.GetImage(0)[0] == 0xAA);
+  REQUIRE(loaded.GetImage(1999).size() == 16 + 1999 % 64);
+  REQUIRE(GetString(loaded, 1999) == u"String 1999");
+}
+
+TEST_CASE("GPD incremental serialization", "[gpd_info]") {
+  // The same changes, with one of the files serialized before them.
+  TestGpdInfo incremental(kTitleId);
+  TestGpdInfo rebuilt(kTitleId);
+  AddEntries(incremental, 300);
+  AddEntries(rebuilt, 300);
+  incremental.Serialize();
+
+  for (TestGpdInfo* gpd : {&incremental, &rebuilt}) {
+    for (uint32_t i = 0; i < 300; i += 7) {
+      gpd->ReplaceImage(i, uint8_t(i + 1), 8 + i % 32);
+    }
+    for (uint32_t i = 1; i < 300; i += 11) {
+      gpd->PatchImage(i, 0x55);
+    }
+    gpd->AddString(1000, u"New string");
+  }
+  REQUIRE(incremental.Serialize() == rebuilt.Serialize());
+
+  // Nothing changed.
+  REQUIRE(incremental.Serialize() == rebuilt.Serialize());
+
+  // Growing the entry table.
+  for (TestGpdInfo* gpd : {&incremental, &rebuilt}) {
+    AddEntries(*gpd, 700);
+  }
+  REQUIRE(incremental.Serialize() == rebuilt.Serialize());
+}
+
+// Run explicitly with the [.benchmark] tag.
+TEST_CASE("GPD lookup and serialization benchmark",
+          "[gpd_info][.benchmark]") {
+  constexpr uint32_t kEntryCount = 10000;
+  constexpr uint32_t kIterations = 100;
+  TestGpdInfo gpd(kTitleId, [] {
+    GpdInfo source(kTitleId);
+    for (uint32_t i = 0; i < kEntryCount; ++i) {
+      source.AddString(i, xe::to_utf16(fmt::format("String {}", i)));
+    }
+    return source.Serialize();
+  }());
+  for (uint32_t i = 0; i < kEntryCount / 2; ++i) {
+    gpd.AddImage(i, std::vector<uint8_t>(64, uint8_t(i)));
+  }
+
+  auto time = [](const char* name, uint32_t count, auto&& function) {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    double ns = std::chrono::duration<double, std::nano>(
+                    std::chrono::steady_clock::now() - start)
+                    .count() /
+                count;
+    fmt::print("{}: {:.1f} ns\n", name, ns);
+  };
+
+  size_t found = 0;
+  time("Lookup", kIterations * kEntryCount, [&] {
+    for (uint32_t i = 0; i < kIterations; ++i) {
+      for (uint32_t id = 0; id < kEntryCount; ++id) {
+        found += gpd.GetImage(id).size();
+      }
+    }
+  });
+  REQUIRE(found == kIterations * (kEntryCount / 2) * 64);
+
+  size_t serialized_size = 0;
+  time("Full serialization", 1,
+       [&] { serialized_size = gpd.Serialize().size(); });
+  REQUIRE(serialized_size);
+  time("Serialization after one change", kIterations, [&] {
+    for (uint32_t i = 0; i < kIterations; ++i) {
+      gpd.ReplaceImage(i, uint8_t(i), 64);
+      serialized_size = gpd.Serialize().size();
+    }
+  });
+}
+
+}  // namespace test
+}  // namespace kernel
+}  // namespace xe
@@ -0,0 +1,274 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/kernel/util/guest_format.h"
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "third_party/fmt/include/fmt/format.h"
+#include "xenia/base/byte_order.h"
+#include "xenia/base/memory.h"
+
+#include "third_party/catch/include/catch.hpp"
+
+namespace xe {
+namespace kernel {
+namespace util {
+namespace test {
+
+constexpr uint32_t kStringAddress = 0x1000;
+constexpr uint32_t kWideStringAddress = 0x1100;
+constexpr uint32_t kWideNonLatinAddress = 0x1200;
+constexpr uint32_t kCountAddress = 0x2000;
+constexpr uint32_t kFormatAddress = 0x10000;
+constexpr uint32_t kArgsAddress = 0x20000;
+constexpr uint32_t kStackAddress = 0x28000;
+
+uint64_t DoubleArg(double value) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+class TestGuest {
+ public:
+  TestGuest() : memory_(0x30000, 0) {
+    ppc_context_ = std::make_unique<cpu::ppc::PPCContext>();
+    ppc_context_->virtual_membase = memory_.data();
+    std::strcpy(reinterpret_cast<char*>(host(kStringAddress)), "xenia");
+    SetWideString(kWideStringAddress, u"hi");
+    SetWideString(kWideNonLatinAddress, u"h\u0100");
+  }
+
+  cpu::ppc::PPCContext* ppc_context() { return ppc_context_.get(); }
+  uint8_t* host(uint32_t address) { return memory_.data() + address; }
+
+  void SetWideString(uint32_t address, std::u16string_view value) {
+    for (size_t i = 0; i < value.size(); ++i) {
+      xe::store_and_swap<uint16_t>(host(address + uint32_t(i) * 2),
+                                   uint16_t(value[i]));
+    }
+    xe::store_and_swap<uint16_t>(host(address + uint32_t(value.size()) * 2),
+                                 0);
+  }
+
+  void SetArgs(const std::vector<uint64_t>& args) {
+    for (size_t i = 0; i < args.size(); ++i) {
+      xe::store_and_swap<uint64_t>(host(kArgsAddress + uint32_t(i) * 8),
+                                   args[i]);
+    }
+  }
+
+  int32_t Format(const char* format, const std::vector<uint64_t>& args,
+                 std::string& output) {
+    std::strcpy(reinterpret_cast<char*>(host(kFormatAddress)), format);
+    SetArgs(args);
+    auto guest_args = GuestFormatArgs::FromArray(ppc_context(), kArgsAddress);
+    return FormatGuestString(ppc_context(), kFormatAddress, guest_args,
+                             output);
+  }
+
+  int32_t FormatWide(std::u16string_view format,
+                     const std::vector<uint64_t>& args, bool wide,
+                     std::u16string& output) {
+    SetWideString(kFormatAddress, format);
+    SetArgs(args);
+    auto guest_args = GuestFormatArgs::FromArray(ppc_context(), kArgsAddress);
+    return FormatGuestString(ppc_context(), kFormatAddress, guest_args, wide,
+                             output);
+  }
+
+ private:
+  std::vector<uint8_t> memory_;
+  std::unique_ptr<cpu::ppc::PPCContext> ppc_context_;
+};
+
+struct ConformanceCase {
+  const char* format;
+  std::vector<uint64_t> args;
+  const char* expected;
+};
+
+// Output of the previous character-at-a-time formatter, including its
+// deviations from the Windows CRT.
+const ConformanceCase kConformanceCases[] = {
+    {"plain text", {}, "plain text"},
+    {"100%% %d %i %u", {42, uint64_t(-7), uint64_t(-1)},
+     "100% 42 -7 4294967295"},
+    {"[%5d] [%-5d] [%05d] [%+d] [% d]",
+     {42, 42, uint64_t(-42), 42, 42},
+     "[   42] [42   ] [-0042] [+42] [ 42]"},
+    {"%x %X %#x %#X %#x %o %#o",
+     {0xBEEF, 0xBEEF, 255, 255, 0, 8, 8},
+     "beef BEEF 0xff 0XFF 0 10 010"},
+    {"%.3d %.0d| %3.2d", {5, 0, 7}, "005 |  07"},
+    {"%hd %hu %hx", {0x18000, 0xFFFF, 0x12345}, "-32768 4294967295 2345"},
+    {"%ld %lld %I64d %I64x %I32d",
+     {uint64_t(-1), 1234567890123ull, uint64_t(-5), 0x123456789ABCull, 77},
+     "-1 1234567890123 -5 123456789abc 77"},
+    {"%p %p", {0x82001234, 0}, "82001234 00000000"},
+    {"%*d|%-*d|%.*d", {6, 12, uint64_t(-6), 12, 4, 3},
+     "    12|12    |0003"},
+    {"%f %.2f %10.3f %-10.1f| %+.1f %e %E %g %G",
+     {DoubleArg(3.14159), DoubleArg(2.5), DoubleArg(-1.0005), DoubleArg(9.96),
+      DoubleArg(0.0), DoubleArg(12345.678), DoubleArg(0.00012),
+      DoubleArg(100000.0), DoubleArg(1e-10)},
+     "3.141590 2.50     -1.000 10.0      | +0.0 1.234568e+04 1.200000E-04 "
+     "100000 1E-10"},
+    {"%#.0f %#g %.0e",
+     {DoubleArg(3.0), DoubleArg(1.5), DoubleArg(12345.0)},
+     "3. 1.50000 1e+04"},
+    {"%s|%10s|%-10s|%.2s|%s",
+     {kStringAddress, kStringAddress, kStringAddress, kStringAddress, 0},
+     "xenia|     xenia|xenia     |xe|(null)"},
+    {"%S %ls %hs %ws %.1S",
+     {kWideStringAddress, kWideStringAddress, kStringAddress,
+      kWideStringAddress, kWideStringAddress},
+     "hi hi xenia hi h"},
+    {"%c%c%C%hc%lc", {'a', 0x162, 'b', 'c', 'd'}, "abbcd"},
+    // The character after %n is parsed as another conversion.
+    {"%nd", {kCountAddress, 8200}, "8200"},
+    // Unknown conversions only output the padding.
+    {"%5q|%-3Z|%hhd", {7}, "     |   |d"},
+    {"%-08.3d|%08s", {5, kStringAddress}, "005     |000xenia"},
+};
+
+TEST_CASE("Guest format matches the previous formatter", "[guest_format]") {
+  TestGuest guest;
+  for (const ConformanceCase& test_case : kConformanceCases) {
+    INFO(test_case.format);
+    std::string output;
+    int32_t count = guest.Format(test_case.format, test_case.args, output);
+    REQUIRE(output == test_case.expected);
+    REQUIRE(count == int32_t(output.size()));
+
+    // The same through a wide format string.
+    std::u16string wide_format(test_case.format,
+                               test_case.format + strlen(test_case.format));
+    std::u16string wide_output;
+    count = guest.FormatWide(wide_format, test_case.args, false, wide_output);
+    REQUIRE(wide_output == std::u16string(test_case.expected,
+                                          test_case.expected +
+                                              strlen(test_case.expected)));
+    REQUIRE(count == int32_t(wide_output.size()));
+  }
+}
+
+TEST_CASE("Guest format errors and side effects", "[guest_format]") {
+  TestGuest guest;
+  std::string output;
+
+  REQUIRE(guest.Format("abc%", {}, output) == -1);
+  // A wide character that doesn't fit in the narrow output.
+  REQUIRE(guest.Format("%S", {kWideNonLatinAddress}, output) == -1);
+
+  REQUIRE(guest.Format("ab%n cd%hn", {kCountAddress, kCountAddress + 4},
+                       output) == -1);
+  REQUIRE(xe::load_and_swap<uint32_t>(guest.host(kCountAddress)) == 2);
+  REQUIRE(guest.Format("abcd%hnx", {kCountAddress + 4, 0x1F}, output) == 6);
+  REQUIRE(output == "abcd1f");
+  REQUIRE(xe::load_and_swap<uint16_t>(guest.host(kCountAddress + 4)) == 4);
+
+  // 64-bit values outside the signed range.
+  REQUIRE(guest.Format("%llx %llu %lld",
+                       {uint64_t(-1), uint64_t(-1), 0x8000000000000000ull},
+                       output) == 58);
+  REQUIRE(output ==
+          "ffffffffffffffff 18446744073709551615 -9223372036854775808");
+}
+
+TEST_CASE("Guest wide format", "[guest_format]") {
+  TestGuest guest;
+  std::u16string output;
+
+  // wprintf meaning of %s and %S.
+  REQUIRE(guest.FormatWide(u"%s %S %c\u00E9\u4E2D",
+                           {kWideNonLatinAddress, kStringAddress, 0x4E2D},
+                           true, output) == 12);
+  REQUIRE(output == u"h\u0100 xenia \u4E2D\u00E9\u4E2D");
+
+  REQUIRE(guest.FormatWide(u"%-4s|%04d", {kWideStringAddress, 7}, true,
+                           output) == 9);
+  REQUIRE(output == u"hi  |0007");
+}
+
+TEST_CASE("Guest format arguments in registers and on the stack",
+          "[guest_format]") {
+  TestGuest guest;
+  auto ppc_context = guest.ppc_context();
+  std::strcpy(reinterpret_cast<char*>(guest.host(kFormatAddress)),
+              "%d %d %d %d %d %d %d %d %d");
+  for (uint32_t i = 0; i < 8; ++i) {
+    ppc_context->r[3 + i] = i;
+  }
+  ppc_context->r[1] = kStackAddress;
+  xe::store_and_swap<uint64_t>(guest.host(kStackAddress + 0x54), 8);
+  xe::store_and_swap<uint64_t>(guest.host(kStackAddress + 0x5C), 9);
+
+  auto args = GuestFormatArgs::FromRegisters(ppc_context, 1);
+  std::string output;
+  REQUIRE(FormatGuestString(ppc_context, kFormatAddress, args, output) == 17);
+  REQUIRE(output == "1 2 3 4 5 6 7 8 9");
+}
+
+TEST_CASE("Guest format strings are reparsed when changed",
+          "[guest_format]") {
+  TestGuest guest;
+  std::string output;
+  REQUIRE(guest.Format("%d-%d", {1, 2}, output) == 3);
+  REQUIRE(output == "1-2");
+  REQUIRE(guest.Format("%d-%d", {3, 4}, output) == 3);
+  REQUIRE(output == "3-4");
+  REQUIRE(guest.Format("%d+", {5}, output) == 2);
+  REQUIRE(output == "5+");
+  REQUIRE(guest.Format("%d+%d", {6, 7}, output) == 3);
+  REQUIRE(output == "6+7");
+}
+
+// Run explicitly with the [.benchmark] tag.
+TEST_CASE("Guest format benchmark", "[guest_format][.benchmark]") {
+  TestGuest guest;
+  constexpr uint32_t kIterations = 200000;
+  const ConformanceCase cases[] = {
+      {"Score: %08d  Lives: %d  Time: %02d:%02d.%03d",
+       {123456, 3, 4, 27, 999},
+       nullptr},
+      {"Player %s at (%.2f, %.2f, %.2f) hp=%5.1f%%",
+       {kStringAddress, DoubleArg(12.5), DoubleArg(-3.25),
+        DoubleArg(1024.0625), DoubleArg(87.5)},
+       nullptr},
+      {"[%s] frame %u: %d draws, %#x flags",
+       {kStringAddress, 36000, 1234, 0xC0FFEE},
+       nullptr},
+  };
+  std::string output;
+  for (const ConformanceCase& test_case : cases) {
+    guest.Format(test_case.format, test_case.args, output);
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < kIterations; ++i) {
+      auto args =
+          GuestFormatArgs::FromArray(guest.ppc_context(), kArgsAddress);
+      FormatGuestString(guest.ppc_context(), kFormatAddress, args, output);
+    }
+    double ns = std::chrono::duration<double, std::nano>(
+                    std::chrono::steady_clock::now() - start)
+                    .count() /
+                kIterations;
+    fmt::print("{}: {:.1f} ns\n", test_case.format, ns);
+  }
+}
+
+}  // namespace test
+}  // namespace util
+}  // namespace kernel
+}  // namespace xe
@@ -0,0 +1,309 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/kernel/util/http_client.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "third_party/catch/include/catch.hpp"
+#include "third_party/fmt/include/fmt/format.h"
+
+#include "xenia/base/platform.h"
+
+#if XE_PLATFORM_WIN32
+#include "xenia/base/platform_win.h"
+// winsock includes must come after platform_win.h:
+#include <winsock2.h>  // NOLINT(build/include_order)
+#include <ws2tcpip.h>  // NOLINT(build/include_order)
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace xe {
+namespace kernel {
+namespace test {
+
+#if XE_PLATFORM_WIN32
+using native_socket_t = SOCKET;
+static void CloseSocket(native_socket_t s) { closesocket(s); }
+#else
+using native_socket_t = int;
+static void CloseSocket(native_socket_t s) { close(s); }
+#endif
+
+// Minimal keep-alive HTTP/1.1 server on an ephemeral loopback port. Every
+// request is answered with 200 and a body naming the method and path.
+class StubServer {
+ public:
+  StubServer() {
+    listen_socket_ = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t address_len = sizeof(address);
+    bind(listen_socket_, reinterpret_cast<sockaddr*>(&address), address_len);
+    getsockname(listen_socket_, reinterpret_cast<sockaddr*>(&address),
+                &address_len);
+    listen(listen_socket_, 16);
+    port_ = ntohs(address.sin_port);
+    accept_thread_ = std::thread([this]() { AcceptMain(); });
+  }
+
+  ~StubServer() {
+    stopping_ = true;
+    // Unblock accept.
+    native_socket_t s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port_);
+    connect(s, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    CloseSocket(s);
+    accept_thread_.join();
+    CloseSocket(listen_socket_);
+    for (auto& thread : connection_threads_) {
+      thread.join();
+    }
+  }
+
+  std::string Url(std::string_view path) const {
+    return fmt::format("http://127.0.0.1:{}/{}", port_, path);
+  }
+
+  uint32_t connections() const { return connection_count_; }
+  uint32_t requests() const { return request_count_; }
+
+ private:
+  void AcceptMain() {
+    while (true) {
+      native_socket_t s = accept(listen_socket_, nullptr, nullptr);
+      if (stopping_) {
+        CloseSocket(s);
+        return;
+      }
+      ++connection_count_;
+      connection_threads_.emplace_back([this, s]() { ConnectionMain(s); });
+    }
+  }
+
+  void ConnectionMain(native_socket_t s) {
+    std::string buffer;
+    char data[4096];
+    while (true) {
+      size_t header_end = buffer.find("\r\n\r\n");
+      if (header_end == std::string::npos) {
+        int received = recv(s, data, sizeof(data), 0);
+        if (received <= 0) {
+          break;
+        }
+        buffer.append(data, received);
+        continue;
+      }
+      size_t content_length = 0;
+      size_t length_pos = buffer.find("Content-Length: ");
+      if (length_pos != std::string::npos && length_pos < header_end) {
+        content_length = std::stoul(buffer.substr(length_pos + 16));
+      }
+      size_t request_size = header_end + 4 + content_length;
+      if (buffer.size() < request_size) {
+        int received = recv(s, data, sizeof(data), 0);
+        if (received <= 0) {
+          break;
+        }
+        buffer.append(data, received);
+        continue;
+      }
+      ++request_count_;
+      std::string body = buffer.substr(0, buffer.find(" HTTP/1.1"));
+      std::string response = fmt::format(
+          "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+          "Content-Length: {}\r\n\r\n{}",
+          body.size(), body);
+      send(s, response.data(), int(response.size()), 0);
+      buffer.erase(0, request_size);
+    }
+    CloseSocket(s);
+  }
+
+  native_socket_t listen_socket_;
+  uint16_t port_;
+  std::atomic<bool> stopping_ = false;
+  std::thread accept_thread_;
+  std::vector<std::thread> connection_threads_;
+  std::atomic<uint32_t> connection_count_ = 0;
+  std::atomic<uint32_t> request_count_ = 0;
+};
+
+#if XE_PLATFORM_WIN32
+struct WinsockScope {
+  WinsockScope() {
+    WSADATA wsa_data;
+    WSAStartup(MAKEWORD(2, 2), &wsa_data);
+  }
+  ~WinsockScope() { WSACleanup(); }
+};
+#else
+struct WinsockScope {};
+#endif
+
+TEST_CASE("HTTP client reuses connections", "[http_client]") {
+  WinsockScope winsock;
+  StubServer server;
+  auto client = HttpClient::Create(1);
+  REQUIRE(client);
+
+  for (uint32_t i = 0; i < 8; ++i) {
+    HttpClient::Request request;
+    request.url = server.Url(fmt::format("sessions/{}", i));
+    auto response = client->Perform(std::move(request));
+    REQUIRE(response.result == CURLE_OK);
+    REQUIRE(response.http_code == 200);
+    REQUIRE(response.body == fmt::format("GET /sessions/{}", i));
+  }
+
+  HttpClient::Request post;
+  post.method = HttpClient::Method::kPost;
+  post.url = server.Url("qos");
+  post.body = {'{', '}'};
+  REQUIRE(client->Perform(std::move(post)).body == "POST /qos");
+
+  HttpClient::Request del;
+  del.method = HttpClient::Method::kDelete;
+  del.url = server.Url("sessions/0");
+  REQUIRE(client->Perform(std::move(del)).body == "DELETE /sessions/0");
+
+  REQUIRE(server.requests() == 10);
+  REQUIRE(server.connections() == 1);
+  REQUIRE(client->GetStats().connections == 1);
+}
+
+TEST_CASE("HTTP client caches GET responses", "[http_client]") {
+  WinsockScope winsock;
+  StubServer server;
+  auto client = HttpClient::Create();
+  REQUIRE(client);
+
+  auto get = [&](uint32_t cache_ttl_ms) {
+    HttpClient::Request request;
+    request.url = server.Url("services");
+    request.cache_ttl_ms = cache_ttl_ms;
+    return client->Perform(std::move(request));
+  };
+
+  REQUIRE_FALSE(get(60000).from_cache);
+  auto cached = get(60000);
+  REQUIRE(cached.from_cache);
+  REQUIRE(cached.http_code == 200);
+  REQUIRE(cached.body == "GET /services");
+  REQUIRE(server.requests() == 1);
+
+  // Requests without a TTL bypass the cache.
+  REQUIRE_FALSE(get(0).from_cache);
+  REQUIRE(server.requests() == 2);
+
+  client->InvalidateCache(server.Url("serv"));
+  REQUIRE_FALSE(get(60000).from_cache);
+  REQUIRE(server.requests() == 3);
+  REQUIRE(client->GetStats().cache_hits == 1);
+}
+
+TEST_CASE("HTTP client completes queued requests", "[http_client]") {
+  WinsockScope winsock;
+  StubServer server;
+  // Fewer queue slots than requests, so Submit has to block.
+  auto client = HttpClient::Create(4, 8);
+  REQUIRE(client);
+
+  constexpr uint32_t kRequestCount = 64;
+  std::atomic<uint32_t> completed = 0;
+  std::atomic<uint32_t> matched = 0;
+  for (uint32_t i = 0; i < kRequestCount; ++i) {
+    HttpClient::Request request;
+    request.url = server.Url(fmt::format("presence/{}", i));
+    client->Submit(std::move(request),
+                   [&, i](HttpClient::Response& response) {
+                     if (response.result == CURLE_OK &&
+                         response.body == fmt::format("GET /presence/{}", i)) {
+                       ++matched;
+                     }
+                     ++completed;
+                   });
+  }
+  // Destruction aborts anything outstanding, so wait for the completions.
+  while (completed < kRequestCount) {
+    std::this_thread::yield();
+  }
+  REQUIRE(matched == kRequestCount);
+  REQUIRE(server.connections() <= 4);
+}
+
+TEST_CASE("HTTP client rejects requests beyond the queue bound",
+          "[http_client]") {
+  WinsockScope winsock;
+  StubServer server;
+  auto client = HttpClient::Create(4, 2);
+  REQUIRE(client);
+
+  // Completions hold the worker thread, keeping both slots outstanding.
+  std::atomic<bool> release = false;
+  std::atomic<uint32_t> completed = 0;
+  auto submit = [&](const char* path) {
+    HttpClient::Request request;
+    request.url = server.Url(path);
+    return client->TrySubmit(std::move(request),
+                             [&](HttpClient::Response& response) {
+                               while (!release) {
+                                 std::this_thread::yield();
+                               }
+                               ++completed;
+                             });
+  };
+  REQUIRE(submit("sessions/0"));
+  REQUIRE(submit("sessions/1"));
+  REQUIRE_FALSE(submit("sessions/2"));
+
+  release = true;
+  while (completed < 2) {
+    std::this_thread::yield();
+  }
+
+  // A completion may chain the next request without blocking the worker.
+  std::atomic<bool> chained = false;
+  std::atomic<bool> matched = false;
+  HttpClient::Request request;
+  request.url = server.Url("sessions/search");
+  REQUIRE(client->TrySubmit(
+      std::move(request), [&](HttpClient::Response& response) {
+        HttpClient::Request details;
+        details.url = server.Url("sessions/0/details");
+        if (!client->TrySubmit(std::move(details),
+                               [&](HttpClient::Response& response) {
+                                 matched = response.body ==
+                                           "GET /sessions/0/details";
+                                 chained = true;
+                               })) {
+          chained = true;
+        }
+      }));
+  while (!chained) {
+    std::this_thread::yield();
+  }
+  REQUIRE(matched);
+  REQUIRE(server.requests() == 4);
+}
+
+}  // namespace test
+}  // namespace kernel
+}  // namespace xe
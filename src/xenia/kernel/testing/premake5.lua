@@ -0,0 +1,13 @@
+project_root = "../../../.."
+include(project_root.."/tools/build")
+
+test_suite("xenia-kernel-tests", project_root, ".", {
+  links = {
+    "fmt",
+    "libcurl",
+    "pugixml",
+    "xenia-base",
+    "xenia-kernel",
+    "zlib",
+  },
+})
@@ -0,0 +1,292 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/kernel/util/rtl_simd.h"
+
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "third_party/fmt/include/fmt/format.h"
+#include "xenia/base/byte_order.h"
+#include "xenia/base/platform.h"
+
+#include "third_party/catch/include/catch.hpp"
+
+namespace xe {
+namespace kernel {
+namespace util {
+namespace test {
+
+std::vector<RtlSimdLevel> SupportedLevels() {
+  std::vector<RtlSimdLevel> levels = {RtlSimdLevel::kScalar};
+#if XE_ARCH_AMD64
+  amd64::InitFeatureFlags();
+  RtlSimdLevel host_level = GetRtlSimdLevel();
+  if (host_level >= RtlSimdLevel::kSSE42) {
+    levels.push_back(RtlSimdLevel::kSSE42);
+  }
+  if (host_level >= RtlSimdLevel::kAVX2) {
+    levels.push_back(RtlSimdLevel::kAVX2);
+  }
+#endif
+  return levels;
+}
+
+const char* LevelName(RtlSimdLevel level) {
+  switch (level) {
+    case RtlSimdLevel::kSSE42:
+      return "SSE4.2";
+    case RtlSimdLevel::kAVX2:
+      return "AVX2";
+    default:
+      return "scalar";
+  }
+}
+
+// The previous implementations of the exports.
+
+uint32_t ReferenceCrc32(uint32_t crc, const uint8_t* data, size_t length) {
+  crc = ~crc;
+  for (size_t i = 0; i < length; ++i) {
+    crc ^= data[i];
+    for (uint32_t bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+int32_t ReferenceCompareStrings(const uint8_t* string_1, uint32_t length_1,
+                                const uint8_t* string_2, uint32_t length_2,
+                                bool case_insensitive) {
+  uint32_t length = std::min(length_1, length_2);
+  for (uint32_t i = 0; i < length; ++i) {
+    uint32_t c1 = string_1[i];
+    uint32_t c2 = string_2[i];
+    if (case_insensitive) {
+      c1 = RtlUpperAnsiChar(uint8_t(c1));
+      c2 = RtlUpperAnsiChar(uint8_t(c2));
+    }
+    if (c1 != c2) {
+      return int32_t(c1 - c2);
+    }
+  }
+  return int32_t(length_1 - length_2);
+}
+
+// Lengths around every block size, at every alignment of a 32-byte vector.
+std::vector<uint32_t> TestLengths() {
+  std::vector<uint32_t> lengths;
+  for (uint32_t length = 0; length <= 300; ++length) {
+    lengths.push_back(length);
+  }
+  for (uint32_t length : {1023u, 1024u, 4093u, 8160u, 8192u, 8229u}) {
+    lengths.push_back(length);
+  }
+  return lengths;
+}
+
+TEST_CASE("Rtl case mapping", "[rtl_simd]") {
+  REQUIRE(RtlUpperAnsiChar('a') == 'A');
+  REQUIRE(RtlUpperAnsiChar('Z') == 'Z');
+  REQUIRE(RtlUpperAnsiChar(0xE9) == 0xC9);
+  REQUIRE(RtlUpperAnsiChar(0xF7) == 0xF7);
+  REQUIRE(RtlUpperAnsiChar(0xFF) == 0x3F);
+  REQUIRE(RtlLowerAnsiChar('A') == 'a');
+  REQUIRE(RtlLowerAnsiChar(0xD7) == 0xD7);
+  REQUIRE(RtlLowerAnsiChar(0xDF) == 0xDF);
+}
+
+TEST_CASE("Rtl memory comparison and fill", "[rtl_simd]") {
+  std::mt19937 random(1);
+  std::vector<uint8_t> source1(8192 + 64), source2(8192 + 64);
+  for (size_t i = 0; i < source1.size(); ++i) {
+    source1[i] = source2[i] = uint8_t(random());
+  }
+  // Sparse and clustered differences.
+  for (size_t i = 0; i < source2.size(); i += 1 + random() % 61) {
+    source2[i] ^= uint8_t(1 + random() % 255);
+  }
+  for (size_t i = 4000; i < 4300; ++i) {
+    source2[i] = ~source1[i];
+  }
+  const uint32_t pattern = 0xC0FFEE42;
+
+  for (RtlSimdLevel level : SupportedLevels()) {
+    INFO(LevelName(level));
+    for (uint32_t length : TestLengths()) {
+      INFO(length);
+      for (uint32_t offset : {0u, 1u, 3u, 17u}) {
+        const uint8_t* p1 = source1.data() + offset;
+        const uint8_t* p2 = source2.data() + offset;
+        uint32_t equal_bytes = 0;
+        for (uint32_t i = 0; i < length; ++i) {
+          equal_bytes += p1[i] == p2[i];
+        }
+        REQUIRE(RtlCountEqualBytes(p1, p2, length, level) == equal_bytes);
+        REQUIRE(RtlCountEqualBytes(p1, p1, length, level) == length);
+
+        std::vector<uint8_t> filled(length + 40, 0xCD);
+        RtlFillUlongs(filled.data() + offset, length / 4, pattern, level);
+        for (uint32_t i = 0; i < filled.size(); ++i) {
+          uint8_t expected = 0xCD;
+          if (i >= offset && i < offset + (length & ~3u)) {
+            expected = uint8_t(pattern >> (24 - (i - offset) % 4 * 8));
+          }
+          REQUIRE(filled[i] == expected);
+        }
+
+        // Matching the whole buffer, then broken at every word and byte.
+        REQUIRE(RtlCompareUlongs(filled.data() + offset, length, pattern,
+                                 level) == (length & ~3u));
+        for (uint32_t i = 0; i < (length & ~3u); i += 1 + i / 16) {
+          uint8_t* mismatch = filled.data() + offset + i;
+          *mismatch ^= 0x10;
+          REQUIRE(RtlCompareUlongs(filled.data() + offset, length, pattern,
+                                   level) == (i & ~3u));
+          *mismatch ^= 0x10;
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("Rtl CRC-32", "[rtl_simd]") {
+  const char check[] = "123456789";
+  std::mt19937 random(2);
+  std::vector<uint8_t> data(8192 + 64);
+  for (uint8_t& value : data) {
+    value = uint8_t(random());
+  }
+
+  for (RtlSimdLevel level : SupportedLevels()) {
+    INFO(LevelName(level));
+    REQUIRE(RtlCrc32(0, reinterpret_cast<const uint8_t*>(check), 9, level) ==
+            0xCBF43926);
+    for (uint32_t length : TestLengths()) {
+      INFO(length);
+      for (uint32_t offset : {0u, 1u, 7u}) {
+        for (uint32_t seed : {0u, 0xFFFFFFFFu, 0x12345678u}) {
+          REQUIRE(RtlCrc32(seed, data.data() + offset, length, level) ==
+                  ReferenceCrc32(seed, data.data() + offset, length));
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("Rtl string comparison", "[rtl_simd]") {
+  for (RtlSimdLevel level : SupportedLevels()) {
+    INFO(LevelName(level));
+
+    // Every pair of characters, at every position of a 64-character string
+    // with both orders of the lengths.
+    std::vector<uint8_t> string_1(64, 'x'), string_2(64, 'X');
+    for (uint32_t position = 0; position < 64; position += 1 + position / 8) {
+      INFO(position);
+      for (uint32_t c1 = 0; c1 < 256; ++c1) {
+        for (uint32_t c2 = 0; c2 < 256; ++c2) {
+          string_1[position] = uint8_t(c1);
+          string_2[position] = uint8_t(c2);
+          for (bool case_insensitive : {false, true}) {
+            for (uint32_t length_2 : {64u, 63u}) {
+              REQUIRE(RtlCompareAnsiStrings(string_1.data(), 64,
+                                            string_2.data(), length_2,
+                                            case_insensitive, level) ==
+                      ReferenceCompareStrings(string_1.data(), 64,
+                                              string_2.data(), length_2,
+                                              case_insensitive));
+            }
+          }
+        }
+      }
+      string_1[position] = 'x';
+      string_2[position] = 'X';
+    }
+
+    // Random case changes with the mismatch at every length.
+    std::mt19937 random(3);
+    std::vector<uint8_t> text(300);
+    for (uint8_t& c : text) {
+      c = uint8_t(random());
+    }
+    for (uint32_t length : TestLengths()) {
+      if (length > text.size()) {
+        break;
+      }
+      std::vector<uint8_t> other(text.begin(), text.begin() + length);
+      for (uint8_t& c : other) {
+        c = (random() & 1) ? RtlUpperAnsiChar(c) : RtlLowerAnsiChar(c);
+      }
+      for (bool case_insensitive : {false, true}) {
+        REQUIRE(RtlCompareAnsiStrings(text.data(), length, other.data(),
+                                      length, case_insensitive, level) ==
+                ReferenceCompareStrings(text.data(), length, other.data(),
+                                        length, case_insensitive));
+        REQUIRE(RtlCompareAnsiStrings(text.data(), uint32_t(text.size()),
+                                      other.data(), length, case_insensitive,
+                                      level) ==
+                ReferenceCompareStrings(text.data(), uint32_t(text.size()),
+                                        other.data(), length,
+                                        case_insensitive));
+      }
+    }
+  }
+}
+
+// Run explicitly with the [.benchmark] tag.
+TEST_CASE("Rtl SIMD benchmark", "[rtl_simd][.benchmark]") {
+  std::vector<uint8_t> source1(0x10000), source2(0x10000), filled(0x10000);
+  for (size_t i = 0; i < source1.size(); ++i) {
+    source1[i] = source2[i] = uint8_t('a' + i % 26);
+    source2[i] = RtlUpperAnsiChar(source2[i]);
+  }
+  auto levels = SupportedLevels();
+
+  for (uint32_t size : {16u, 64u, 256u, 4096u, 65536u}) {
+    uint32_t iterations = 64 * 1024 * 1024 / size;
+    auto time = [&](const char* name, auto&& function) {
+      for (RtlSimdLevel level : levels) {
+        uint32_t sink = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < iterations; ++i) {
+          sink += function(level);
+        }
+        double ns = std::chrono::duration<double, std::nano>(
+                        std::chrono::steady_clock::now() - start)
+                        .count() /
+                    iterations;
+        fmt::print("{} {} bytes, {}: {:.1f} ns ({:.2f} GB/s) [{}]\n", name,
+                   size, LevelName(level), ns, size / ns, sink & 1);
+      }
+    };
+    time("RtlCompareMemory", [&](RtlSimdLevel level) {
+      return RtlCountEqualBytes(source1.data(), source1.data(), size, level);
+    });
+    time("RtlFillMemoryUlong", [&](RtlSimdLevel level) {
+      RtlFillUlongs(filled.data(), size / 4, 0x41414141, level);
+      return uint32_t(filled[0]);
+    });
+    time("RtlComputeCrc32", [&](RtlSimdLevel level) {
+      return RtlCrc32(0, source1.data(), size, level);
+    });
+    time("RtlCompareString", [&](RtlSimdLevel level) {
+      return uint32_t(RtlCompareAnsiStrings(source1.data(), size,
+                                            source2.data(), size, true,
+                                            level));
+    });
+  }
+}
+
+}  // namespace test
+}  // namespace util
+}  // namespace kernel
+}  // namespace xe
@@ -0,0 +1,382 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/kernel/util/xlast.h"
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "third_party/catch/include/catch.hpp"
+#include "third_party/fmt/include/fmt/format.h"
+#include "third_party/zlib/zlib.h"
+#include "xenia/base/string.h"
+
+namespace xe {
+namespace kernel {
+namespace test {
+
+using util::XLast;
+
+// An XLAST with the given number of each kind of entry. Every string is
+// translated to English and German, and only the first also to Japanese.
+std::string BuildXLastXml(uint32_t count) {
+  std::string xml =
+      "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+      "<XboxLiveSubmissionProject>\n"
+      "<GameConfigProject titleName=\"Test Title\">\n"
+      "<LocalizedStrings defaultLocale=\"en-US\">\n"
+      "<SupportedLocale locale=\"en-US\"/>\n"
+      "<SupportedLocale locale=\"de-DE\"/>\n"
+      "<SupportedLocale locale=\"ja-JP\"/>\n";
+  for (uint32_t i = 1; i <= count; ++i) {
+    xml += fmt::format(
+        "<LocalizedString id=\"{0}\" friendlyName=\"String{0}\">"
+        "<Translation locale=\"en-US\">English {0}</Translation>"
+        "<Translation locale=\"de-DE\">Deutsch {0}</Translation>",
+        i);
+    if (i == 1) {
+      xml += "<Translation locale=\"ja-JP\">Japanese 1</Translation>";
+    }
+    xml += "</LocalizedString>\n";
+  }
+  xml += "</LocalizedStrings>\n<GameModes defaultValue=\"1\">\n";
+  for (uint32_t i = 1; i <= count; ++i) {
+    xml += fmt::format(
+        "<GameMode value=\"{0}\" friendlyName=\"Mode{0}\" stringId=\"{0}\"/>\n",
+        i);
+  }
+  xml += "</GameModes>\n<Properties>\n";
+  for (uint32_t i = 1; i <= count; ++i) {
+    xml += fmt::format(
+        "<Property id=\"0x{:08X}\" friendlyName=\"Property{}\" "
+        "dataSize=\"{}\" stringId=\"{}\"><Format/></Property>\n",
+        0x10000000 | i, i, 4 + i % 2 * 4, i);
+  }
+  xml += "</Properties>\n<Contexts>\n";
+  for (uint32_t i = 1; i <= count; ++i) {
+    xml += fmt::format(
+        "<Context id=\"0x{:08X}\" friendlyName=\"Context{}\" "
+        "defaultValue=\"{}\">",
+        i, i, i % 3);
+    for (uint32_t value = 0; value < 3; ++value) {
+      xml += fmt::format("<ContextValue value=\"{}\" stringId=\"{}\"/>", value,
+                         i + value);
+    }
+    xml += "</Context>\n";
+  }
+  xml += "</Contexts>\n<Presence>\n";
+  for (uint32_t i = 1; i <= count; ++i) {
+    xml += fmt::format("<PresenceMode contextValue=\"{}\" stringId=\"{}\"/>\n",
+                       i - 1, i);
+  }
+  xml += "</Presence>\n<Matchmaking>\n<Queries>\n";
+  for (uint32_t i = 1; i <= count; ++i) {
+    xml += fmt::format(
+        "<Query id=\"{0}\" friendlyName=\"Query{0}\">"
+        "<Returns><Return id=\"0x{1:08X}\"/><Return id=\"0x{2:08X}\"/>"
+        "</Returns>"
+        "<Parameters><Parameter id=\"0x{1:08X}\"/></Parameters>"
+        "<Filters><Filter left=\"0x{1:08X}\" right=\"0x{3:08X}\"/></Filters>"
+        "</Query>\n",
+        i, 0x10000000 | i, 0x10000000 | (i + 1), 0x20000000 | i);
+  }
+  xml += "</Queries>\n</Matchmaking>\n</GameConfigProject>\n"
+         "</XboxLiveSubmissionProject>\n";
+  return xml;
+}
+
+// Compressed the way the XLAST is stored in the SPA.
+std::vector<uint8_t> GzipCompress(const std::string& data) {
+  z_stream stream = {};
+  REQUIRE(deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                       16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+  std::vector<uint8_t> compressed(deflateBound(&stream, uLong(data.size())));
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  stream.avail_in = uInt(data.size());
+  stream.next_out = compressed.data();
+  stream.avail_out = uInt(compressed.size());
+  REQUIRE(deflate(&stream, Z_FINISH) == Z_STREAM_END);
+  compressed.resize(stream.total_out);
+  deflateEnd(&stream);
+  return compressed;
+}
+
+std::unique_ptr<XLast> CreateXLast(const std::string& xml) {
+  std::vector<uint8_t> compressed = GzipCompress(xml);
+  return std::make_unique<XLast>(compressed.data(),
+                                 uint32_t(compressed.size()),
+                                 uint32_t(xml.size()));
+}
+
+// The lookups as they were done before the XLAST was indexed, searching the
+// document with XPath on every call.
+class XPathXLast {
+ public:
+  explicit XPathXLast(const std::string& xml) {
+    REQUIRE(document_.load_buffer(xml.data(), xml.size()));
+  }
+
+  pugi::xml_node Select(const std::string& xpath) const {
+    return document_.select_node(xpath.c_str()).node();
+  }
+
+  pugi::xml_node GameMode(uint32_t value) const {
+    return Select(fmt::format(
+        "/XboxLiveSubmissionProject/GameConfigProject/GameModes/"
+        "GameMode[@value = \"{}\"]",
+        value));
+  }
+  pugi::xml_node Property(uint32_t id) const {
+    return Select(fmt::format(
+        "/XboxLiveSubmissionProject/GameConfigProject/Properties/"
+        "Property[@id = \"0x{:08X}\"]",
+        id));
+  }
+  pugi::xml_node Context(uint32_t id) const {
+    return Select(fmt::format(
+        "/XboxLiveSubmissionProject/GameConfigProject/Contexts/"
+        "Context[@id = \"0x{:08X}\"]",
+        id));
+  }
+  pugi::xml_node ContextValue(uint32_t id, uint32_t value) const {
+    pugi::xml_node context = Context(id);
+    if (!context) {
+      return pugi::xml_node();
+    }
+    return context
+        .select_node(fmt::format("ContextValue[@value = \"{}\"]", value)
+                         .c_str())
+        .node();
+  }
+  pugi::xml_node Query(uint32_t id) const {
+    return Select(fmt::format(
+        "/XboxLiveSubmissionProject/GameConfigProject/Matchmaking/Queries/"
+        "Query[@id = \"{}\"]",
+        id));
+  }
+  std::optional<uint32_t> PresenceStringId(uint32_t context_value) const {
+    pugi::xml_node node = Select(fmt::format(
+        "/XboxLiveSubmissionProject/GameConfigProject/Presence/"
+        "PresenceMode[@contextValue = \"{}\"]",
+        context_value));
+    if (!node) {
+      return std::nullopt;
+    }
+    return node.attribute("stringId").as_uint();
+  }
+  std::u16string LocalizedString(uint32_t id, XLanguage language) const {
+    pugi::xml_node node = Select(fmt::format(
+        "/XboxLiveSubmissionProject/GameConfigProject/LocalizedStrings/"
+        "LocalizedString[@id = \"{}\"]",
+        id));
+    auto locale = util::language_mapping.find(language);
+    const std::string& locale_name =
+        locale != util::language_mapping.cend()
+            ? locale->second
+            : util::language_mapping.at(XLanguage::kEnglish);
+    pugi::xml_node locale_node =
+        node.find_child_by_attribute("locale", locale_name.c_str());
+    if (!locale_node) {
+      return u"";
+    }
+    return xe::to_utf16(locale_node.child_value());
+  }
+
+ private:
+  pugi::xml_document document_;
+};
+
+std::optional<uint32_t> UintAttribute(pugi::xml_node node, const char* name) {
+  if (!node) {
+    return std::nullopt;
+  }
+  return node.attribute(name).as_uint();
+}
+
+std::optional<std::string> StringAttribute(pugi::xml_node node,
+                                           const char* name) {
+  if (!node) {
+    return std::nullopt;
+  }
+  return std::string(node.attribute(name).as_string());
+}
+
+// One more than the number of entries, to also look up missing ones.
+constexpr uint32_t kEntryCount = 4;
+constexpr uint32_t kLookupCount = kEntryCount + 1;
+
+TEST_CASE("XLAST indexed lookups match XPath", "[xlast]") {
+  const std::string xml = BuildXLastXml(kEntryCount);
+  auto xlast = CreateXLast(xml);
+  XPathXLast reference(xml);
+  REQUIRE(xlast->HasXLast());
+  REQUIRE(xlast->GetTitleName() == u"Test Title");
+
+  SECTION("Game modes") {
+    auto query = xlast->GetGameModeQuery();
+    REQUIRE(query);
+    REQUIRE(query->GetGameModeValues() == std::vector<uint32_t>{1, 2, 3, 4});
+    REQUIRE(query->GetGameModeDefaultValue() == 1u);
+    for (uint32_t value = 0; value <= kLookupCount; ++value) {
+      INFO(value);
+      pugi::xml_node node = reference.GameMode(value);
+      REQUIRE(query->GetGameModeNode(value).empty() == node.empty());
+      REQUIRE(query->GetGameModeFriendlyName(value) ==
+              StringAttribute(node, "friendlyName"));
+      REQUIRE(query->GetGameModeStringID(value) ==
+              UintAttribute(node, "stringId"));
+      REQUIRE(xlast->GetGameModeStringId(value) ==
+              UintAttribute(node, "stringId"));
+    }
+  }
+
+  SECTION("Properties") {
+    auto query = xlast->GetPropertiesQuery();
+    REQUIRE(query);
+    REQUIRE(query->GetPropertyIDs().size() == kEntryCount);
+    for (uint32_t i = 0; i <= kLookupCount; ++i) {
+      const uint32_t id = 0x10000000 | i;
+      INFO(id);
+      pugi::xml_node node = reference.Property(id);
+      REQUIRE(query->GetPropertyNode(id).empty() == node.empty());
+      REQUIRE(query->GetPropertyFriendlyName(id) ==
+              StringAttribute(node, "friendlyName"));
+      REQUIRE(query->GetPropertySize(id) == UintAttribute(node, "dataSize"));
+      REQUIRE(query->GetPropertyStringID(id) ==
+              UintAttribute(node, "stringId"));
+      REQUIRE(query->GetPropertyFormat(id).empty() ==
+              node.child("Format").empty());
+    }
+  }
+
+  SECTION("Contexts") {
+    auto query = xlast->GetContextsQuery();
+    REQUIRE(query);
+    REQUIRE(query->GetContextsIDs() == std::vector<uint32_t>{1, 2, 3, 4});
+    for (uint32_t id = 0; id <= kLookupCount; ++id) {
+      INFO(id);
+      pugi::xml_node node = reference.Context(id);
+      REQUIRE(query->GetContextNode(id).empty() == node.empty());
+      REQUIRE(query->GetContextFriendlyName(id) ==
+              StringAttribute(node, "friendlyName"));
+      REQUIRE(query->GetContextDefaultValue(id) ==
+              UintAttribute(node, "defaultValue"));
+      for (uint32_t value = 0; value <= 3; ++value) {
+        INFO(value);
+        pugi::xml_node value_node = reference.ContextValue(id, value);
+        REQUIRE(query->GetContextValueNode(id, value).empty() ==
+                value_node.empty());
+        REQUIRE(query->GetContextValueStringID(id, value) ==
+                UintAttribute(value_node, "stringId"));
+      }
+    }
+  }
+
+  SECTION("Matchmaking queries") {
+    auto query = xlast->GetMatchmakingQuery();
+    REQUIRE(query);
+    for (uint32_t id = 0; id <= kLookupCount; ++id) {
+      INFO(id);
+      pugi::xpath_node node(reference.Query(id));
+      REQUIRE(query->GetQuery(id).empty() == node.node().empty());
+      REQUIRE(query->GetName(id) ==
+              std::string(node.node().attribute("friendlyName").value()));
+      REQUIRE(query->GetReturns(id) ==
+              XLast::GetAllValuesFromNode(node, "Returns", "id"));
+      REQUIRE(query->GetParameters(id) ==
+              XLast::GetAllValuesFromNode(node, "Parameters", "id"));
+      REQUIRE(query->GetFiltersLeft(id) ==
+              XLast::GetAllValuesFromNode(node, "Filters", "left"));
+      REQUIRE(query->GetFiltersRight(id) ==
+              XLast::GetAllValuesFromNode(node, "Filters", "right"));
+    }
+    REQUIRE(query->GetReturns(1) ==
+            std::vector<uint32_t>{0x10000001, 0x10000002});
+  }
+
+  SECTION("Presence") {
+    for (uint32_t value = 0; value <= kLookupCount; ++value) {
+      INFO(value);
+      REQUIRE(xlast->GetPresenceStringId(value) ==
+              reference.PresenceStringId(value));
+    }
+  }
+
+  SECTION("Localized strings") {
+    REQUIRE(xlast->GetSupportedLanguages() ==
+            std::vector<XLanguage>{XLanguage::kEnglish, XLanguage::kGerman,
+                                   XLanguage::kJapanese});
+    for (uint32_t language = uint32_t(XLanguage::kInvalid);
+         language < uint32_t(XLanguage::kMaxLanguages); ++language) {
+      for (uint32_t id = 0; id <= kLookupCount; ++id) {
+        INFO(language << " " << id);
+        REQUIRE(xlast->GetLocalizedString(id, XLanguage(language)) ==
+                reference.LocalizedString(id, XLanguage(language)));
+      }
+    }
+    REQUIRE(xlast->GetLocalizedString(2, XLanguage::kGerman) == u"Deutsch 2");
+    REQUIRE(xlast->GetLocalizedString(1, XLanguage::kJapanese) ==
+            u"Japanese 1");
+    REQUIRE(xlast->GetLocalizedString(2, XLanguage::kJapanese).empty());
+    // Languages without a locale use English.
+    REQUIRE(xlast->GetLocalizedString(3, XLanguage::kSChinese) ==
+            u"English 3");
+  }
+}
+
+// Run explicitly with the [.benchmark] tag.
+TEST_CASE("XLAST lookup benchmark", "[xlast][.benchmark]") {
+  for (uint32_t count : {16u, 256u, 2048u}) {
+    const std::string xml = BuildXLastXml(count);
+    auto xlast = CreateXLast(xml);
+    XPathXLast reference(xml);
+
+    auto time = [&](const char* name, auto&& function) {
+      constexpr uint32_t kIterations = 10000;
+      size_t sink = 0;
+      auto start = std::chrono::steady_clock::now();
+      for (uint32_t i = 0; i < kIterations; ++i) {
+        sink += function(1 + i % count);
+      }
+      double ns = std::chrono::duration<double, std::nano>(
+                      std::chrono::steady_clock::now() - start)
+                      .count() /
+                  kIterations;
+      fmt::print("{} entries, {}: {:.1f} ns [{}]\n", count, name, ns, sink);
+    };
+    time("XPath localized string", [&](uint32_t id) {
+      return reference.LocalizedString(id, XLanguage::kGerman).size();
+    });
+    time("indexed localized string", [&](uint32_t id) {
+      return xlast->GetLocalizedString(id, XLanguage::kGerman).size();
+    });
+    time("XPath presence string ID", [&](uint32_t value) {
+      return size_t(reference.PresenceStringId(value).value_or(0));
+    });
+    time("indexed presence string ID", [&](uint32_t value) {
+      return size_t(xlast->GetPresenceStringId(value).value_or(0));
+    });
+    time("XPath context value string ID", [&](uint32_t id) {
+      return size_t(
+          UintAttribute(reference.ContextValue(id, 1), "stringId").value_or(0));
+    });
+    auto contexts_query = xlast->GetContextsQuery();
+    time("indexed context value string ID", [&](uint32_t id) {
+      return size_t(
+          contexts_query->GetContextValueStringID(id, 1).value_or(0));
+    });
+  }
+}
+
+}  // namespace test
+}  // namespace kernel
+}  // namespace xe
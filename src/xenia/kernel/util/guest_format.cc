@@ -0,0 +1,767 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/kernel/util/guest_format.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "xenia/base/assert.h"
+#include "xenia/base/byte_order.h"
+#include "xenia/base/memory.h"
+#include "xenia/kernel/util/shim_utils.h"
+
+namespace xe {
+namespace kernel {
+namespace util {
+
+namespace {
+
+enum FormatState {
+  FS_Invalid = 0,
+  FS_Unknown,
+  FS_Start,
+  FS_Flags,
+  FS_Width,
+  FS_PrecisionStart,
+  FS_Precision,
+  FS_Size,
+  FS_Type,
+  FS_End,
+};
+
+enum FormatFlags : uint32_t {
+  FF_LeftJustify = 1 << 0,
+  FF_AddLeadingZeros = 1 << 1,
+  FF_AddPositive = 1 << 2,
+  FF_AddPositiveAsSpace = 1 << 3,
+  FF_AddNegative = 1 << 4,
+  FF_AddPrefix = 1 << 5,
+  FF_IsShort = 1 << 6,
+  FF_IsLong = 1 << 7,
+  FF_IsLongLong = 1 << 8,
+  FF_IsWide = 1 << 9,
+  FF_IsSigned = 1 << 10,
+  FF_ForceLeadingZero = 1 << 11,
+  FF_InvertWide = 1 << 12,
+};
+
+constexpr int32_t kMaxIntegerPrecision = 512;
+// Per thread, direct-mapped by the guest address of the format string.
+constexpr uint32_t kFormatCacheSize = 64;
+
+struct FormatOp {
+  enum class Type : uint8_t {
+    kLiteral,
+    kConversion,
+    // Format string ending in the middle of a specification.
+    kError,
+  };
+
+  Type type;
+  uint16_t conversion;
+  // %n doesn't end the specification - the next character is parsed as
+  // another conversion using the same width and precision.
+  bool inherit;
+  bool width_from_arg;
+  bool precision_from_arg;
+  uint32_t flags;
+  int32_t width;
+  int32_t precision;
+  uint32_t literal_offset;
+  uint32_t literal_length;
+};
+
+template <typename GuestChar>
+struct CompiledFormat {
+  uint32_t guest_address = 0;
+  // Characters with the terminator, as stored in guest memory.
+  std::vector<GuestChar> text;
+  std::vector<FormatOp> ops;
+};
+
+inline uint16_t LoadChar(uint8_t c) { return c; }
+inline uint16_t LoadChar(uint16_t c) { return xe::byte_swap(c); }
+
+inline size_t StringLength(const uint8_t* s) {
+  return std::strlen(reinterpret_cast<const char*>(s));
+}
+inline size_t StringLength(const uint16_t* s) {
+  const uint16_t* end = s;
+  while (*end) {
+    ++end;
+  }
+  return size_t(end - s);
+}
+
+// Parses the format string with the state machine of the original
+// character-at-a-time formatter, so invalid and unusual specifications
+// produce the same output.
+template <typename GuestChar>
+void CompileFormat(CompiledFormat<GuestChar>& format) {
+  std::vector<FormatOp>& ops = format.ops;
+  ops.clear();
+  const GuestChar* text = format.text.data();
+  size_t text_size = format.text.size();
+  size_t position = 0;
+
+  auto get = [&]() -> uint16_t {
+    uint16_t c = LoadChar(text[position]);
+    if (c) {
+      ++position;
+    }
+    return c;
+  };
+  auto peek = [&](size_t offset) -> uint16_t {
+    return position + offset < text_size ? LoadChar(text[position + offset])
+                                         : 0;
+  };
+  auto skip = [&](int32_t count) {
+    while (count-- > 0 && get()) {
+    }
+  };
+  // Appends the character just read.
+  auto add_literal = [&]() {
+    uint32_t offset = uint32_t(position - 1);
+    if (!ops.empty() && ops.back().type == FormatOp::Type::kLiteral &&
+        ops.back().literal_offset + ops.back().literal_length == offset) {
+      ++ops.back().literal_length;
+      return;
+    }
+    FormatOp op = {};
+    op.type = FormatOp::Type::kLiteral;
+    op.literal_offset = offset;
+    op.literal_length = 1;
+    ops.push_back(op);
+  };
+
+  auto state = FS_Unknown;
+  FormatOp spec = {};
+  for (uint16_t c = get();; c = get()) {
+    if (state == FS_Unknown) {
+      if (!c) {
+        return;
+      } else if (c != '%') {
+        add_literal();
+        continue;
+      }
+      state = FS_Start;
+      c = get();
+    }
+
+    if (!c) {
+      FormatOp op = {};
+      op.type = FormatOp::Type::kError;
+      ops.push_back(op);
+      return;
+    }
+
+  restart:
+    switch (state) {
+      case FS_Invalid:
+      case FS_Unknown:
+      case FS_End:
+      default: {
+        assert_always();
+      }
+
+      case FS_Start: {
+        if (c == '%') {
+          state = FS_Unknown;
+          add_literal();
+          continue;
+        }
+        state = FS_Flags;
+        spec = {};
+        spec.type = FormatOp::Type::kConversion;
+        spec.precision = -1;
+        [[fallthrough]];
+      }
+
+      case FS_Flags: {
+        if (c == '-') {
+          spec.flags |= FF_LeftJustify;
+          continue;
+        } else if (c == '+') {
+          spec.flags |= FF_AddPositive;
+          continue;
+        } else if (c == '0') {
+          spec.flags |= FF_AddLeadingZeros;
+          continue;
+        } else if (c == ' ') {
+          spec.flags |= FF_AddPositiveAsSpace;
+          continue;
+        } else if (c == '#') {
+          spec.flags |= FF_AddPrefix;
+          continue;
+        }
+        state = FS_Width;
+        [[fallthrough]];
+      }
+
+      case FS_Width: {
+        if (c == '*') {
+          spec.width_from_arg = true;
+          state = FS_PrecisionStart;
+          continue;
+        } else if (c >= '0' && c <= '9') {
+          spec.width = int32_t(uint32_t(spec.width) * 10 + (c - '0'));
+          continue;
+        }
+        state = FS_PrecisionStart;
+        [[fallthrough]];
+      }
+
+      case FS_PrecisionStart: {
+        if (c == '.') {
+          state = FS_Precision;
+          spec.precision = 0;
+          continue;
+        }
+        state = FS_Size;
+        goto restart;
+      }
+
+      case FS_Precision: {
+        if (c == '*') {
+          spec.precision_from_arg = true;
+          state = FS_Size;
+          continue;
+        } else if (c >= '0' && c <= '9') {
+          spec.precision =
+              int32_t(uint32_t(spec.precision) * 10 + (c - '0'));
+          continue;
+        }
+        state = FS_Size;
+        [[fallthrough]];
+      }
+
+      case FS_Size: {
+        if (c == 'l') {
+          if (peek(0) == 'l') {
+            skip(1);
+            spec.flags |= FF_IsLongLong;
+          } else {
+            spec.flags |= FF_IsLong;
+          }
+          state = FS_Type;
+          continue;
+        } else if (c == 'L') {
+          // 58410826 incorrectly uses 'L' instead of 'l'.
+          state = FS_Type;
+          continue;
+        } else if (c == 'h') {
+          spec.flags |= FF_IsShort;
+          state = FS_Type;
+          continue;
+        } else if (c == 'w') {
+          spec.flags |= FF_IsWide;
+          state = FS_Type;
+          continue;
+        } else if (c == 'I') {
+          if (peek(0) == '6' && peek(1) == '4') {
+            skip(2);
+            spec.flags |= FF_IsLongLong;
+          } else if (peek(0) == '3' && peek(1) == '2') {
+            skip(2);
+          }
+          state = FS_Type;
+          continue;
+        }
+        [[fallthrough]];
+      }
+
+      case FS_Type: {
+        spec.conversion = c;
+        ops.push_back(spec);
+        if (c == 'n') {
+          // Stays in the current state.
+          spec.inherit = true;
+          spec.width_from_arg = false;
+          spec.precision_from_arg = false;
+          continue;
+        }
+        break;
+      }
+    }
+
+    state = FS_Unknown;
+  }
+}
+
+template <typename GuestChar>
+const CompiledFormat<GuestChar>& GetCompiledFormat(
+    const GuestChar* host_format, uint32_t format_ptr) {
+  thread_local std::array<CompiledFormat<GuestChar>, kFormatCacheSize> cache;
+  size_t length = StringLength(host_format);
+  auto& entry =
+      cache[((format_ptr >> 2) ^ (format_ptr >> 9)) % kFormatCacheSize];
+  if (entry.guest_address == format_ptr && entry.text.size() == length + 1 &&
+      !std::memcmp(entry.text.data(), host_format,
+                   length * sizeof(GuestChar))) {
+    return entry;
+  }
+  entry.guest_address = format_ptr;
+  entry.text.assign(host_format, host_format + length + 1);
+  CompileFormat(entry);
+  return entry;
+}
+
+// Matches std::ostringstream with the precision and the fixed, scientific,
+// hexfloat or default float field.
+std::string_view FormatDouble(double value, int32_t precision, uint16_t c,
+                              uint32_t flags, char (&buffer)[512],
+                              std::string& fallback) {
+  if (precision < 0) {
+    precision = 6;
+  } else if (precision == 0 && c == 'g') {
+    precision = 1;
+  }
+
+  bool is_upper = c == 'E' || c == 'G' || c == 'A';
+  if (!(flags & FF_AddPrefix) && c != 'a' && c != 'A') {
+    std::chars_format format = std::chars_format::general;
+    if (c == 'f') {
+      format = std::chars_format::fixed;
+    } else if (c == 'e' || c == 'E') {
+      format = std::chars_format::scientific;
+    }
+    auto result = std::to_chars(buffer, buffer + xe::countof(buffer), value,
+                                format, precision);
+    if (result.ec == std::errc()) {
+      if (is_upper) {
+        for (char* p = buffer; p != result.ptr; ++p) {
+          if (*p >= 'a' && *p <= 'z') {
+            *p -= 'a' - 'A';
+          }
+        }
+      }
+      return std::string_view(buffer, size_t(result.ptr - buffer));
+    }
+  }
+
+  // The alternate form and hexadecimal floats, as well as the very long
+  // results, go through the C library like the streams do.
+  char printf_format[8];
+  char* p = printf_format;
+  *p++ = '%';
+  if (flags & FF_AddPrefix) {
+    *p++ = '#';
+  }
+  bool is_hex = c == 'a' || c == 'A';
+  if (!is_hex) {
+    *p++ = '.';
+    *p++ = '*';
+  }
+  *p++ = char(c);
+  *p = '\0';
+  int length = is_hex ? std::snprintf(nullptr, 0, printf_format, value)
+                      : std::snprintf(nullptr, 0, printf_format, precision,
+                                      value);
+  if (length <= 0) {
+    return std::string_view();
+  }
+  fallback.resize(size_t(length) + 1);
+  if (is_hex) {
+    std::snprintf(fallback.data(), fallback.size(), printf_format, value);
+  } else {
+    std::snprintf(fallback.data(), fallback.size(), printf_format, precision,
+                  value);
+  }
+  fallback.resize(size_t(length));
+  return fallback;
+}
+
+template <typename OutChar>
+void AppendNarrow(std::basic_string<OutChar>& output, const char* text,
+                  size_t length) {
+  if constexpr (std::is_same_v<OutChar, char>) {
+    output.append(text, length);
+  } else {
+    output.append(reinterpret_cast<const uint8_t*>(text),
+                  reinterpret_cast<const uint8_t*>(text) + length);
+  }
+}
+
+// Returns false if a character doesn't fit in a narrow output.
+template <typename OutChar>
+bool AppendWide(std::basic_string<OutChar>& output, const uint16_t* text,
+                size_t length, bool swap) {
+  if constexpr (std::is_same_v<OutChar, char16_t>) {
+    size_t offset = output.size();
+    output.resize(offset + length);
+    if (swap) {
+      xe::copy_and_swap(reinterpret_cast<uint16_t*>(&output[offset]), text,
+                        length);
+    } else {
+      std::memcpy(&output[offset], text, length * sizeof(uint16_t));
+    }
+  } else {
+    for (size_t i = 0; i < length; ++i) {
+      uint16_t c = swap ? xe::byte_swap(text[i]) : text[i];
+      if (c >= 0x100) {
+        return false;
+      }
+      output.push_back(char(c));
+    }
+  }
+  return true;
+}
+
+template <typename GuestChar, typename OutChar>
+int32_t ExecuteFormat(cpu::ppc::PPCContext* ppc_context,
+                      const CompiledFormat<GuestChar>& format,
+                      GuestFormatArgs& args, bool wide,
+                      std::basic_string<OutChar>& output) {
+  char work8[kMaxIntegerPrecision + 8];
+  char float_work[512];
+  std::string float_fallback;
+  uint16_t work16[1];
+
+  int32_t width = 0;
+  int32_t precision = -1;
+  uint32_t arg_flags = 0;
+
+  for (const FormatOp& op : format.ops) {
+    if (op.type == FormatOp::Type::kLiteral) {
+      const GuestChar* literal = format.text.data() + op.literal_offset;
+      if constexpr (sizeof(GuestChar) == 1) {
+        AppendNarrow(output, reinterpret_cast<const char*>(literal),
+                     op.literal_length);
+      } else {
+        AppendWide(output, literal, op.literal_length, true);
+      }
+      continue;
+    }
+    if (op.type == FormatOp::Type::kError) {
+      return -1;
+    }
+
+    if (!op.inherit) {
+      width = op.width;
+      precision = op.precision;
+      arg_flags = 0;
+      if (op.width_from_arg) {
+        width = int32_t(args.Get32());
+        if (width < 0) {
+          arg_flags |= FF_LeftJustify;
+          width = -width;
+        }
+      }
+      if (op.precision_from_arg) {
+        precision = int32_t(args.Get32());
+        if (precision < 0) {
+          precision = -1;
+        }
+      }
+    }
+
+    uint32_t flags = op.flags | arg_flags;
+    int32_t op_precision = precision;
+    uint16_t c = op.conversion;
+
+    struct {
+      const void* buffer = nullptr;
+      size_t length = 0;
+      bool is_wide = false;
+      bool swap_wide = true;
+    } text;
+    char prefix[2];
+    size_t prefix_length = 0;
+
+    switch (c) {
+      case 'C':
+      case 'c': {
+        if (c == 'C') {
+          flags |= FF_InvertWide;
+        }
+        bool is_wide;
+        if (flags & (FF_IsLong | FF_IsWide)) {
+          is_wide = true;
+        } else if (flags & FF_IsShort) {
+          is_wide = false;
+        } else {
+          is_wide = ((flags & FF_InvertWide) != 0) ^ wide;
+        }
+        uint32_t value = args.Get32();
+        if (!is_wide) {
+          work8[0] = char(uint8_t(value));
+          text.buffer = work8;
+        } else {
+          work16[0] = uint16_t(value);
+          text.buffer = work16;
+          text.is_wide = true;
+          text.swap_wide = false;
+        }
+        text.length = 1;
+        break;
+      }
+
+      case 'd':
+      case 'i':
+      case 'o':
+      case 'u':
+      case 'x':
+      case 'X':
+      case 'p': {
+        int radix = 10;
+        bool is_upper = false;
+        if (c == 'd' || c == 'i') {
+          flags |= FF_IsSigned;
+        } else if (c == 'o') {
+          radix = 8;
+          if (flags & FF_AddPrefix) {
+            flags |= FF_ForceLeadingZero;
+          }
+        } else if (c == 'x' || c == 'X') {
+          radix = 16;
+          is_upper = c == 'X';
+          if (flags & FF_AddPrefix) {
+            prefix[0] = '0';
+            prefix[1] = char(c);
+            prefix_length = 2;
+          }
+        } else if (c == 'p') {
+          radix = 16;
+          is_upper = true;
+          op_precision = 8;
+          flags &= ~(FF_IsLongLong | FF_IsShort);
+          flags |= FF_IsLong;
+        }
+
+        int64_t value;
+        if (flags & FF_IsLongLong) {
+          value = int64_t(args.Get64());
+        } else if (flags & FF_IsShort) {
+          value = int16_t(args.Get32());
+        } else {
+          value = int32_t(args.Get32());
+        }
+        if (op_precision >= 0) {
+          op_precision = std::min(op_precision, kMaxIntegerPrecision);
+        } else {
+          op_precision = 1;
+        }
+        uint64_t magnitude = uint64_t(value);
+        if ((flags & FF_IsSigned) && value < 0) {
+          magnitude = uint64_t(0) - magnitude;
+          flags |= FF_AddNegative;
+        }
+        if (!(flags & FF_IsLongLong)) {
+          magnitude &= UINT32_MAX;
+        }
+        if (magnitude == 0) {
+          prefix_length = 0;
+        }
+
+        char digits[64];
+        size_t digit_count = 0;
+        if (magnitude) {
+          auto result =
+              std::to_chars(digits, digits + xe::countof(digits), magnitude,
+                            radix);
+          digit_count = size_t(result.ptr - digits);
+          if (is_upper) {
+            for (size_t i = 0; i < digit_count; ++i) {
+              if (digits[i] >= 'a') {
+                digits[i] -= 'a' - 'A';
+              }
+            }
+          }
+        }
+        char* end = work8 + xe::countof(work8);
+        char* start = end - digit_count;
+        std::memcpy(start, digits, digit_count);
+        if (size_t(op_precision) > digit_count) {
+          size_t zeros = size_t(op_precision) - digit_count;
+          start -= zeros;
+          std::memset(start, '0', zeros);
+        }
+        if ((flags & FF_ForceLeadingZero) && (start == end || *start != '0')) {
+          *--start = '0';
+        }
+        text.buffer = start;
+        text.length = size_t(end - start);
+        break;
+      }
+
+      case 'e':
+      case 'E':
+      case 'f':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A': {
+        flags |= FF_IsSigned;
+        uint64_t bits = args.Get64();
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        if (value < 0) {
+          value = -value;
+          flags |= FF_AddNegative;
+        }
+        std::string_view s = FormatDouble(value, op_precision, c, flags,
+                                          float_work, float_fallback);
+        text.buffer = s.data();
+        text.length = s.size();
+        break;
+      }
+
+      case 'n': {
+        uint32_t pointer = args.Get32();
+        if (pointer) {
+          auto count = output.size();
+          if (flags & FF_IsShort) {
+            xe::store_and_swap<uint16_t>(
+                ppc_context->TranslateVirtual(pointer), uint16_t(count));
+          } else {
+            xe::store_and_swap<uint32_t>(
+                ppc_context->TranslateVirtual(pointer), uint32_t(count));
+          }
+        }
+        continue;
+      }
+
+      case 'S':
+      case 's': {
+        if (c == 'S') {
+          flags |= FF_InvertWide;
+        }
+        uint32_t pointer = args.Get32();
+        size_t cap = op_precision < 0 ? SIZE_MAX : size_t(op_precision);
+        if (!pointer) {
+          static const char kNull[] = "(null)";
+          text.buffer = kNull;
+          text.length = std::min(sizeof(kNull) - 1, cap);
+          break;
+        }
+        const void* str = ppc_context->TranslateVirtual(pointer);
+        bool is_wide;
+        if (flags & (FF_IsLong | FF_IsWide)) {
+          is_wide = true;
+        } else if (flags & FF_IsShort) {
+          is_wide = false;
+        } else {
+          is_wide = ((flags & FF_InvertWide) != 0) ^ wide;
+        }
+        if (!is_wide) {
+          if (cap == SIZE_MAX) {
+            text.length = std::strlen(static_cast<const char*>(str));
+          } else {
+            auto terminator = std::memchr(str, 0, cap);
+            text.length =
+                terminator ? size_t(static_cast<const char*>(terminator) -
+                                    static_cast<const char*>(str))
+                           : cap;
+          }
+        } else {
+          auto s = static_cast<const uint16_t*>(str);
+          size_t length = 0;
+          while (length < cap && s[length]) {
+            ++length;
+          }
+          text.length = length;
+        }
+        text.buffer = str;
+        text.is_wide = is_wide;
+        break;
+      }
+
+      default: {
+        // Including ANSI_STRING / UNICODE_STRING (Z) - only the padding is
+        // written.
+        assert_always();
+        break;
+      }
+    }
+
+    if (flags & FF_IsSigned) {
+      if (flags & FF_AddNegative) {
+        prefix[0] = '-';
+        prefix_length = 1;
+      } else if (flags & FF_AddPositive) {
+        prefix[0] = '+';
+        prefix_length = 1;
+      } else if (flags & FF_AddPositiveAsSpace) {
+        prefix[0] = ' ';
+        prefix_length = 1;
+      }
+    }
+
+    int32_t padding = width - int32_t(text.length) - int32_t(prefix_length);
+    if (!(flags & (FF_LeftJustify | FF_AddLeadingZeros)) && padding > 0) {
+      output.append(size_t(padding), OutChar(' '));
+    }
+    AppendNarrow(output, prefix, prefix_length);
+    if ((flags & FF_AddLeadingZeros) && !(flags & FF_LeftJustify) &&
+        padding > 0) {
+      output.append(size_t(padding), OutChar('0'));
+    }
+    if (!text.is_wide) {
+      AppendNarrow(output, static_cast<const char*>(text.buffer),
+                   text.length);
+    } else if (!AppendWide(output, static_cast<const uint16_t*>(text.buffer),
+                           text.length, text.swap_wide)) {
+      return -1;
+    }
+    if ((flags & FF_LeftJustify) && padding > 0) {
+      output.append(size_t(padding), OutChar(' '));
+    }
+  }
+
+  return int32_t(output.size());
+}
+
+}  // namespace
+
+GuestFormatArgs GuestFormatArgs::FromRegisters(
+    cpu::ppc::PPCContext* ppc_context, uint8_t first_index) {
+  return GuestFormatArgs(ppc_context, false, 0, first_index);
+}
+
+GuestFormatArgs GuestFormatArgs::FromArray(cpu::ppc::PPCContext* ppc_context,
+                                           uint32_t array_ptr) {
+  return GuestFormatArgs(ppc_context, true, array_ptr, 0);
+}
+
+uint64_t GuestFormatArgs::Get64() {
+  uint32_t index = index_++;
+  if (is_array_) {
+    return xe::load_and_swap<uint64_t>(
+        ppc_context_->TranslateVirtual(array_ptr_ + 8 * index));
+  }
+  return get_arg_64(ppc_context_, uint8_t(index));
+}
+
+int32_t FormatGuestString(cpu::ppc::PPCContext* ppc_context,
+                          uint32_t format_ptr, GuestFormatArgs& args,
+                          std::string& output) {
+  output.clear();
+  const auto& format = GetCompiledFormat(
+      ppc_context->TranslateVirtual<const uint8_t*>(format_ptr), format_ptr);
+  return ExecuteFormat(ppc_context, format, args, false, output);
+}
+
+int32_t FormatGuestString(cpu::ppc::PPCContext* ppc_context,
+                          uint32_t format_ptr, GuestFormatArgs& args,
+                          bool wide, std::u16string& output) {
+  output.clear();
+  const auto& format = GetCompiledFormat(
+      ppc_context->TranslateVirtual<const uint16_t*>(format_ptr), format_ptr);
+  return ExecuteFormat(ppc_context, format, args, wide, output);
+}
+
+}  // namespace util
+}  // namespace kernel
+}  // namespace xe
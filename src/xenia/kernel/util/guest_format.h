@@ -0,0 +1,76 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#ifndef XENIA_KERNEL_UTIL_GUEST_FORMAT_H_
+#define XENIA_KERNEL_UTIL_GUEST_FORMAT_H_
+
+#include <cstdint>
+#include <string>
+
+#include "xenia/cpu/ppc/ppc_context.h"
+
+namespace xe {
+namespace kernel {
+namespace util {
+
+// Arguments of a guest printf-family call, 64 bits each.
+class GuestFormatArgs {
+ public:
+  // Variadic arguments starting at the given argument index, in the
+  // registers and then on the stack, as passed to sprintf.
+  static GuestFormatArgs FromRegisters(cpu::ppc::PPCContext* ppc_context,
+                                       uint8_t first_index);
+  // A va_list, as passed to vsprintf.
+  static GuestFormatArgs FromArray(cpu::ppc::PPCContext* ppc_context,
+                                   uint32_t array_ptr);
+
+  uint32_t Get32() { return uint32_t(Get64()); }
+  uint64_t Get64();
+
+ private:
+  GuestFormatArgs(cpu::ppc::PPCContext* ppc_context, bool is_array,
+                  uint32_t array_ptr, uint32_t index)
+      : ppc_context_(ppc_context),
+        is_array_(is_array),
+        array_ptr_(array_ptr),
+        index_(index) {}
+
+  cpu::ppc::PPCContext* ppc_context_;
+  bool is_array_;
+  uint32_t array_ptr_;
+  uint32_t index_;
+};
+
+// Formats like the printf family of the Windows CRT:
+// "Format Specification Syntax: printf and wprintf Functions"
+// https://msdn.microsoft.com/en-us/library/56e442dc.aspx
+//
+// Parsed format strings are cached per thread by guest address and reused
+// while the guest string is unchanged, and the output is built in bulk
+// without going through a character at a time.
+//
+// Returns the number of characters written to the output, or -1 on errors,
+// such as an incomplete format specification or a character of a wide
+// string that doesn't fit in a narrow output.
+
+// Narrow format and output (sprintf).
+int32_t FormatGuestString(cpu::ppc::PPCContext* ppc_context,
+                          uint32_t format_ptr, GuestFormatArgs& args,
+                          std::string& output);
+// Big-endian wide format, output in host byte order (swprintf). wide selects
+// the meaning of %c and %s - the wide string itself when true, like wprintf.
+int32_t FormatGuestString(cpu::ppc::PPCContext* ppc_context,
+                          uint32_t format_ptr, GuestFormatArgs& args,
+                          bool wide, std::u16string& output);
+
+}  // namespace util
+}  // namespace kernel
+}  // namespace xe
+
+#endif  // XENIA_KERNEL_UTIL_GUEST_FORMAT_H_
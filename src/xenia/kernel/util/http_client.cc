@@ -0,0 +1,364 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/kernel/util/http_client.h"
+
+#include <algorithm>
+#include <future>
+
+#include "xenia/base/logging.h"
+
+namespace xe {
+namespace kernel {
+
+// Cached responses are only purged of expired entries once there are more.
+constexpr size_t kCachePurgeThreshold = 256;
+
+std::unique_ptr<HttpClient> HttpClient::Create(uint32_t max_host_connections,
+                                               uint32_t max_queued_requests) {
+  auto client = std::unique_ptr<HttpClient>(new HttpClient());
+  if (!client->Initialize(max_host_connections, max_queued_requests)) {
+    return nullptr;
+  }
+  return client;
+}
+
+bool HttpClient::Initialize(uint32_t max_host_connections,
+                            uint32_t max_queued_requests) {
+  multi_handle_ = curl_multi_init();
+  if (!multi_handle_) {
+    XELOGE("HttpClient: Cannot initialize CURL multi handle");
+    return false;
+  }
+  curl_multi_setopt(multi_handle_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+  curl_multi_setopt(multi_handle_, CURLMOPT_MAX_HOST_CONNECTIONS,
+                    long(std::max(max_host_connections, 1u)));
+  max_outstanding_ = std::max(max_queued_requests, 1u);
+
+  running_ = true;
+  thread_ = xe::threading::Thread::Create({}, [this]() {
+    xe::threading::set_name("HTTP Client");
+    ThreadMain();
+  });
+  if (!thread_) {
+    running_ = false;
+    return false;
+  }
+  return true;
+}
+
+HttpClient::~HttpClient() {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    running_ = false;
+  }
+  queue_cv_.notify_all();
+  if (thread_) {
+    curl_multi_wakeup(multi_handle_);
+    xe::threading::Wait(thread_.get(), false);
+  }
+  for (CURL* handle : idle_handles_) {
+    curl_easy_cleanup(handle);
+  }
+  if (multi_handle_) {
+    curl_multi_cleanup(multi_handle_);
+  }
+}
+
+void HttpClient::Submit(Request request, CompletionCallback callback) {
+  Enqueue(std::move(request), std::move(callback), true);
+}
+
+bool HttpClient::TrySubmit(Request request, CompletionCallback callback) {
+  return Enqueue(std::move(request), std::move(callback), false);
+}
+
+bool HttpClient::Enqueue(Request request, CompletionCallback callback,
+                         bool wait) {
+  auto transfer = std::make_unique<Transfer>();
+  if (LookupCache(request, transfer->response)) {
+    request_count_.fetch_add(1, std::memory_order_relaxed);
+    cache_hit_count_.fetch_add(1, std::memory_order_relaxed);
+    callback(transfer->response);
+    return true;
+  }
+  transfer->request = std::move(request);
+  transfer->callback = std::move(callback);
+
+  {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    auto has_slot = [this] {
+      return !running_ || outstanding_ < max_outstanding_;
+    };
+    if (wait) {
+      queue_cv_.wait(lock, has_slot);
+    } else if (!has_slot()) {
+      return false;
+    }
+    if (running_) {
+      queue_.push_back(std::move(transfer));
+      ++outstanding_;
+    }
+  }
+  request_count_.fetch_add(1, std::memory_order_relaxed);
+  if (transfer) {
+    transfer->response.result = CURLE_ABORTED_BY_CALLBACK;
+    transfer->callback(transfer->response);
+    return true;
+  }
+  curl_multi_wakeup(multi_handle_);
+  return true;
+}
+
+HttpClient::Response HttpClient::Perform(Request request) {
+  std::promise<Response> promise;
+  std::future<Response> future = promise.get_future();
+  Submit(std::move(request), [&promise](Response& response) {
+    promise.set_value(std::move(response));
+  });
+  return future.get();
+}
+
+void HttpClient::InvalidateCache(std::string_view url_prefix) {
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  if (url_prefix.empty()) {
+    cache_.clear();
+    return;
+  }
+  for (auto it = cache_.begin(); it != cache_.end();) {
+    if (std::string_view(it->first).substr(0, url_prefix.size()) ==
+        url_prefix) {
+      it = cache_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+HttpClient::Stats HttpClient::GetStats() const {
+  Stats stats;
+  stats.requests = request_count_.load(std::memory_order_relaxed);
+  stats.cache_hits = cache_hit_count_.load(std::memory_order_relaxed);
+  stats.connections = connection_count_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+bool HttpClient::LookupCache(const Request& request, Response& response) {
+  if (request.method != Method::kGet || !request.cache_ttl_ms) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  auto it = cache_.find(request.url);
+  if (it == cache_.end()) {
+    return false;
+  }
+  if (it->second.expiry <= std::chrono::steady_clock::now()) {
+    cache_.erase(it);
+    return false;
+  }
+  response.result = CURLE_OK;
+  response.http_code = it->second.http_code;
+  response.body = it->second.body;
+  response.from_cache = true;
+  return true;
+}
+
+void HttpClient::ThreadMain() {
+  while (true) {
+    std::deque<std::unique_ptr<Transfer>> queue;
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex_);
+      if (!running_) {
+        queue.swap(queue_);
+        break;
+      }
+      queue.swap(queue_);
+    }
+    for (auto& transfer : queue) {
+      StartTransfer(std::move(transfer));
+    }
+
+    int running_handles;
+    curl_multi_perform(multi_handle_, &running_handles);
+
+    CURLMsg* message;
+    int messages_left;
+    while ((message = curl_multi_info_read(multi_handle_, &messages_left))) {
+      if (message->msg == CURLMSG_DONE) {
+        FinishTransfer(message->easy_handle, message->data.result);
+      }
+    }
+
+    curl_multi_poll(multi_handle_, nullptr, 0, 1000, nullptr);
+  }
+
+  // Shutting down - abort everything still outstanding.
+  for (auto& [handle, transfer] : active_) {
+    curl_multi_remove_handle(multi_handle_, handle);
+    curl_easy_cleanup(handle);
+    curl_slist_free_all(transfer->headers);
+    transfer->response.result = CURLE_ABORTED_BY_CALLBACK;
+    Complete(std::move(transfer));
+  }
+  active_.clear();
+  std::deque<std::unique_ptr<Transfer>> queue;
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    queue.swap(queue_);
+  }
+  for (auto& transfer : queue) {
+    transfer->response.result = CURLE_ABORTED_BY_CALLBACK;
+    Complete(std::move(transfer));
+  }
+}
+
+void HttpClient::StartTransfer(std::unique_ptr<Transfer> transfer) {
+  CURL* handle;
+  if (!idle_handles_.empty()) {
+    handle = idle_handles_.back();
+    idle_handles_.pop_back();
+  } else {
+    handle = curl_easy_init();
+    if (!handle) {
+      XELOGE("HttpClient: Cannot initialize CURL");
+      transfer->response.result = CURLE_FAILED_INIT;
+      Complete(std::move(transfer));
+      return;
+    }
+  }
+
+  const Request& request = transfer->request;
+  if (verbose_) {
+    XELOGI("cURL: {}", request.url);
+    curl_easy_setopt(handle, CURLOPT_VERBOSE, 1L);
+    curl_easy_setopt(handle, CURLOPT_STDERR, stderr);
+  }
+  curl_easy_setopt(handle, CURLOPT_URL, request.url.c_str());
+  curl_easy_setopt(handle, CURLOPT_USERAGENT, "xenia");
+  // Signals cannot be used for DNS timeouts off the main thread.
+  curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+  curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+  curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, WriteCallback);
+  curl_easy_setopt(handle, CURLOPT_WRITEDATA, &transfer->response);
+  if (request.timeout) {
+    curl_easy_setopt(handle, CURLOPT_TIMEOUT, long(request.timeout));
+  }
+
+  switch (request.method) {
+    case Method::kGet:
+      curl_easy_setopt(handle, CURLOPT_HTTPGET, 1L);
+      break;
+    case Method::kPost:
+      curl_easy_setopt(handle, CURLOPT_POST, 1L);
+      curl_easy_setopt(handle, CURLOPT_POSTFIELDSIZE_LARGE,
+                       curl_off_t(request.body.size()));
+      curl_easy_setopt(handle, CURLOPT_POSTFIELDS,
+                       request.body.empty()
+                           ? ""
+                           : reinterpret_cast<const char*>(request.body.data()));
+      break;
+    case Method::kDelete:
+      curl_easy_setopt(handle, CURLOPT_CUSTOMREQUEST, "DELETE");
+      break;
+  }
+
+  if (request.json) {
+    transfer->headers =
+        curl_slist_append(transfer->headers, "Content-Type: application/json");
+    transfer->headers =
+        curl_slist_append(transfer->headers, "Accept: application/json");
+    transfer->headers = curl_slist_append(transfer->headers, "charset: utf-8");
+    curl_easy_setopt(handle, CURLOPT_HTTPHEADER, transfer->headers);
+  }
+
+  CURLMcode result = curl_multi_add_handle(multi_handle_, handle);
+  if (result != CURLM_OK) {
+    XELOGE("HttpClient: curl_multi_add_handle failed: {}",
+           static_cast<uint32_t>(result));
+    curl_easy_cleanup(handle);
+    curl_slist_free_all(transfer->headers);
+    transfer->response.result = CURLE_FAILED_INIT;
+    Complete(std::move(transfer));
+    return;
+  }
+  transfer->handle = handle;
+  active_.emplace(handle, std::move(transfer));
+}
+
+void HttpClient::FinishTransfer(CURL* handle, CURLcode result) {
+  auto it = active_.find(handle);
+  if (it == active_.end()) {
+    return;
+  }
+  std::unique_ptr<Transfer> transfer = std::move(it->second);
+  active_.erase(it);
+
+  Response& response = transfer->response;
+  response.result = result;
+  long http_code = 0;
+  curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &http_code);
+  response.http_code = uint64_t(http_code);
+  long new_connections = 0;
+  curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &new_connections);
+  connection_count_.fetch_add(uint64_t(new_connections),
+                              std::memory_order_relaxed);
+
+  curl_multi_remove_handle(multi_handle_, handle);
+  curl_slist_free_all(transfer->headers);
+  transfer->headers = nullptr;
+  // Connections are owned by the multi handle, so the easy handle can be
+  // recycled without losing them.
+  curl_easy_reset(handle);
+  if (idle_handles_.size() < max_outstanding_) {
+    idle_handles_.push_back(handle);
+  } else {
+    curl_easy_cleanup(handle);
+  }
+
+  if (result != CURLE_OK) {
+    XELOGE("HttpClient: {} failed: {}", transfer->request.url,
+           curl_easy_strerror(result));
+  }
+
+  const Request& request = transfer->request;
+  if (request.method == Method::kGet && request.cache_ttl_ms &&
+      result == CURLE_OK && response.http_code == 200) {
+    const auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    if (cache_.size() >= kCachePurgeThreshold) {
+      std::erase_if(cache_, [now](const auto& entry) {
+        return entry.second.expiry <= now;
+      });
+    }
+    cache_[request.url] = {
+        response.body, response.http_code,
+        now + std::chrono::milliseconds(request.cache_ttl_ms)};
+  }
+
+  Complete(std::move(transfer));
+}
+
+void HttpClient::Complete(std::unique_ptr<Transfer> transfer) {
+  transfer->callback(transfer->response);
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    --outstanding_;
+  }
+  queue_cv_.notify_one();
+}
+
+size_t HttpClient::WriteCallback(char* data, size_t size, size_t nmemb,
+                                 void* user_data) {
+  auto response = reinterpret_cast<Response*>(user_data);
+  response->body.append(data, size * nmemb);
+  return size * nmemb;
+}
+
+}  // namespace kernel
+}  // namespace xe
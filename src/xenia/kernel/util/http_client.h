@@ -0,0 +1,153 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#ifndef XENIA_KERNEL_UTIL_HTTP_CLIENT_H_
+#define XENIA_KERNEL_UTIL_HTTP_CLIENT_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "third_party/libcurl/include/curl/curl.h"
+
+#include "xenia/base/threading.h"
+
+namespace xe {
+namespace kernel {
+
+// HTTP client sharing a single curl multi handle between all requests, so
+// connections (and TLS sessions) to the same host are kept alive and reused,
+// and multiplexed when the server speaks HTTP/2.
+//
+// Requests are serviced by one worker thread. At most max_queued_requests may
+// be outstanding at a time; further submissions block until one completes.
+// Successful GET responses may optionally be cached for a short time.
+class HttpClient {
+ public:
+  enum class Method { kGet, kPost, kDelete };
+
+  struct Request {
+    Method method = Method::kGet;
+    std::string url;
+    std::vector<uint8_t> body;
+    // Sends the JSON content negotiation headers.
+    bool json = true;
+    // Whole transfer timeout in seconds, 0 for none.
+    uint32_t timeout = 0;
+    // How long a successful GET response may be served from the cache, 0 to
+    // bypass the cache.
+    uint32_t cache_ttl_ms = 0;
+  };
+
+  struct Response {
+    // CURLE_OK if the transfer completed, regardless of the HTTP status.
+    CURLcode result = CURLE_OK;
+    uint64_t http_code = 0;
+    std::string body;
+    bool from_cache = false;
+  };
+
+  // Called on the worker thread, or on the submitting thread for cache hits.
+  // Must not wait on other requests of the same client.
+  using CompletionCallback = std::function<void(Response& response)>;
+
+  struct Stats {
+    uint64_t requests;
+    uint64_t cache_hits;
+    // Connections opened, as opposed to reused.
+    uint64_t connections;
+  };
+
+  static std::unique_ptr<HttpClient> Create(uint32_t max_host_connections = 4,
+                                            uint32_t max_queued_requests = 64);
+
+  // Aborts outstanding requests, completing them with CURLE_ABORTED_BY_CALLBACK.
+  ~HttpClient();
+
+  void Submit(Request request, CompletionCallback callback);
+  // Like Submit, but returns false instead of blocking if max_queued_requests
+  // are outstanding. The callback is not called in that case. Safe to call
+  // from a completion callback.
+  bool TrySubmit(Request request, CompletionCallback callback);
+  // Submits the request and waits for its completion.
+  Response Perform(Request request);
+
+  // Drops cached responses for URLs starting with the prefix (all if empty).
+  void InvalidateCache(std::string_view url_prefix = {});
+
+  void set_verbose(bool verbose) { verbose_ = verbose; }
+
+  Stats GetStats() const;
+
+ private:
+  struct Transfer {
+    Request request;
+    CompletionCallback callback;
+    Response response;
+    CURL* handle = nullptr;
+    curl_slist* headers = nullptr;
+  };
+
+  struct CacheEntry {
+    std::string body;
+    uint64_t http_code;
+    std::chrono::steady_clock::time_point expiry;
+  };
+
+  HttpClient() = default;
+  bool Initialize(uint32_t max_host_connections, uint32_t max_queued_requests);
+
+  bool Enqueue(Request request, CompletionCallback callback, bool wait);
+  bool LookupCache(const Request& request, Response& response);
+  void ThreadMain();
+  // Worker thread only.
+  void StartTransfer(std::unique_ptr<Transfer> transfer);
+  void FinishTransfer(CURL* handle, CURLcode result);
+  void Complete(std::unique_ptr<Transfer> transfer);
+
+  static size_t WriteCallback(char* data, size_t size, size_t nmemb,
+                              void* user_data);
+
+  CURLM* multi_handle_ = nullptr;
+  std::unique_ptr<xe::threading::Thread> thread_;
+  std::atomic<bool> running_ = false;
+  std::atomic<bool> verbose_ = false;
+
+  std::mutex queue_mutex_;
+  std::condition_variable queue_cv_;
+  std::deque<std::unique_ptr<Transfer>> queue_;
+  // Queued and active transfers.
+  uint32_t outstanding_ = 0;
+  uint32_t max_outstanding_ = 0;
+
+  // Worker thread only.
+  std::unordered_map<CURL*, std::unique_ptr<Transfer>> active_;
+  std::vector<CURL*> idle_handles_;
+
+  std::mutex cache_mutex_;
+  std::unordered_map<std::string, CacheEntry> cache_;
+
+  std::atomic<uint64_t> request_count_ = 0;
+  std::atomic<uint64_t> cache_hit_count_ = 0;
+  std::atomic<uint64_t> connection_count_ = 0;
+};
+
+}  // namespace kernel
+}  // namespace xe
+
+#endif  // XENIA_KERNEL_UTIL_HTTP_CLIENT_H_
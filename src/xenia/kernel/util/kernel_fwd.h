@@ -8,6 +8,7 @@ class KernelModule;
 class XModule;
 class XNotifyListener;
 class XThread;
+struct XThreadStatistics;
 class UserModule;
 struct X_KPROCESS;
 struct TerminateNotification;
@@ -0,0 +1,478 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/kernel/util/rtl_simd.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "xenia/base/byte_order.h"
+#include "xenia/base/math.h"
+#include "xenia/base/platform.h"
+
+#if XE_ARCH_AMD64
+#include <immintrin.h>
+#endif
+
+// The x64 builds target AVX, but PCLMULQDQ has to be enabled separately for
+// the functions using it outside MSVC.
+#if XE_ARCH_AMD64 && !XE_COMPILER_MSVC
+#define XE_RTL_TARGET_PCLMUL __attribute__((target("pclmul")))
+#else
+#define XE_RTL_TARGET_PCLMUL
+#endif
+
+namespace xe {
+namespace kernel {
+namespace util {
+
+static constexpr const unsigned char rtl_lower_table[256] = {
+    0x0,  0x1,  0x2,  0x3,  0x4,  0x5,  0x6,  0x7,  0x8,  0x9,  0xA,  0xB,
+    0xC,  0xD,  0xE,  0xF,  0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+    0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23,
+    0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F,
+    0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B,
+    0x3C, 0x3D, 0x3E, 0x3F, 0x40, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67,
+    0x68, 0x69, 0x6A, 0x6B, 0x6C, 0x6D, 0x6E, 0x6F, 0x70, 0x71, 0x72, 0x73,
+    0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F,
+    0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6A, 0x6B,
+    0x6C, 0x6D, 0x6E, 0x6F, 0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77,
+    0x78, 0x79, 0x7A, 0x7B, 0x7C, 0x7D, 0x7E, 0x7F, 0x80, 0x81, 0x82, 0x83,
+    0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F,
+    0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0x9B,
+    0x9C, 0x9D, 0x9E, 0x9F, 0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7,
+    0xA8, 0xA9, 0xAA, 0xAB, 0xAC, 0xAD, 0xAE, 0xAF, 0xB0, 0xB1, 0xB2, 0xB3,
+    0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF,
+    0xE0, 0xE1, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xEB,
+    0xEC, 0xED, 0xEE, 0xEF, 0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xD7,
+    0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xDF, 0xE0, 0xE1, 0xE2, 0xE3,
+    0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xEB, 0xEC, 0xED, 0xEE, 0xEF,
+    0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFB,
+    0xFC, 0xFD, 0xFE, 0xFF};
+
+static constexpr const unsigned char rtl_upper_table[256] = {
+    0x0,  0x1,  0x2,  0x3,  0x4,  0x5,  0x6,  0x7,  0x8,  0x9,  0xA,  0xB,
+    0xC,  0xD,  0xE,  0xF,  0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+    0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23,
+    0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F,
+    0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B,
+    0x3C, 0x3D, 0x3E, 0x3F, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47,
+    0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F, 0x50, 0x51, 0x52, 0x53,
+    0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F,
+    0x60, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B,
+    0x4C, 0x4D, 0x4E, 0x4F, 0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57,
+    0x58, 0x59, 0x5A, 0x7B, 0x7C, 0x7D, 0x7E, 0x7F, 0x80, 0x81, 0x82, 0x83,
+    0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F,
+    0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0x9B,
+    0x9C, 0x9D, 0x9E, 0x9F, 0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7,
+    0xA8, 0xA9, 0xAA, 0xAB, 0xAC, 0xAD, 0xAE, 0xAF, 0xB0, 0xB1, 0xB2, 0xB3,
+    0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF,
+    0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xCB,
+    0xCC, 0xCD, 0xCE, 0xCF, 0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7,
+    0xD8, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF, 0xC0, 0xC1, 0xC2, 0xC3,
+    0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF,
+    0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xF7, 0xD8, 0xD9, 0xDA, 0xDB,
+    0xDC, 0xDD, 0xDE, 0x3F};
+
+static constexpr uint32_t crc32_table[256] = {
+    0x00000000u, 0x77073096u, 0xEE0E612Cu, 0x990951BAu, 0x076DC419u,
+    0x706AF48Fu, 0xE963A535u, 0x9E6495A3u, 0x0EDB8832u, 0x79DCB8A4u,
+    0xE0D5E91Eu, 0x97D2D988u, 0x09B64C2Bu, 0x7EB17CBDu, 0xE7B82D07u,
+    0x90BF1D91u, 0x1DB71064u, 0x6AB020F2u, 0xF3B97148u, 0x84BE41DEu,
+    0x1ADAD47Du, 0x6DDDE4EBu, 0xF4D4B551u, 0x83D385C7u, 0x136C9856u,
+    0x646BA8C0u, 0xFD62F97Au, 0x8A65C9ECu, 0x14015C4Fu, 0x63066CD9u,
+    0xFA0F3D63u, 0x8D080DF5u, 0x3B6E20C8u, 0x4C69105Eu, 0xD56041E4u,
+    0xA2677172u, 0x3C03E4D1u, 0x4B04D447u, 0xD20D85FDu, 0xA50AB56Bu,
+    0x35B5A8FAu, 0x42B2986Cu, 0xDBBBC9D6u, 0xACBCF940u, 0x32D86CE3u,
+    0x45DF5C75u, 0xDCD60DCFu, 0xABD13D59u, 0x26D930ACu, 0x51DE003Au,
+    0xC8D75180u, 0xBFD06116u, 0x21B4F4B5u, 0x56B3C423u, 0xCFBA9599u,
+    0xB8BDA50Fu, 0x2802B89Eu, 0x5F058808u, 0xC60CD9B2u, 0xB10BE924u,
+    0x2F6F7C87u, 0x58684C11u, 0xC1611DABu, 0xB6662D3Du, 0x76DC4190u,
+    0x01DB7106u, 0x98D220BCu, 0xEFD5102Au, 0x71B18589u, 0x06B6B51Fu,
+    0x9FBFE4A5u, 0xE8B8D433u, 0x7807C9A2u, 0x0F00F934u, 0x9609A88Eu,
+    0xE10E9818u, 0x7F6A0DBBu, 0x086D3D2Du, 0x91646C97u, 0xE6635C01u,
+    0x6B6B51F4u, 0x1C6C6162u, 0x856530D8u, 0xF262004Eu, 0x6C0695EDu,
+    0x1B01A57Bu, 0x8208F4C1u, 0xF50FC457u, 0x65B0D9C6u, 0x12B7E950u,
+    0x8BBEB8EAu, 0xFCB9887Cu, 0x62DD1DDFu, 0x15DA2D49u, 0x8CD37CF3u,
+    0xFBD44C65u, 0x4DB26158u, 0x3AB551CEu, 0xA3BC0074u, 0xD4BB30E2u,
+    0x4ADFA541u, 0x3DD895D7u, 0xA4D1C46Du, 0xD3D6F4FBu, 0x4369E96Au,
+    0x346ED9FCu, 0xAD678846u, 0xDA60B8D0u, 0x44042D73u, 0x33031DE5u,
+    0xAA0A4C5Fu, 0xDD0D7CC9u, 0x5005713Cu, 0x270241AAu, 0xBE0B1010u,
+    0xC90C2086u, 0x5768B525u, 0x206F85B3u, 0xB966D409u, 0xCE61E49Fu,
+    0x5EDEF90Eu, 0x29D9C998u, 0xB0D09822u, 0xC7D7A8B4u, 0x59B33D17u,
+    0x2EB40D81u, 0xB7BD5C3Bu, 0xC0BA6CADu, 0xEDB88320u, 0x9ABFB3B6u,
+    0x03B6E20Cu, 0x74B1D29Au, 0xEAD54739u, 0x9DD277AFu, 0x04DB2615u,
+    0x73DC1683u, 0xE3630B12u, 0x94643B84u, 0x0D6D6A3Eu, 0x7A6A5AA8u,
+    0xE40ECF0Bu, 0x9309FF9Du, 0x0A00AE27u, 0x7D079EB1u, 0xF00F9344u,
+    0x8708A3D2u, 0x1E01F268u, 0x6906C2FEu, 0xF762575Du, 0x806567CBu,
+    0x196C3671u, 0x6E6B06E7u, 0xFED41B76u, 0x89D32BE0u, 0x10DA7A5Au,
+    0x67DD4ACCu, 0xF9B9DF6Fu, 0x8EBEEFF9u, 0x17B7BE43u, 0x60B08ED5u,
+    0xD6D6A3E8u, 0xA1D1937Eu, 0x38D8C2C4u, 0x4FDFF252u, 0xD1BB67F1u,
+    0xA6BC5767u, 0x3FB506DDu, 0x48B2364Bu, 0xD80D2BDAu, 0xAF0A1B4Cu,
+    0x36034AF6u, 0x41047A60u, 0xDF60EFC3u, 0xA867DF55u, 0x316E8EEFu,
+    0x4669BE79u, 0xCB61B38Cu, 0xBC66831Au, 0x256FD2A0u, 0x5268E236u,
+    0xCC0C7795u, 0xBB0B4703u, 0x220216B9u, 0x5505262Fu, 0xC5BA3BBEu,
+    0xB2BD0B28u, 0x2BB45A92u, 0x5CB36A04u, 0xC2D7FFA7u, 0xB5D0CF31u,
+    0x2CD99E8Bu, 0x5BDEAE1Du, 0x9B64C2B0u, 0xEC63F226u, 0x756AA39Cu,
+    0x026D930Au, 0x9C0906A9u, 0xEB0E363Fu, 0x72076785u, 0x05005713u,
+    0x95BF4A82u, 0xE2B87A14u, 0x7BB12BAEu, 0x0CB61B38u, 0x92D28E9Bu,
+    0xE5D5BE0Du, 0x7CDCEFB7u, 0x0BDBDF21u, 0x86D3D2D4u, 0xF1D4E242u,
+    0x68DDB3F8u, 0x1FDA836Eu, 0x81BE16CDu, 0xF6B9265Bu, 0x6FB077E1u,
+    0x18B74777u, 0x88085AE6u, 0xFF0F6A70u, 0x66063BCAu, 0x11010B5Cu,
+    0x8F659EFFu, 0xF862AE69u, 0x616BFFD3u, 0x166CCF45u, 0xA00AE278u,
+    0xD70DD2EEu, 0x4E048354u, 0x3903B3C2u, 0xA7672661u, 0xD06016F7u,
+    0x4969474Du, 0x3E6E77DBu, 0xAED16A4Au, 0xD9D65ADCu, 0x40DF0B66u,
+    0x37D83BF0u, 0xA9BCAE53u, 0xDEBB9EC5u, 0x47B2CF7Fu, 0x30B5FFE9u,
+    0xBDBDF21Cu, 0xCABAC28Au, 0x53B39330u, 0x24B4A3A6u, 0xBAD03605u,
+    0xCDD70693u, 0x54DE5729u, 0x23D967BFu, 0xB3667A2Eu, 0xC4614AB8u,
+    0x5D681B02u, 0x2A6F2B94u, 0xB40BBE37u, 0xC30C8EA1u, 0x5A05DF1Bu,
+    0x2D02EF8Du,
+};
+
+RtlSimdLevel GetRtlSimdLevel() {
+#if XE_ARCH_AMD64
+  uint64_t feature_flags = amd64::GetFeatureFlags();
+  if (!(feature_flags & amd64::kX64EmitPCLMULQDQ)) {
+    return RtlSimdLevel::kScalar;
+  }
+  return (feature_flags & amd64::kX64EmitAVX2) ? RtlSimdLevel::kAVX2
+                                               : RtlSimdLevel::kSSE42;
+#else
+  return RtlSimdLevel::kScalar;
+#endif
+}
+
+uint8_t RtlUpperAnsiChar(uint8_t c) { return rtl_upper_table[c]; }
+
+uint8_t RtlLowerAnsiChar(uint8_t c) { return rtl_lower_table[c]; }
+
+uint32_t RtlCountEqualBytes(const uint8_t* source1, const uint8_t* source2,
+                            uint32_t length, RtlSimdLevel level) {
+  uint32_t count = 0;
+  uint32_t i = 0;
+#if XE_ARCH_AMD64
+  // Equal bytes are -1 after the comparison, so they're accumulated as bytes
+  // for up to 255 blocks, then widened with psadbw.
+  if (level == RtlSimdLevel::kAVX2) {
+    __m256i totals = _mm256_setzero_si256();
+    while (i + 32 <= length) {
+      uint32_t blocks = std::min((length - i) / 32, uint32_t(255));
+      __m256i counts = _mm256_setzero_si256();
+      for (uint32_t j = 0; j < blocks; ++j, i += 32) {
+        __m256i equal = _mm256_cmpeq_epi8(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source1 + i)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source2 + i)));
+        counts = _mm256_sub_epi8(counts, equal);
+      }
+      totals = _mm256_add_epi64(
+          totals, _mm256_sad_epu8(counts, _mm256_setzero_si256()));
+    }
+    __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(totals),
+                                _mm256_extracti128_si256(totals, 1));
+    count += uint32_t(_mm_cvtsi128_si64(sum) + _mm_extract_epi64(sum, 1));
+  }
+  if (level != RtlSimdLevel::kScalar) {
+    __m128i totals = _mm_setzero_si128();
+    while (i + 16 <= length) {
+      uint32_t blocks = std::min((length - i) / 16, uint32_t(255));
+      __m128i counts = _mm_setzero_si128();
+      for (uint32_t j = 0; j < blocks; ++j, i += 16) {
+        __m128i equal = _mm_cmpeq_epi8(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(source1 + i)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(source2 + i)));
+        counts = _mm_sub_epi8(counts, equal);
+      }
+      totals = _mm_add_epi64(totals, _mm_sad_epu8(counts, _mm_setzero_si128()));
+    }
+    count += uint32_t(_mm_cvtsi128_si64(totals) + _mm_extract_epi64(totals, 1));
+  }
+#endif
+  for (; i < length; ++i) {
+    count += source1[i] == source2[i];
+  }
+  return count;
+}
+
+uint32_t RtlCompareUlongs(const uint8_t* source, uint32_t length,
+                          uint32_t pattern, RtlSimdLevel level) {
+  uint32_t aligned_length = length & ~uint32_t(3);
+  uint32_t swapped_pattern = xe::byte_swap(pattern);
+  uint32_t i = 0;
+#if XE_ARCH_AMD64
+  // The first differing byte is found, and rounded down to its word.
+  if (level == RtlSimdLevel::kAVX2) {
+    __m256i pattern_vector = _mm256_set1_epi32(int(swapped_pattern));
+    for (; i + 32 <= aligned_length; i += 32) {
+      uint32_t equal = uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i)),
+          pattern_vector)));
+      if (equal != UINT32_MAX) {
+        return i + (xe::tzcnt(~equal) & ~uint32_t(3));
+      }
+    }
+  }
+  if (level != RtlSimdLevel::kScalar) {
+    __m128i pattern_vector = _mm_set1_epi32(int(swapped_pattern));
+    for (; i + 16 <= aligned_length; i += 16) {
+      uint32_t equal = uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i)),
+          pattern_vector)));
+      if (equal != 0xFFFF) {
+        return i + (xe::tzcnt(~equal) & ~uint32_t(3));
+      }
+    }
+  }
+#endif
+  for (; i < aligned_length; i += 4) {
+    uint32_t word;
+    std::memcpy(&word, source + i, sizeof(word));
+    if (word != swapped_pattern) {
+      break;
+    }
+  }
+  return i;
+}
+
+void RtlFillUlongs(uint8_t* destination, uint32_t count, uint32_t pattern,
+                   RtlSimdLevel level) {
+  uint32_t swapped_pattern = xe::byte_swap(pattern);
+  size_t length = size_t(count) * 4;
+  size_t i = 0;
+#if XE_ARCH_AMD64
+  if (level == RtlSimdLevel::kAVX2) {
+    __m256i pattern_vector = _mm256_set1_epi32(int(swapped_pattern));
+    for (; i + 32 <= length; i += 32) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i),
+                          pattern_vector);
+    }
+  }
+  if (level != RtlSimdLevel::kScalar) {
+    __m128i pattern_vector = _mm_set1_epi32(int(swapped_pattern));
+    for (; i + 16 <= length; i += 16) {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i),
+                       pattern_vector);
+    }
+  }
+#endif
+  for (; i < length; i += 4) {
+    std::memcpy(destination + i, &swapped_pattern, sizeof(swapped_pattern));
+  }
+}
+
+// Works on the inverted CRC.
+static uint32_t Crc32Bytewise(uint32_t crc, const uint8_t* data,
+                              size_t length) {
+  for (size_t i = 0; i < length; ++i) {
+    crc = crc32_table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+#if XE_ARCH_AMD64
+// Multiplies both halves of the value by the constants and adds the next
+// block.
+XE_RTL_TARGET_PCLMUL
+static inline __m128i Crc32FoldBlock(__m128i value, __m128i next,
+                                     __m128i constants) {
+  __m128i low = _mm_clmulepi64_si128(value, constants, 0x00);
+  __m128i high = _mm_clmulepi64_si128(value, constants, 0x11);
+  return _mm_xor_si128(_mm_xor_si128(low, high), next);
+}
+
+// Folding with carry-less multiplication, from "Fast CRC Computation for
+// Generic Polynomials Using PCLMULQDQ Instruction" (Intel, 2009), with the
+// constants for the bit-reflected 0xEDB88320 given at the end of the paper.
+// Works on the inverted CRC, length must be at least 64 and a multiple of 16.
+XE_RTL_TARGET_PCLMUL
+static uint32_t Crc32Fold(uint32_t crc, const uint8_t* data, size_t length) {
+  // x^(4*128+32) mod P, x^(4*128-32) mod P.
+  const __m128i k1k2 = _mm_set_epi64x(0x01C6E41596, 0x0154442BD4);
+  // x^(128+32) mod P, x^(128-32) mod P.
+  const __m128i k3k4 = _mm_set_epi64x(0x00CCAA009E, 0x01751997D0);
+  // x^64 mod P.
+  const __m128i k5 = _mm_set_epi64x(0, 0x0163CD6124);
+  // P(x) and the Barrett constant floor(x^64 / P(x)).
+  const __m128i poly = _mm_set_epi64x(0x01F7011641, 0x01DB710641);
+  const __m128i low_dwords_mask = _mm_setr_epi32(-1, 0, -1, 0);
+
+  const __m128i* blocks = reinterpret_cast<const __m128i*>(data);
+  __m128i x1 = _mm_xor_si128(_mm_loadu_si128(blocks),
+                             _mm_cvtsi32_si128(int(crc)));
+  __m128i x2 = _mm_loadu_si128(blocks + 1);
+  __m128i x3 = _mm_loadu_si128(blocks + 2);
+  __m128i x4 = _mm_loadu_si128(blocks + 3);
+  blocks += 4;
+  length -= 64;
+
+  // Four streams in parallel while 64 bytes remain.
+  for (; length >= 64; length -= 64, blocks += 4) {
+    x1 = Crc32FoldBlock(x1, _mm_loadu_si128(blocks), k1k2);
+    x2 = Crc32FoldBlock(x2, _mm_loadu_si128(blocks + 1), k1k2);
+    x3 = Crc32FoldBlock(x3, _mm_loadu_si128(blocks + 2), k1k2);
+    x4 = Crc32FoldBlock(x4, _mm_loadu_si128(blocks + 3), k1k2);
+  }
+
+  // Into one, then the remaining 16-byte blocks.
+  x1 = Crc32FoldBlock(x1, x2, k3k4);
+  x1 = Crc32FoldBlock(x1, x3, k3k4);
+  x1 = Crc32FoldBlock(x1, x4, k3k4);
+  for (; length >= 16; length -= 16, ++blocks) {
+    x1 = Crc32FoldBlock(x1, _mm_loadu_si128(blocks), k3k4);
+  }
+
+  // 128 to 64 bits.
+  __m128i x = _mm_xor_si128(_mm_srli_si128(x1, 8),
+                            _mm_clmulepi64_si128(x1, k3k4, 0x10));
+  x = _mm_xor_si128(
+      _mm_srli_si128(x, 4),
+      _mm_clmulepi64_si128(_mm_and_si128(x, low_dwords_mask), k5, 0x00));
+
+  // Barrett reduction to 32 bits.
+  __m128i t = _mm_clmulepi64_si128(_mm_and_si128(x, low_dwords_mask), poly,
+                                   0x10);
+  t = _mm_clmulepi64_si128(_mm_and_si128(t, low_dwords_mask), poly, 0x00);
+  return uint32_t(_mm_extract_epi32(_mm_xor_si128(x, t), 1));
+}
+#endif
+
+uint32_t RtlCrc32(uint32_t crc, const uint8_t* data, size_t length,
+                  RtlSimdLevel level) {
+  crc = ~crc;
+#if XE_ARCH_AMD64
+  if (level != RtlSimdLevel::kScalar && length >= 64) {
+    size_t folded_length = length & ~size_t(15);
+    crc = Crc32Fold(crc, data, folded_length);
+    data += folded_length;
+    length -= folded_length;
+  }
+#endif
+  return ~Crc32Bytewise(crc, data, length);
+}
+
+#if XE_ARCH_AMD64
+// Vector RtlUpperAnsiChar: a-z, and 0xE0-0xFE except for 0xF7, are lowercase,
+// and 0xFF becomes ?.
+template <typename Vector, typename Ops>
+static Vector UpperAnsiChars(Vector c) {
+  auto in_range = [](Vector c, uint8_t low, uint8_t high) {
+    Vector offset = Ops::sub(c, Ops::set1(low));
+    return Ops::cmpeq(Ops::min(offset, Ops::set1(high - low)), offset);
+  };
+  Vector lower = Ops::or_(
+      in_range(c, 'a', 'z'),
+      Ops::andnot(Ops::cmpeq(c, Ops::set1(0xF7)), in_range(c, 0xE0, 0xFE)));
+  Vector upper = Ops::sub(c, Ops::and_(lower, Ops::set1(0x20)));
+  return Ops::blendv(upper, Ops::set1(0x3F), Ops::cmpeq(c, Ops::set1(0xFF)));
+}
+
+struct SSEOps {
+  static __m128i set1(uint8_t value) { return _mm_set1_epi8(char(value)); }
+  static __m128i sub(__m128i a, __m128i b) { return _mm_sub_epi8(a, b); }
+  static __m128i min(__m128i a, __m128i b) { return _mm_min_epu8(a, b); }
+  static __m128i cmpeq(__m128i a, __m128i b) { return _mm_cmpeq_epi8(a, b); }
+  static __m128i or_(__m128i a, __m128i b) { return _mm_or_si128(a, b); }
+  static __m128i and_(__m128i a, __m128i b) { return _mm_and_si128(a, b); }
+  static __m128i andnot(__m128i a, __m128i b) {
+    return _mm_andnot_si128(a, b);
+  }
+  static __m128i blendv(__m128i a, __m128i b, __m128i mask) {
+    return _mm_blendv_epi8(a, b, mask);
+  }
+};
+
+struct AVX2Ops {
+  static __m256i set1(uint8_t value) { return _mm256_set1_epi8(char(value)); }
+  static __m256i sub(__m256i a, __m256i b) { return _mm256_sub_epi8(a, b); }
+  static __m256i min(__m256i a, __m256i b) { return _mm256_min_epu8(a, b); }
+  static __m256i cmpeq(__m256i a, __m256i b) {
+    return _mm256_cmpeq_epi8(a, b);
+  }
+  static __m256i or_(__m256i a, __m256i b) { return _mm256_or_si256(a, b); }
+  static __m256i and_(__m256i a, __m256i b) { return _mm256_and_si256(a, b); }
+  static __m256i andnot(__m256i a, __m256i b) {
+    return _mm256_andnot_si256(a, b);
+  }
+  static __m256i blendv(__m256i a, __m256i b, __m256i mask) {
+    return _mm256_blendv_epi8(a, b, mask);
+  }
+};
+#endif
+
+// Index of the first 16 or 32 character block with a mismatch, or of the
+// remainder that doesn't fill a block.
+static uint32_t SkipEqualAnsiChars(const uint8_t* string_1,
+                                   const uint8_t* string_2, uint32_t length,
+                                   bool case_insensitive, RtlSimdLevel level) {
+  uint32_t i = 0;
+#if XE_ARCH_AMD64
+  if (level == RtlSimdLevel::kAVX2) {
+    for (; i + 32 <= length; i += 32) {
+      __m256i c1 =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(string_1 + i));
+      __m256i c2 =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(string_2 + i));
+      uint32_t equal =
+          uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(c1, c2)));
+      if (equal != UINT32_MAX && case_insensitive) {
+        equal = uint32_t(_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(UpperAnsiChars<__m256i, AVX2Ops>(c1),
+                              UpperAnsiChars<__m256i, AVX2Ops>(c2))));
+      }
+      if (equal != UINT32_MAX) {
+        return i;
+      }
+    }
+  }
+  if (level != RtlSimdLevel::kScalar) {
+    for (; i + 16 <= length; i += 16) {
+      __m128i c1 =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(string_1 + i));
+      __m128i c2 =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(string_2 + i));
+      uint32_t equal = uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(c1, c2)));
+      if (equal != 0xFFFF && case_insensitive) {
+        equal = uint32_t(_mm_movemask_epi8(
+            _mm_cmpeq_epi8(UpperAnsiChars<__m128i, SSEOps>(c1),
+                           UpperAnsiChars<__m128i, SSEOps>(c2))));
+      }
+      if (equal != 0xFFFF) {
+        return i;
+      }
+    }
+  }
+#endif
+  return i;
+}
+
+int32_t RtlCompareAnsiStrings(const uint8_t* string_1, uint32_t length_1,
+                              const uint8_t* string_2, uint32_t length_2,
+                              bool case_insensitive, RtlSimdLevel level) {
+  uint32_t length = std::min(length_1, length_2);
+  uint32_t i =
+      SkipEqualAnsiChars(string_1, string_2, length, case_insensitive, level);
+  for (; i < length; ++i) {
+    uint32_t c1 = string_1[i];
+    uint32_t c2 = string_2[i];
+    if (c1 != c2) {
+      if (!case_insensitive) {
+        return int32_t(c1 - c2);
+      }
+      uint32_t cu1 = rtl_upper_table[c1];
+      uint32_t cu2 = rtl_upper_table[c2];
+      if (cu1 != cu2) {
+        return int32_t(cu1 - cu2);
+      }
+    }
+  }
+  return int32_t(length_1 - length_2);
+}
+
+}  // namespace util
+}  // namespace kernel
+}  // namespace xe
@@ -0,0 +1,75 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#ifndef XENIA_KERNEL_UTIL_RTL_SIMD_H_
+#define XENIA_KERNEL_UTIL_RTL_SIMD_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace xe {
+namespace kernel {
+namespace util {
+
+// Host implementations of the memory, CRC and string routines of the guest
+// runtime library (RtlCompareMemory, RtlComputeCrc32 and such), working on
+// host pointers into guest memory.
+//
+// Every routine takes the instruction set to use so the vector paths can be
+// checked against the scalar ones. kSSE42 also implies PCLMULQDQ, which every
+// CPU with AVX has.
+enum class RtlSimdLevel {
+  kScalar,
+  kSSE42,
+  kAVX2,
+};
+
+// The best level supported by the host, from the x64 feature flags.
+RtlSimdLevel GetRtlSimdLevel();
+
+// Case mapping of the guest code page, as used by RtlUpperChar and
+// RtlLowerChar.
+uint8_t RtlUpperAnsiChar(uint8_t c);
+uint8_t RtlLowerAnsiChar(uint8_t c);
+
+// Number of positions where the two buffers have equal bytes - not only the
+// matching prefix, as this is what RtlCompareMemory has always returned.
+uint32_t RtlCountEqualBytes(const uint8_t* source1, const uint8_t* source2,
+                            uint32_t length,
+                            RtlSimdLevel level = GetRtlSimdLevel());
+
+// Number of bytes at the beginning of the buffer made of big-endian copies of
+// the pattern, in whole words, looking at length rounded down to 4.
+uint32_t RtlCompareUlongs(const uint8_t* source, uint32_t length,
+                          uint32_t pattern,
+                          RtlSimdLevel level = GetRtlSimdLevel());
+
+// Stores count big-endian copies of the pattern. The destination only needs
+// to be byte-aligned.
+void RtlFillUlongs(uint8_t* destination, uint32_t count, uint32_t pattern,
+                   RtlSimdLevel level = GetRtlSimdLevel());
+
+// Updates a CRC-32 (reflected 0xEDB88320, like zlib) that hasn't been
+// inverted - the seed of RtlComputeCrc32 - with the data.
+uint32_t RtlCrc32(uint32_t crc, const uint8_t* data, size_t length,
+                  RtlSimdLevel level = GetRtlSimdLevel());
+
+// Compares the strings up to the shorter length, optionally ignoring case
+// with RtlUpperAnsiChar. Returns the difference of the first mismatching
+// characters, or of the lengths if there is none.
+int32_t RtlCompareAnsiStrings(const uint8_t* string_1, uint32_t length_1,
+                              const uint8_t* string_2, uint32_t length_2,
+                              bool case_insensitive,
+                              RtlSimdLevel level = GetRtlSimdLevel());
+
+}  // namespace util
+}  // namespace kernel
+}  // namespace xe
+
+#endif  // XENIA_KERNEL_UTIL_RTL_SIMD_H_
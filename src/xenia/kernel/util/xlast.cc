@@ -8,6 +8,11 @@
  */
 
 #include "xenia/kernel/util/xlast.h"
+
+#include <cstring>
+#include <string_view>
+#include <unordered_set>
+
 #include "third_party/zlib/zlib.h"
 #include "xenia/base/cvar.h"
 #include "xenia/base/filesystem.h"
@@ -27,48 +32,81 @@ XLastMatchmakingQuery::XLastMatchmakingQuery() {}
 XLastMatchmakingQuery::XLastMatchmakingQuery(
     const pugi::xpath_node query_node) {
   node_ = query_node;
-}
 
-pugi::xml_node XLastMatchmakingQuery::GetQuery(uint32_t query_id) const {
-  pugi::xml_node query_node;
+  schema_ =
+      XLast::GetAllValuesFromNode(node_.parent().parent(), "Schema", "id");
+  constants_ =
+      XLast::GetAllValuesFromNode(node_.parent().parent(), "Constants", "id");
 
-  std::string xpath = fmt::format("Queries/Query[@id = \"{}\"]", query_id);
+  for (pugi::xml_node query_node : node_.node().child("Queries").children()) {
+    pugi::xml_attribute id = query_node.attribute("id");
+    if (!id) {
+      continue;
+    }
+    // The first query with the ID is the one that's looked up.
+    auto [it, inserted] = queries_.try_emplace(id.as_uint());
+    if (!inserted) {
+      continue;
+    }
+    Query& query = it->second;
+    query.node = query_node;
+    query.name = query_node.attribute("friendlyName").value();
+    query.returns = XLast::GetAllValuesFromNode(query_node, "Returns", "id");
+    query.parameters =
+        XLast::GetAllValuesFromNode(query_node, "Parameters", "id");
+    query.filters_left =
+        XLast::GetAllValuesFromNode(query_node, "Filters", "left");
+    query.filters_right =
+        XLast::GetAllValuesFromNode(query_node, "Filters", "right");
+  }
+}
 
-  query_node = node_.node().select_node(xpath.c_str()).node();
+const XLastMatchmakingQuery::Query* XLastMatchmakingQuery::FindQuery(
+    uint32_t query_id) const {
+  auto it = queries_.find(query_id);
+  return it != queries_.cend() ? &it->second : nullptr;
+}
 
-  return query_node;
+pugi::xml_node XLastMatchmakingQuery::GetQuery(uint32_t query_id) const {
+  const Query* query = FindQuery(query_id);
+  return query ? query->node : pugi::xml_node();
 }
+
 std::vector<uint32_t> XLastMatchmakingQuery::GetSchema() const {
-  return XLast::GetAllValuesFromNode(node_.parent().parent(), "Schema", "id");
+  return schema_;
 }
 
 std::vector<uint32_t> XLastMatchmakingQuery::GetConstants() const {
-  return XLast::GetAllValuesFromNode(node_.parent().parent(), "Constants",
-                                     "id");
+  return constants_;
 }
 
 std::string XLastMatchmakingQuery::GetName(uint32_t query_id) const {
-  return GetQuery(query_id).attribute("friendlyName").value();
+  const Query* query = FindQuery(query_id);
+  return query ? query->name : std::string();
 }
 
 std::vector<uint32_t> XLastMatchmakingQuery::GetReturns(
     uint32_t query_id) const {
-  return XLast::GetAllValuesFromNode(GetQuery(query_id), "Returns", "id");
+  const Query* query = FindQuery(query_id);
+  return query ? query->returns : std::vector<uint32_t>();
 }
 
 std::vector<uint32_t> XLastMatchmakingQuery::GetParameters(
     uint32_t query_id) const {
-  return XLast::GetAllValuesFromNode(GetQuery(query_id), "Parameters", "id");
+  const Query* query = FindQuery(query_id);
+  return query ? query->parameters : std::vector<uint32_t>();
 }
 
 std::vector<uint32_t> XLastMatchmakingQuery::GetFiltersLeft(
     uint32_t query_id) const {
-  return XLast::GetAllValuesFromNode(GetQuery(query_id), "Filters", "left");
+  const Query* query = FindQuery(query_id);
+  return query ? query->filters_left : std::vector<uint32_t>();
 }
 
 std::vector<uint32_t> XLastMatchmakingQuery::GetFiltersRight(
     uint32_t query_id) const {
-  return XLast::GetAllValuesFromNode(GetQuery(query_id), "Filters", "right");
+  const Query* query = FindQuery(query_id);
+  return query ? query->filters_right : std::vector<uint32_t>();
 }
 
 #pragma endregion
@@ -78,28 +116,28 @@ std::vector<uint32_t> XLastMatchmakingQuery::GetFiltersRight(
 XLastPropertiesQuery::XLastPropertiesQuery() {}
 XLastPropertiesQuery::XLastPropertiesQuery(const pugi::xpath_node query_node) {
   node_ = query_node;
-}
-
-std::vector<uint32_t> XLastPropertiesQuery::GetPropertyIDs() const {
-  std::vector<uint32_t> result = {};
 
   for (pugi::xml_node child : node_.node().children()) {
-    result.push_back(xe::string_util::from_string<uint32_t>(
-        child.attribute("id").value(), true));
+    if (!*child.attribute("id").value()) {
+      continue;
+    }
+    const uint32_t property_id = xe::string_util::from_string<uint32_t>(
+        child.attribute("id").value(), true);
+    property_ids_.push_back(property_id);
+    if (std::strcmp(child.name(), "Property") == 0) {
+      properties_.emplace(property_id, child);
+    }
   }
+}
 
-  return result;
+std::vector<uint32_t> XLastPropertiesQuery::GetPropertyIDs() const {
+  return property_ids_;
 }
 
 pugi::xml_node XLastPropertiesQuery::GetPropertyNode(
     uint32_t property_id) const {
-  pugi::xml_node property_node;
-
-  std::string xpath = fmt::format("Property[@id = \"0x{:08X}\"]", property_id);
-
-  property_node = node_.node().select_node(xpath.c_str()).node();
-
-  return property_node;
+  auto it = properties_.find(property_id);
+  return it != properties_.cend() ? it->second : pugi::xml_node();
 }
 
 std::optional<std::string> XLastPropertiesQuery::GetPropertyFriendlyName(
@@ -153,27 +191,38 @@ pugi::xml_node XLastPropertiesQuery::GetPropertyFormat(
 XLastContextsQuery::XLastContextsQuery() {}
 XLastContextsQuery::XLastContextsQuery(const pugi::xpath_node query_node) {
   node_ = query_node;
-}
-
-std::vector<uint32_t> XLastContextsQuery::GetContextsIDs() const {
-  std::vector<uint32_t> result = {};
 
   for (pugi::xml_node child : node_.node().children()) {
-    result.push_back(xe::string_util::from_string<uint32_t>(
-        child.attribute("id").value(), true));
+    if (!*child.attribute("id").value()) {
+      continue;
+    }
+    const uint32_t context_id = xe::string_util::from_string<uint32_t>(
+        child.attribute("id").value(), true);
+    context_ids_.push_back(context_id);
+    if (std::strcmp(child.name(), "Context") != 0) {
+      continue;
+    }
+    auto [it, inserted] = contexts_.try_emplace(context_id);
+    if (!inserted) {
+      continue;
+    }
+    it->second.node = child;
+    for (pugi::xml_node value_node : child.children("ContextValue")) {
+      pugi::xml_attribute value = value_node.attribute("value");
+      if (value) {
+        it->second.values.emplace(value.as_uint(), value_node);
+      }
+    }
   }
+}
 
-  return result;
+std::vector<uint32_t> XLastContextsQuery::GetContextsIDs() const {
+  return context_ids_;
 }
 
 pugi::xml_node XLastContextsQuery::GetContextNode(uint32_t property_id) const {
-  pugi::xml_node property_node;
-
-  std::string xpath = fmt::format("Context[@id = \"0x{:08X}\"]", property_id);
-
-  property_node = node_.node().select_node(xpath.c_str()).node();
-
-  return property_node;
+  auto it = contexts_.find(property_id);
+  return it != contexts_.cend() ? it->second.node : pugi::xml_node();
 }
 
 std::optional<std::string> XLastContextsQuery::GetContextFriendlyName(
@@ -204,17 +253,13 @@ std::optional<uint32_t> XLastContextsQuery::GetContextDefaultValue(
 
 pugi::xml_node XLastContextsQuery::GetContextValueNode(uint32_t property_id,
                                                        uint32_t value) const {
-  pugi::xml_node context_node = GetContextNode(property_id);
-
-  pugi::xml_node context_value_node;
-
-  std::string xpath = fmt::format("ContextValue[@value = \"{}\"]", value);
-
-  if (context_node) {
-    context_value_node = context_node.select_node(xpath.c_str()).node();
+  auto context_it = contexts_.find(property_id);
+  if (context_it == contexts_.cend()) {
+    return pugi::xml_node();
   }
-
-  return context_value_node;
+  auto value_it = context_it->second.values.find(value);
+  return value_it != context_it->second.values.cend() ? value_it->second
+                                                      : pugi::xml_node();
 }
 
 std::optional<uint32_t> XLastContextsQuery::GetContextValueStringID(
@@ -237,27 +282,28 @@ std::optional<uint32_t> XLastContextsQuery::GetContextValueStringID(
 XLastGameModeQuery::XLastGameModeQuery() {}
 XLastGameModeQuery::XLastGameModeQuery(const pugi::xpath_node query_node) {
   node_ = query_node;
-}
-
-std::vector<uint32_t> XLastGameModeQuery::GetGameModeValues() const {
-  std::vector<uint32_t> result = {};
 
   for (pugi::xml_node child : node_.node().children()) {
-    result.push_back(xe::string_util::from_string<uint32_t>(
-        child.attribute("value").value(), false));
+    if (!*child.attribute("value").value()) {
+      continue;
+    }
+    const uint32_t value = xe::string_util::from_string<uint32_t>(
+        child.attribute("value").value(), false);
+    game_mode_values_.push_back(value);
+    if (std::strcmp(child.name(), "GameMode") == 0) {
+      game_modes_.emplace(value, child);
+    }
   }
+}
 
-  return result;
+std::vector<uint32_t> XLastGameModeQuery::GetGameModeValues() const {
+  return game_mode_values_;
 }
 
 pugi::xml_node XLastGameModeQuery::GetGameModeNode(
     uint32_t gamemode_value) const {
-  pugi::xml_node gamemode_node;
-
-  std::string xpath = fmt::format("GameMode[@value = \"{}\"]", gamemode_value);
-  gamemode_node = node_.node().select_node(xpath.c_str()).node();
-
-  return gamemode_node;
+  auto it = game_modes_.find(gamemode_value);
+  return it != game_modes_.cend() ? it->second : pugi::xml_node();
 }
 
 std::optional<uint32_t> XLastGameModeQuery::GetGameModeDefaultValue() const {
@@ -337,21 +383,87 @@ XLast::XLast(const uint8_t* compressed_xml_data,
 
   parse_result_ = parsed_xlast_->load_buffer(xlast_decompressed_xml_.data(),
                                              xlast_decompressed_xml_.size());
+  if (!parse_result_) {
+    XELOGE("XLast: Error during XML parsing: {}", parse_result_.description());
+    return;
+  }
+
+  BuildIndex();
 }
 
-std::u16string XLast::GetTitleName() const {
-  std::string xpath = "/XboxLiveSubmissionProject/GameConfigProject";
+// Languages without a locale in the XLAST use the English strings.
+static uint64_t GetLocalizedStringKey(uint32_t string_id, XLanguage language) {
+  if (language_mapping.find(language) == language_mapping.cend()) {
+    language = XLanguage::kEnglish;
+  }
+  return (uint64_t(language) << 32) | string_id;
+}
 
-  if (!HasXLast()) {
-    return u"";
+void XLast::BuildIndex() {
+  game_config_node_ = parsed_xlast_->child("XboxLiveSubmissionProject")
+                          .child("GameConfigProject");
+  if (!game_config_node_) {
+    return;
   }
 
-  const pugi::xpath_node node = parsed_xlast_->select_node(xpath.c_str());
-  if (!node) {
+  if (pugi::xml_node node = game_config_node_.child("GameModes")) {
+    game_mode_query_ =
+        std::make_unique<XLastGameModeQuery>(pugi::xpath_node(node));
+  }
+  if (pugi::xml_node node = game_config_node_.child("Contexts")) {
+    contexts_query_ =
+        std::make_unique<XLastContextsQuery>(pugi::xpath_node(node));
+  }
+  if (pugi::xml_node node = game_config_node_.child("Properties")) {
+    properties_query_ =
+        std::make_unique<XLastPropertiesQuery>(pugi::xpath_node(node));
+  }
+  if (pugi::xml_node node = game_config_node_.child("Matchmaking")) {
+    matchmaking_query_ =
+        std::make_unique<XLastMatchmakingQuery>(pugi::xpath_node(node));
+  }
+
+  std::unordered_map<std::string_view, XLanguage> locale_languages;
+  for (const auto& language : language_mapping) {
+    locale_languages.emplace(language.second, language.first);
+  }
+  std::unordered_set<uint32_t> string_ids;
+  for (pugi::xml_node string_node :
+       game_config_node_.child("LocalizedStrings").children("LocalizedString")) {
+    pugi::xml_attribute id = string_node.attribute("id");
+    // Only the first string with the ID is looked up.
+    if (!id || !string_ids.insert(id.as_uint()).second) {
+      continue;
+    }
+    for (pugi::xml_node locale_node : string_node.children()) {
+      auto language =
+          locale_languages.find(locale_node.attribute("locale").value());
+      if (language == locale_languages.cend()) {
+        continue;
+      }
+      localized_strings_.emplace(
+          GetLocalizedStringKey(id.as_uint(), language->second),
+          xe::to_utf16(locale_node.child_value()));
+    }
+  }
+
+  for (pugi::xml_node presence_node :
+       game_config_node_.child("Presence").children("PresenceMode")) {
+    pugi::xml_attribute context_value = presence_node.attribute("contextValue");
+    if (context_value) {
+      presence_string_ids_.emplace(
+          context_value.as_uint(),
+          presence_node.attribute("stringId").as_uint());
+    }
+  }
+}
+
+std::u16string XLast::GetTitleName() const {
+  if (!game_config_node_) {
     return u"";
   }
 
-  return xe::to_utf16(node.node().attribute("titleName").as_string());
+  return xe::to_utf16(game_config_node_.attribute("titleName").as_string());
 }
 
 std::map<ProductInformationEntry, uint32_t>
@@ -426,72 +538,32 @@ std::vector<XLanguage> XLast::GetSupportedLanguages() const {
 
 std::optional<std::uint32_t> XLast::GetGameModeStringId(
     uint32_t game_mode_value) const {
-  std::string xpath = fmt::format(
-      "/XboxLiveSubmissionProject/GameConfigProject/GameModes/"
-      "GameMode[@value = \"{}\"]",
-      game_mode_value);
-
-  std::optional<uint32_t> value = std::nullopt;
-
-  if (!HasXLast()) {
-    return value;
-  }
-
-  const pugi::xpath_node node = parsed_xlast_->select_node(xpath.c_str());
-  if (node) {
-    value = node.node().attribute("stringId").as_uint();
+  if (!game_mode_query_) {
+    return std::nullopt;
   }
 
-  return value;
+  return game_mode_query_->GetGameModeStringID(game_mode_value);
 }
 
 std::u16string XLast::GetLocalizedString(uint32_t string_id,
                                          XLanguage language) const {
-  std::string xpath = fmt::format(
-      "/XboxLiveSubmissionProject/GameConfigProject/LocalizedStrings/"
-      "LocalizedString[@id = \"{}\"]",
-      string_id);
-
-  if (!HasXLast()) {
-    return u"";
-  }
-
-  const pugi::xpath_node node = parsed_xlast_->select_node(xpath.c_str());
-  if (!node) {
-    return u"";
-  }
-
-  const std::string locale_name = GetLocaleStringFromLanguage(language);
-  const pugi::xml_node locale_node =
-      node.node().find_child_by_attribute("locale", locale_name.c_str());
-
-  if (!locale_node) {
+  const auto it =
+      localized_strings_.find(GetLocalizedStringKey(string_id, language));
+  if (it == localized_strings_.cend()) {
     return u"";
   }
 
-  return xe::to_utf16(locale_node.child_value());
+  return it->second;
 }
 
 const std::optional<uint32_t> XLast::GetPresenceStringId(
     const uint32_t context_id) {
-  std::string xpath = fmt::format(
-      "/XboxLiveSubmissionProject/GameConfigProject/Presence/"
-      "PresenceMode[@contextValue = \"{}\"]",
-      context_id);
-
-  std::optional<uint32_t> string_id = std::nullopt;
-
-  if (!HasXLast()) {
-    return string_id;
+  const auto it = presence_string_ids_.find(context_id);
+  if (it == presence_string_ids_.cend()) {
+    return std::nullopt;
   }
 
-  pugi::xpath_node node = parsed_xlast_->select_node(xpath.c_str());
-
-  if (node) {
-    string_id = node.node().attribute("stringId").as_uint();
-  }
-
-  return string_id;
+  return it->second;
 }
 
 const std::u16string XLast::GetPresenceRawString(
@@ -513,75 +585,19 @@ const std::u16string XLast::GetPresenceRawString(
 }
 
 XLastGameModeQuery* XLast::GetGameModeQuery() const {
-  std::string xpath =
-      fmt::format("/XboxLiveSubmissionProject/GameConfigProject/GameModes");
-
-  XLastGameModeQuery* query = nullptr;
-
-  if (!HasXLast()) {
-    return query;
-  }
-
-  pugi::xpath_node node = parsed_xlast_->select_node(xpath.c_str());
-  if (!node) {
-    return query;
-  }
-
-  return new XLastGameModeQuery(node);
+  return game_mode_query_.get();
 }
 
 XLastContextsQuery* XLast::GetContextsQuery() const {
-  std::string xpath =
-      fmt::format("/XboxLiveSubmissionProject/GameConfigProject/Contexts");
-
-  XLastContextsQuery* query = nullptr;
-
-  if (!HasXLast()) {
-    return query;
-  }
-
-  pugi::xpath_node node = parsed_xlast_->select_node(xpath.c_str());
-  if (!node) {
-    return query;
-  }
-
-  return new XLastContextsQuery(node);
+  return contexts_query_.get();
 }
 
 XLastPropertiesQuery* XLast::GetPropertiesQuery() const {
-  std::string xpath =
-      fmt::format("/XboxLiveSubmissionProject/GameConfigProject/Properties");
-
-  XLastPropertiesQuery* query = nullptr;
-
-  if (!HasXLast()) {
-    return query;
-  }
-
-  pugi::xpath_node node = parsed_xlast_->select_node(xpath.c_str());
-  if (!node) {
-    return query;
-  }
-
-  return new XLastPropertiesQuery(node);
+  return properties_query_.get();
 }
 
 XLastMatchmakingQuery* XLast::GetMatchmakingQuery() const {
-  std::string xpath =
-      fmt::format("/XboxLiveSubmissionProject/GameConfigProject/Matchmaking");
-
-  XLastMatchmakingQuery* matchmaking = nullptr;
-
-  if (!HasXLast()) {
-    return matchmaking;
-  }
-
-  pugi::xpath_node node = parsed_xlast_->select_node(xpath.c_str());
-  if (!node) {
-    return matchmaking;
-  }
-
-  return new XLastMatchmakingQuery(node);
+  return matchmaking_query_.get();
 }
 
 std::vector<uint32_t> XLast::GetAllValuesFromNode(
@@ -627,15 +643,6 @@ void XLast::Dump(std::string file_name) const {
   fclose(outfile);
 }
 
-std::string XLast::GetLocaleStringFromLanguage(XLanguage language) const {
-  const auto value = language_mapping.find(language);
-  if (value != language_mapping.cend()) {
-    return value->second;
-  }
-
-  return language_mapping.at(XLanguage::kEnglish);
-}
-
 }  // namespace util
 }  // namespace kernel
 }  // namespace xe
@@ -11,8 +11,10 @@
 #define XENIA_KERNEL_UTIL_XLAST_H_
 
 #include <map>
+#include <memory>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "third_party/pugixml/src/pugixml.hpp"
@@ -68,7 +70,21 @@ class XLastMatchmakingQuery {
   std::vector<uint32_t> GetFiltersRight(uint32_t query_id) const;
 
  private:
+  struct Query {
+    pugi::xml_node node;
+    std::string name;
+    std::vector<uint32_t> returns;
+    std::vector<uint32_t> parameters;
+    std::vector<uint32_t> filters_left;
+    std::vector<uint32_t> filters_right;
+  };
+
+  const Query* FindQuery(uint32_t query_id) const;
+
   pugi::xpath_node node_;
+  std::vector<uint32_t> schema_;
+  std::vector<uint32_t> constants_;
+  std::unordered_map<uint32_t, Query> queries_;
 };
 
 class XLastPropertiesQuery {
@@ -86,6 +102,8 @@ class XLastPropertiesQuery {
 
  private:
   pugi::xpath_node node_;
+  std::vector<uint32_t> property_ids_;
+  std::unordered_map<uint32_t, pugi::xml_node> properties_;
 };
 
 class XLastContextsQuery {
@@ -103,7 +121,14 @@ class XLastContextsQuery {
                                                   uint32_t value) const;
 
  private:
+  struct Context {
+    pugi::xml_node node;
+    std::unordered_map<uint32_t, pugi::xml_node> values;
+  };
+
   pugi::xpath_node node_;
+  std::vector<uint32_t> context_ids_;
+  std::unordered_map<uint32_t, Context> contexts_;
 };
 
 class XLastGameModeQuery {
@@ -119,8 +144,12 @@ class XLastGameModeQuery {
 
  private:
   pugi::xpath_node node_;
+  std::vector<uint32_t> game_mode_values_;
+  std::unordered_map<uint32_t, pugi::xml_node> game_modes_;
 };
 
+// The document is indexed once when loaded, so lookups by ID don't need to
+// search it. The returned queries are owned by the XLast.
 class XLast {
  public:
   XLast() = default;
@@ -154,11 +183,22 @@ class XLast {
   const bool HasXLast() const { return !xlast_decompressed_xml_.empty(); };
 
  private:
-  std::string GetLocaleStringFromLanguage(XLanguage language) const;
+  void BuildIndex();
 
   std::vector<uint8_t> xlast_decompressed_xml_;
   std::unique_ptr<pugi::xml_document> parsed_xlast_ = nullptr;
   pugi::xml_parse_result parse_result_ = {};
+
+  pugi::xml_node game_config_node_;
+  std::unique_ptr<XLastGameModeQuery> game_mode_query_;
+  std::unique_ptr<XLastContextsQuery> contexts_query_;
+  std::unique_ptr<XLastPropertiesQuery> properties_query_;
+  std::unique_ptr<XLastMatchmakingQuery> matchmaking_query_;
+  // Localized strings of the supported languages, keyed by the language in
+  // the upper 32 bits and the string ID in the lower.
+  std::unordered_map<uint64_t, std::u16string> localized_strings_;
+  // Presence mode context values to their string IDs.
+  std::unordered_map<uint32_t, uint32_t> presence_string_ids_;
 };
 
 }  // namespace util
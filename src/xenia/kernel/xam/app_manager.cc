@@ -74,8 +74,15 @@ X_HRESULT AppManager::DispatchMessageAsync(uint32_t app_id, uint32_t message,
   };
 
   if (overlapped_ptr) {
-    it->second->kernel_state_->CompleteOverlappedDeferred(run, overlapped_ptr,
-                                                          nullptr, post);
+    KernelState* kernel_state = it->second->kernel_state_;
+    // Pending before dispatching, the completion may be queued right away.
+    kernel_state->BeginOverlappedDeferred(overlapped_ptr);
+    if (!it->second->DispatchMessageOverlapped(message, buffer_in,
+                                               buffer_length, overlapped_ptr,
+                                               post)) {
+      kernel_state->CompleteOverlappedDeferred(run, overlapped_ptr, nullptr,
+                                               post);
+    }
     return X_ERROR_IO_PENDING;
   };
 
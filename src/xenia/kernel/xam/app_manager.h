@@ -11,6 +11,7 @@
 #define XENIA_KERNEL_XAM_APP_MANAGER_H_
 
 #include <cstddef>
+#include <functional>
 #include <memory>
 #include <unordered_map>
 #include <vector>
@@ -35,6 +36,19 @@ class App {
   virtual X_HRESULT DispatchMessageSync(uint32_t message, uint32_t buffer_ptr,
                                         uint32_t buffer_length) = 0;
 
+  // Starts an overlapped message that waits on the network, completing it
+  // through KernelState::QueueOverlappedCompletion once the response arrives
+  // and calling post_callback afterwards. Returns false, without taking
+  // ownership, if the message has no such path or the request queue is full;
+  // the message is then run through DispatchMessageSync on the dispatch
+  // thread instead.
+  virtual bool DispatchMessageOverlapped(uint32_t message, uint32_t buffer_ptr,
+                                         uint32_t buffer_length,
+                                         uint32_t overlapped_ptr,
+                                         std::function<void()> post_callback) {
+    return false;
+  }
+
   virtual ~App() = default;
   KernelState* kernel_state_;
 
@@ -92,8 +92,316 @@ struct XGI_XUSER_STATS_RESET {
 };
 static_assert_size(XGI_XUSER_STATS_RESET, 0x8);
 
+// Builds the leaderboards/find query for XUserReadStats, empty if there are no
+// users to read.
+static std::string MakeReadStatsQuery(KernelState* kernel_state,
+                                      XGI_XUSER_READ_STATS* data) {
+  Memory* memory = kernel_state->memory();
+
+  Document doc;
+  doc.SetObject();
+
+  Value xuidsJsonArray(kArrayType);
+  auto xuids = memory->TranslateVirtual<xe::be<uint64_t>*>(data->xuids_ptr);
+
+  for (uint32_t player_index = 0; player_index < data->xuids_count;
+       player_index++) {
+    const xe::be<uint64_t> xuid = xuids[player_index];
+
+    assert_true(IsValidXUID(xuid));
+
+    if (xuid) {
+      std::string xuid_str = string_util::to_hex_string(xuid);
+
+      Value value;
+      value.SetString(xuid_str.c_str(), 16, doc.GetAllocator());
+      xuidsJsonArray.PushBack(value, doc.GetAllocator());
+    }
+  }
+
+  if (xuidsJsonArray.Empty()) {
+    return {};
+  }
+
+  doc.AddMember("players", xuidsJsonArray, doc.GetAllocator());
+
+  std::string title_id = fmt::format("{:08x}", kernel_state->title_id());
+  doc.AddMember("titleId", title_id, doc.GetAllocator());
+
+  Value leaderboardQueryJsonArray(kArrayType);
+  auto queries = memory->TranslateVirtual<X_USER_STATS_SPEC*>(data->specs_ptr);
+
+  for (unsigned int queryIndex = 0; queryIndex < data->specs_count;
+       queryIndex++) {
+    Value queryObject(kObjectType);
+    queryObject.AddMember("id", queries[queryIndex].view_id,
+                          doc.GetAllocator());
+
+    assert_false(queries[queryIndex].num_column_ids > kXUserMaxStatsAttributes);
+
+    const uint32_t num_column_ids = std::min<uint32_t>(
+        queries[queryIndex].num_column_ids, kXUserMaxStatsAttributes);
+
+    Value statIdsArray(kArrayType);
+    for (uint32_t stat_id_index = 0; stat_id_index < num_column_ids;
+         stat_id_index++) {
+      statIdsArray.PushBack(queries[queryIndex].column_Ids[stat_id_index],
+                            doc.GetAllocator());
+    }
+    queryObject.AddMember("statisticIds", statIdsArray, doc.GetAllocator());
+    leaderboardQueryJsonArray.PushBack(queryObject, doc.GetAllocator());
+  }
+
+  doc.AddMember("queries", leaderboardQueryJsonArray, doc.GetAllocator());
+
+  rapidjson::StringBuffer buffer;
+  PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+  doc.Accept(writer);
+
+  return buffer.GetString();
+}
+
+static X_RESULT ReadStatsResults(Memory* memory, XGI_XUSER_READ_STATS* data,
+                                 HTTPResponseObjectJSON* chunk) {
+  if (chunk->RawResponse().response == nullptr ||
+      chunk->StatusCode() != HTTP_STATUS_CODE::HTTP_CREATED) {
+    // FM2 crashes with X_ERROR_FUNCTION_FAILED
+    return X_ERROR_SUCCESS;
+  }
+
+  Document leaderboards;
+  leaderboards.Parse(chunk->RawResponse().response);
+  const Value& leaderboardsArray = leaderboards.GetArray();
+
+  auto leaderboards_guest_address = memory->SystemHeapAlloc(
+      sizeof(X_USER_STATS_VIEW) * leaderboardsArray.Size());
+  auto leaderboard = memory->TranslateVirtual<X_USER_STATS_VIEW*>(
+      leaderboards_guest_address);
+  auto resultsHeader =
+      memory->TranslateVirtual<X_USER_STATS_READ_RESULTS*>(data->results_ptr);
+  resultsHeader->num_views = leaderboardsArray.Size();
+  resultsHeader->views_ptr = leaderboards_guest_address;
+
+  uint32_t leaderboardIndex = 0;
+  for (Value::ConstValueIterator leaderboardObjectPtr =
+           leaderboardsArray.Begin();
+       leaderboardObjectPtr != leaderboardsArray.End();
+       ++leaderboardObjectPtr) {
+    leaderboard[leaderboardIndex].ViewId =
+        (*leaderboardObjectPtr)["id"].GetUint();
+    auto playersArray = (*leaderboardObjectPtr)["players"].GetArray();
+    leaderboard[leaderboardIndex].NumRows = playersArray.Size();
+    leaderboard[leaderboardIndex].TotalViewRows = playersArray.Size();
+    auto players_guest_address = memory->SystemHeapAlloc(
+        sizeof(X_USER_STATS_ROW) * playersArray.Size());
+    auto player =
+        memory->TranslateVirtual<X_USER_STATS_ROW*>(players_guest_address);
+    leaderboard[leaderboardIndex].pRows = players_guest_address;
+
+    uint32_t playerIndex = 0;
+    for (Value::ConstValueIterator playerObjectPtr = playersArray.Begin();
+         playerObjectPtr != playersArray.End(); ++playerObjectPtr) {
+      auto gamertag = (*playerObjectPtr)["gamertag"].GetString();
+      auto gamertagLength = (*playerObjectPtr)["gamertag"].GetStringLength();
+      memcpy(player[playerIndex].szGamertag, gamertag, gamertagLength);
+
+      std::vector<uint8_t> xuid;
+      string_util::hex_string_to_array(
+          xuid, (*playerObjectPtr)["xuid"].GetString());
+      memcpy(&player[playerIndex].xuid, xuid.data(), 8);
+
+      auto statisticsArray = (*playerObjectPtr)["stats"].GetArray();
+      player[playerIndex].NumColumns = statisticsArray.Size();
+      auto stats_guest_address = memory->SystemHeapAlloc(
+          sizeof(X_USER_STATS_COLUMN) * statisticsArray.Size());
+      auto stat = memory->TranslateVirtual<X_USER_STATS_COLUMN*>(
+          stats_guest_address);
+      player[playerIndex].pColumns = stats_guest_address;
+
+      uint32_t statIndex = 0;
+      for (Value::ConstValueIterator statObjectPtr = statisticsArray.Begin();
+           statObjectPtr != statisticsArray.End(); ++statObjectPtr) {
+        stat[statIndex].ColumnId = (*statObjectPtr)["id"].GetUint();
+
+        stat[statIndex].Value.type = static_cast<X_USER_DATA_TYPE>(
+            (*statObjectPtr)["type"].GetUint());
+
+        X_USER_DATA_TYPE stat_type = stat[statIndex].Value.type;
+
+        switch (stat_type) {
+          case X_USER_DATA_TYPE::CONTEXT: {
+            XELOGW("Statistic type: CONTEXT");
+          } break;
+          case X_USER_DATA_TYPE::INT32: {
+            XELOGW("Statistic type: INT32");
+          } break;
+          case X_USER_DATA_TYPE::INT64: {
+            XELOGW("Statistic type: INT64");
+          } break;
+          case X_USER_DATA_TYPE::DOUBLE: {
+            XELOGW("Statistic type: DOUBLE");
+          } break;
+          case X_USER_DATA_TYPE::FLOAT: {
+            XELOGW("Statistic type: FLOAT");
+          } break;
+          case X_USER_DATA_TYPE::DATETIME: {
+            XELOGW("Statistic type: DATETIME");
+          } break;
+          case X_USER_DATA_TYPE::UNSET: {
+            // Backend returns placeholder stats for display
+            XELOGW(
+                "Row Index: {} - Placeholder stat missing stat ID in "
+                "stats.json",
+                playerIndex);
+          } break;
+          case X_USER_DATA_TYPE::WSTRING:
+          case X_USER_DATA_TYPE::BINARY:
+          default: {
+            XELOGW("Unsupported statistic type.",
+                   static_cast<uint32_t>(stat_type));
+          } break;
+        }
+
+        switch (stat_type) {
+          case X_USER_DATA_TYPE::CONTEXT:
+            stat[statIndex].Value.data.u32 =
+                (*statObjectPtr)["value"].GetUint();
+            break;
+          case X_USER_DATA_TYPE::INT32:
+            stat[statIndex].Value.data.s32 = (*statObjectPtr)["value"].GetInt();
+            break;
+          case X_USER_DATA_TYPE::INT64:
+            stat[statIndex].Value.data.s64 =
+                (*statObjectPtr)["value"].GetInt64();
+            break;
+          case X_USER_DATA_TYPE::UNSET: {
+            // Ignore don't read missing/placeholder stat
+          } break;
+          default:
+            XELOGW("Unimplemented stat type for read, will attempt anyway.",
+                   static_cast<uint32_t>(stat[statIndex].Value.type));
+            if ((*statObjectPtr)["value"].IsNumber()) {
+              stat[statIndex].Value.data.s64 =
+                  (*statObjectPtr)["value"].GetUint64();
+            }
+        }
+
+        player[playerIndex].Rank = 1;
+
+        if ((*statObjectPtr)["value"].IsNumber()) {
+          // 41560901 uses i64Rating for ranking friends scores
+          player[playerIndex].i64Rating = (*statObjectPtr)["value"].GetUint64();
+        }
+
+        statIndex++;
+      }
+
+      playerIndex++;
+    }
+
+    leaderboardIndex++;
+  }
+  return X_E_SUCCESS;
+}
+
 XgiApp::XgiApp(KernelState* kernel_state) : App(kernel_state, 0xFB) {}
 
+bool XgiApp::DispatchMessageOverlapped(uint32_t message, uint32_t buffer_ptr,
+                                       uint32_t buffer_length,
+                                       uint32_t overlapped_ptr,
+                                       std::function<void()> post_callback) {
+  auto buffer = memory_->TranslateVirtual(buffer_ptr);
+
+  // Only the requests are issued here, the guest buffers are filled in on the
+  // dispatch thread once the responses arrive. Size queries and anything
+  // that doesn't need the network go through DispatchMessageSync.
+  switch (message) {
+    case 0x000B0016:
+    case 0x000B001C: {
+      XGI_SESSION_SEARCH* data;
+      uint32_t num_users;
+
+      if (message == 0x000B001C) {
+        auto search_ex = reinterpret_cast<XGI_SESSION_SEARCH_EX*>(buffer);
+        data = &search_ex->session_search;
+        num_users = search_ex->num_users;
+      } else {
+        data = reinterpret_cast<XGI_SESSION_SEARCH*>(buffer);
+        num_users = kernel_state()
+                        ->xam_state()
+                        ->profile_manager()
+                        ->SignedInProfilesCount();
+      }
+
+      if (!data->results_buffer_size) {
+        return false;
+      }
+
+      XELOGI("XSessionSearch (overlapped)");
+
+      return XLiveAPI::SessionSearchAsync(
+          data, num_users,
+          [this, data, overlapped_ptr,
+           post_callback](std::vector<SessionSearchResult> sessions) {
+            auto results = std::make_shared<std::vector<SessionSearchResult>>(
+                std::move(sessions));
+
+            QueueOverlappedCompletion(
+                overlapped_ptr,
+                [this, data, results]() {
+                  return XSession::FillSessionSearchResults(kernel_state_,
+                                                            data, *results);
+                },
+                post_callback);
+          });
+    }
+    case 0x000B0021: {
+      XGI_XUSER_READ_STATS* data =
+          reinterpret_cast<XGI_XUSER_READ_STATS*>(buffer);
+
+      if (!data->results_ptr) {
+        return false;
+      }
+
+      const std::string query = MakeReadStatsQuery(kernel_state_, data);
+
+      if (query.empty()) {
+        return false;
+      }
+
+      XELOGI("XUserReadStats (overlapped)");
+
+      return XLiveAPI::LeaderboardsFindAsync(
+          (uint8_t*)query.c_str(),
+          [this, data, overlapped_ptr,
+           post_callback](std::unique_ptr<HTTPResponseObjectJSON> response) {
+            std::shared_ptr<HTTPResponseObjectJSON> chunk = std::move(response);
+
+            QueueOverlappedCompletion(
+                overlapped_ptr,
+                [this, data, chunk]() {
+                  return ReadStatsResults(memory_, data, chunk.get());
+                },
+                post_callback);
+          });
+    }
+  }
+  return false;
+}
+
+void XgiApp::QueueOverlappedCompletion(uint32_t overlapped_ptr,
+                                       std::function<X_RESULT()> fill,
+                                       std::function<void()> post_callback) {
+  kernel_state_->QueueOverlappedCompletion(
+      [fill](uint32_t& extended_error, uint32_t& length) -> X_RESULT {
+        X_RESULT result = fill();
+        extended_error = static_cast<uint32_t>(result);
+        length = 0;
+        return result;
+      },
+      overlapped_ptr, nullptr, post_callback);
+}
+
 X_HRESULT XgiApp::DispatchMessageSync(uint32_t message, uint32_t buffer_ptr,
                                       uint32_t buffer_length) {
   // NOTE: buffer_length may be zero or valid.
@@ -204,218 +512,16 @@ X_HRESULT XgiApp::DispatchMessageSync(uint32_t message, uint32_t buffer_ptr,
         return 1;
       }
 
-#pragma region Curl
-      Document doc;
-      doc.SetObject();
-
-      Value xuidsJsonArray(kArrayType);
-      auto xuids =
-          memory_->TranslateVirtual<xe::be<uint64_t>*>(data->xuids_ptr);
-
-      for (uint32_t player_index = 0; player_index < data->xuids_count;
-           player_index++) {
-        const xe::be<uint64_t> xuid = xuids[player_index];
+      const std::string query = MakeReadStatsQuery(kernel_state_, data);
 
-        assert_true(IsValidXUID(xuid));
-
-        if (xuid) {
-          std::string xuid_str = string_util::to_hex_string(xuid);
-
-          Value value;
-          value.SetString(xuid_str.c_str(), 16, doc.GetAllocator());
-          xuidsJsonArray.PushBack(value, doc.GetAllocator());
-        }
-      }
-
-      if (xuidsJsonArray.Empty()) {
+      if (query.empty()) {
         return X_E_SUCCESS;
       }
 
-      doc.AddMember("players", xuidsJsonArray, doc.GetAllocator());
-
-      std::string title_id = fmt::format("{:08x}", kernel_state()->title_id());
-      doc.AddMember("titleId", title_id, doc.GetAllocator());
-
-      Value leaderboardQueryJsonArray(kArrayType);
-      auto queries =
-          memory_->TranslateVirtual<X_USER_STATS_SPEC*>(data->specs_ptr);
-
-      for (unsigned int queryIndex = 0; queryIndex < data->specs_count;
-           queryIndex++) {
-        Value queryObject(kObjectType);
-        queryObject.AddMember("id", queries[queryIndex].view_id,
-                              doc.GetAllocator());
-
-        assert_false(queries[queryIndex].num_column_ids >
-                     kXUserMaxStatsAttributes);
-
-        const uint32_t num_column_ids = std::min<uint32_t>(
-            queries[queryIndex].num_column_ids, kXUserMaxStatsAttributes);
-
-        Value statIdsArray(kArrayType);
-        for (uint32_t stat_id_index = 0; stat_id_index < num_column_ids;
-             stat_id_index++) {
-          statIdsArray.PushBack(queries[queryIndex].column_Ids[stat_id_index],
-                                doc.GetAllocator());
-        }
-        queryObject.AddMember("statisticIds", statIdsArray, doc.GetAllocator());
-        leaderboardQueryJsonArray.PushBack(queryObject, doc.GetAllocator());
-      }
-
-      doc.AddMember("queries", leaderboardQueryJsonArray, doc.GetAllocator());
-
-      rapidjson::StringBuffer buffer;
-      PrettyWriter<rapidjson::StringBuffer> writer(buffer);
-      doc.Accept(writer);
-
       std::unique_ptr<HTTPResponseObjectJSON> chunk =
-          XLiveAPI::LeaderboardsFind((uint8_t*)buffer.GetString());
-
-      if (chunk->RawResponse().response == nullptr ||
-          chunk->StatusCode() != HTTP_STATUS_CODE::HTTP_CREATED) {
-        // FM2 crashes with X_ERROR_FUNCTION_FAILED
-        return X_ERROR_SUCCESS;
-      }
-
-      Document leaderboards;
-      leaderboards.Parse(chunk->RawResponse().response);
-      const Value& leaderboardsArray = leaderboards.GetArray();
-
-      auto leaderboards_guest_address = memory_->SystemHeapAlloc(
-          sizeof(X_USER_STATS_VIEW) * leaderboardsArray.Size());
-      auto leaderboard = memory_->TranslateVirtual<X_USER_STATS_VIEW*>(
-          leaderboards_guest_address);
-      auto resultsHeader =
-          memory_->TranslateVirtual<X_USER_STATS_READ_RESULTS*>(
-              data->results_ptr);
-      resultsHeader->num_views = leaderboardsArray.Size();
-      resultsHeader->views_ptr = leaderboards_guest_address;
-
-      uint32_t leaderboardIndex = 0;
-      for (Value::ConstValueIterator leaderboardObjectPtr =
-               leaderboardsArray.Begin();
-           leaderboardObjectPtr != leaderboardsArray.End();
-           ++leaderboardObjectPtr) {
-        leaderboard[leaderboardIndex].ViewId =
-            (*leaderboardObjectPtr)["id"].GetUint();
-        auto playersArray = (*leaderboardObjectPtr)["players"].GetArray();
-        leaderboard[leaderboardIndex].NumRows = playersArray.Size();
-        leaderboard[leaderboardIndex].TotalViewRows = playersArray.Size();
-        auto players_guest_address = memory_->SystemHeapAlloc(
-            sizeof(X_USER_STATS_ROW) * playersArray.Size());
-        auto player =
-            memory_->TranslateVirtual<X_USER_STATS_ROW*>(players_guest_address);
-        leaderboard[leaderboardIndex].pRows = players_guest_address;
-
-        uint32_t playerIndex = 0;
-        for (Value::ConstValueIterator playerObjectPtr = playersArray.Begin();
-             playerObjectPtr != playersArray.End(); ++playerObjectPtr) {
-          auto gamertag = (*playerObjectPtr)["gamertag"].GetString();
-          auto gamertagLength =
-              (*playerObjectPtr)["gamertag"].GetStringLength();
-          memcpy(player[playerIndex].szGamertag, gamertag, gamertagLength);
-
-          std::vector<uint8_t> xuid;
-          string_util::hex_string_to_array(
-              xuid, (*playerObjectPtr)["xuid"].GetString());
-          memcpy(&player[playerIndex].xuid, xuid.data(), 8);
-
-          auto statisticsArray = (*playerObjectPtr)["stats"].GetArray();
-          player[playerIndex].NumColumns = statisticsArray.Size();
-          auto stats_guest_address = memory_->SystemHeapAlloc(
-              sizeof(X_USER_STATS_COLUMN) * statisticsArray.Size());
-          auto stat = memory_->TranslateVirtual<X_USER_STATS_COLUMN*>(
-              stats_guest_address);
-          player[playerIndex].pColumns = stats_guest_address;
-
-          uint32_t statIndex = 0;
-          for (Value::ConstValueIterator statObjectPtr =
-                   statisticsArray.Begin();
-               statObjectPtr != statisticsArray.End(); ++statObjectPtr) {
-            stat[statIndex].ColumnId = (*statObjectPtr)["id"].GetUint();
-
-            stat[statIndex].Value.type = static_cast<X_USER_DATA_TYPE>(
-                (*statObjectPtr)["type"].GetUint());
-
-            X_USER_DATA_TYPE stat_type = stat[statIndex].Value.type;
-
-            switch (stat_type) {
-              case X_USER_DATA_TYPE::CONTEXT: {
-                XELOGW("Statistic type: CONTEXT");
-              } break;
-              case X_USER_DATA_TYPE::INT32: {
-                XELOGW("Statistic type: INT32");
-              } break;
-              case X_USER_DATA_TYPE::INT64: {
-                XELOGW("Statistic type: INT64");
-              } break;
-              case X_USER_DATA_TYPE::DOUBLE: {
-                XELOGW("Statistic type: DOUBLE");
-              } break;
-              case X_USER_DATA_TYPE::FLOAT: {
-                XELOGW("Statistic type: FLOAT");
-              } break;
-              case X_USER_DATA_TYPE::DATETIME: {
-                XELOGW("Statistic type: DATETIME");
-              } break;
-              case X_USER_DATA_TYPE::UNSET: {
-                // Backend returns placeholder stats for display
-                XELOGW(
-                    "Row Index: {} - Placeholder stat missing stat ID in "
-                    "stats.json",
-                    playerIndex);
-              } break;
-              case X_USER_DATA_TYPE::WSTRING:
-              case X_USER_DATA_TYPE::BINARY:
-              default: {
-                XELOGW("Unsupported statistic type.",
-                       static_cast<uint32_t>(stat_type));
-              } break;
-            }
-
-            switch (stat_type) {
-              case X_USER_DATA_TYPE::CONTEXT:
-                stat[statIndex].Value.data.u32 =
-                    (*statObjectPtr)["value"].GetUint();
-                break;
-              case X_USER_DATA_TYPE::INT32:
-                stat[statIndex].Value.data.s32 =
-                    (*statObjectPtr)["value"].GetInt();
-                break;
-              case X_USER_DATA_TYPE::INT64:
-                stat[statIndex].Value.data.s64 =
-                    (*statObjectPtr)["value"].GetInt64();
-                break;
-              case X_USER_DATA_TYPE::UNSET: {
-                // Ignore don't read missing/placeholder stat
-              } break;
-              default:
-                XELOGW("Unimplemented stat type for read, will attempt anyway.",
-                       static_cast<uint32_t>(stat[statIndex].Value.type));
-                if ((*statObjectPtr)["value"].IsNumber()) {
-                  stat[statIndex].Value.data.s64 =
-                      (*statObjectPtr)["value"].GetUint64();
-                }
-            }
-
-            player[playerIndex].Rank = 1;
+          XLiveAPI::LeaderboardsFind((uint8_t*)query.c_str());
 
-            if ((*statObjectPtr)["value"].IsNumber()) {
-              // 41560901 uses i64Rating for ranking friends scores
-              player[playerIndex].i64Rating =
-                  (*statObjectPtr)["value"].GetUint64();
-            }
-
-            statIndex++;
-          }
-
-          playerIndex++;
-        }
-
-        leaderboardIndex++;
-      }
-#pragma endregion
-      return X_E_SUCCESS;
+      return ReadStatsResults(memory_, data, chunk.get());
     }
     case 0x000B001A: {
       assert_true(!buffer_length ||
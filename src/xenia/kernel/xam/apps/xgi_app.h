@@ -24,6 +24,18 @@ class XgiApp : public App {
 
   X_HRESULT DispatchMessageSync(uint32_t message, uint32_t buffer_ptr,
                                 uint32_t buffer_length) override;
+
+  bool DispatchMessageOverlapped(uint32_t message, uint32_t buffer_ptr,
+                                 uint32_t buffer_length,
+                                 uint32_t overlapped_ptr,
+                                 std::function<void()> post_callback) override;
+
+ private:
+  // Completes an overlapped message with the result of fill, run on the
+  // dispatch thread.
+  void QueueOverlappedCompletion(uint32_t overlapped_ptr,
+                                 std::function<X_RESULT()> fill,
+                                 std::function<void()> post_callback);
 };
 
 }  // namespace apps
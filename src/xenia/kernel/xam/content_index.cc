@@ -0,0 +1,245 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/kernel/xam/content_index.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "xenia/base/filesystem.h"
+#include "xenia/base/logging.h"
+#include "xenia/base/string.h"
+#include "xenia/base/string_util.h"
+
+namespace xe {
+namespace kernel {
+namespace xam {
+
+namespace {
+
+constexpr uint32_t kIndexMagic = 0x58434958;  // 'XCIX'
+constexpr uint32_t kIndexVersion = 1;
+
+// Modification time of a missing directory - it's cached as having no
+// packages until it's created.
+constexpr int64_t kMissingTime = INT64_MIN;
+
+// Directories modified more recently than this aren't cached. Timestamps can
+// be as coarse as 2 seconds (FAT), and a directory changed again within its
+// current timestamp granularity wouldn't get a new modification time.
+constexpr auto kRacyTimeWindow = std::chrono::seconds(3);
+
+int64_t GetModificationTime(const std::filesystem::path& path) {
+  std::error_code ec;
+  auto time = std::filesystem::last_write_time(path, ec);
+  if (ec) {
+    return kMissingTime;
+  }
+  return int64_t(time.time_since_epoch().count());
+}
+
+bool IsRacyTime(int64_t time) {
+  if (time == kMissingTime) {
+    return false;
+  }
+  auto threshold = std::filesystem::file_time_type::clock::now() -
+                   std::chrono::duration_cast<
+                       std::filesystem::file_time_type::duration>(
+                       kRacyTimeWindow);
+  return time >= int64_t(threshold.time_since_epoch().count());
+}
+
+template <typename T>
+bool Write(FILE* file, const T& value) {
+  return fwrite(&value, sizeof(T), 1, file) == 1;
+}
+
+bool WriteString(FILE* file, const std::string& value) {
+  return Write(file, uint32_t(value.size())) &&
+         fwrite(value.data(), 1, value.size(), file) == value.size();
+}
+
+template <typename T>
+bool Read(FILE* file, T& value) {
+  return fread(&value, sizeof(T), 1, file) == 1;
+}
+
+bool ReadString(FILE* file, std::string& value) {
+  uint32_t size;
+  // Names and paths are far shorter than this, anything else is corrupt.
+  if (!Read(file, size) || size > 0x10000) {
+    return false;
+  }
+  value.resize(size);
+  return fread(value.data(), 1, size, file) == size;
+}
+
+}  // namespace
+
+ContentIndex::ContentIndex(const std::filesystem::path& index_path)
+    : index_path_(index_path) {}
+
+std::vector<ContentIndex::Package> ContentIndex::List(
+    const std::filesystem::path& package_root,
+    const std::filesystem::path& header_root) {
+  // Times taken before listing, so changes made during the scan make the
+  // stored entry stale instead of being missed.
+  int64_t package_root_time = GetModificationTime(package_root);
+  int64_t header_root_time = GetModificationTime(header_root);
+  std::string key = xe::path_to_utf8(package_root);
+
+  {
+    std::lock_guard<xe_mutex> lock(mutex_);
+    auto it = directories_.find(key);
+    if (it != directories_.end() &&
+        it->second.package_root_time == package_root_time &&
+        it->second.header_root_time == header_root_time) {
+      return it->second.packages;
+    }
+  }
+
+  std::vector<Package> packages = Scan(package_root, header_root);
+
+  std::lock_guard<xe_mutex> lock(mutex_);
+  if (IsRacyTime(package_root_time) || IsRacyTime(header_root_time)) {
+    if (directories_.erase(key)) {
+      dirty_ = true;
+    }
+  } else {
+    directories_[key] = {package_root_time, header_root_time, packages};
+    dirty_ = true;
+  }
+  return packages;
+}
+
+size_t ContentIndex::size() const {
+  std::lock_guard<xe_mutex> lock(mutex_);
+  return directories_.size();
+}
+
+bool ContentIndex::ReadHeaderFile(const std::filesystem::path& path,
+                                  XCONTENT_AGGREGATE_DATA& data) {
+  FILE* file = xe::filesystem::OpenFile(path, "rb");
+  if (!file) {
+    return false;
+  }
+  size_t result = fread(&data, sizeof(XCONTENT_AGGREGATE_DATA), 1, file);
+  fclose(file);
+  return result == 1;
+}
+
+std::vector<ContentIndex::Package> ContentIndex::Scan(
+    const std::filesystem::path& package_root,
+    const std::filesystem::path& header_root) {
+  std::vector<Package> packages;
+  for (const auto& file_info : xe::filesystem::ListDirectories(package_root)) {
+    Package package;
+    package.name = xe::path_to_utf8(file_info.name);
+    auto header_name = xe::string_util::trim(package.name) + ".header";
+    package.has_header =
+        ReadHeaderFile(header_root / xe::to_path(header_name), package.data);
+    packages.push_back(std::move(package));
+  }
+  return packages;
+}
+
+bool ContentIndex::Load() {
+  FILE* file = xe::filesystem::OpenFile(index_path_, "rb");
+  if (!file) {
+    return false;
+  }
+
+  std::unordered_map<std::string, Directory> directories;
+  uint32_t magic, version, directory_count;
+  bool valid = Read(file, magic) && magic == kIndexMagic &&
+               Read(file, version) && version == kIndexVersion &&
+               Read(file, directory_count);
+  for (uint32_t i = 0; valid && i < directory_count; ++i) {
+    std::string key;
+    Directory directory;
+    uint32_t package_count;
+    valid = ReadString(file, key) && Read(file, directory.package_root_time) &&
+            Read(file, directory.header_root_time) &&
+            Read(file, package_count);
+    for (uint32_t j = 0; valid && j < package_count; ++j) {
+      Package package;
+      uint8_t has_header;
+      valid = ReadString(file, package.name) && Read(file, has_header) &&
+              Read(file, package.data);
+      package.has_header = has_header != 0;
+      directory.packages.push_back(std::move(package));
+    }
+    directories[std::move(key)] = std::move(directory);
+  }
+  fclose(file);
+
+  if (!valid) {
+    XELOGW("Ignoring invalid content index {}", xe::path_to_utf8(index_path_));
+    return false;
+  }
+
+  std::lock_guard<xe_mutex> lock(mutex_);
+  directories_ = std::move(directories);
+  dirty_ = false;
+  return true;
+}
+
+bool ContentIndex::Save() {
+  std::unordered_map<std::string, Directory> directories;
+  {
+    std::lock_guard<xe_mutex> lock(mutex_);
+    if (!dirty_) {
+      return true;
+    }
+    directories = directories_;
+    dirty_ = false;
+  }
+
+  // Written next to the index and renamed over it, so an interrupted save
+  // leaves the previous index.
+  auto temp_path = index_path_;
+  temp_path += ".tmp";
+  std::error_code ec;
+  std::filesystem::create_directories(index_path_.parent_path(), ec);
+  FILE* file = xe::filesystem::OpenFile(temp_path, "wb");
+  if (!file) {
+    XELOGW("Unable to write content index {}", xe::path_to_utf8(temp_path));
+    return false;
+  }
+
+  bool written = Write(file, kIndexMagic) && Write(file, kIndexVersion) &&
+                 Write(file, uint32_t(directories.size()));
+  for (const auto& [key, directory] : directories) {
+    written = written && WriteString(file, key) &&
+              Write(file, directory.package_root_time) &&
+              Write(file, directory.header_root_time) &&
+              Write(file, uint32_t(directory.packages.size()));
+    for (const Package& package : directory.packages) {
+      written = written && WriteString(file, package.name) &&
+                Write(file, uint8_t(package.has_header)) &&
+                Write(file, package.data);
+    }
+  }
+  written = fclose(file) == 0 && written;
+
+  if (written) {
+    std::filesystem::rename(temp_path, index_path_, ec);
+  }
+  if (!written || ec) {
+    XELOGW("Unable to write content index {}", xe::path_to_utf8(index_path_));
+    std::filesystem::remove(temp_path, ec);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace xam
+}  // namespace kernel
+}  // namespace xe
@@ -0,0 +1,92 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Canary. All rights reserved.                          *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#ifndef XENIA_KERNEL_XAM_CONTENT_INDEX_H_
+#define XENIA_KERNEL_XAM_CONTENT_INDEX_H_
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "xenia/base/mutex.h"
+#include "xenia/kernel/xam/content_manager.h"
+
+namespace xe {
+namespace kernel {
+namespace xam {
+
+// Packages of the content directories of a profile, title and content type,
+// with their parsed headers, so enumerating content doesn't list the
+// directory and read the header of every package again each time.
+//
+// A directory is rescanned when the modification time of it or of its header
+// directory changes, which happens when packages or headers are added,
+// removed or renamed - headers rewritten in place need the modification time
+// of their directory to be updated. Directories modified within the last few
+// seconds aren't cached, as on file systems with coarse timestamps a later
+// change could keep the same modification time.
+//
+// Filesystem work is done without holding the index lock, so concurrent
+// enumerations of different directories don't wait for each other.
+class ContentIndex {
+ public:
+  struct Package {
+    // Name of the package directory.
+    std::string name;
+    // Whether the data was read from the header file - otherwise only the
+    // name and the content type are known.
+    bool has_header;
+    XCONTENT_AGGREGATE_DATA data;
+  };
+
+  // The index is persisted in index_path by Save.
+  explicit ContentIndex(const std::filesystem::path& index_path);
+
+  // Returns the packages in package_root, with headers named
+  // "<package>.header" in header_root.
+  std::vector<Package> List(const std::filesystem::path& package_root,
+                            const std::filesystem::path& header_root);
+
+  // Loads the index written by Save, replacing the current contents.
+  bool Load();
+  // Writes the index if it has changed since it was loaded.
+  bool Save();
+
+  // Number of cached directories.
+  size_t size() const;
+
+  // Reads the XCONTENT_AGGREGATE_DATA at the beginning of a header file.
+  static bool ReadHeaderFile(const std::filesystem::path& path,
+                             XCONTENT_AGGREGATE_DATA& data);
+
+ private:
+  struct Directory {
+    int64_t package_root_time;
+    int64_t header_root_time;
+    std::vector<Package> packages;
+  };
+
+  static std::vector<Package> Scan(const std::filesystem::path& package_root,
+                                   const std::filesystem::path& header_root);
+
+  std::filesystem::path index_path_;
+
+  mutable xe_mutex mutex_;
+  // By the UTF-8 package root path.
+  std::unordered_map<std::string, Directory> directories_;
+  bool dirty_ = false;
+};
+
+}  // namespace xam
+}  // namespace kernel
+}  // namespace xe
+
+#endif  // XENIA_KERNEL_XAM_CONTENT_INDEX_H_
@@ -19,6 +19,7 @@
 #include "xenia/base/string.h"
 #include "xenia/emulator.h"
 #include "xenia/kernel/kernel_state.h"
+#include "xenia/kernel/xam/content_index.h"
 #include "xenia/kernel/xam/user_profile.h"
 #include "xenia/kernel/xfile.h"
 #include "xenia/kernel/xobject.h"
@@ -33,6 +34,7 @@ namespace xam {
 static const char* kThumbnailFileName = "__thumbnail.png";
 static const char* kGameContentHeaderDirName = "Headers";
 static const char* kSpaFilename = "spa.bin";
+static const char* kContentIndexFileName = "content_index.bin";
 
 static int content_device_id_ = 0;
 
@@ -60,29 +62,33 @@ ContentPackage::~ContentPackage() {
   fs->UnregisterDevice(device_path_);
 }
 
-void ContentPackage::LoadPackageLicenseMask(
-    const std::filesystem::path header_path) {
-  if (!std::filesystem::exists(header_path)) {
-    return;
-  }
-
+bool ContentPackage::ReadPackageLicenseMask(
+    const std::filesystem::path& header_path, uint32_t& license) {
   auto file = xe::filesystem::OpenFile(header_path, "rb");
-  auto file_size = std::filesystem::file_size(header_path);
-  if (file_size < sizeof(XCONTENT_AGGREGATE_DATA) + sizeof(license_)) {
-    fclose(file);
-    return;
+  if (!file) {
+    return false;
   }
 
-  fseek(file, sizeof(XCONTENT_AGGREGATE_DATA), SEEK_SET);
-  size_t result = fread(&license_, 1, sizeof(license_), file);
+  uint32_t value;
+  bool result = fseek(file, sizeof(XCONTENT_AGGREGATE_DATA), SEEK_SET) == 0 &&
+                fread(&value, sizeof(value), 1, file) == 1;
   fclose(file);
+  if (result) {
+    license = value;
+  }
+  return result;
 }
 
 ContentManager::ContentManager(KernelState* kernel_state,
                                const std::filesystem::path& root_path)
-    : kernel_state_(kernel_state), root_path_(root_path) {}
+    : kernel_state_(kernel_state),
+      root_path_(root_path),
+      content_index_(
+          std::make_unique<ContentIndex>(root_path / kContentIndexFileName)) {
+  content_index_->Load();
+}
 
-ContentManager::~ContentManager() = default;
+ContentManager::~ContentManager() { content_index_->Save(); }
 
 std::filesystem::path ContentManager::ResolvePackageRoot(
     uint64_t xuid, uint32_t title_id, XContentType content_type) const {
@@ -144,9 +150,8 @@ std::filesystem::path ContentManager::ResolvePackagePath(
   return get_package_path(data.title_id);
 }
 
-std::filesystem::path ContentManager::ResolvePackageHeaderPath(
-    const std::string_view file_name, uint64_t xuid, uint32_t title_id,
-    const XContentType content_type) const {
+std::filesystem::path ContentManager::ResolvePackageHeaderRoot(
+    uint64_t xuid, uint32_t title_id, const XContentType content_type) const {
   if (title_id == kCurrentlyRunningTitleId) {
     title_id = kernel_state_->title_id();
   }
@@ -158,13 +163,19 @@ std::filesystem::path ContentManager::ResolvePackageHeaderPath(
   auto xuid_str = fmt::format("{:016X}", xuid);
   auto title_id_str = fmt::format("{:08X}", title_id);
   auto content_type_str = fmt::format("{:08X}", uint32_t(content_type));
-  std::string final_name =
-      xe::string_util::trim(std::string(file_name)) + ".header";
 
   // Header root path:
   // content_root/xuid/title_id/Headers/content_type/
   return root_path_ / xuid_str / title_id_str / kGameContentHeaderDirName /
-         content_type_str / final_name;
+         content_type_str;
+}
+
+std::filesystem::path ContentManager::ResolvePackageHeaderPath(
+    const std::string_view file_name, uint64_t xuid, uint32_t title_id,
+    const XContentType content_type) const {
+  std::string final_name =
+      xe::string_util::trim(std::string(file_name)) + ".header";
+  return ResolvePackageHeaderRoot(xuid, title_id, content_type) / final_name;
 }
 
 std::unordered_set<uint32_t> ContentManager::FindPublisherTitleIds(
@@ -216,25 +227,19 @@ std::vector<XCONTENT_AGGREGATE_DATA> ContentManager::ListContent(
   for (const uint32_t& title_id : title_ids) {
     // Search path:
     // content_root/xuid/title_id/type_name/*
-    auto package_root = ResolvePackageRoot(xuid, title_id, content_type);
-    auto file_infos = xe::filesystem::ListFiles(package_root);
-
-    for (const auto& file_info : file_infos) {
-      if (file_info.type != xe::filesystem::FileInfo::Type::kDirectory) {
-        // Directories only.
-        continue;
-      }
+    auto packages = content_index_->List(
+        ResolvePackageRoot(xuid, title_id, content_type),
+        ResolvePackageHeaderRoot(xuid, title_id, content_type));
 
-      XCONTENT_AGGREGATE_DATA content_data;
-      if (XSUCCEEDED(ReadContentHeaderFile(xe::path_to_utf8(file_info.name),
-                                           xuid, title_id, content_type,
-                                           content_data))) {
-        result.emplace_back(std::move(content_data));
+    for (const auto& package : packages) {
+      if (package.has_header) {
+        result.push_back(package.data);
       } else {
+        XCONTENT_AGGREGATE_DATA content_data;
         content_data.device_id = device_id;
         content_data.content_type = content_type;
-        content_data.set_display_name(xe::path_to_utf16(file_info.name));
-        content_data.set_file_name(xe::path_to_utf8(file_info.name));
+        content_data.set_display_name(xe::to_utf16(package.name));
+        content_data.set_file_name(package.name);
         content_data.title_id = title_id;
         content_data.xuid = xuid;
         result.emplace_back(std::move(content_data));
@@ -280,21 +285,6 @@ std::vector<XCONTENT_AGGREGATE_DATA> ContentManager::ListContentODD(
   return result;
 }
 
-std::unique_ptr<ContentPackage> ContentManager::ResolvePackage(
-    const std::string_view root_name, const uint64_t xuid,
-    const XCONTENT_AGGREGATE_DATA& data, const uint32_t disc_number) {
-  auto package_path = ResolvePackagePath(xuid, data, disc_number);
-  if (!std::filesystem::exists(package_path)) {
-    return nullptr;
-  }
-
-  auto global_lock = global_critical_region_.Acquire();
-
-  auto package = std::make_unique<ContentPackage>(kernel_state_, root_name,
-                                                  data, package_path);
-  return package;
-}
-
 bool ContentManager::ContentExists(const uint64_t xuid,
                                    const XCONTENT_AGGREGATE_DATA& data) {
   auto path = ResolvePackagePath(xuid, data);
@@ -328,6 +318,12 @@ X_RESULT ContentManager::WriteContentHeaderFile(const uint64_t xuid,
     auto file = xe::filesystem::OpenFile(header_path, "wb");
     fwrite(&data, 1, sizeof(XCONTENT_AGGREGATE_DATA), file);
     fclose(file);
+
+    // Replacing the contents of an existing header doesn't change the
+    // directory, which is how the content index notices changed headers.
+    std::error_code ec;
+    std::filesystem::last_write_time(
+        parent_path, std::filesystem::file_time_type::clock::now(), ec);
     return X_STATUS_SUCCESS;
   }
   return X_STATUS_NO_SUCH_FILE;
@@ -368,13 +364,16 @@ X_RESULT ContentManager::ReadContentHeaderFile(
 X_RESULT ContentManager::CreateContent(const std::string_view root_name,
                                        const uint64_t xuid,
                                        const XCONTENT_AGGREGATE_DATA& data) {
-  auto global_lock = global_critical_region_.Acquire();
-
-  if (open_packages_.count(string_key(root_name))) {
-    // Already content open with this root name.
-    return X_ERROR_ALREADY_EXISTS;
+  {
+    auto global_lock = global_critical_region_.Acquire();
+    if (open_packages_.count(string_key(root_name))) {
+      // Already content open with this root name.
+      return X_ERROR_ALREADY_EXISTS;
+    }
   }
 
+  // The host filesystem is accessed without the lock, only registering the
+  // package needs it.
   auto package_path = ResolvePackagePath(xuid, data);
   if (std::filesystem::exists(package_path)) {
     // Exists, must not!
@@ -385,9 +384,19 @@ X_RESULT ContentManager::CreateContent(const std::string_view root_name,
     return X_ERROR_ACCESS_DENIED;
   }
 
-  auto package = ResolvePackage(root_name, xuid, data);
-  assert_not_null(package);
+  auto global_lock = global_critical_region_.Acquire();
 
+  if (open_packages_.count(string_key(root_name))) {
+    // Opened with this root name in the meantime - don't leave the new package
+    // behind. Only removed while still empty, in case it has been opened by
+    // its path since.
+    std::error_code ec;
+    std::filesystem::remove(package_path, ec);
+    return X_ERROR_ALREADY_EXISTS;
+  }
+
+  auto package = std::make_unique<ContentPackage>(kernel_state_, root_name,
+                                                  data, package_path);
   open_packages_.insert({string_key::create(root_name), package.release()});
 
   return X_ERROR_SUCCESS;
@@ -398,25 +407,39 @@ X_RESULT ContentManager::OpenContent(const std::string_view root_name,
                                      const XCONTENT_AGGREGATE_DATA& data,
                                      uint32_t& content_license,
                                      const uint32_t disc_number) {
-  auto global_lock = global_critical_region_.Acquire();
-
-  if (open_packages_.count(string_key(root_name))) {
-    // Already content open with this root name.
-    return X_ERROR_ALREADY_EXISTS;
+  {
+    auto global_lock = global_critical_region_.Acquire();
+    if (open_packages_.count(string_key(root_name))) {
+      // Already content open with this root name.
+      return X_ERROR_ALREADY_EXISTS;
+    }
   }
 
+  // The host filesystem is accessed without the lock, only registering the
+  // package needs it.
   auto package_path = ResolvePackagePath(xuid, data, disc_number);
   if (!std::filesystem::exists(package_path)) {
     // Does not exist, must be created.
     return X_ERROR_FILE_NOT_FOUND;
   }
 
-  // Open package.
-  auto package = ResolvePackage(root_name, xuid, data, disc_number);
-  assert_not_null(package);
+  uint32_t license = cvars::license_mask;
+  ContentPackage::ReadPackageLicenseMask(
+      ResolvePackageHeaderPath(data.file_name(), xuid,
+                               kernel_state_->title_id(), data.content_type),
+      license);
+
+  auto global_lock = global_critical_region_.Acquire();
 
-  package->LoadPackageLicenseMask(ResolvePackageHeaderPath(
-      data.file_name(), xuid, kernel_state_->title_id(), data.content_type));
+  if (open_packages_.count(string_key(root_name))) {
+    // Opened with this root name in the meantime.
+    return X_ERROR_ALREADY_EXISTS;
+  }
+
+  // Open package.
+  auto package = std::make_unique<ContentPackage>(kernel_state_, root_name,
+                                                  data, package_path);
+  package->SetPackageLicense(license);
 
   content_license = package->GetPackageLicense();
 
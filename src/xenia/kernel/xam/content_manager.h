@@ -32,6 +32,8 @@ namespace xe {
 namespace kernel {
 namespace xam {
 
+class ContentIndex;
+
 // If set in XCONTENT_AGGREGATE_DATA, will be substituted with the running
 // titles ID
 // TODO: check if actual x360 kernel/xam has a value similar to this
@@ -125,13 +127,17 @@ class ContentPackage {
                  const std::filesystem::path& package_path);
   ~ContentPackage();
 
-  void LoadPackageLicenseMask(const std::filesystem::path header_path);
+  // Reads the license mask stored after the header data, leaving license
+  // unchanged if there is none.
+  static bool ReadPackageLicenseMask(const std::filesystem::path& header_path,
+                                     uint32_t& license);
 
   const XCONTENT_AGGREGATE_DATA& GetPackageContentData() const {
     return content_data_;
   }
 
   const uint32_t GetPackageLicense() const { return license_; }
+  void SetPackageLicense(uint32_t license) { license_ = license; }
 
  private:
   KernelState* kernel_state_;
@@ -155,10 +161,6 @@ class ContentManager {
       const uint32_t device_id, const uint64_t xuid, const uint32_t title_id,
       const XContentType content_type) const;
 
-  std::unique_ptr<ContentPackage> ResolvePackage(
-      const std::string_view root_name, const uint64_t xuid,
-      const XCONTENT_AGGREGATE_DATA& data, const uint32_t disc_number = -1);
-
   bool ContentExists(const uint64_t xuid, const XCONTENT_AGGREGATE_DATA& data);
   X_RESULT WriteContentHeaderFile(const uint64_t xuid,
                                   XCONTENT_AGGREGATE_DATA data);
@@ -195,6 +197,8 @@ class ContentManager {
   std::filesystem::path ResolvePackagePath(const uint64_t xuid,
                                            const XCONTENT_AGGREGATE_DATA& data,
                                            const uint32_t disc_number = -1);
+  std::filesystem::path ResolvePackageHeaderRoot(
+      uint64_t xuid, uint32_t title_id, const XContentType content_type) const;
   std::filesystem::path ResolvePackageHeaderPath(
       const std::string_view file_name, uint64_t xuid, uint32_t title_id,
       const XContentType content_type) const;
@@ -205,6 +209,7 @@ class ContentManager {
 
   KernelState* kernel_state_;
   std::filesystem::path root_path_;
+  std::unique_ptr<ContentIndex> content_index_;
 
   // TODO(benvanik): remove use of global lock, it's bad here!
   xe::global_critical_region global_critical_region_;
@@ -536,10 +536,7 @@ bool UserProfile::UpdatePresence() {
           kernel_state()->emulator()->title_name(), updated_presence);
     }
 
-    auto run = [] { XLiveAPI::SetPresence(); };
-
-    std::thread update_presence(run);
-    update_presence.detach();
+    XLiveAPI::SetPresence();
   }
 
   return updated;
@@ -460,13 +460,8 @@ dword_result_t NetDll_WSASendTo_entry(
     dword_t num_buffers, lpdword_t num_bytes_sent, dword_t flags,
     pointer_t<XSOCKADDR_IN> to_ptr, dword_t to_len,
     pointer_t<XWSAOVERLAPPED> overlapped, lpvoid_t completion_routine) {
-  assert(!overlapped);
   assert(!completion_routine);
 
-  if (overlapped) {
-    XELOGW("NetDll_WSASendTo: overlapped!");
-  }
-
   auto socket =
       kernel_state()->object_table()->LookupObject<XSocket>(socket_handle);
   if (!socket) {
@@ -490,8 +485,8 @@ dword_result_t NetDll_WSASendTo_entry(
     combined_buffer_offset += buffers[i].len;
   }
 
-  const int result = socket->SendTo(
-      combined_buffer_mem.data(), combined_buffer_size, flags, to_ptr, to_len);
+  const int result = socket->WSASendTo(std::move(combined_buffer_mem), flags,
+                                      to_ptr, to_len, overlapped);
 
   if (result == -1) {
     XThread::SetLastError(socket->GetLastWSAError());
@@ -504,10 +499,9 @@ dword_result_t NetDll_WSASendTo_entry(
            to_ptr->address_ip.S_un.S_un_b.s_b4);
   }
 
-  if (num_bytes_sent && !overlapped) {
+  if (num_bytes_sent) {
     *num_bytes_sent = result;
   }
-  // TODO: Instantly complete overlapped
 
   return 0;
 }
@@ -1226,9 +1220,15 @@ dword_result_t NetDll_XNetQosLookup_entry(
 
   const uint32_t probes = qos->count - countOffset;
 
+  std::vector<uint64_t> probe_session_ids(probes);
+  for (uint32_t i = 0; i < probes; i++) {
+    probe_session_ids[i] = session_ids[i].as_uintBE64();
+  }
+  const std::vector<response_data> chunks =
+      XLiveAPI::QoSGet(probe_session_ids);
+
   for (uint32_t i = 0; i < probes; i++) {
-    uint64_t session_id = session_ids[i].as_uintBE64();
-    response_data chunk = XLiveAPI::QoSGet(session_id);
+    const response_data& chunk = chunks[i];
 
     if (chunk.http_code == HTTP_STATUS_CODE::HTTP_OK ||
         chunk.http_code == HTTP_STATUS_CODE::HTTP_NO_CONTENT) {
@@ -1903,8 +1903,7 @@ dword_result_t NetDll_WSAEventSelect_entry(dword_t caller,
     return -1;
   }
 
-  int ret = socket->WSAEventSelect(socket->native_handle(), ev->native_handle(),
-                                   flags);
+  int ret = socket->WSAEventSelect(ev, flags);
 
   if (ret < 0) {
     XThread::SetLastError(socket->GetLastWSAError());
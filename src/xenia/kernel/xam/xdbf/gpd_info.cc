@@ -11,6 +11,7 @@
 #include "xenia/kernel/util/shim_utils.h"
 #include "xenia/kernel/xam/user_settings.h"
 
+#include <algorithm>
 #include <map>
 #include <ranges>
 
@@ -46,9 +47,8 @@ std::span<const uint8_t> GpdInfo::GetImage(uint64_t id) const {
 }
 
 void GpdInfo::AddImage(uint32_t id, std::span<const uint8_t> image_data) {
-  Entry* entry = GetEntry(static_cast<uint16_t>(GpdSection::kImage), id);
-
-  if (entry || !image_data.size()) {
+  if (HasEntry(static_cast<uint16_t>(GpdSection::kImage), id) ||
+      !image_data.size()) {
     return;
   }
 
@@ -110,9 +110,7 @@ std::u16string GpdInfo::GetString(uint32_t id) const {
 }
 
 void GpdInfo::AddString(uint32_t id, std::u16string string_data) {
-  Entry* entry = GetEntry(static_cast<uint16_t>(GpdSection::kString), id);
-
-  if (entry != nullptr) {
+  if (HasEntry(static_cast<uint16_t>(GpdSection::kString), id)) {
     return;
   }
 
@@ -129,17 +127,32 @@ void GpdInfo::AddString(uint32_t id, std::u16string string_data) {
 }
 
 std::vector<uint8_t> GpdInfo::Serialize() const {
-  // Resize to proper size.
-  const uint32_t entries_table_size = sizeof(XdbfEntry) * header_.entry_count;
-  const uint32_t free_table_size = sizeof(XdbfFileLoc) * header_.free_count;
-
-  const uint32_t gpd_size = sizeof(XdbfHeader) + entries_table_size +
-                            free_table_size + CalculateEntriesSize();
-
-  std::vector<uint8_t> data(gpd_size);
+  const uint32_t data_start = CalculateDataStartOffset();
+  const uint32_t gpd_size = data_start + CalculateEntriesSize();
+
+  // Growing the tables moves all the data, otherwise the previous file is
+  // patched.
+  const bool rebuild = serialized_.empty() ||
+                       serialized_entry_count_ != header_.entry_count ||
+                       serialized_free_count_ != header_.free_count;
+  if (rebuild) {
+    serialized_.assign(gpd_size, 0);
+  } else {
+    serialized_.resize(gpd_size, 0);
+    for (const XdbfFileLoc& loc : freed_locations_) {
+      const uint32_t offset = data_start + loc.offset;
+      if (offset < gpd_size) {
+        std::fill_n(serialized_.begin() + offset,
+                    std::min<uint32_t>(loc.size, gpd_size - offset), 0);
+      }
+    }
+  }
+  freed_locations_.clear();
+  serialized_entry_count_ = header_.entry_count;
+  serialized_free_count_ = header_.free_count;
 
   // Header part
-  uint8_t* write_ptr = data.data();
+  uint8_t* write_ptr = serialized_.data();
   // Write header
   memcpy(write_ptr, &header_, sizeof(XdbfHeader));
   write_ptr += sizeof(XdbfHeader);
@@ -170,6 +183,10 @@ std::vector<uint8_t> GpdInfo::Serialize() const {
 
   // Entries data
   for (const auto& entry : entries) {
+    if (!rebuild && !entry->dirty) {
+      continue;
+    }
+    entry->dirty = false;
     if (!entry->info.size) {
       continue;
     }
@@ -177,7 +194,7 @@ std::vector<uint8_t> GpdInfo::Serialize() const {
     memcpy(write_ptr + entry->info.offset, entry->data.data(),
            entry->data.size());
   }
-  return data;
+  return serialized_;
 }
 
 bool GpdInfo::IsSyncEntry(const Entry* const entry) {
@@ -233,8 +250,13 @@ void GpdInfo::InsertEntry(Entry* entry) {
 
   entry->info.offset = FindFreeLocation(entry->info.size);
 
-  entries_.push_back(*entry);
+  AddEntry(*entry);
 
+  if (replaced_key_ !=
+      std::make_pair(entry->info.section.get(), entry->info.id.get())) {
+    sorted_keys_valid_ = false;
+  }
+  replaced_key_.reset();
   header_.entry_used++;
 }
 
@@ -242,20 +264,25 @@ void GpdInfo::DeleteEntry(const Entry* entry) {
   // Don't really remove entry. Just remove entry in the entry table.
   MarkSpaceAsFree(entry->info.offset, entry->info.size);
 
-  auto itr =
-      std::find_if(entries_.begin(), entries_.end(), [entry](Entry first) {
-        return entry->info.section == first.info.section &&
-               first.info.id == entry->info.id;
-      });
-
-  if (itr != entries_.end()) {
-    entries_.erase(itr);
+  if (replaced_key_) {
+    sorted_keys_valid_ = false;
   }
+  replaced_key_ =
+      std::make_pair(entry->info.section.get(), entry->info.id.get());
+  RemoveEntry(entry->info.section, entry->info.id);
   header_.entry_used--;
 }
 
 std::vector<const Entry*> GpdInfo::GetSortedEntries() const {
   std::vector<const Entry*> sorted_entries;
+  sorted_entries.reserve(entries_.size());
+
+  if (sorted_keys_valid_ && !replaced_key_) {
+    for (const auto& key : sorted_keys_) {
+      sorted_entries.push_back(GetEntry(key.first, key.second));
+    }
+    return sorted_entries;
+  }
 
   for (auto& entry : entries_) {
     sorted_entries.push_back(&entry);
@@ -269,6 +296,12 @@ std::vector<const Entry*> GpdInfo::GetSortedEntries() const {
               return first->info.section < second->info.section;
             });
 
+  sorted_keys_.clear();
+  sorted_keys_.reserve(sorted_entries.size());
+  for (const Entry* entry : sorted_entries) {
+    sorted_keys_.emplace_back(entry->info.section, entry->info.id);
+  }
+  sorted_keys_valid_ = true;
   return sorted_entries;
 }
 
@@ -302,6 +335,9 @@ void GpdInfo::MarkSpaceAsFree(uint32_t offset, uint32_t size) {
   ResizeEntryTable();
   free_entries_.emplace(free_entries_.begin(), loc);
   header_.free_used++;
+  if (!serialized_.empty()) {
+    freed_locations_.push_back(loc);
+  }
 }
 
 }  // namespace xam
@@ -10,8 +10,10 @@
 #ifndef XENIA_KERNEL_XAM_XDBF_GPD_INFO_H_
 #define XENIA_KERNEL_XAM_XDBF_GPD_INFO_H_
 
+#include <optional>
 #include <span>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "xenia/base/byte_order.h"
@@ -127,6 +129,8 @@ class GpdInfo : public XdbfFile {
   std::u16string GetString(uint32_t id) const;
   void AddString(uint32_t id, std::u16string string_data);
 
+  // Only the entries modified since the previous call, and the tables, are
+  // written unless the size of the tables changed.
   std::vector<uint8_t> Serialize() const;
 
  protected:
@@ -151,6 +155,22 @@ class GpdInfo : public XdbfFile {
   void ResizeEntryTable();
   void ReallocateEntry(Entry* entry, uint32_t required_size);
   void MarkSpaceAsFree(uint32_t offset, uint32_t size);
+
+  // The file as of the last serialization, and what it needs to be patched
+  // with.
+  mutable std::vector<uint8_t> serialized_;
+  mutable uint32_t serialized_entry_count_ = 0;
+  mutable uint32_t serialized_free_count_ = 0;
+  // Data of removed entries, cleared so the space is zeroed like in a file
+  // written from scratch.
+  mutable std::vector<XdbfFileLoc> freed_locations_;
+
+  // Sections and IDs of the entries in the order of the table, kept while
+  // entries are only replaced rather than added or removed.
+  mutable std::vector<std::pair<uint16_t, uint64_t>> sorted_keys_;
+  mutable bool sorted_keys_valid_ = false;
+  // Removed entry that's expected to be inserted back by an upsert.
+  std::optional<std::pair<uint16_t, uint64_t>> replaced_key_;
 };
 
 }  // namespace xam
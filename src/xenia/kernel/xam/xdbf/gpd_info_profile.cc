@@ -36,21 +36,13 @@ GpdInfoProfile::GetTitlesInfo() const {
 };
 
 X_XDBF_GPD_TITLE_PLAYED* GpdInfoProfile::GetTitleInfo(const uint32_t title_id) {
-  auto title = entries_ | std::views::filter([](const auto& entry) {
-                 return !IsSyncEntry(&entry);
-               }) |
-               std::views::filter([](const auto& entry) {
-                 return IsEntryOfSection(&entry, GpdSection::kTitle);
-               }) |
-               std::views::filter([title_id](const auto& entry) {
-                 return static_cast<uint32_t>(entry.info.id) == title_id;
-               });
-
-  if (title.empty()) {
+  Entry* entry = GetEntry(static_cast<uint16_t>(GpdSection::kTitle), title_id);
+
+  if (!entry) {
     return nullptr;
   }
 
-  return reinterpret_cast<X_XDBF_GPD_TITLE_PLAYED*>(title.begin()->data.data());
+  return reinterpret_cast<X_XDBF_GPD_TITLE_PLAYED*>(entry->data.data());
 }
 
 std::u16string GpdInfoProfile::GetTitleName(const uint32_t title_id) const {
@@ -24,8 +24,20 @@ X_XDBF_GPD_ACHIEVEMENT* GpdInfoTitle::GetAchievementEntry(const uint32_t id) {
   return reinterpret_cast<X_XDBF_GPD_ACHIEVEMENT*>(entry->data.data());
 }
 
-const char16_t* GpdInfoTitle::GetAchievementTitlePtr(const uint32_t id) {
-  X_XDBF_GPD_ACHIEVEMENT* achievement_ptr = GetAchievementEntry(id);
+const X_XDBF_GPD_ACHIEVEMENT* GpdInfoTitle::GetAchievementEntry(
+    const uint32_t id) const {
+  const Entry* entry =
+      GetEntry(static_cast<uint16_t>(GpdSection::kAchievement), id);
+
+  if (!entry) {
+    return nullptr;
+  }
+
+  return reinterpret_cast<const X_XDBF_GPD_ACHIEVEMENT*>(entry->data.data());
+}
+
+const char16_t* GpdInfoTitle::GetAchievementTitlePtr(const uint32_t id) const {
+  const X_XDBF_GPD_ACHIEVEMENT* achievement_ptr = GetAchievementEntry(id);
   if (!achievement_ptr) {
     return nullptr;
   }
@@ -33,7 +45,8 @@ const char16_t* GpdInfoTitle::GetAchievementTitlePtr(const uint32_t id) {
   return reinterpret_cast<const char16_t*>(++achievement_ptr);
 }
 
-const char16_t* GpdInfoTitle::GetAchievementDescriptionPtr(const uint32_t id) {
+const char16_t* GpdInfoTitle::GetAchievementDescriptionPtr(
+    const uint32_t id) const {
   // We need to get ptr to first string. These are one after another in memory.
   const char16_t* title_ptr = GetAchievementTitlePtr(id);
   if (!title_ptr) {
@@ -45,7 +58,7 @@ const char16_t* GpdInfoTitle::GetAchievementDescriptionPtr(const uint32_t id) {
 }
 
 const char16_t* GpdInfoTitle::GetAchievementUnachievedDescriptionPtr(
-    const uint32_t id) {
+    const uint32_t id) const {
   const char16_t* title_ptr = GetAchievementDescriptionPtr(id);
   if (!title_ptr) {
     return nullptr;
@@ -55,7 +68,7 @@ const char16_t* GpdInfoTitle::GetAchievementUnachievedDescriptionPtr(
       title_ptr + GetAchievementDescription(id).length());
 }
 
-std::u16string GpdInfoTitle::GetAchievementTitle(const uint32_t id) {
+std::u16string GpdInfoTitle::GetAchievementTitle(const uint32_t id) const {
   auto title_ptr = GetAchievementTitlePtr(id);
 
   if (!title_ptr) {
@@ -65,7 +78,8 @@ std::u16string GpdInfoTitle::GetAchievementTitle(const uint32_t id) {
   return string_util::read_u16string_and_swap(title_ptr);
 }
 
-std::u16string GpdInfoTitle::GetAchievementDescription(const uint32_t id) {
+std::u16string GpdInfoTitle::GetAchievementDescription(
+    const uint32_t id) const {
   auto description_ptr = GetAchievementDescriptionPtr(id);
 
   if (!description_ptr) {
@@ -76,7 +90,7 @@ std::u16string GpdInfoTitle::GetAchievementDescription(const uint32_t id) {
 }
 
 std::u16string GpdInfoTitle::GetAchievementUnachievedDescription(
-    const uint32_t id) {
+    const uint32_t id) const {
   auto description_ptr = GetAchievementUnachievedDescriptionPtr(id);
 
   if (!description_ptr) {
@@ -104,10 +118,7 @@ std::vector<uint32_t> GpdInfoTitle::GetAchievementsIds() const {
 }
 
 void GpdInfoTitle::AddAchievement(const AchievementDetails* header) {
-  Entry* entry =
-      GetEntry(static_cast<uint16_t>(GpdSection::kAchievement), header->id);
-
-  if (entry) {
+  if (HasEntry(static_cast<uint16_t>(GpdSection::kAchievement), header->id)) {
     return;
   }
 
@@ -153,7 +164,7 @@ void GpdInfoTitle::AddAchievement(const AchievementDetails* header) {
   UpsertEntry(&new_entry);
 }
 
-uint32_t GpdInfoTitle::GetTotalGamerscore() {
+uint32_t GpdInfoTitle::GetTotalGamerscore() const {
   const auto ids = GetAchievementsIds();
 
   uint32_t gamerscore = 0;
@@ -163,7 +174,7 @@ uint32_t GpdInfoTitle::GetTotalGamerscore() {
 
   return gamerscore;
 }
-uint32_t GpdInfoTitle::GetGamerscore() {
+uint32_t GpdInfoTitle::GetGamerscore() const {
   const auto ids = GetAchievementsIds();
   uint32_t gamerscore = 0;
   for (const auto id : ids) {
@@ -175,11 +186,11 @@ uint32_t GpdInfoTitle::GetGamerscore() {
   return gamerscore;
 }
 
-uint32_t GpdInfoTitle::GetAchievementCount() {
+uint32_t GpdInfoTitle::GetAchievementCount() const {
   return static_cast<uint32_t>(GetAchievementsIds().size());
 }
 
-uint32_t GpdInfoTitle::GetUnlockedAchievementCount() {
+uint32_t GpdInfoTitle::GetUnlockedAchievementCount() const {
   const auto ids = GetAchievementsIds();
   uint32_t count = 0;
   for (const auto id : ids) {
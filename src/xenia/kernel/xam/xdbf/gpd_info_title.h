@@ -38,20 +38,23 @@ class GpdInfoTitle : public GpdInfo {
 
   void AddAchievement(const AchievementDetails* header);
 
+  // The mutable entry is written to the GPD on the next serialization.
   X_XDBF_GPD_ACHIEVEMENT* GetAchievementEntry(const uint32_t id);
-  std::u16string GetAchievementTitle(const uint32_t id);
-  std::u16string GetAchievementDescription(const uint32_t id);
-  std::u16string GetAchievementUnachievedDescription(const uint32_t id);
+  const X_XDBF_GPD_ACHIEVEMENT* GetAchievementEntry(const uint32_t id) const;
+  std::u16string GetAchievementTitle(const uint32_t id) const;
+  std::u16string GetAchievementDescription(const uint32_t id) const;
+  std::u16string GetAchievementUnachievedDescription(const uint32_t id) const;
 
-  uint32_t GetTotalGamerscore();
-  uint32_t GetGamerscore();
-  uint32_t GetAchievementCount();
-  uint32_t GetUnlockedAchievementCount();
+  uint32_t GetTotalGamerscore() const;
+  uint32_t GetGamerscore() const;
+  uint32_t GetAchievementCount() const;
+  uint32_t GetUnlockedAchievementCount() const;
 
  private:
-  const char16_t* GetAchievementTitlePtr(const uint32_t id);
-  const char16_t* GetAchievementDescriptionPtr(const uint32_t id);
-  const char16_t* GetAchievementUnachievedDescriptionPtr(const uint32_t id);
+  const char16_t* GetAchievementTitlePtr(const uint32_t id) const;
+  const char16_t* GetAchievementDescriptionPtr(const uint32_t id) const;
+  const char16_t* GetAchievementUnachievedDescriptionPtr(
+      const uint32_t id) const;
 };
 
 }  // namespace xam
@@ -57,9 +57,13 @@ void XdbfFile::LoadEntries(const XdbfEntry* table_of_content,
     return;
   }
 
+  entries_.reserve(header_.entry_used);
   for (uint32_t i = 0; i < header_.entry_used; i++) {
-    entries_.push_back({table_of_content++, data_ptr});
+    AddEntry({table_of_content++, data_ptr});
   }
+  // Only the first of entries with the same ID could ever be looked up, so
+  // the duplicates are dropped.
+  header_.entry_used = static_cast<uint32_t>(entries_.size());
 }
 
 void XdbfFile::LoadFreeEntries(const XdbfFileLoc* free_entries) {
@@ -70,23 +74,48 @@ void XdbfFile::LoadFreeEntries(const XdbfFileLoc* free_entries) {
 }
 
 Entry* XdbfFile::GetEntry(uint16_t section, uint64_t id) {
-  for (Entry& entry : entries_) {
-    if (entry.info.id != id || entry.info.section != section) {
-      continue;
-    }
-    return &entry;
+  auto it = entry_indices_.find({section, id});
+  if (it == entry_indices_.cend()) {
+    return nullptr;
   }
-  return nullptr;
+  Entry& entry = entries_[it->second];
+  entry.dirty = true;
+  return &entry;
 }
 
 const Entry* const XdbfFile::GetEntry(uint16_t section, uint64_t id) const {
-  for (const Entry& entry : entries_) {
-    if (entry.info.id != id || entry.info.section != section) {
-      continue;
-    }
-    return &entry;
+  auto it = entry_indices_.find({section, id});
+  if (it == entry_indices_.cend()) {
+    return nullptr;
   }
-  return nullptr;
+  return &entries_[it->second];
+}
+
+Entry* XdbfFile::AddEntry(const Entry& entry) {
+  auto [it, inserted] = entry_indices_.try_emplace(
+      {entry.info.section, entry.info.id}, entries_.size());
+  if (!inserted) {
+    return nullptr;
+  }
+  return &entries_.emplace_back(entry);
+}
+
+bool XdbfFile::RemoveEntry(uint16_t section, uint64_t id) {
+  auto it = entry_indices_.find({section, id});
+  if (it == entry_indices_.cend()) {
+    return false;
+  }
+  // The order of the entries doesn't matter, so the last one takes the place
+  // of the removed one.
+  const size_t index = it->second;
+  entry_indices_.erase(it);
+  if (index != entries_.size() - 1) {
+    Entry& last = entries_.back();
+    entry_indices_[{last.info.section, last.info.id}] = index;
+    entries_[index] = std::move(last);
+  }
+  entries_.pop_back();
+  return true;
 }
 
 uint32_t XdbfFile::CalculateDataStartOffset() const {
@@ -12,6 +12,7 @@
 
 #include <span>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "xenia/base/memory.h"
@@ -157,6 +158,8 @@ struct Entry {
 
   XdbfEntry info;
   std::vector<uint8_t> data;
+  // Whether the data may differ from the last serialized file.
+  mutable bool dirty = true;
 };
 
 // Wraps an XDBF (XboxDataBaseFormat) in-memory database.
@@ -169,22 +172,48 @@ class XdbfFile {
   ~XdbfFile() = default;
 
   const Entry* const GetEntry(uint16_t section, uint64_t id) const;
+  bool HasEntry(uint16_t section, uint64_t id) const {
+    return entry_indices_.contains({section, id});
+  }
 
  protected:
   XdbfHeader header_ = {};
   std::vector<Entry> entries_ = {};
   std::vector<XdbfFileLoc> free_entries_ = {};
 
-  // Gets an entry in the given section.
+  // Gets an entry in the given section for modification, so it's marked as
+  // dirty.
   // If the entry is not found the returned block will be nullptr.
   Entry* GetEntry(uint16_t section, uint64_t id);
+  // Adds an entry, unless one with the same section and ID already exists.
+  // Returns the added entry, valid until the entries are modified.
+  Entry* AddEntry(const Entry& entry);
+  // Returns whether the entry existed.
+  bool RemoveEntry(uint16_t section, uint64_t id);
   uint32_t CalculateDataStartOffset() const;
   uint32_t CalculateEntriesSize() const;
 
  private:
+  struct EntryKey {
+    uint16_t section;
+    uint64_t id;
+
+    bool operator==(const EntryKey& other) const {
+      return section == other.section && id == other.id;
+    }
+  };
+  struct EntryKeyHash {
+    size_t operator()(const EntryKey& key) const {
+      return std::hash<uint64_t>()(key.id ^ (uint64_t(key.section) << 48));
+    }
+  };
+
   bool LoadHeader(const XdbfHeader* header);
   void LoadEntries(const XdbfEntry* table_of_content, const uint8_t* data_ptr);
   void LoadFreeEntries(const XdbfFileLoc* free_entries);
+
+  // Indices of the entries in entries_.
+  std::unordered_map<EntryKey, size_t, EntryKeyHash> entry_indices_;
 };
 
 }  // namespace xam
@@ -15,6 +15,9 @@
 #include "xenia/kernel/xboxkrnl/cert_monitor.h"
 #include "xenia/kernel/xboxkrnl/debug_monitor.h"
 #include "xenia/kernel/xboxkrnl/xboxkrnl_private.h"
+#include "xenia/kernel/xboxkrnl/xboxkrnl_rtl.h"
+
+DECLARE_bool(profile_critical_sections);
 
 DEFINE_string(cl, "", "Specify additional command-line provided to guest.",
               "Kernel");
@@ -258,7 +261,12 @@ void XboxkrnlModule::RegisterExportTable(
   export_resolver->RegisterTable("xboxkrnl.exe", &xboxkrnl_exports);
 }
 
-XboxkrnlModule::~XboxkrnlModule() = default;
+XboxkrnlModule::~XboxkrnlModule() {
+  if (cvars::profile_critical_sections) {
+    XELOGI("Guest critical section statistics: {}",
+           DescribeCriticalSectionStatistics(64));
+  }
+}
 
 }  // namespace xboxkrnl
 }  // namespace kernel
@@ -9,15 +9,35 @@
 
 #include "xenia/kernel/xboxkrnl/xboxkrnl_rtl.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <unordered_map>
+
+#include "third_party/fmt/include/fmt/format.h"
 #include "xenia/base/atomic.h"
+#include "xenia/base/cvar.h"
+#include "xenia/base/mutex.h"
 #include "xenia/base/pe_image.h"
 #include "xenia/kernel/kernel_state.h"
 #include "xenia/kernel/user_module.h"
+#include "xenia/kernel/util/rtl_simd.h"
 #include "xenia/kernel/util/shim_utils.h"
 #include "xenia/kernel/xboxkrnl/xboxkrnl_private.h"
 #include "xenia/kernel/xboxkrnl/xboxkrnl_threading.h"
 #include "xenia/kernel/xthread.h"
 
+DEFINE_bool(adaptive_critical_section_spin, true,
+            "Spin on contended guest critical sections for as long as they "
+            "have recently been taking to be released, instead of the spin "
+            "count set by the title for the console.",
+            "Kernel");
+DEFINE_bool(profile_critical_sections, false,
+            "Record acquisition, contention and wait statistics for each guest "
+            "critical section, logged when the title exits.",
+            "Kernel");
+
 namespace xe {
 namespace kernel {
 namespace xboxkrnl {
@@ -29,41 +49,18 @@ struct X_STRING {
 // https://msdn.microsoft.com/en-us/library/ff561778
 dword_result_t RtlCompareMemory_entry(lpvoid_t source1, lpvoid_t source2,
                                       dword_t length) {
-  uint8_t* p1 = source1;
-  uint8_t* p2 = source2;
-
   // Note that the return value is the number of bytes that match, so it's best
   // we just do this ourselves vs. using memcmp.
-  // On Windows we could use the builtin function.
-
-  uint32_t c = 0;
-  for (uint32_t n = 0; n < length; n++, p1++, p2++) {
-    if (*p1 == *p2) {
-      c++;
-    }
-  }
-
-  return c;
+  return util::RtlCountEqualBytes(source1.as<uint8_t*>(),
+                                  source2.as<uint8_t*>(), length);
 }
 DECLARE_XBOXKRNL_EXPORT1(RtlCompareMemory, kMemory, kImplemented);
 
 // https://msdn.microsoft.com/en-us/library/ff552123
 dword_result_t RtlCompareMemoryUlong_entry(lpvoid_t source, dword_t length,
                                            dword_t pattern) {
-  uint32_t num_compared_bytes = 0;
-
-  uint32_t swapped_pattern = xe::byte_swap(pattern.value());
-
-  char* host_source = (char*)source.host_address();
-
-  for (uint32_t aligned_length = length & 0xFFFFFFFCU; aligned_length;
-       num_compared_bytes += 4) {
-    if (*(uint32_t*)(host_source + num_compared_bytes) != swapped_pattern) {
-      break;
-    }
-    aligned_length = aligned_length - 4;
-  }
-  return num_compared_bytes;
+  return util::RtlCompareUlongs(source.as<uint8_t*>(), length,
+                                pattern.value());
 }
 DECLARE_XBOXKRNL_EXPORT1(RtlCompareMemoryUlong, kMemory, kImplemented);
 
@@ -71,71 +68,18 @@ DECLARE_XBOXKRNL_EXPORT1(RtlCompareMemoryUlong, kMemory, kImplemented);
 void RtlFillMemoryUlong_entry(lpvoid_t destination, dword_t length,
                               dword_t pattern) {
   // NOTE: length must be % 4, so we can work on uint32s.
-  uint32_t count = length >> 2;
-
-  uint32_t* p = destination.as<uint32_t*>();
-  uint32_t swapped_pattern = xe::byte_swap(pattern.value());
-  for (uint32_t n = 0; n < count; n++, p++) {
-    *p = swapped_pattern;
-  }
+  util::RtlFillUlongs(destination.as<uint8_t*>(), length >> 2,
+                      pattern.value());
 }
 DECLARE_XBOXKRNL_EXPORT1(RtlFillMemoryUlong, kMemory, kImplemented);
 
-static constexpr const unsigned char rtl_lower_table[256] = {
-    0x0,  0x1,  0x2,  0x3,  0x4,  0x5,  0x6,  0x7,  0x8,  0x9,  0xA,  0xB,
-    0xC,  0xD,  0xE,  0xF,  0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
-    0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23,
-    0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F,
-    0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B,
-    0x3C, 0x3D, 0x3E, 0x3F, 0x40, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67,
-    0x68, 0x69, 0x6A, 0x6B, 0x6C, 0x6D, 0x6E, 0x6F, 0x70, 0x71, 0x72, 0x73,
-    0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F,
-    0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6A, 0x6B,
-    0x6C, 0x6D, 0x6E, 0x6F, 0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77,
-    0x78, 0x79, 0x7A, 0x7B, 0x7C, 0x7D, 0x7E, 0x7F, 0x80, 0x81, 0x82, 0x83,
-    0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F,
-    0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0x9B,
-    0x9C, 0x9D, 0x9E, 0x9F, 0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7,
-    0xA8, 0xA9, 0xAA, 0xAB, 0xAC, 0xAD, 0xAE, 0xAF, 0xB0, 0xB1, 0xB2, 0xB3,
-    0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF,
-    0xE0, 0xE1, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xEB,
-    0xEC, 0xED, 0xEE, 0xEF, 0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xD7,
-    0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xDF, 0xE0, 0xE1, 0xE2, 0xE3,
-    0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xEB, 0xEC, 0xED, 0xEE, 0xEF,
-    0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFB,
-    0xFC, 0xFD, 0xFE, 0xFF};
-
-static constexpr const unsigned char rtl_upper_table[256] = {
-    0x0,  0x1,  0x2,  0x3,  0x4,  0x5,  0x6,  0x7,  0x8,  0x9,  0xA,  0xB,
-    0xC,  0xD,  0xE,  0xF,  0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
-    0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23,
-    0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F,
-    0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B,
-    0x3C, 0x3D, 0x3E, 0x3F, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47,
-    0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F, 0x50, 0x51, 0x52, 0x53,
-    0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F,
-    0x60, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B,
-    0x4C, 0x4D, 0x4E, 0x4F, 0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57,
-    0x58, 0x59, 0x5A, 0x7B, 0x7C, 0x7D, 0x7E, 0x7F, 0x80, 0x81, 0x82, 0x83,
-    0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F,
-    0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0x9B,
-    0x9C, 0x9D, 0x9E, 0x9F, 0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7,
-    0xA8, 0xA9, 0xAA, 0xAB, 0xAC, 0xAD, 0xAE, 0xAF, 0xB0, 0xB1, 0xB2, 0xB3,
-    0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF,
-    0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xCB,
-    0xCC, 0xCD, 0xCE, 0xCF, 0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7,
-    0xD8, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF, 0xC0, 0xC1, 0xC2, 0xC3,
-    0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF,
-    0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xF7, 0xD8, 0xD9, 0xDA, 0xDB,
-    0xDC, 0xDD, 0xDE, 0x3F};
-
 dword_result_t RtlUpperChar_entry(dword_t in) {
-  return rtl_upper_table[in & 0xff];
+  return util::RtlUpperAnsiChar(uint8_t(in & 0xFF));
 }
 DECLARE_XBOXKRNL_EXPORT1(RtlUpperChar, kNone, kImplemented);
 
 dword_result_t RtlLowerChar_entry(dword_t in) {
-  return rtl_lower_table[in & 0xff];
+  return util::RtlLowerAnsiChar(uint8_t(in & 0xFF));
 }
 DECLARE_XBOXKRNL_EXPORT1(RtlLowerChar, kNone, kImplemented);
 
@@ -143,41 +87,15 @@ static int RtlCompareStringN_impl(uint8_t* string_1, unsigned int string_1_len,
                                   uint8_t* string_2, unsigned int string_2_len,
                                   int case_insensitive) {
   if (string_1_len == 0xFFFFFFFF) {
-    uint8_t* string1_strlen_iter = string_1;
-    while (*string1_strlen_iter++);
-    string_1_len =
-        static_cast<unsigned int>(string1_strlen_iter - string_1 - 1);
+    string_1_len = static_cast<unsigned int>(
+        std::strlen(reinterpret_cast<const char*>(string_1)));
   }
   if (string_2_len == 0xFFFFFFFF) {
-    uint8_t* string2_strlen_iter = string_2;
-    while (*string2_strlen_iter++);
-    string_2_len =
-        static_cast<unsigned int>(string2_strlen_iter - string_2 - 1);
-  }
-  uint8_t* string1_end = &string_1[std::min(string_2_len, string_1_len)];
-  if (case_insensitive) {
-    while (string_1 < string1_end) {
-      unsigned c1 = *string_1++;
-      unsigned c2 = *string_2++;
-      if (c1 != c2) {
-        unsigned cu1 = rtl_upper_table[c1];
-        unsigned cu2 = rtl_upper_table[c2];
-        if (cu1 != cu2) {
-          return cu1 - cu2;
-        }
-      }
-    }
-  } else {
-    while (string_1 < string1_end) {
-      unsigned c1 = *string_1++;
-      unsigned c2 = *string_2++;
-      if (c1 != c2) {
-        return c1 - c2;
-      }
-    }
+    string_2_len = static_cast<unsigned int>(
+        std::strlen(reinterpret_cast<const char*>(string_2)));
   }
-  // why? not sure, but its the original logic
-  return string_1_len - string_2_len;
+  return util::RtlCompareAnsiStrings(string_1, string_1_len, string_2,
+                                     string_2_len, case_insensitive != 0);
 }
 dword_result_t RtlCompareStringN_entry(lpstring_t string_1,
                                        dword_t string_1_len,
@@ -586,6 +504,88 @@ static void CriticalSectionPrefetchW(const void* vp) {
 #endif
 }
 
+static void CriticalSectionPause() {
+#if XE_ARCH_AMD64 == 1
+  _mm_pause();
+#elif XE_ARCH_ARM64 == 1
+  __asm__ volatile("yield");
+#endif
+}
+
+// How many times spinning on each critical section has recently needed to
+// acquire it, packed with a tag of the address, in a table indexed by the
+// address. Collisions only make the estimates less accurate.
+static constexpr uint32_t kCriticalSectionSpinTableSizeLog2 = 12;
+static constexpr uint32_t kCriticalSectionMaxSpinCount = 2048;
+static std::atomic<uint32_t>
+    critical_section_spin_estimates_[1 << kCriticalSectionSpinTableSizeLog2];
+
+static std::atomic<uint32_t>& GetCriticalSectionSpinEstimate(
+    uint32_t cs_ptr, uint32_t& tag_out) {
+  uint32_t hash = (cs_ptr >> 2) * UINT32_C(0x9E3779B1);
+  tag_out = hash & 0xFFFF0000;
+  return critical_section_spin_estimates_[hash >>
+                                          (32 -
+                                           kCriticalSectionSpinTableSizeLog2)];
+}
+
+// Profiling of the critical sections, only when enabled as it's locked on
+// every acquisition.
+static xe_mutex critical_section_statistics_mutex_;
+static std::unordered_map<uint32_t, CriticalSectionStatistics>
+    critical_section_statistics_;
+
+static void RecordCriticalSectionAcquisition(uint32_t cs_ptr, bool contended,
+                                             bool waited,
+                                             uint64_t wait_time_ns) {
+  std::lock_guard<xe_mutex> lock(critical_section_statistics_mutex_);
+  CriticalSectionStatistics& statistics = critical_section_statistics_[cs_ptr];
+  statistics.guest_address = cs_ptr;
+  ++statistics.acquisition_count;
+  statistics.contention_count += contended;
+  statistics.wait_count += waited;
+  statistics.wait_time_ns += wait_time_ns;
+}
+
+std::vector<CriticalSectionStatistics> QueryCriticalSectionStatistics() {
+  std::vector<CriticalSectionStatistics> result;
+  {
+    std::lock_guard<xe_mutex> lock(critical_section_statistics_mutex_);
+    result.reserve(critical_section_statistics_.size());
+    for (const auto& statistics : critical_section_statistics_) {
+      result.push_back(statistics.second);
+    }
+  }
+  std::sort(result.begin(), result.end(),
+            [](const CriticalSectionStatistics& a,
+               const CriticalSectionStatistics& b) {
+              if (a.wait_time_ns != b.wait_time_ns) {
+                return a.wait_time_ns > b.wait_time_ns;
+              }
+              return a.contention_count > b.contention_count;
+            });
+  return result;
+}
+
+std::string DescribeCriticalSectionStatistics(size_t max_count) {
+  std::vector<CriticalSectionStatistics> statistics =
+      QueryCriticalSectionStatistics();
+  std::string result = fmt::format(
+      "{} critical sections, address: acquisitions, contended, waits, wait "
+      "time",
+      statistics.size());
+  for (size_t i = 0; i < std::min(max_count, statistics.size()); ++i) {
+    const CriticalSectionStatistics& entry = statistics[i];
+    result += fmt::format("\n  {:08X}: {}, {} ({:.1f}%), {}, {:.3f} ms",
+                          entry.guest_address, entry.acquisition_count,
+                          entry.contention_count,
+                          100.0 * double(entry.contention_count) /
+                              double(entry.acquisition_count),
+                          entry.wait_count, double(entry.wait_time_ns) / 1e6);
+  }
+  return result;
+}
+
 void RtlEnterCriticalSection_entry(pointer_t<X_RTL_CRITICAL_SECTION> cs) {
   if (!cs.guest_address()) {
     XELOGE("Null critical section in RtlEnterCriticalSection!");
@@ -593,7 +593,6 @@ void RtlEnterCriticalSection_entry(pointer_t<X_RTL_CRITICAL_SECTION> cs) {
   }
   CriticalSectionPrefetchW(&cs->lock_count);
   uint32_t cur_thread = XThread::GetCurrentThread()->guest_object();
-  uint32_t spin_count = cs->header.absolute * 256;
 
   if (cs->owning_thread == cur_thread) {
     // We already own the lock.
@@ -602,25 +601,81 @@ void RtlEnterCriticalSection_entry(pointer_t<X_RTL_CRITICAL_SECTION> cs) {
     return;
   }
 
-  // Spin loop
-  while (spin_count--) {
-    if (xe::atomic_cas(-1, 0, &cs->lock_count)) {
-      // Acquired.
-      cs->owning_thread = cur_thread;
-      cs->recursion_count = 1;
-      return;
+  bool contended = false, waited = false;
+  uint64_t wait_time_ns = 0;
+  if (!xe::atomic_cas(-1, 0, &cs->lock_count)) {
+    contended = true;
+    bool acquired = false;
+    if (cvars::adaptive_critical_section_spin) {
+      // The guest spin count was chosen for the console, the time the owner
+      // holds the critical section for on the host is measured instead.
+      uint32_t tag;
+      std::atomic<uint32_t>& packed_estimate =
+          GetCriticalSectionSpinEstimate(cs.guest_address(), tag);
+      uint32_t packed = packed_estimate.load(std::memory_order_relaxed);
+      uint32_t estimate = (packed & 0xFFFF0000) == tag ? packed & 0xFFFF : 0;
+      uint32_t max_spin_count =
+          std::min(estimate * 2 + 16, kCriticalSectionMaxSpinCount);
+      uint32_t spin_count = 0;
+      uint32_t pause_count = 1;
+      while (spin_count < max_spin_count) {
+        ++spin_count;
+        for (uint32_t i = 0; i < pause_count; ++i) {
+          CriticalSectionPause();
+        }
+        pause_count = std::min(pause_count * 2, UINT32_C(16));
+        // Only try to take the cache line for writing when it's released.
+        if (*static_cast<volatile int32_t*>(&cs->lock_count) == -1 &&
+            xe::atomic_cas(-1, 0, &cs->lock_count)) {
+          acquired = true;
+          break;
+        }
+      }
+      // Follow the spin count needed when spinning helps, back off when the
+      // critical section is held for longer than that.
+      if (acquired) {
+        estimate += (int32_t(spin_count) - int32_t(estimate)) / 8;
+      } else {
+        estimate /= 2;
+      }
+      packed_estimate.store(tag | estimate, std::memory_order_relaxed);
+    } else {
+      uint32_t spin_count = cs->header.absolute * 256;
+      while (spin_count--) {
+        if (xe::atomic_cas(-1, 0, &cs->lock_count)) {
+          acquired = true;
+          break;
+        }
+      }
+    }
+    if (!acquired) {
+      if (xe::atomic_inc(&cs->lock_count) != 0) {
+        // Create a full waiter.
+        waited = true;
+        std::chrono::steady_clock::time_point wait_start;
+        if (cvars::profile_critical_sections) {
+          wait_start = std::chrono::steady_clock::now();
+        }
+        xeKeWaitForSingleObject(reinterpret_cast<void*>(cs.host_address()), 8,
+                                0, 0, nullptr);
+        if (cvars::profile_critical_sections) {
+          wait_time_ns = uint64_t(
+              std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - wait_start)
+                  .count());
+        }
+      }
+      assert_true(cs->owning_thread == 0);
     }
   }
 
-  if (xe::atomic_inc(&cs->lock_count) != 0) {
-    // Create a full waiter.
-    xeKeWaitForSingleObject(reinterpret_cast<void*>(cs.host_address()), 8, 0, 0,
-                            nullptr);
-  }
-
-  assert_true(cs->owning_thread == 0);
   cs->owning_thread = cur_thread;
   cs->recursion_count = 1;
+
+  if (cvars::profile_critical_sections) {
+    RecordCriticalSectionAcquisition(cs.guest_address(), contended, waited,
+                                     wait_time_ns);
+  }
 }
 DECLARE_XBOXKRNL_EXPORT2(RtlEnterCriticalSection, kNone, kImplemented,
                          kHighFrequency);
@@ -638,6 +693,9 @@ dword_result_t RtlTryEnterCriticalSection_entry(
     // Able to steal the lock right away.
     cs->owning_thread = thread;
     cs->recursion_count = 1;
+    if (cvars::profile_critical_sections) {
+      RecordCriticalSectionAcquisition(cs.guest_address(), false, false, 0);
+    }
     return 1;
   } else if (cs->owning_thread == thread) {
     // Already own the lock.
@@ -742,71 +800,12 @@ dword_result_t RtlTimeFieldsToTime_entry(
 }
 DECLARE_XBOXKRNL_EXPORT1(RtlTimeFieldsToTime, kNone, kImplemented);
 
-static uint32_t crc32_table[256] = {
-    0x00000000u, 0x77073096u, 0xEE0E612Cu, 0x990951BAu, 0x076DC419u,
-    0x706AF48Fu, 0xE963A535u, 0x9E6495A3u, 0x0EDB8832u, 0x79DCB8A4u,
-    0xE0D5E91Eu, 0x97D2D988u, 0x09B64C2Bu, 0x7EB17CBDu, 0xE7B82D07u,
-    0x90BF1D91u, 0x1DB71064u, 0x6AB020F2u, 0xF3B97148u, 0x84BE41DEu,
-    0x1ADAD47Du, 0x6DDDE4EBu, 0xF4D4B551u, 0x83D385C7u, 0x136C9856u,
-    0x646BA8C0u, 0xFD62F97Au, 0x8A65C9ECu, 0x14015C4Fu, 0x63066CD9u,
-    0xFA0F3D63u, 0x8D080DF5u, 0x3B6E20C8u, 0x4C69105Eu, 0xD56041E4u,
-    0xA2677172u, 0x3C03E4D1u, 0x4B04D447u, 0xD20D85FDu, 0xA50AB56Bu,
-    0x35B5A8FAu, 0x42B2986Cu, 0xDBBBC9D6u, 0xACBCF940u, 0x32D86CE3u,
-    0x45DF5C75u, 0xDCD60DCFu, 0xABD13D59u, 0x26D930ACu, 0x51DE003Au,
-    0xC8D75180u, 0xBFD06116u, 0x21B4F4B5u, 0x56B3C423u, 0xCFBA9599u,
-    0xB8BDA50Fu, 0x2802B89Eu, 0x5F058808u, 0xC60CD9B2u, 0xB10BE924u,
-    0x2F6F7C87u, 0x58684C11u, 0xC1611DABu, 0xB6662D3Du, 0x76DC4190u,
-    0x01DB7106u, 0x98D220BCu, 0xEFD5102Au, 0x71B18589u, 0x06B6B51Fu,
-    0x9FBFE4A5u, 0xE8B8D433u, 0x7807C9A2u, 0x0F00F934u, 0x9609A88Eu,
-    0xE10E9818u, 0x7F6A0DBBu, 0x086D3D2Du, 0x91646C97u, 0xE6635C01u,
-    0x6B6B51F4u, 0x1C6C6162u, 0x856530D8u, 0xF262004Eu, 0x6C0695EDu,
-    0x1B01A57Bu, 0x8208F4C1u, 0xF50FC457u, 0x65B0D9C6u, 0x12B7E950u,
-    0x8BBEB8EAu, 0xFCB9887Cu, 0x62DD1DDFu, 0x15DA2D49u, 0x8CD37CF3u,
-    0xFBD44C65u, 0x4DB26158u, 0x3AB551CEu, 0xA3BC0074u, 0xD4BB30E2u,
-    0x4ADFA541u, 0x3DD895D7u, 0xA4D1C46Du, 0xD3D6F4FBu, 0x4369E96Au,
-    0x346ED9FCu, 0xAD678846u, 0xDA60B8D0u, 0x44042D73u, 0x33031DE5u,
-    0xAA0A4C5Fu, 0xDD0D7CC9u, 0x5005713Cu, 0x270241AAu, 0xBE0B1010u,
-    0xC90C2086u, 0x5768B525u, 0x206F85B3u, 0xB966D409u, 0xCE61E49Fu,
-    0x5EDEF90Eu, 0x29D9C998u, 0xB0D09822u, 0xC7D7A8B4u, 0x59B33D17u,
-    0x2EB40D81u, 0xB7BD5C3Bu, 0xC0BA6CADu, 0xEDB88320u, 0x9ABFB3B6u,
-    0x03B6E20Cu, 0x74B1D29Au, 0xEAD54739u, 0x9DD277AFu, 0x04DB2615u,
-    0x73DC1683u, 0xE3630B12u, 0x94643B84u, 0x0D6D6A3Eu, 0x7A6A5AA8u,
-    0xE40ECF0Bu, 0x9309FF9Du, 0x0A00AE27u, 0x7D079EB1u, 0xF00F9344u,
-    0x8708A3D2u, 0x1E01F268u, 0x6906C2FEu, 0xF762575Du, 0x806567CBu,
-    0x196C3671u, 0x6E6B06E7u, 0xFED41B76u, 0x89D32BE0u, 0x10DA7A5Au,
-    0x67DD4ACCu, 0xF9B9DF6Fu, 0x8EBEEFF9u, 0x17B7BE43u, 0x60B08ED5u,
-    0xD6D6A3E8u, 0xA1D1937Eu, 0x38D8C2C4u, 0x4FDFF252u, 0xD1BB67F1u,
-    0xA6BC5767u, 0x3FB506DDu, 0x48B2364Bu, 0xD80D2BDAu, 0xAF0A1B4Cu,
-    0x36034AF6u, 0x41047A60u, 0xDF60EFC3u, 0xA867DF55u, 0x316E8EEFu,
-    0x4669BE79u, 0xCB61B38Cu, 0xBC66831Au, 0x256FD2A0u, 0x5268E236u,
-    0xCC0C7795u, 0xBB0B4703u, 0x220216B9u, 0x5505262Fu, 0xC5BA3BBEu,
-    0xB2BD0B28u, 0x2BB45A92u, 0x5CB36A04u, 0xC2D7FFA7u, 0xB5D0CF31u,
-    0x2CD99E8Bu, 0x5BDEAE1Du, 0x9B64C2B0u, 0xEC63F226u, 0x756AA39Cu,
-    0x026D930Au, 0x9C0906A9u, 0xEB0E363Fu, 0x72076785u, 0x05005713u,
-    0x95BF4A82u, 0xE2B87A14u, 0x7BB12BAEu, 0x0CB61B38u, 0x92D28E9Bu,
-    0xE5D5BE0Du, 0x7CDCEFB7u, 0x0BDBDF21u, 0x86D3D2D4u, 0xF1D4E242u,
-    0x68DDB3F8u, 0x1FDA836Eu, 0x81BE16CDu, 0xF6B9265Bu, 0x6FB077E1u,
-    0x18B74777u, 0x88085AE6u, 0xFF0F6A70u, 0x66063BCAu, 0x11010B5Cu,
-    0x8F659EFFu, 0xF862AE69u, 0x616BFFD3u, 0x166CCF45u, 0xA00AE278u,
-    0xD70DD2EEu, 0x4E048354u, 0x3903B3C2u, 0xA7672661u, 0xD06016F7u,
-    0x4969474Du, 0x3E6E77DBu, 0xAED16A4Au, 0xD9D65ADCu, 0x40DF0B66u,
-    0x37D83BF0u, 0xA9BCAE53u, 0xDEBB9EC5u, 0x47B2CF7Fu, 0x30B5FFE9u,
-    0xBDBDF21Cu, 0xCABAC28Au, 0x53B39330u, 0x24B4A3A6u, 0xBAD03605u,
-    0xCDD70693u, 0x54DE5729u, 0x23D967BFu, 0xB3667A2Eu, 0xC4614AB8u,
-    0x5D681B02u, 0x2A6F2B94u, 0xB40BBE37u, 0xC30C8EA1u, 0x5A05DF1Bu,
-    0x2D02EF8Du,
-};
-
 dword_result_t RtlComputeCrc32_entry(dword_t seed, lpvoid_t buffer,
                                      dword_t length) {
   if (!length) {
     return seed.value();
   }
-  uint32_t hash = ~seed;
-  for (uint32_t i = 0; i < length; ++i) {
-    hash = crc32_table[buffer[i] ^ (hash & 0xFF)] ^ (hash >> 8);
-  }
-  return ~hash;
+  return util::RtlCrc32(seed, buffer.as<uint8_t*>(), length);
 }
 DECLARE_XBOXKRNL_EXPORT1(RtlComputeCrc32, kNone, kImplemented);
 
@@ -10,6 +10,9 @@
 #ifndef XENIA_KERNEL_XBOXKRNL_XBOXKRNL_RTL_H_
 #define XENIA_KERNEL_XBOXKRNL_XBOXKRNL_RTL_H_
 
+#include <string>
+#include <vector>
+
 #include "xenia/xbox.h"
 
 namespace xe {
@@ -24,6 +27,19 @@ X_STATUS xeRtlInitializeCriticalSectionAndSpinCount(X_RTL_CRITICAL_SECTION* cs,
                                                     uint32_t cs_ptr,
                                                     uint32_t spin_count);
 
+struct CriticalSectionStatistics {
+  uint32_t guest_address = 0;
+  uint64_t acquisition_count = 0;
+  // Acquisitions that found the critical section owned by another thread.
+  uint64_t contention_count = 0;
+  // Contended acquisitions that had to wait on the event after spinning.
+  uint64_t wait_count = 0;
+  uint64_t wait_time_ns = 0;
+};
+// Recorded if profile_critical_sections is enabled, sorted by the wait time.
+std::vector<CriticalSectionStatistics> QueryCriticalSectionStatistics();
+std::string DescribeCriticalSectionStatistics(size_t max_count);
+
 }  // namespace xboxkrnl
 }  // namespace kernel
 }  // namespace xe
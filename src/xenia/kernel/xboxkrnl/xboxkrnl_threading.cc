@@ -1340,6 +1340,7 @@ X_STATUS xeProcessUserApcs(PPCContext* ctx) {
       ctx->processor->Execute(ctx->thread_state, normal_routine, normal_args,
                               xe::countof(normal_args));
     }
+    XThread::GetCurrentThread()->OnApcDelivered();
 
     unlocked_irql = xeKeKfAcquireSpinLock(ctx, &current_thread->apc_lock);
   }
@@ -740,27 +740,34 @@ X_RESULT XSession::GetSessions(KernelState* kernel_state,
   const uint32_t session_count = std::min<int32_t>(
       search_data->num_results, static_cast<uint32_t>(sessions.size()));
 
-  const uint32_t session_ids =
-      kernel_state->memory()->SystemHeapAlloc(session_count * sizeof(XNKID));
-
-  XNKID* session_ids_ptr =
-      kernel_state->memory()->TranslateVirtual<XNKID*>(session_ids);
+  std::vector<SessionSearchResult> results(session_count);
 
   for (uint32_t i = 0; i < session_count; i++) {
-    XNKID id = {};
-    Uint64toXNKID(sessions.at(i)->SessionID_UInt(), &id);
+    const uint64_t session_id = sessions.at(i)->SessionID_UInt();
 
-    session_ids_ptr[i] = id;
+    results[i].session = XLiveAPI::XSessionGet(session_id);
+    results[i].properties = XLiveAPI::SessionPropertiesGet(session_id);
   }
 
-  GetSessionByIDs(kernel_state->memory(), session_ids_ptr, session_count,
-                  search_data->search_results_ptr,
-                  search_data->results_buffer_size);
+  return FillSessionSearchResults(kernel_state, search_data, results);
+}
+
+X_RESULT XSession::FillSessionSearchResults(
+    KernelState* kernel_state, XGI_SESSION_SEARCH* search_data,
+    const std::vector<SessionSearchResult>& sessions) {
+  Memory* memory = kernel_state->memory();
 
   SEARCH_RESULTS* search_results_ptr =
-      kernel_state->memory()->TranslateVirtual<SEARCH_RESULTS*>(
+      memory->TranslateVirtual<SEARCH_RESULTS*>(
           search_data->search_results_ptr);
 
+  const uint32_t session_search_result_ptr =
+      memory->SystemHeapAlloc(search_data->results_buffer_size);
+
+  search_results_ptr->results_ptr =
+      memory->TranslateVirtual<XSESSION_SEARCHRESULT*>(
+          session_search_result_ptr);
+
   xam::XUSER_CONTEXT* search_contexts_ptr =
       kernel_state->memory()->TranslateVirtual<xam::XUSER_CONTEXT*>(
           search_data->ctx_ptr);
@@ -812,14 +819,23 @@ X_RESULT XSession::GetSessions(KernelState* kernel_state,
     }
   }
 
+  const uint32_t session_count = std::min<uint32_t>(
+      search_data->num_results, static_cast<uint32_t>(sessions.size()));
+
+  uint32_t result_index = 0;
+
   for (uint32_t i = 0; i < session_count; i++) {
+    const auto& session = sessions[i].session;
+
+    if (!session || !IsValidXNKID(session->SessionID_UInt()) ||
+        session->HostAddress().empty()) {
+      continue;
+    }
+
     std::vector<xam::Property> contexts = {};
     std::vector<xam::Property> properties = {};
 
-    const auto all_properties =
-        XLiveAPI::SessionPropertiesGet(sessions.at(i)->SessionID_UInt());
-
-    for (const auto& property : all_properties) {
+    for (const auto& property : sessions[i].properties) {
       if (property.IsContext()) {
         contexts.push_back(property);
       } else {
@@ -827,16 +843,23 @@ X_RESULT XSession::GetSessions(KernelState* kernel_state,
       }
     }
 
-    FillSessionContext(kernel_state->memory(), search_data->proc_index,
-                       matchmaking_query, contexts, search_data->num_ctx,
-                       search_contexts_ptr,
-                       &search_results_ptr->results_ptr[i]);
-    FillSessionProperties(kernel_state->memory(), search_data->proc_index,
-                          matchmaking_query, properties, search_data->num_props,
-                          search_properties_ptr,
-                          &search_results_ptr->results_ptr[i]);
+    XSESSION_SEARCHRESULT* result =
+        &search_results_ptr->results_ptr[result_index];
+
+    FillSessionContext(memory, search_data->proc_index, matchmaking_query,
+                       contexts, search_data->num_ctx, search_contexts_ptr,
+                       result);
+    FillSessionProperties(memory, search_data->proc_index, matchmaking_query,
+                          properties, search_data->num_props,
+                          search_properties_ptr, result);
+    FillSessionSearchResult(session, result);
+
+    result_index++;
   }
 
+  search_results_ptr->header.search_results_count = result_index;
+  search_results_ptr->header.search_results_ptr = session_search_result_ptr;
+
   return X_ERROR_SUCCESS;
 }
 
@@ -244,6 +244,12 @@ struct XSessionArbitrationJSON {
   std::vector<MachineInfo> machines;
 };
 
+// A session search hit, with what's needed to fill in its search result.
+struct SessionSearchResult {
+  std::unique_ptr<SessionObjectJSON> session;
+  std::vector<xam::Property> properties;
+};
+
 class XSession : public XObject {
  public:
   static const Type kObjectType = Type::Session;
@@ -272,6 +278,11 @@ class XSession : public XObject {
   static X_RESULT GetSessions(KernelState* kernel_state,
                               XGI_SESSION_SEARCH* search_data,
                               uint32_t num_users);
+  // Writes search hits to the guest, run once they've been fetched. Hits
+  // without session details are skipped.
+  static X_RESULT FillSessionSearchResults(
+      KernelState* kernel_state, XGI_SESSION_SEARCH* search_data,
+      const std::vector<SessionSearchResult>& sessions);
   static X_RESULT GetWeightedSessions(KernelState* kernel_state,
                                       XGI_SESSION_SEARCH_WEIGHTED* search_data,
                                       uint32_t num_users);
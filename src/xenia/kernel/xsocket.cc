@@ -11,6 +11,10 @@
 
 #include <cstring>
 
+#ifndef XE_PLATFORM_WIN32
+#include <fcntl.h>
+#endif
+
 #include "xenia/base/platform.h"
 #include "xenia/kernel/kernel_state.h"
 #include "xenia/kernel/xam/xam_module.h"
@@ -23,13 +27,35 @@ using namespace std::chrono_literals;
 namespace xe {
 namespace kernel {
 
+constexpr uint32_t kSelectReadEvents =
+    XSocket::X_FD_READ | XSocket::X_FD_OOB | XSocket::X_FD_ACCEPT |
+    XSocket::X_FD_CLOSE;
+constexpr uint32_t kSelectWriteEvents =
+    XSocket::X_FD_WRITE | XSocket::X_FD_CONNECT;
+
+// MSG_PARTIAL as reported to the guest.
+constexpr uint32_t kMsgPartial = 0x8000;
+
+static bool IsLastErrorWouldBlock() {
+#ifdef XE_PLATFORM_WIN32
+  return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+  return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
 XSocket::XSocket(KernelState* kernel_state)
     : XObject(kernel_state, kObjectType) {}
 
 XSocket::XSocket(KernelState* kernel_state, uint64_t native_handle)
     : XObject(kernel_state, kObjectType), native_handle_(native_handle) {}
 
-XSocket::~XSocket() { Close(); }
+XSocket::~XSocket() {
+  // Nobody can observe the completion anymore, and guest events may already
+  // be gone if the object table is being torn down.
+  CancelPendingOperations(false);
+  Close();
+}
 
 X_STATUS XSocket::Initialize(AddressFamily af, Type type, Protocol proto) {
   af_ = af;
@@ -49,13 +75,42 @@ X_STATUS XSocket::Initialize(AddressFamily af, Type type, Protocol proto) {
   return X_STATUS_SUCCESS;
 }
 
-X_STATUS XSocket::Close() {
-  std::unique_lock lock(receive_mutex_);
-  if (active_overlapped_ && !(active_overlapped_->offset_high & 1)) {
-    active_overlapped_->offset_high |= 2;
-  }
+void XSocket::CancelPendingOperations(bool signal) {
+  std::unique_lock lock(overlapped_mutex_);
+  SocketReactor* reactor = reactor_;
+  reactor_ = nullptr;
   lock.unlock();
 
+  // Must be done without holding the lock, as this waits for a callback that
+  // may be running on a reactor thread.
+  if (reactor) {
+    reactor->Unregister(native_handle_);
+  }
+
+  lock.lock();
+  for (XWSAOVERLAPPED* overlapped :
+       {pending_receive_ ? pending_receive_->overlapped : nullptr,
+        pending_send_ ? pending_send_->overlapped : nullptr}) {
+    if (!overlapped) {
+      continue;
+    }
+    overlapped->internal_high = uint32_t(X_WSAError::X_WSA_OPERATION_ABORTED);
+    if (signal) {
+      SignalOverlapped(overlapped);
+    } else {
+      overlapped->offset_high |= 1;
+    }
+  }
+  pending_receive_.reset();
+  pending_send_.reset();
+  select_event_.reset();
+  select_events_ = 0;
+  select_enabled_events_ = 0;
+}
+
+X_STATUS XSocket::Close() {
+  CancelPendingOperations(true);
+
   std::unique_lock socket_lock(receive_socket_mutex_);
 #if XE_PLATFORM_WIN32
   int ret = closesocket(native_handle_);
@@ -214,6 +269,7 @@ object_ref<XSocket> XSocket::Accept(XSOCKADDR_IN* name, int* name_len) {
 
   const uint64_t ret = accept(native_handle_, name ? &sa : nullptr,
                               name_len ? &addrlen : nullptr);
+  ReenableSelectEvents(X_FD_ACCEPT);
   if (ret == -1) {
     return nullptr;
   }
@@ -235,7 +291,9 @@ object_ref<XSocket> XSocket::Accept(XSOCKADDR_IN* name, int* name_len) {
 int XSocket::Shutdown(int how) { return shutdown(native_handle_, how); }
 
 int XSocket::Recv(uint8_t* buf, uint32_t buf_len, uint32_t flags) {
-  return recv(native_handle_, reinterpret_cast<char*>(buf), buf_len, flags);
+  int ret = recv(native_handle_, reinterpret_cast<char*>(buf), buf_len, flags);
+  ReenableSelectEvents(X_FD_READ | X_FD_OOB);
+  return ret;
 }
 
 int XSocket::RecvFrom(uint8_t* buf, uint32_t buf_len, uint32_t flags,
@@ -248,6 +306,7 @@ int XSocket::RecvFrom(uint8_t* buf, uint32_t buf_len, uint32_t flags,
 
   int ret = recvfrom(native_handle_, reinterpret_cast<char*>(buf), buf_len,
                      flags, from ? &sa : nullptr, (int*)from_len);
+  ReenableSelectEvents(X_FD_READ | X_FD_OOB);
 
   if (from) {
     from->to_guest(&sa);
@@ -256,139 +315,97 @@ int XSocket::RecvFrom(uint8_t* buf, uint32_t buf_len, uint32_t flags,
   return ret;
 }
 
-struct WSARecvFromData {
-  XWSABUF* buffers;
-  uint32_t num_buffers;
-  uint32_t flags;
-  XSOCKADDR_IN* from;
-  xe::be<uint32_t>* from_len;
-  XWSAOVERLAPPED* overlapped;
-};
-
-int XSocket::PollWSARecvFrom(bool wait, WSARecvFromData receive_async_data) {
-  receive_async_data.overlapped->internal_high = 0;
+int XSocket::TryWSARecvFrom(const XWSABUF* buffers, uint32_t num_buffers,
+                            uint32_t flags, XSOCKADDR_IN* from,
+                            xe::be<uint32_t>* from_len,
+                            XWSAOVERLAPPED* overlapped) {
+  overlapped->internal_high = 0;
 
   struct pollfd fds[1];
   fds->fd = native_handle_;
   fds->events = POLLIN;
 
-  DWORD bytes_received = 0;
-  DWORD flags = receive_async_data.flags;
-  auto buffers = new WSABUF[receive_async_data.num_buffers];
-
-  int ret;
-  do {
 #ifdef XE_PLATFORM_WIN32
-    ret = WSAPoll(fds, 1, wait ? 1000 : 0);
+  int ret = WSAPoll(fds, 1, 0);
 #else
-    ret = poll(fds, 1, wait ? 1000 : 0);
+  int ret = poll(fds, 1, 0);
 #endif
 
-    if (receive_async_data.overlapped->offset_high & 2) {
-      receive_async_data.overlapped->internal_high =
-          (uint32_t)X_WSAError::X_WSA_OPERATION_ABORTED;
-      ret = -1;
-      goto threadexit;
-    }
-  } while (ret == 0 && wait);
-
   if (ret < 0) {
-    receive_async_data.overlapped->internal_high = WSAGetLastError();
-    XELOGE("XSocket receive thread failed polling with error {}",
-           static_cast<uint32_t>(receive_async_data.overlapped->internal_high));
-    goto threadexit;
+    overlapped->internal_high = GetLastWSAError();
+    XELOGE("XSocket receive failed polling with error {}",
+           static_cast<uint32_t>(overlapped->internal_high));
+    return -1;
   } else if (ret == 0) {
-    receive_async_data.overlapped->internal_high =
-        (uint32_t)X_WSAError::X_WSAEWOULDBLOCK;
-    ret = -1;
-    goto threadexit;
+    overlapped->internal_high = (uint32_t)X_WSAError::X_WSAEWOULDBLOCK;
+    return -1;
   }
 
+  sockaddr addr = {};
+
 #ifdef XE_PLATFORM_WIN32
-  for (auto i = 0u; i < receive_async_data.num_buffers; i++) {
-    buffers[i].len = receive_async_data.buffers[i].len;
-    buffers[i].buf =
+  std::vector<WSABUF> host_buffers(num_buffers);
+  for (auto i = 0u; i < num_buffers; i++) {
+    host_buffers[i].len = buffers[i].len;
+    host_buffers[i].buf =
         reinterpret_cast<CHAR*>(kernel_state()->memory()->TranslateVirtual(
-            receive_async_data.buffers[i].buf_ptr));
+            buffers[i].buf_ptr));
   }
 
+  int addr_len = sizeof(addr);
+  DWORD bytes_received = 0;
+  DWORD host_flags = flags;
   {
     std::unique_lock socket_lock(receive_socket_mutex_);
-
-    sockaddr* sa = nullptr;
-    if (receive_async_data.from) {
-      sockaddr addr = receive_async_data.from->to_host();
-      sa = const_cast<sockaddr*>(&addr);
-    }
-
-    ret = ::WSARecvFrom(native_handle_, buffers, receive_async_data.num_buffers,
-                        &bytes_received, &flags, sa,
-                        (LPINT)receive_async_data.from_len, nullptr, nullptr);
-    if (ret < 0) {
-      receive_async_data.overlapped->internal_high = GetLastWSAError();
-    } else {
-      receive_async_data.overlapped->internal = bytes_received;
-    }
-    receive_async_data.from->to_guest(sa);
-    socket_lock.unlock();
+    ret = ::WSARecvFrom(native_handle_, host_buffers.data(), num_buffers,
+                        &bytes_received, &host_flags, from ? &addr : nullptr,
+                        from ? &addr_len : nullptr, nullptr, nullptr);
+  }
+  if (ret < 0) {
+    overlapped->internal_high = GetLastWSAError();
+    return -1;
   }
 
-  receive_async_data.overlapped->offset = flags;
+  overlapped->internal = bytes_received;
+  overlapped->offset = host_flags;
 #else
-  auto buffers = new iovec[receive_async_data.num_buffers];
-  for (auto i = 0u; i < receive_async_data.num_buffers; i++) {
-    buffers[i].iov_len = receive_async_data.buffers[i].len;
-    buffers[i].iov_base = kernel_state()->memory()->TranslateVirtual(
-        receive_async_data.buffers[i].buf_ptr);
+  std::vector<iovec> host_buffers(num_buffers);
+  for (auto i = 0u; i < num_buffers; i++) {
+    host_buffers[i].iov_len = buffers[i].len;
+    host_buffers[i].iov_base =
+        kernel_state()->memory()->TranslateVirtual(buffers[i].buf_ptr);
   }
 
   msghdr msg;
   std::memset(&msg, 0, sizeof(msg));
-  msg.msg_name = &n_from;
-  msg.msg_namelen = n_from_len;
-  msg.msg_iov = buffers;
-  msg.msg_iovlen = receive_async_data.num_buffers;
+  msg.msg_name = from ? &addr : nullptr;
+  msg.msg_namelen = from ? sizeof(addr) : 0;
+  msg.msg_iov = host_buffers.data();
+  msg.msg_iovlen = num_buffers;
 
   {
     std::unique_lock socket_lock(receive_socket_mutex_);
-    ret = recvmsg(native_handle_, &msg, receive_async_data.flags);
-    if (ret < 0) {
-      receive_async_data.overlapped->internal_high = GetLastWSAError();
-    } else {
-      receive_async_data.overlapped->internal = ret;
-    }
-    socket_lock.unlock();
-  }
-
-  flags = 0;
-  if (msg.msg_flags & MSG_TRUNC) flags |= MSG_PARTIAL;
-  if (msg.msg_flags & MSG_OOB) flags |= MSG_OOB;
-  receive_async_data.overlapped->offset = flags;
-
-  if (ret >= 0) {
-    SetLastWSAError((X_WSAError)0);
-    ret = 0;
+    ret = recvmsg(native_handle_, &msg, flags);
   }
-#endif
-  delete[] buffers;
-
-threadexit:
-  std::unique_lock lock(receive_mutex_);
-  if (wait) {
-    delete[] receive_async_data.buffers;
+  if (ret < 0) {
+    overlapped->internal_high = GetLastWSAError();
+    return -1;
   }
 
-  receive_async_data.overlapped->offset_high |= 1;
+  overlapped->internal = ret;
+  uint32_t out_flags = 0;
+  if (msg.msg_flags & MSG_TRUNC) out_flags |= kMsgPartial;
+  if (msg.msg_flags & MSG_OOB) out_flags |= MSG_OOB;
+  overlapped->offset = out_flags;
+  int addr_len = int(msg.msg_namelen);
+#endif
 
-  if (wait && receive_async_data.overlapped->event_handle) {
-    xboxkrnl::xeNtSetEvent(receive_async_data.overlapped->event_handle,
-                           nullptr);
+  if (from) {
+    from->to_guest(&addr);
+    *from_len = addr_len;
   }
 
-  receive_cv_.notify_all();
-  lock.unlock();
-
-  return ret;
+  return 0;
 }
 
 int XSocket::WSARecvFrom(XWSABUF* buffers, uint32_t num_buffers,
@@ -406,62 +423,99 @@ int XSocket::WSARecvFrom(XWSABUF* buffers, uint32_t num_buffers,
   // relying on the caller to set the "alertable" flag to true when waiting. We
   // also need to do our own async handling anyway for Linux so we might as well
   // make the code paths the same to improve symmetry in behaviour.
+  // Receives that can't complete right away are handed to the kernel socket
+  // reactor, which finishes them as soon as data arrives.
 
-  WSARecvFromData receive_async_data;
-  receive_async_data.buffers = buffers;
-  receive_async_data.num_buffers = num_buffers;
-  receive_async_data.flags = *flags_ptr;
-  receive_async_data.from = from_ptr;
-  receive_async_data.from_len = fromlen_ptr;
+  ReenableSelectEvents(X_FD_READ | X_FD_OOB);
 
   XWSAOVERLAPPED tmp_overlapped;
   std::memset(&tmp_overlapped, 0, sizeof(tmp_overlapped));
-  receive_async_data.overlapped =
+  XWSAOVERLAPPED* overlapped =
       overlapped_ptr ? overlapped_ptr : &tmp_overlapped;
 
-  int ret = PollWSARecvFrom(false, receive_async_data);
-
-  if (ret < 0) {
-    auto wsa_error = receive_async_data.overlapped->internal_high.get();
-    SetLastWSAError((X_WSAError)wsa_error);
-
-    if (overlapped_ptr && wsa_error == (uint32_t)X_WSAError::X_WSAEWOULDBLOCK) {
-      receive_mutex_.lock();
-
-      if (!active_overlapped_ || active_overlapped_->offset_high & 1) {
-        // These may have been on the stack - copy them.
-        receive_async_data.buffers = new XWSABUF[num_buffers];
-        std::memcpy(receive_async_data.buffers, buffers,
-                    num_buffers * sizeof(XWSABUF));
-
-        overlapped_ptr->offset_high = 0;
-        if (overlapped_ptr->event_handle) {
-          xboxkrnl::xeNtClearEvent(overlapped_ptr->event_handle);
-        }
-        active_overlapped_ = overlapped_ptr;
-
-        if (!polling_task_.valid()) {
-          polling_task_ =
-              std::async(std::launch::async, &XSocket::PollWSARecvFrom, this,
-                         true, receive_async_data);
-        } else {
-          auto status = polling_task_.wait_for(0ms);
-          if (status == std::future_status::ready) {
-            auto result = polling_task_.get();
-          }
-        }
-        SetLastWSAError(X_WSAError::X_WSA_IO_PENDING);
-      }
+  std::unique_lock lock(overlapped_mutex_);
+  int ret = TryWSARecvFrom(buffers, num_buffers, *flags_ptr, from_ptr,
+                           fromlen_ptr, overlapped);
 
-      receive_mutex_.unlock();
-    }
-  } else {
+  if (ret >= 0) {
     if (num_bytes_recv_ptr) {
-      *num_bytes_recv_ptr = receive_async_data.overlapped->internal;
+      *num_bytes_recv_ptr = overlapped->internal;
     }
-    *flags_ptr = receive_async_data.overlapped->offset;
+    *flags_ptr = overlapped->offset;
+    SignalOverlapped(overlapped);
+    return ret;
+  }
+
+  auto wsa_error = overlapped->internal_high.get();
+  SetLastWSAError((X_WSAError)wsa_error);
+  if (!overlapped_ptr ||
+      wsa_error != (uint32_t)X_WSAError::X_WSAEWOULDBLOCK) {
+    overlapped->offset_high |= 1;
+    return ret;
+  }
+
+  // Only a single overlapped receive may be outstanding.
+  if (pending_receive_ || !EnsureReactorRegistration()) {
+    return ret;
+  }
+
+  overlapped_ptr->offset_high = 0;
+  if (overlapped_ptr->event_handle) {
+    xboxkrnl::xeNtClearEvent(overlapped_ptr->event_handle);
   }
 
+  pending_receive_ = PendingReceive{
+      std::vector<XWSABUF>(buffers, buffers + num_buffers),
+      *flags_ptr,
+      from_ptr,
+      fromlen_ptr,
+      overlapped_ptr,
+  };
+  ArmReactor();
+
+  SetLastWSAError(X_WSAError::X_WSA_IO_PENDING);
+  return ret;
+}
+
+int XSocket::WSASendTo(std::vector<uint8_t> buffer, uint32_t flags,
+                       XSOCKADDR_IN* to, uint32_t to_len,
+                       XWSAOVERLAPPED* overlapped_ptr) {
+  int ret = SendTo(buffer.data(), uint32_t(buffer.size()), flags, to, to_len);
+  bool would_block = ret < 0 && IsLastErrorWouldBlock();
+  uint32_t wsa_error = ret < 0 ? GetLastWSAError() : 0;
+
+  if (!overlapped_ptr) {
+    return ret;
+  }
+
+  std::unique_lock lock(overlapped_mutex_);
+  if (ret >= 0) {
+    overlapped_ptr->internal = ret;
+    overlapped_ptr->internal_high = 0;
+    overlapped_ptr->offset = 0;
+    SignalOverlapped(overlapped_ptr);
+    return ret;
+  }
+
+  // Only a single overlapped send may be outstanding.
+  if (!would_block || pending_send_ || !EnsureReactorRegistration()) {
+    SetLastWSAError((X_WSAError)wsa_error);
+    return ret;
+  }
+
+  overlapped_ptr->offset_high = 0;
+  if (overlapped_ptr->event_handle) {
+    xboxkrnl::xeNtClearEvent(overlapped_ptr->event_handle);
+  }
+
+  // SendTo has already applied the port mapping to the guest address.
+  pending_send_ = PendingSend{
+      std::move(buffer), flags, to ? to->to_host() : sockaddr{},
+      to_len,            to != nullptr, overlapped_ptr,
+  };
+  ArmReactor();
+
+  SetLastWSAError(X_WSAError::X_WSA_IO_PENDING);
   return ret;
 }
 
@@ -473,10 +527,12 @@ bool XSocket::WSAGetOverlappedResult(XWSAOVERLAPPED* overlapped_ptr,
     return false;
   }
 
-  std::unique_lock lock(receive_mutex_);
+  std::unique_lock lock(overlapped_mutex_);
   if (!(overlapped_ptr->offset_high & 1)) {
     if (wait) {
-      receive_cv_.wait(lock);
+      overlapped_cv_.wait(lock, [overlapped_ptr]() {
+        return (overlapped_ptr->offset_high & 1) != 0;
+      });
     } else {
       SetLastWSAError(X_WSAError::X_WSA_IO_INCOMPLETE);
       return false;
@@ -485,21 +541,21 @@ bool XSocket::WSAGetOverlappedResult(XWSAOVERLAPPED* overlapped_ptr,
 
   if (overlapped_ptr->internal_high != 0) {
     SetLastWSAError((X_WSAError)overlapped_ptr->internal_high.get());
-    active_overlapped_ = nullptr;
     return false;
   }
 
   *bytes_transferred = overlapped_ptr->internal;
   *flags_ptr = overlapped_ptr->offset;
 
-  active_overlapped_ = nullptr;
-
   return true;
 }
-
 int XSocket::Send(const uint8_t* buf, uint32_t buf_len, uint32_t flags) {
-  return send(native_handle_, reinterpret_cast<const char*>(buf), buf_len,
-              flags);
+  int ret =
+      send(native_handle_, reinterpret_cast<const char*>(buf), buf_len, flags);
+  if (ret < 0 && IsLastErrorWouldBlock()) {
+    ReenableSelectEvents(X_FD_WRITE);
+  }
+  return ret;
 }
 
 int XSocket::SendTo(uint8_t* buf, uint32_t buf_len, uint32_t flags,
@@ -509,14 +565,146 @@ int XSocket::SendTo(uint8_t* buf, uint32_t buf_len, uint32_t flags,
 
   sockaddr addr = to->to_host();
 
-  return sendto(native_handle_, reinterpret_cast<char*>(buf), buf_len, flags,
-                to ? &addr : nullptr, to_len);
+  int ret = sendto(native_handle_, reinterpret_cast<char*>(buf), buf_len,
+                   flags, to ? &addr : nullptr, to_len);
+  if (ret < 0 && IsLastErrorWouldBlock()) {
+    ReenableSelectEvents(X_FD_WRITE);
+  }
+  return ret;
+}
+
+int XSocket::WSAEventSelect(object_ref<XEvent> event, uint32_t flags) {
+  // As on Windows, event selection puts the socket into non-blocking mode.
+  if (flags && !SetNonBlocking(true)) {
+    return -1;
+  }
+
+  std::unique_lock lock(overlapped_mutex_);
+  if (flags && !EnsureReactorRegistration()) {
+    SetLastWSAError(X_WSAError::X_WSAENETDOWN);
+    return -1;
+  }
+  select_event_ = flags ? std::move(event) : object_ref<XEvent>();
+  select_events_ = flags;
+  select_enabled_events_ = flags;
+  ArmReactor();
+  return 0;
 }
 
-int XSocket::WSAEventSelect(uint64_t socket_handle, uint64_t event_handle,
-                            uint32_t flags) {
-  return ::WSAEventSelect(socket_handle, reinterpret_cast<HANDLE>(event_handle),
-                          flags);
+bool XSocket::SetNonBlocking(bool non_blocking) {
+#ifdef XE_PLATFORM_WIN32
+  u_long value = non_blocking ? 1 : 0;
+  return ioctlsocket(native_handle_, FIONBIO, &value) == 0;
+#else
+  int flags = fcntl(int(native_handle_), F_GETFL, 0);
+  if (flags == -1) {
+    return false;
+  }
+  flags = non_blocking ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+  return fcntl(int(native_handle_), F_SETFL, flags) == 0;
+#endif
+}
+
+bool XSocket::EnsureReactorRegistration() {
+  if (reactor_) {
+    return true;
+  }
+  SocketReactor* reactor = kernel_state()->socket_reactor();
+  if (!reactor ||
+      !reactor->Register(native_handle_,
+                         [this](uint32_t events) { OnReactorEvents(events); })) {
+    XELOGE("XSocket: failed to register socket with the reactor");
+    return false;
+  }
+  reactor_ = reactor;
+  return true;
+}
+
+void XSocket::ArmReactor() {
+  if (!reactor_) {
+    return;
+  }
+  uint32_t events = 0;
+  if (pending_receive_ || (select_enabled_events_ & kSelectReadEvents)) {
+    events |= SocketReactor::kEventReadable;
+  }
+  if (pending_send_ || (select_enabled_events_ & kSelectWriteEvents)) {
+    events |= SocketReactor::kEventWritable;
+  }
+  if (events) {
+    reactor_->Arm(native_handle_, events);
+  }
+}
+
+void XSocket::SignalOverlapped(XWSAOVERLAPPED* overlapped) {
+  overlapped->offset_high |= 1;
+  if (overlapped->event_handle) {
+    xboxkrnl::xeNtSetEvent(overlapped->event_handle, nullptr);
+  }
+  overlapped_cv_.notify_all();
+}
+
+void XSocket::ReenableSelectEvents(uint32_t events) {
+  std::unique_lock lock(overlapped_mutex_);
+  events &= select_events_ & ~select_enabled_events_;
+  if (!events) {
+    return;
+  }
+  select_enabled_events_ |= events;
+  // Don't clobber the error of the socket call that re-enabled the events.
+  uint32_t last_error = GetLastWSAError();
+  ArmReactor();
+  SetLastWSAError(X_WSAError(last_error));
+}
+
+void XSocket::OnReactorEvents(uint32_t events) {
+  std::unique_lock lock(overlapped_mutex_);
+  uint32_t network_events = 0;
+
+  if (events & (SocketReactor::kEventReadable | SocketReactor::kEventError)) {
+    if (pending_receive_) {
+      PendingReceive& receive = *pending_receive_;
+      int ret = TryWSARecvFrom(
+          receive.buffers.data(), uint32_t(receive.buffers.size()),
+          receive.flags, receive.from, receive.from_len, receive.overlapped);
+      // Spurious wake-ups leave the receive pending.
+      if (ret >= 0 || receive.overlapped->internal_high !=
+                          uint32_t(X_WSAError::X_WSAEWOULDBLOCK)) {
+        SignalOverlapped(receive.overlapped);
+        pending_receive_.reset();
+      }
+    }
+    network_events |= select_enabled_events_ & kSelectReadEvents;
+  }
+
+  if (events & (SocketReactor::kEventWritable | SocketReactor::kEventError)) {
+    if (pending_send_) {
+      PendingSend& send = *pending_send_;
+      int ret = sendto(native_handle_,
+                       reinterpret_cast<const char*>(send.buffer.data()),
+                       int(send.buffer.size()), send.flags,
+                       send.has_to ? &send.to : nullptr,
+                       send.has_to ? int(send.to_len) : 0);
+      if (ret >= 0) {
+        send.overlapped->internal = ret;
+        send.overlapped->offset = 0;
+        SignalOverlapped(send.overlapped);
+        pending_send_.reset();
+      } else if (!IsLastErrorWouldBlock()) {
+        send.overlapped->internal_high = GetLastWSAError();
+        SignalOverlapped(send.overlapped);
+        pending_send_.reset();
+      }
+    }
+    network_events |= select_enabled_events_ & kSelectWriteEvents;
+  }
+
+  if (network_events) {
+    select_enabled_events_ &= ~network_events;
+    select_event_->Set(0, false);
+  }
+
+  ArmReactor();
 }
 
 bool XSocket::QueuePacket(uint32_t src_ip, uint16_t src_port,
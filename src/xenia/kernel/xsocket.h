@@ -10,11 +10,15 @@
 #ifndef XENIA_KERNEL_XSOCKET_H_
 #define XENIA_KERNEL_XSOCKET_H_
 
+#include <condition_variable>
 #include <cstring>
-#include <future>
+#include <optional>
 #include <queue>
+#include <vector>
 
 #include "xenia/base/byte_order.h"
+#include "xenia/base/socket_reactor.h"
+#include "xenia/kernel/xevent.h"
 #include "xenia/kernel/xobject.h"
 
 #ifdef XE_PLATFORM_WIN32
@@ -117,6 +121,16 @@ class XSocket : public XObject {
     X_IPPROTO_VDP = 254,
   };
 
+  // WSAEventSelect network events.
+  enum NetworkEvent : uint32_t {
+    X_FD_READ = 1 << 0,
+    X_FD_WRITE = 1 << 1,
+    X_FD_OOB = 1 << 2,
+    X_FD_ACCEPT = 1 << 3,
+    X_FD_CONNECT = 1 << 4,
+    X_FD_CLOSE = 1 << 5,
+  };
+
   XSocket(KernelState* kernel_state);
   ~XSocket();
 
@@ -148,14 +162,15 @@ class XSocket : public XObject {
   int SendTo(uint8_t* buf, uint32_t buf_len, uint32_t flags, XSOCKADDR_IN* to,
              uint32_t to_len);
 
-  int WSAEventSelect(uint64_t socket_handle, uint64_t event_handle,
-                     uint32_t flags);
+  int WSAEventSelect(object_ref<XEvent> event, uint32_t flags);
 
   int WSARecvFrom(XWSABUF* buffers, uint32_t num_buffers,
                   xe::be<uint32_t>* num_bytes_recv_ptr,
                   xe::be<uint32_t>* flags_ptr, XSOCKADDR_IN* from_ptr,
                   xe::be<uint32_t>* fromlen_ptr,
                   XWSAOVERLAPPED* overlapped_ptr);
+  int WSASendTo(std::vector<uint8_t> buffer, uint32_t flags, XSOCKADDR_IN* to,
+                uint32_t to_len, XWSAOVERLAPPED* overlapped_ptr);
   bool WSAGetOverlappedResult(XWSAOVERLAPPED* overlapped_ptr,
                               xe::be<uint32_t>* bytes_transferred, bool wait,
                               xe::be<uint32_t>* flags_ptr);
@@ -197,14 +212,58 @@ class XSocket : public XObject {
   std::mutex incoming_packet_mutex_;
   std::queue<uint8_t*> incoming_packets_;
 
-  std::future<int> polling_task_;
+  // Overlapped operations waiting for the socket to become ready. Only one of
+  // each may be outstanding at a time.
+  struct PendingReceive {
+    // Copied - the guest may have had them on the stack.
+    std::vector<XWSABUF> buffers;
+    uint32_t flags;
+    XSOCKADDR_IN* from;
+    xe::be<uint32_t>* from_len;
+    XWSAOVERLAPPED* overlapped;
+  };
+  struct PendingSend {
+    std::vector<uint8_t> buffer;
+    uint32_t flags;
+    sockaddr to;
+    uint32_t to_len;
+    bool has_to;
+    XWSAOVERLAPPED* overlapped;
+  };
+
+  // Registered with the kernel socket reactor on the first asynchronous
+  // operation, null before that and after Close.
+  SocketReactor* reactor_ = nullptr;
 
-  std::mutex receive_mutex_;
-  std::condition_variable receive_cv_;
+  // Guards all the overlapped and event selection state below.
+  std::mutex overlapped_mutex_;
+  std::condition_variable overlapped_cv_;
   std::mutex receive_socket_mutex_;
-  XWSAOVERLAPPED* active_overlapped_ = nullptr;
-
-  int PollWSARecvFrom(bool wait, struct WSARecvFromData data);
+  std::optional<PendingReceive> pending_receive_;
+  std::optional<PendingSend> pending_send_;
+
+  object_ref<XEvent> select_event_;
+  uint32_t select_events_ = 0;
+  // Selected events that will signal select_event_ when they next occur. Like
+  // on Windows, an event is disabled once reported and re-enabled by the call
+  // that consumes it (recv for FD_READ, accept for FD_ACCEPT, a blocked send
+  // for FD_WRITE).
+  uint32_t select_enabled_events_ = 0;
+
+  // The overlapped_mutex_ must be held by the callers of these.
+  bool EnsureReactorRegistration();
+  void ArmReactor();
+  void SignalOverlapped(XWSAOVERLAPPED* overlapped);
+
+  // Unregisters from the reactor and aborts outstanding overlapped operations.
+  void CancelPendingOperations(bool signal);
+  void OnReactorEvents(uint32_t events);
+  void ReenableSelectEvents(uint32_t events);
+  bool SetNonBlocking(bool non_blocking);
+
+  int TryWSARecvFrom(const XWSABUF* buffers, uint32_t num_buffers,
+                     uint32_t flags, XSOCKADDR_IN* from,
+                     xe::be<uint32_t>* from_len, XWSAOVERLAPPED* overlapped);
 
   void SetLastWSAError(X_WSAError) const;
 };
@@ -10,8 +10,10 @@
 #include "xenia/kernel/xthread.h"
 
 #include "xenia/base/byte_stream.h"
+#include "xenia/base/clock.h"
 #include "xenia/base/logging.h"
 #include "xenia/base/profiling.h"
+#include "xenia/base/scheduling_policy.h"
 #include "xenia/base/threading.h"
 #include "xenia/cpu/processor.h"
 #include "xenia/emulator.h"
@@ -421,7 +423,9 @@ X_STATUS XThread::Create() {
   }
 
   if (creation_params_.creation_flags & 0x60) {
-    thread_->set_priority(creation_params_.creation_flags & 0x20 ? 1 : 0);
+    thread_->set_priority(creation_params_.creation_flags & 0x20
+                              ? xe::threading::ThreadPriority::kAboveNormal
+                              : xe::threading::ThreadPriority::kNormal);
   }
 
   // Assign the newly created thread to the logical processor, and also set up
@@ -523,6 +527,7 @@ void XThread::Execute() {
               thread_id_, handle(), thread_name_, thread_->system_id());
   // Let the kernel know we are starting.
   kernel_state()->OnThreadExecute(this);
+  emulator()->processor()->OnThreadExecute(thread_id_, thread_name_);
 
   // All threads get a mandatory sleep. This is to deal with some buggy
   // games that are assuming the 360 is so slow to create threads that they
@@ -666,14 +671,21 @@ void XThread::SetActiveCpu(uint8_t cpu_index) {
     thread_object.current_cpu = cpu_index;
   }
 
-  if (xe::threading::logical_processor_count() >= 6) {
-    if (!cvars::ignore_thread_affinities) {
-      thread_->set_affinity_mask(uint64_t(1) << cpu_index);
-    }
-  } else {
-    // there no good reason why we need to log this... we don't perfectly
-    // emulate the 360's scheduler in any way
-    // XELOGW("Too few processor cores - scheduling will be wonky");
+  // The policy leaves the mask 0 if there are too few host processors - we
+  // don't perfectly emulate the 360's scheduler in any way anyway.
+  const xe::threading::SchedulingPolicy& policy =
+      xe::threading::SchedulingPolicy::Get();
+  uint64_t affinity_mask = 0;
+  if (service_thread_) {
+    affinity_mask = policy.service_thread_affinity();
+  }
+  // Without isolation, service threads stay on the processor of their
+  // hardware thread like guest threads.
+  if (!affinity_mask && !cvars::ignore_thread_affinities) {
+    affinity_mask = policy.hardware_thread_affinity(cpu_index);
+  }
+  if (affinity_mask) {
+    thread_->set_affinity_mask(affinity_mask);
   }
 }
 
@@ -701,6 +713,51 @@ uint32_t XThread::suspend_count() {
   return guest_object<X_KTHREAD>()->suspend_count;
 }
 
+void XThread::QueryStatistics(XThreadStatistics& statistics_out) {
+  statistics_out = XThreadStatistics();
+  statistics_out.thread_id = thread_id_;
+  statistics_out.name = name();
+  statistics_out.is_guest_thread = guest_thread_;
+  statistics_out.priority = priority_;
+  if (pcr_address_) {
+    statistics_out.active_cpu = active_cpu();
+  }
+  if (guest_object()) {
+    statistics_out.suspend_count = suspend_count();
+  }
+
+  xe::threading::Thread::CpuStatistics cpu_statistics;
+  if (thread_ && running_ && thread_->QueryCpuStatistics(cpu_statistics)) {
+    statistics_out.cpu_time_ns = cpu_statistics.cpu_time_ns;
+    statistics_out.voluntary_context_switches =
+        cpu_statistics.voluntary_context_switches;
+    statistics_out.involuntary_context_switches =
+        cpu_statistics.involuntary_context_switches;
+  }
+
+  uint64_t wait_host_ticks = wait_host_ticks_.load(std::memory_order_relaxed);
+  uint64_t host_tick_frequency = Clock::QueryHostTickFrequency();
+  statistics_out.wait_time_ns =
+      wait_host_ticks / host_tick_frequency * 1000000000 +
+      wait_host_ticks % host_tick_frequency * 1000000000 / host_tick_frequency;
+  statistics_out.wait_count = wait_count_.load(std::memory_order_relaxed);
+  statistics_out.apc_count = apc_count_.load(std::memory_order_relaxed);
+}
+
+XThread::WaitAccounting::WaitAccounting()
+    : thread_(current_xthread_tls_),
+      start_host_tick_(thread_ ? Clock::QueryHostTickCount() : 0) {}
+
+XThread::WaitAccounting::~WaitAccounting() {
+  if (!thread_) {
+    return;
+  }
+  thread_->wait_host_ticks_.fetch_add(
+      Clock::QueryHostTickCount() - start_host_tick_,
+      std::memory_order_relaxed);
+  thread_->wait_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
 X_STATUS XThread::Resume(uint32_t* out_suspend_count) {
   auto guest_thread = guest_object<X_KTHREAD>();
 
@@ -761,6 +818,7 @@ X_STATUS XThread::Delay(uint32_t processor_mode, uint32_t alertable,
     }
   }
   timeout_ms = Clock::ScaleGuestDurationMillis(timeout_ms);
+  WaitAccounting wait_accounting;
   if (alertable) {
     auto result =
         xe::threading::AlertableSleep(std::chrono::milliseconds(timeout_ms));
@@ -262,6 +262,25 @@ struct X_KTHREAD {
 };
 static_assert_size(X_KTHREAD, 0xAB0);
 
+// Host resource usage and kernel scheduling counters of a thread, see
+// KernelState::QueryThreadStatistics.
+struct XThreadStatistics {
+  uint32_t thread_id = 0;
+  std::string name;
+  bool is_guest_thread = false;
+  int32_t priority = 0;
+  uint8_t active_cpu = 0;
+  uint32_t suspend_count = 0;
+  // From the host, see xe::threading::Thread::CpuStatistics.
+  uint64_t cpu_time_ns = 0;
+  uint64_t voluntary_context_switches = 0;
+  uint64_t involuntary_context_switches = 0;
+  // Time blocked in kernel object waits and delays, and the number of them.
+  uint64_t wait_time_ns = 0;
+  uint64_t wait_count = 0;
+  uint64_t apc_count = 0;
+};
+
 class XThread : public XObject, public cpu::Thread {
  public:
   static const XObject::Type kObjectType = XObject::Type::Thread;
@@ -303,6 +322,11 @@ class XThread : public XObject, public cpu::Thread {
   bool is_guest_thread() const { return guest_thread_; }
   bool main_thread() const { return main_thread_; }
   bool is_running() const { return running_; }
+  // Host threads doing emulator work (GPU commands, audio) rather than
+  // standing in for a guest thread, placed according to the service thread
+  // scheduling policy. Must be set before Create.
+  bool is_service_thread() const { return service_thread_; }
+  void set_is_service_thread(bool value) { service_thread_ = value; }
 
   uint32_t thread_id() const { return thread_id_; }
   uint32_t last_error();
@@ -349,6 +373,25 @@ class XThread : public XObject, public cpu::Thread {
 
   xe::threading::Thread* thread() { return thread_.get(); }
 
+  // May be called from any thread.
+  void QueryStatistics(XThreadStatistics& statistics_out);
+  // Called on the thread itself when it has run a user APC.
+  void OnApcDelivered() {
+    apc_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Adds the time until destruction to the wait statistics of the calling
+  // thread, if it's an XThread.
+  class WaitAccounting {
+   public:
+    WaitAccounting();
+    ~WaitAccounting();
+
+   private:
+    XThread* thread_;
+    uint64_t start_host_tick_;
+  };
+
   virtual bool Save(ByteStream* stream) override;
   static object_ref<XThread> Restore(KernelState* kernel_state,
                                      ByteStream* stream);
@@ -384,9 +427,15 @@ class XThread : public XObject, public cpu::Thread {
   uint32_t stack_limit_ = 0;       // Low address
   bool guest_thread_ = false;
   bool main_thread_ = false;  // Entry-point thread
+  bool service_thread_ = false;
   bool running_ = false;
 
   int32_t priority_ = 0;
+
+  // Updated by the thread itself, read by QueryStatistics.
+  std::atomic<uint64_t> wait_host_ticks_ = 0;
+  std::atomic<uint64_t> wait_count_ = 0;
+  std::atomic<uint64_t> apc_count_ = 0;
 };
 
 class XHostThread : public XThread {
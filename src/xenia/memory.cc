@@ -33,6 +33,13 @@ DEFINE_bool(protect_on_release, false,
             "Protect released memory to prevent accesses.", "Memory");
 DEFINE_bool(scribble_heap, false,
             "Scribble 0xCD into all allocated heap memory.", "Memory");
+DEFINE_bool(
+    host_large_pages, false,
+    "Back guest memory with 2 MB host pages where possible to reduce TLB "
+    "misses. Host memory is then committed 2 MB at a time. On Linux, this "
+    "needs /sys/kernel/mm/transparent_hugepage/shmem_enabled to be set to "
+    "advise.",
+    "Memory");
 
 namespace xe {
 uint32_t get_page_count(uint32_t value, uint32_t page_size) {
@@ -144,7 +151,8 @@ bool Memory::Initialize() {
   mapping_ = xe::memory::CreateFileMappingHandle(
       file_name_,
       // entire 4gb space + 512mb physical:
-      0x11FFFFFFF, xe::memory::PageAccess::kReadWrite, false);
+      0x11FFFFFFF, xe::memory::PageAccess::kReadWrite, false,
+      cvars::host_large_pages);
   if (mapping_ == xe::memory::kFileMappingHandleInvalid) {
     XELOGE("Unable to reserve the 4gb guest address space.");
     assert_always();
@@ -169,6 +177,18 @@ bool Memory::Initialize() {
   virtual_membase_ = mapping_base_;
   physical_membase_ = mapping_base_ + 0x100000000ull;
 
+  if (cvars::host_large_pages) {
+    size_t large_page_size = xe::memory::large_page_size();
+    if (large_page_size) {
+      XELOGI("Guest memory is backed by {} KB host pages where possible",
+             large_page_size / 1024);
+    } else {
+      XELOGW(
+          "Large host pages were requested for guest memory, but the host "
+          "doesn't provide them for shared memory");
+    }
+  }
+
   // Prepare virtual heaps.
   heaps_.v00000000.Initialize(this, virtual_membase_, HeapType::kGuestVirtual,
                               0x00000000, 0x40000000, 4096);
@@ -329,10 +349,64 @@ int Memory::MapViews(uint8_t* mapping_base) {
       UnmapViews();
       return 1;
     }
+    // The mapping base is 4 GB-aligned, so all views but the 0xE0000000 one,
+    // which is offset by 4 KB, line up with the large pages of the mapping.
+    if (cvars::host_large_pages) {
+      xe::memory::AdviseLargePages(views_.all_views[n],
+                                   map_info[n].virtual_address_end -
+                                       map_info[n].virtual_address_start + 1);
+    }
   }
   return 0;
 }
 
+bool Memory::MapSharedImage(uint32_t address, uint32_t length,
+                            const std::filesystem::path& path,
+                            size_t file_offset) {
+  // Physical memory is also visible through the virtual ranges mapped to it,
+  // so only images in XEX heaps can have their own backing. The 0x80000000 and
+  // 0x90000000 XEX views alias each other too, but two private file mappings
+  // can't share written pages, so only the view at the load address is
+  // replaced. The image is only accessed at that address, and the other XEX
+  // heap using the aliased range would overwrite the image even without a
+  // shared mapping, so the two views only differ in ranges that are never
+  // read through both.
+  const BaseHeap* heap = LookupHeap(address);
+  if (!heap || heap->heap_type() != HeapType::kGuestXex || !length) {
+    return false;
+  }
+  size_t host_page_size = xe::memory::page_size();
+  if ((address | file_offset) & (host_page_size - 1)) {
+    return false;
+  }
+  return xe::memory::MapFileViewCopyOnWrite(
+      path, TranslateVirtual(address), xe::round_up(length, host_page_size),
+      xe::memory::PageAccess::kReadWrite, file_offset);
+}
+
+void Memory::UnmapSharedImage(uint32_t address, uint32_t length) {
+  for (size_t n = 0; n < xe::countof(map_info); n++) {
+    if (address < map_info[n].virtual_address_start ||
+        address > map_info[n].virtual_address_end) {
+      continue;
+    }
+    size_t host_length = xe::round_up(size_t(length), xe::memory::page_size());
+    if (!xe::memory::RestoreFileView(
+            mapping_, TranslateVirtual(address), host_length,
+            xe::memory::PageAccess::kReadWrite,
+            map_info[n].target_address +
+                (address - map_info[n].virtual_address_start))) {
+      XELOGE(
+          "Failed to restore the guest memory at {:08X} after a shared image",
+          address);
+    } else if (cvars::host_large_pages) {
+      // The restored pages are a new host mapping without the advice.
+      xe::memory::AdviseLargePages(TranslateVirtual(address), host_length);
+    }
+    return;
+  }
+}
+
 void Memory::UnmapViews() {
   for (size_t n = 0; n < xe::countof(views_.all_views); n++) {
     if (views_.all_views[n]) {
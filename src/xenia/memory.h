@@ -11,6 +11,7 @@
 #define XENIA_MEMORY_H_
 
 #include <cstdint>
+#include <filesystem>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -528,6 +529,15 @@ class Memory {
   // Gets the physical base heap.
   VirtualHeap* GetPhysicalHeap();
 
+  // Backs an allocated range of an XEX heap with a copy-on-write view of a
+  // file containing the image at file_offset, so pages that are never written
+  // are shared by all processes running the same image. Returns false without
+  // changing the range if not possible on the host.
+  bool MapSharedImage(uint32_t address, uint32_t length,
+                      const std::filesystem::path& path, size_t file_offset);
+  // Gives a range mapped with MapSharedImage its private backing back.
+  void UnmapSharedImage(uint32_t address, uint32_t length);
+
   void GetHeapsPageStatsSummary(const BaseHeap* const* provided_heaps,
                                 size_t heaps_count, uint32_t& unreserved_pages,
                                 uint32_t& reserved_pages, uint32_t& used_pages,
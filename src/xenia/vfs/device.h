@@ -42,9 +42,18 @@ class Device {
   virtual uint32_t sectors_per_allocation_unit() const = 0;
   virtual uint32_t bytes_per_sector() const = 0;
 
+  // Changed whenever entries are created, deleted or renamed, so paths
+  // resolved earlier can be revalidated. Accessed within the global critical
+  // region.
+  uint64_t entries_generation() const { return entries_generation_; }
+  void InvalidateEntries() { ++entries_generation_; }
+
  protected:
   xe::global_critical_region global_critical_region_;
   std::string mount_path_;
+
+ private:
+  uint64_t entries_generation_ = 0;
 };
 
 }  // namespace vfs
@@ -9,12 +9,25 @@
 
 #include "xenia/vfs/devices/host_path_device.h"
 
+#if XE_PLATFORM_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif  // XE_PLATFORM_LINUX
+
+#include "xenia/base/cvar.h"
 #include "xenia/base/filesystem.h"
 #include "xenia/base/logging.h"
 #include "xenia/base/math.h"
+#include "xenia/base/string.h"
+#include "xenia/base/utf8.h"
 #include "xenia/kernel/xfile.h"
 #include "xenia/vfs/devices/host_path_entry.h"
 
+DEFINE_bool(watch_host_path_changes, false,
+            "Add files created on the host to mounted host directories that "
+            "have already been listed (Linux only).",
+            "Storage");
+
 namespace xe {
 namespace vfs {
 
@@ -26,7 +39,15 @@ HostPathDevice::HostPathDevice(const std::string_view mount_path,
       host_path_(host_path),
       read_only_(read_only) {}
 
-HostPathDevice::~HostPathDevice() = default;
+HostPathDevice::~HostPathDevice() {
+  // The entries unregister their watches when destroyed.
+  root_entry_.reset();
+#if XE_PLATFORM_LINUX
+  if (inotify_fd_ >= 0) {
+    close(inotify_fd_);
+  }
+#endif  // XE_PLATFORM_LINUX
+}
 
 bool HostPathDevice::Initialize() {
   if (!std::filesystem::exists(host_path_)) {
@@ -39,10 +60,20 @@ bool HostPathDevice::Initialize() {
     }
   }
 
+#if XE_PLATFORM_LINUX
+  if (cvars::watch_host_path_changes) {
+    inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd_ < 0) {
+      XELOGW("Failed to watch host path {} for changes", host_path_);
+    }
+  }
+#endif  // XE_PLATFORM_LINUX
+
+  // The directories are listed when first accessed, so large trees don't need
+  // to be walked before the title starts.
   auto root_entry = new HostPathEntry(this, nullptr, "", host_path_);
   root_entry->attributes_ = kFileAttributeDirectory;
   root_entry_ = std::unique_ptr<Entry>(root_entry);
-  PopulateEntry(root_entry);
 
   return true;
 }
@@ -61,17 +92,88 @@ Entry* HostPathDevice::ResolvePath(const std::string_view path) {
 }
 
 void HostPathDevice::PopulateEntry(HostPathEntry* parent_entry) {
+#if XE_PLATFORM_LINUX
+  // Watch before listing so files created in between aren't missed.
+  if (inotify_fd_ >= 0) {
+    int watch_descriptor = inotify_add_watch(
+        inotify_fd_, parent_entry->host_path().c_str(),
+        IN_CREATE | IN_MOVED_TO | IN_ONLYDIR);
+    if (watch_descriptor >= 0) {
+      watched_entries_[watch_descriptor] = parent_entry;
+    }
+  }
+#endif  // XE_PLATFORM_LINUX
+
   auto child_infos = xe::filesystem::ListFiles(parent_entry->host_path());
+  parent_entry->children_.reserve(parent_entry->children_.size() +
+                                  child_infos.size());
   for (auto& child_info : child_infos) {
     auto child = HostPathEntry::Create(
         this, parent_entry, parent_entry->host_path() / child_info.name,
         child_info);
     parent_entry->children_.push_back(std::unique_ptr<Entry>(child));
+  }
+}
 
-    if (child_info.type == xe::filesystem::FileInfo::Type::kDirectory) {
-      PopulateEntry(child);
+void HostPathDevice::ProcessHostChanges() {
+#if XE_PLATFORM_LINUX
+  if (inotify_fd_ < 0) {
+    return;
+  }
+  alignas(inotify_event) char buffer[4096];
+  while (true) {
+    ssize_t length = read(inotify_fd_, buffer, sizeof(buffer));
+    if (length <= 0) {
+      break;
+    }
+    for (ssize_t offset = 0; offset < length;) {
+      auto event = reinterpret_cast<const inotify_event*>(buffer + offset);
+      offset += sizeof(inotify_event) + event->len;
+      auto it = watched_entries_.find(event->wd);
+      if (it == watched_entries_.end() || !event->len) {
+        continue;
+      }
+      HostPathEntry* parent_entry = it->second;
+      std::string_view name(event->name);
+      // Possibly already created through the VFS itself. Not using GetChild
+      // as it processes the changes.
+      bool exists = false;
+      for (const auto& child : parent_entry->children_) {
+        if (xe::utf8::equal_case(child->name(), name)) {
+          exists = true;
+          break;
+        }
+      }
+      if (exists) {
+        continue;
+      }
+      auto full_path = parent_entry->host_path() / xe::to_path(name);
+      auto child_info = xe::filesystem::GetInfo(full_path);
+      if (!child_info) {
+        continue;
+      }
+      parent_entry->children_.push_back(std::unique_ptr<Entry>(
+          HostPathEntry::Create(this, parent_entry, full_path, *child_info)));
+      XELOGFS("HostPathDevice: {} created on the host", full_path);
+    }
+  }
+#endif  // XE_PLATFORM_LINUX
+}
+
+void HostPathDevice::UnwatchEntry(HostPathEntry* entry) {
+#if XE_PLATFORM_LINUX
+  if (!entry->children_populated_ || inotify_fd_ < 0) {
+    return;
+  }
+  for (auto it = watched_entries_.begin(); it != watched_entries_.end();
+       ++it) {
+    if (it->second == entry) {
+      inotify_rm_watch(inotify_fd_, it->first);
+      watched_entries_.erase(it);
+      break;
     }
   }
+#endif  // XE_PLATFORM_LINUX
 }
 
 }  // namespace vfs
@@ -11,7 +11,9 @@
 #define XENIA_VFS_DEVICES_HOST_PATH_DEVICE_H_
 
 #include <string>
+#include <unordered_map>
 
+#include "xenia/base/platform.h"
 #include "xenia/vfs/device.h"
 
 namespace xe {
@@ -45,12 +47,24 @@ class HostPathDevice : public Device {
   std::filesystem::path host_path() const { return host_path_; }
 
  private:
+  // Creates the entries for the contents of a directory, without recursing
+  // into the subdirectories, which are populated when accessed.
   void PopulateEntry(HostPathEntry* parent_entry);
+  // Adds the files created on the host since the directories were populated,
+  // if watching for changes.
+  void ProcessHostChanges();
+  void UnwatchEntry(HostPathEntry* entry);
 
   std::string name_;
   std::filesystem::path host_path_;
   std::unique_ptr<Entry> root_entry_;
   bool read_only_;
+
+#if XE_PLATFORM_LINUX
+  int inotify_fd_ = -1;
+  // Populated directories by their inotify watch descriptors.
+  std::unordered_map<int, HostPathEntry*> watched_entries_;
+#endif  // XE_PLATFORM_LINUX
 };
 
 }  // namespace vfs
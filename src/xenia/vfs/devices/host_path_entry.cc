@@ -26,7 +26,9 @@ HostPathEntry::HostPathEntry(Device* device, Entry* parent,
                              const std::filesystem::path& host_path)
     : Entry(device, parent, path), host_path_(host_path) {}
 
-HostPathEntry::~HostPathEntry() = default;
+HostPathEntry::~HostPathEntry() {
+  static_cast<HostPathDevice*>(device_)->UnwatchEntry(this);
+}
 
 HostPathEntry* HostPathEntry::Create(Device* device, Entry* parent,
                                      const std::filesystem::path& full_path,
@@ -130,6 +132,17 @@ void HostPathEntry::RenameEntryInternal(const std::filesystem::path file_path) {
   host_path_ = new_host_path_;
 }
 
+void HostPathEntry::PopulateChildren() {
+  auto global_lock = global_critical_region_.Acquire();
+  auto device = static_cast<HostPathDevice*>(device_);
+  device->ProcessHostChanges();
+  if (children_populated_ || !(attributes_ & kFileAttributeDirectory)) {
+    return;
+  }
+  children_populated_ = true;
+  device->PopulateEntry(this);
+}
+
 void HostPathEntry::update() {
   auto file_info = xe::filesystem::GetInfo(host_path_);
   if (!file_info) {
@@ -52,8 +52,11 @@ class HostPathEntry : public Entry {
                                              uint32_t attributes) override;
   bool DeleteEntryInternal(Entry* entry) override;
   void RenameEntryInternal(const std::filesystem::path file_path) override;
+  void PopulateChildren() override;
 
   std::filesystem::path host_path_;
+  // Directories are listed when their children are first accessed.
+  bool children_populated_ = false;
 };
 
 }  // namespace vfs
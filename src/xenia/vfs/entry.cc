@@ -40,6 +40,7 @@ void Entry::Dump(xe::StringBuffer* string_buffer, int indent) {
   }
   string_buffer->Append(name());
   string_buffer->Append('\n');
+  PopulateChildren();
   for (auto& child : children_) {
     child->Dump(string_buffer, indent + 2);
   }
@@ -49,14 +50,38 @@ bool Entry::is_read_only() const { return device_->is_read_only(); }
 
 Entry* Entry::GetChild(const std::string_view name) {
   auto global_lock = global_critical_region_.Acquire();
-  auto it = std::find_if(children_.cbegin(), children_.cend(),
-                         [&](const auto& child) {
-                           return xe::utf8::equal_case(child->name(), name);
-                         });
-  if (it == children_.cend()) {
+  PopulateChildren();
+  if (children_.size() < kChildIndexMinCount) {
+    auto it = std::find_if(children_.cbegin(), children_.cend(),
+                           [&](const auto& child) {
+                             return xe::utf8::equal_case(child->name(), name);
+                           });
+    if (it == children_.cend()) {
+      return nullptr;
+    }
+    return (*it).get();
+  }
+  // Index the children added since the last lookup. The first child with the
+  // name is kept, like with the linear search.
+  if (child_index_count_ < children_.size()) {
+    child_index_.reserve(children_.size());
+    for (; child_index_count_ < children_.size(); ++child_index_count_) {
+      Entry* child = children_[child_index_count_].get();
+      child_index_.emplace(string_key_case(std::string_view(child->name())),
+                           child);
+    }
+  }
+  auto it = child_index_.find(string_key_case(name));
+  if (it == child_index_.cend()) {
     return nullptr;
   }
-  return (*it).get();
+  return it->second;
+}
+
+void Entry::ResetChildIndex() {
+  auto global_lock = global_critical_region_.Acquire();
+  child_index_.clear();
+  child_index_count_ = 0;
 }
 
 Entry* Entry::ResolvePath(const std::string_view path) {
@@ -75,6 +100,7 @@ Entry* Entry::ResolvePath(const std::string_view path) {
 Entry* Entry::IterateChildren(const xe::filesystem::WildcardEngine& engine,
                               size_t* current_index) {
   auto global_lock = global_critical_region_.Acquire();
+  PopulateChildren();
   while (*current_index < children_.size()) {
     auto& child = children_[*current_index];
     *current_index = *current_index + 1;
@@ -100,6 +126,7 @@ Entry* Entry::CreateEntry(const std::string_view name, uint32_t attributes) {
   }
   children_.push_back(std::move(entry));
   // TODO(benvanik): resort? would break iteration?
+  device_->InvalidateEntries();
   Touch();
   return children_.back().get();
 }
@@ -117,10 +144,12 @@ bool Entry::Delete(Entry* entry) {
   }
   for (auto it = children_.begin(); it != children_.end(); ++it) {
     if (it->get() == entry) {
+      ResetChildIndex();
       children_.erase(it);
       break;
     }
   }
+  device_->InvalidateEntries();
   Touch();
   return true;
 }
@@ -135,6 +164,7 @@ void Entry::Touch() {
 }
 
 void Entry::Rename(const std::filesystem::path file_path) {
+  auto global_lock = global_critical_region_.Acquire();
   std::vector<std::string_view> splitted_path =
       xe::utf8::split_path(xe::path_to_utf8(file_path));
 
@@ -145,6 +175,12 @@ void Entry::Rename(const std::filesystem::path file_path) {
 
   RenameEntryInternal(guest_path_without_root);
 
+  // The index of the parent refers to the current name.
+  if (parent_) {
+    parent_->ResetChildIndex();
+  }
+  device_->InvalidateEntries();
+
   absolute_path_ = xe::utf8::join_guest_paths(device_->mount_path(),
                                               guest_path_without_root);
   path_ = guest_path_without_root;
@@ -12,6 +12,7 @@
 
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "xenia/base/filesystem.h"
@@ -19,6 +20,7 @@
 #include "xenia/base/mapped_memory.h"
 #include "xenia/base/mutex.h"
 #include "xenia/base/string_buffer.h"
+#include "xenia/base/string_key.h"
 #include "xenia/xbox.h"
 
 namespace xe {
@@ -108,10 +110,14 @@ class Entry {
   Entry* GetChild(const std::string_view name);
   Entry* ResolvePath(const std::string_view path);
 
-  const std::vector<std::unique_ptr<Entry>>& children() const {
+  const std::vector<std::unique_ptr<Entry>>& children() {
+    PopulateChildren();
     return children_;
   }
-  size_t child_count() const { return children_.size(); }
+  size_t child_count() {
+    PopulateChildren();
+    return children_.size();
+  }
   Entry* IterateChildren(const xe::filesystem::WildcardEngine& engine,
                          size_t* current_index);
 
@@ -142,6 +148,13 @@ class Entry {
   }
   virtual bool DeleteEntryInternal(Entry* entry) = 0;
   virtual void RenameEntryInternal(const std::filesystem::path file_path) {}
+  // Called before the children are accessed, for devices that create them on
+  // demand.
+  virtual void PopulateChildren() {}
+
+  // Drops the index of the children, must be done whenever a child is removed
+  // or renamed.
+  void ResetChildIndex();
 
   xe::global_critical_region global_critical_region_;
   Device* device_;
@@ -157,6 +170,16 @@ class Entry {
   uint64_t write_timestamp_;
   bool delete_on_close_;
   std::vector<std::unique_ptr<Entry>> children_;
+
+ private:
+  // Directories with fewer children are searched linearly.
+  static constexpr size_t kChildIndexMinCount = 32;
+
+  // Case-insensitive index of the children by their names, built when first
+  // needed for large directories. Children may be appended directly by the
+  // devices, so only the first child_index_count_ children are in it.
+  std::unordered_map<string_key_case, Entry*> child_index_;
+  size_t child_index_count_ = 0;
 };
 
 }  // namespace vfs
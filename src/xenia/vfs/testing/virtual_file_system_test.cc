@@ -0,0 +1,169 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2024 Xenia Emulator. All rights reserved.                        *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/vfs/virtual_file_system.h"
+
+#include <chrono>
+
+#include "third_party/catch/include/catch.hpp"
+#include "third_party/fmt/include/fmt/format.h"
+
+namespace xe::vfs::test {
+
+class TestEntry : public Entry {
+ public:
+  TestEntry(Device* device, Entry* parent, const std::string_view path,
+            uint32_t attributes)
+      : Entry(device, parent, path) {
+    attributes_ = attributes;
+  }
+
+  X_STATUS Open(uint32_t desired_access, File** out_file) override {
+    return X_STATUS_NOT_IMPLEMENTED;
+  }
+
+  void AddChild(const std::string_view name, uint32_t attributes) {
+    children_.push_back(std::make_unique<TestEntry>(
+        device_, this, xe::utf8::join_guest_paths(path_, name), attributes));
+  }
+
+ protected:
+  std::unique_ptr<Entry> CreateEntryInternal(const std::string_view name,
+                                             uint32_t attributes) override {
+    return std::make_unique<TestEntry>(
+        device_, this, xe::utf8::join_guest_paths(path_, name), attributes);
+  }
+  bool DeleteEntryInternal(Entry* entry) override { return true; }
+};
+
+class TestDevice : public Device {
+ public:
+  explicit TestDevice(const std::string_view mount_path)
+      : Device(mount_path),
+        root_entry_(std::make_unique<TestEntry>(this, nullptr, "",
+                                                kFileAttributeDirectory)) {}
+
+  bool Initialize() override { return true; }
+  bool is_read_only() const override { return false; }
+  void Dump(StringBuffer* string_buffer) override {}
+  Entry* ResolvePath(const std::string_view path) override {
+    return root_entry_->ResolvePath(path);
+  }
+
+  const std::string& name() const override { return name_; }
+  uint32_t attributes() const override { return 0; }
+  uint32_t component_name_max_length() const override { return 40; }
+  uint32_t total_allocation_units() const override { return 0; }
+  uint32_t available_allocation_units() const override { return 0; }
+  uint32_t sectors_per_allocation_unit() const override { return 0; }
+  uint32_t bytes_per_sector() const override { return 0; }
+
+  TestEntry* root_entry() const { return root_entry_.get(); }
+
+ private:
+  std::string name_ = "Test";
+  std::unique_ptr<TestEntry> root_entry_;
+};
+
+// A directory with many files, added directly like the devices do.
+static TestDevice* CreateTestTree(VirtualFileSystem& vfs, uint32_t file_count) {
+  auto device = std::make_unique<TestDevice>("\\Device\\Test");
+  TestDevice* device_ptr = device.get();
+  vfs.RegisterDevice(std::move(device));
+  device_ptr->root_entry()->AddChild("Data", kFileAttributeDirectory);
+  auto data =
+      static_cast<TestEntry*>(device_ptr->root_entry()->GetChild("data"));
+  for (uint32_t i = 0; i < file_count; ++i) {
+    data->AddChild(fmt::format("File{}.bin", i), kFileAttributeNormal);
+  }
+  return device_ptr;
+}
+
+TEST_CASE("VFS path resolution in large directories", "[vfs]") {
+  VirtualFileSystem vfs;
+  CreateTestTree(vfs, 1000);
+
+  Entry* entry = vfs.ResolvePath("\\Device\\Test\\Data\\File500.bin");
+  REQUIRE(entry);
+  REQUIRE(entry->name() == "File500.bin");
+  REQUIRE(vfs.ResolvePath("\\Device\\Test\\DATA\\file500.BIN") == entry);
+  REQUIRE_FALSE(vfs.ResolvePath("\\Device\\Test\\Data\\File1000.bin"));
+
+  // Created entries are found, also through symbolic links.
+  REQUIRE(vfs.RegisterSymbolicLink("test:", "\\Device\\Test"));
+  Entry* created =
+      vfs.CreatePath("test:\\Data\\New.bin", kFileAttributeNormal);
+  REQUIRE(created);
+  REQUIRE(vfs.ResolvePath("\\Device\\Test\\Data\\new.bin") == created);
+  REQUIRE(vfs.ResolvePath("test:\\Data\\File500.bin") == entry);
+
+  // Deleted entries aren't returned from the cache.
+  REQUIRE(vfs.DeletePath("\\Device\\Test\\Data\\File500.bin"));
+  REQUIRE_FALSE(vfs.ResolvePath("\\Device\\Test\\Data\\File500.bin"));
+  REQUIRE(vfs.ResolvePath("\\Device\\Test\\Data\\File999.bin"));
+
+  // Renamed entries are only found by the new name.
+  Entry* renamed = vfs.ResolvePath("\\Device\\Test\\Data\\File10.bin");
+  REQUIRE(renamed);
+  renamed->Rename("\\Device/Data/Renamed.bin");
+  REQUIRE(renamed->name() == "Renamed.bin");
+  REQUIRE_FALSE(vfs.ResolvePath("\\Device\\Test\\Data\\File10.bin"));
+  REQUIRE(vfs.ResolvePath("\\Device\\Test\\Data\\Renamed.bin") == renamed);
+
+  // Unregistered devices aren't returned from the cache.
+  REQUIRE(vfs.UnregisterDevice("\\Device\\Test"));
+  REQUIRE_FALSE(vfs.ResolvePath("\\Device\\Test\\Data\\File999.bin"));
+}
+
+// Run explicitly with the [.benchmark] tag.
+TEST_CASE("VFS path resolution benchmark", "[vfs][.benchmark]") {
+  constexpr uint32_t kFileCount = 50000;
+  VirtualFileSystem vfs;
+  TestDevice* device = CreateTestTree(vfs, kFileCount);
+
+  auto time = [](const char* name, uint32_t count, auto&& function) {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    double ns = std::chrono::duration<double, std::nano>(
+                    std::chrono::steady_clock::now() - start)
+                    .count() /
+                count;
+    fmt::print("{}: {:.1f} ns\n", name, ns);
+  };
+
+  std::vector<std::string> paths;
+  for (uint32_t i = 0; i < kFileCount; i += 7) {
+    paths.push_back(fmt::format("\\Device\\Test\\Data\\file{}.bin", i));
+  }
+  size_t found = 0;
+  time("Resolve (uncached)", uint32_t(paths.size()), [&] {
+    for (const std::string& path : paths) {
+      // Different paths each time, so mostly the child index is used.
+      found += vfs.ResolvePath(path) != nullptr;
+    }
+  });
+  time("Resolve child in the device", uint32_t(paths.size()), [&] {
+    for (const std::string& path : paths) {
+      found += device->ResolvePath(std::string_view(path).substr(
+                   sizeof("\\Device\\Test") - 1)) !=
+               nullptr;
+    }
+  });
+  std::vector<std::string> hot_paths(paths.begin(), paths.begin() + 256);
+  time("Resolve (cached)", uint32_t(hot_paths.size()) * 100, [&] {
+    for (uint32_t i = 0; i < 100; ++i) {
+      for (const std::string& path : hot_paths) {
+        found += vfs.ResolvePath(path) != nullptr;
+      }
+    }
+  });
+  REQUIRE(found == paths.size() * 2 + hot_paths.size() * 100);
+}
+
+}  // namespace xe::vfs::test
@@ -31,12 +31,14 @@ VirtualFileSystem::~VirtualFileSystem() {
 }
 
 void VirtualFileSystem::Clear() {
+  resolved_path_cache_.clear();
   devices_.clear();
   symlinks_.clear();
 }
 
 bool VirtualFileSystem::RegisterDevice(std::unique_ptr<Device> device) {
   auto global_lock = global_critical_region_.Acquire();
+  resolved_path_cache_.clear();
   devices_.emplace_back(std::move(device));
   return true;
 }
@@ -46,6 +48,7 @@ bool VirtualFileSystem::UnregisterDevice(const std::string_view path) {
   for (auto it = devices_.begin(); it != devices_.end(); ++it) {
     if ((*it)->mount_path() == path) {
       XELOGD("Unregistered device: {}", (*it)->mount_path());
+      resolved_path_cache_.clear();
       devices_.erase(it);
       return true;
     }
@@ -56,6 +59,7 @@ bool VirtualFileSystem::UnregisterDevice(const std::string_view path) {
 bool VirtualFileSystem::RegisterSymbolicLink(const std::string_view path,
                                              const std::string_view target) {
   auto global_lock = global_critical_region_.Acquire();
+  resolved_path_cache_.clear();
   symlinks_.insert({std::string(path), std::string(target)});
   XELOGD("Registered symbolic link: {} => {}", path, target);
 
@@ -72,6 +76,7 @@ bool VirtualFileSystem::UnregisterSymbolicLink(const std::string_view path) {
   }
   XELOGD("Unregistered symbolic link: {} => {}", it->first, it->second);
 
+  resolved_path_cache_.clear();
   symlinks_.erase(it);
   return true;
 }
@@ -112,6 +117,15 @@ bool VirtualFileSystem::ResolveSymbolicLink(const std::string_view path,
 Entry* VirtualFileSystem::ResolvePath(const std::string_view path) {
   auto global_lock = global_critical_region_.Acquire();
 
+  auto cached_it = resolved_path_cache_.find(string_key(path));
+  if (cached_it != resolved_path_cache_.end()) {
+    const ResolvedPath& cached = cached_it->second;
+    if (cached.device->entries_generation() == cached.entries_generation) {
+      return cached.entry;
+    }
+    resolved_path_cache_.erase(cached_it);
+  }
+
   // Resolve relative paths
   auto normalized_path(xe::utf8::canonicalize_guest_path(path));
 
@@ -137,7 +151,16 @@ Entry* VirtualFileSystem::ResolvePath(const std::string_view path) {
 
   const auto& device = *it;
   auto relative_path = normalized_path.substr(device->mount_path().size());
-  return device->ResolvePath(relative_path);
+  Entry* entry = device->ResolvePath(relative_path);
+  if (entry) {
+    if (resolved_path_cache_.size() >= kResolvedPathCacheMaxSize) {
+      resolved_path_cache_.clear();
+    }
+    resolved_path_cache_.emplace(
+        string_key::create(path),
+        ResolvedPath{device.get(), device->entries_generation(), entry});
+  }
+  return entry;
 }
 
 Entry* VirtualFileSystem::CreatePath(const std::string_view path,
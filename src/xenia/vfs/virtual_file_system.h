@@ -16,6 +16,7 @@
 #include <vector>
 
 #include "xenia/base/mutex.h"
+#include "xenia/base/string_key.h"
 #include "xenia/vfs/device.h"
 #include "xenia/vfs/entry.h"
 #include "xenia/vfs/file.h"
@@ -60,9 +61,22 @@ class VirtualFileSystem {
                                    std::filesystem::path base_path);
 
  private:
+  struct ResolvedPath {
+    Device* device;
+    // Generation of the entries of the device the path was resolved in.
+    uint64_t entries_generation;
+    Entry* entry;
+  };
+
+  // The cache is cleared when full rather than evicting individual paths.
+  static constexpr size_t kResolvedPathCacheMaxSize = 4096;
+
   xe::global_critical_region global_critical_region_;
   std::vector<std::unique_ptr<Device>> devices_;
   std::unordered_map<std::string, std::string> symlinks_;
+  // Entries recently found by ResolvePath, by the exact path requested. Must
+  // be cleared when devices or symbolic links are changed.
+  std::unordered_map<string_key, ResolvedPath> resolved_path_cache_;
 
   bool ResolveSymbolicLink(const std::string_view path, std::string& result);
 };